@@ -0,0 +1,126 @@
+/// \file BenchDebugDraw.cpp
+/// \brief Cost of the immediate-mode debug primitives of DebugScene, up to
+/// 100k per frame: recording them in a DebugDrawList, and rendering them
+/// (upload and batched draws, GPU time measured with fences) when they are
+/// redrawn every frame or kept from the last one. Renders headless.
+#include "candlewick/core/DebugDraw.h"
+#include "candlewick/core/DebugScene.h"
+#include "candlewick/core/Camera.h"
+#include "candlewick/core/Renderer.h"
+
+#include <benchmark/benchmark.h>
+#include <entt/entity/registry.hpp>
+#include <SDL3/SDL_init.h>
+#include <optional>
+#include <vector>
+
+using namespace candlewick;
+
+static std::optional<Renderer> g_renderer;
+
+/// Random positions in a 2m cube, shared by the benchmarks.
+static const std::vector<Float3> &randomPoints(size_t count) {
+  static std::vector<Float3> points;
+  while (points.size() < count)
+    points.push_back(Float3::Random());
+  return points;
+}
+
+/// A mix of the primitive types: lines, points, spheres, boxes and arrows.
+static void drawPrimitives(DebugDrawList &list, size_t count) {
+  const auto &points = randomPoints(count + 1);
+  const Float4 color{0.2f, 0.6f, 1.f, 1.f};
+  for (size_t i = 0; i < count; i++) {
+    const Float3 &p = points[i];
+    switch (i % 5) {
+    case 0:
+      list.line(p, points[i + 1], color);
+      break;
+    case 1:
+      list.point(p, 0.005f, color);
+      break;
+    case 2:
+      list.sphere(p, 0.01f, color);
+      break;
+    case 3: {
+      Mat4f pose = Mat4f::Identity();
+      pose.topRightCorner<3, 1>() = p;
+      list.box(pose, Float3::Constant(0.01f), color);
+      break;
+    }
+    case 4:
+      list.arrow(p, p + 0.05f * Float3::UnitZ(), color, 0.002f);
+      break;
+    }
+  }
+}
+
+static void primitiveCounts(benchmark::internal::Benchmark *b) {
+  b->ArgName("primitives");
+  for (int count : {1000, 10'000, 100'000})
+    b->Arg(count);
+}
+
+static void BM_Record(benchmark::State &state) {
+  const size_t count = size_t(state.range(0));
+  DebugDrawList list;
+  for (auto _ : state) {
+    list.clear();
+    drawPrimitives(list, count);
+    benchmark::DoNotOptimize(list.size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Frames of the debug scene alone. With redraw=0, the primitives of the
+/// first frame are kept and not uploaded again.
+static void BM_Render(benchmark::State &state) {
+  Renderer &renderer = *g_renderer;
+  const size_t count = size_t(state.range(0));
+  const bool redraw = bool(state.range(1));
+  entt::registry registry;
+  DebugScene scene{registry, renderer};
+  const Camera camera{
+      .projection = perspectiveFromFov(55.0_degf, 4.f / 3.f, 0.01f, 10.f),
+      .view = Eigen::Isometry3f{lookAt({3.f, 0.f, 1.f}, Float3::Zero())},
+  };
+
+  scene.drawImmediate([&](DebugDrawList &list) { drawPrimitives(list, count); });
+  for (auto _ : state) {
+    if (redraw) {
+      scene.drawImmediate(
+          [&](DebugDrawList &list) { drawPrimitives(list, count); });
+    }
+    CommandBuffer cmdBuf = renderer.acquireCommandBuffer();
+    renderer.waitAndAcquireSwapchain(cmdBuf);
+    scene.render(cmdBuf, camera);
+    SDL_GPUFence *fence = cmdBuf.submitAndAcquireFence();
+    SDL_WaitForGPUFences(renderer.device, true, &fence, 1);
+    SDL_ReleaseGPUFence(renderer.device, fence);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  scene.release();
+}
+
+BENCHMARK(BM_Record)->Apply(primitiveCounts);
+BENCHMARK(BM_Render)
+    ->ArgNames({"primitives", "redraw"})
+    ->ArgsProduct({{1000, 10'000, 100'000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  g_renderer.emplace(Device{auto_detect_shader_format_subset()},
+                     OffscreenTargetInfo{1280, 960},
+                     SDL_GPU_TEXTUREFORMAT_D32_FLOAT);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  g_renderer.reset();
+  SDL_Quit();
+  return 0;
+}
@@ -0,0 +1,134 @@
+/// \file BenchPixelFormatConversion.cpp
+/// \brief Benchmark of the pixel format conversion kernels at 1080p and 4K.
+#include "candlewick/utils/PixelFormatConversion.h"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace candlewick;
+
+struct Resolution {
+  Uint32 width;
+  Uint32 height;
+};
+
+static void resolutionArgs(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"width", "height"});
+  b->Args({1920, 1080});
+  b->Args({3840, 2160});
+}
+
+static Resolution getResolution(const benchmark::State &state) {
+  return {Uint32(state.range(0)), Uint32(state.range(1))};
+}
+
+static void setProcessed(benchmark::State &state, size_t bytesPerIter) {
+  state.SetBytesProcessed(Sint64(state.iterations() * bytesPerIter));
+  state.SetLabel(pixelConversionBackend());
+}
+
+/// Scalar baseline, for comparison.
+static void BM_bgra_to_rgba_scalar(benchmark::State &state) {
+  auto [w, h] = getResolution(state);
+  std::vector<Uint32> src(w * h, 0x11223344), dst(w * h);
+  for (auto _ : state) {
+    for (size_t i = 0; i < src.size(); i++) {
+      const Uint32 p = src[i];
+      dst[i] = ((p & 0x00FF0000) >> 16) | (p & 0x0000FF00) |
+               ((p & 0x000000FF) << 16) | (p & 0xFF000000);
+    }
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(Sint64(state.iterations() * src.size() * 4));
+}
+BENCHMARK(BM_bgra_to_rgba_scalar)->Apply(resolutionArgs);
+
+static void BM_bgra_to_rgba(benchmark::State &state) {
+  auto [w, h] = getResolution(state);
+  std::vector<Uint32> src(w * h, 0x11223344), dst(w * h);
+  for (auto _ : state) {
+    bgraToRgbaConvert(src.data(), dst.data(), w * h);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  setProcessed(state, src.size() * 4);
+}
+BENCHMARK(BM_bgra_to_rgba)->Apply(resolutionArgs);
+
+static void BM_rgba_to_rgb(benchmark::State &state) {
+  auto [w, h] = getResolution(state);
+  std::vector<Uint8> src(4 * w * h, 0x7f), dst(3 * w * h);
+  for (auto _ : state) {
+    rgbaToRgbConvert(src.data(), dst.data(), w * h);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  setProcessed(state, src.size());
+}
+BENCHMARK(BM_rgba_to_rgb)->Apply(resolutionArgs);
+
+static void BM_bgra_to_rgb(benchmark::State &state) {
+  auto [w, h] = getResolution(state);
+  std::vector<Uint8> src(4 * w * h, 0x7f), dst(3 * w * h);
+  for (auto _ : state) {
+    bgraToRgbConvert(src.data(), dst.data(), w * h);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  setProcessed(state, src.size());
+}
+BENCHMARK(BM_bgra_to_rgb)->Apply(resolutionArgs);
+
+/// RGBA32F color image to RGBA8.
+static void BM_float_to_unorm8(benchmark::State &state) {
+  auto [w, h] = getResolution(state);
+  std::vector<float> src(4 * w * h, 0.5f);
+  std::vector<Uint8> dst(4 * w * h);
+  for (auto _ : state) {
+    floatToUnorm8Convert(src.data(), dst.data(), Uint32(src.size()));
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  setProcessed(state, src.size() * sizeof(float));
+}
+BENCHMARK(BM_float_to_unorm8)->Apply(resolutionArgs);
+
+static void BM_depth_to_unorm16(benchmark::State &state) {
+  auto [w, h] = getResolution(state);
+  std::vector<float> src(w * h, 0.5f);
+  std::vector<Uint16> dst(w * h);
+  for (auto _ : state) {
+    depthToUnorm16Convert(src.data(), dst.data(), w * h);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  setProcessed(state, src.size() * sizeof(float));
+}
+BENCHMARK(BM_depth_to_unorm16)->Apply(resolutionArgs);
+
+static void BM_flip_vertically(benchmark::State &state) {
+  auto [w, h] = getResolution(state);
+  std::vector<Uint8> src(4 * w * h, 0x7f), dst(4 * w * h);
+  for (auto _ : state) {
+    flipImageVertically(src.data(), dst.data(), 4 * w, h);
+    benchmark::DoNotOptimize(dst.data());
+    benchmark::ClobberMemory();
+  }
+  setProcessed(state, src.size());
+}
+BENCHMARK(BM_flip_vertically)->Apply(resolutionArgs);
+
+static void BM_flip_vertically_inplace(benchmark::State &state) {
+  auto [w, h] = getResolution(state);
+  std::vector<Uint8> img(4 * w * h, 0x7f);
+  for (auto _ : state) {
+    flipImageVertically(img.data(), img.data(), 4 * w, h);
+    benchmark::DoNotOptimize(img.data());
+    benchmark::ClobberMemory();
+  }
+  setProcessed(state, img.size());
+}
+BENCHMARK(BM_flip_vertically_inplace)->Apply(resolutionArgs);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,138 @@
+/// \file BenchSceneQuery.cpp
+/// \brief Cost of the CPU scene queries used for picking and hovering: ray
+/// casts refined on the picking meshes, nearest entity and frustum overlaps,
+/// and the per-frame BVH refit, for 500 to 5k entities. Runs headless.
+#include "candlewick/core/Bvh.h"
+#include "candlewick/core/Camera.h"
+#include "candlewick/core/Components.h"
+#include "candlewick/core/SceneQuery.h"
+#include "candlewick/primitives/Sphere.h"
+
+#include <benchmark/benchmark.h>
+#include <entt/entity/registry.hpp>
+#include <Eigen/Geometry>
+#include <vector>
+
+using namespace candlewick;
+
+/// Spheres of radius 0.2, randomly placed in a 10m cube.
+struct Scene {
+  entt::registry reg;
+  std::vector<entt::entity> entities;
+  SceneQuery query;
+
+  explicit Scene(Eigen::Index count) {
+    MeshData data = loadUvSphereSolid(16, 32);
+    auto sphere = std::make_shared<const TriangleBvh>(
+        buildTriangleBvh(std::span{&data, 1}));
+    for (Eigen::Index i = 0; i < count; i++) {
+      auto ent = reg.create();
+      Mat4f M = Mat4f::Identity();
+      M.topLeftCorner<3, 3>() =
+          0.2f * Eigen::Quaternionf::UnitRandom().toRotationMatrix();
+      M.topRightCorner<3, 1>() = 5.f * Float3::Random();
+      reg.emplace<TransformComponent>(ent, M);
+      reg.emplace<LocalBoundsComponent>(
+          ent, BoundingBox{Float3::Zero(), Float3::Ones()});
+      reg.emplace<PickingMeshComponent>(ent, sphere);
+      entities.push_back(ent);
+    }
+    query.update(reg);
+  }
+};
+
+/// Rays from outside the scene towards random points of it.
+static std::vector<Ray> randomRays(size_t count) {
+  std::vector<Ray> rays(count);
+  for (auto &ray : rays) {
+    const Float3 origin = 10.f * Float3::Random().normalized();
+    ray = {origin, (5.f * Float3::Random() - origin).normalized()};
+  }
+  return rays;
+}
+
+static void entityCounts(benchmark::internal::Benchmark *b) {
+  b->ArgName("entities");
+  for (int count : {500, 1000, 5000})
+    b->Arg(count);
+}
+
+static void BM_Raycast(benchmark::State &state) {
+  Scene scene{state.range(0)};
+  const auto rays = randomRays(256);
+  size_t i = 0;
+  for (auto _ : state) {
+    auto hit = scene.query.raycast(rays[i++ % rays.size()]);
+    benchmark::DoNotOptimize(hit);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_Nearest(benchmark::State &state) {
+  Scene scene{state.range(0)};
+  std::vector<Float3> points(256);
+  for (auto &p : points)
+    p = 6.f * Float3::Random();
+  size_t i = 0;
+  for (auto _ : state) {
+    auto hit = scene.query.nearest(points[i++ % points.size()]);
+    benchmark::DoNotOptimize(hit);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// Box selection of a quarter of the image.
+static void BM_Frustum(benchmark::State &state) {
+  Scene scene{state.range(0)};
+  const Camera camera{
+      .projection = perspectiveFromFov(60.0_degf, 1.f, 0.1f, 30.f),
+      .view = Eigen::Isometry3f{
+          lookAt({0.f, 0.f, 15.f}, Float3::Zero(), Float3::UnitY())},
+  };
+  const auto frustum =
+      cameraRectFrustum(camera, Float2::Zero(), Float2::Ones());
+  std::vector<entt::entity> found;
+  for (auto _ : state) {
+    found.clear();
+    scene.query.queryFrustum(frustum, found);
+    benchmark::DoNotOptimize(found.data());
+  }
+  state.counters["found"] = double(found.size());
+}
+
+/// Per-frame update, with a fraction (in percent) of the entities moving by
+/// small steps: refits only.
+static void BM_UpdateRefit(benchmark::State &state) {
+  Scene scene{state.range(0)};
+  const size_t moving = scene.entities.size() * size_t(state.range(1)) / 100;
+  float t = 0.f;
+  for (auto _ : state) {
+    t += 1e-3f;
+    for (size_t i = 0; i < moving; i++) {
+      auto &M = scene.reg.get<TransformComponent>(scene.entities[i]);
+      M(0, 3) += (i % 2 ? 1e-3f : -1e-3f) * std::sin(t);
+    }
+    scene.query.update(scene.reg);
+  }
+  state.counters["rebuilds"] = double(scene.query.stats().rebuilds);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Rebuild(benchmark::State &state) {
+  Scene scene{state.range(0)};
+  for (auto _ : state) {
+    scene.query.invalidate();
+    scene.query.update(scene.reg);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_Raycast)->Apply(entityCounts);
+BENCHMARK(BM_Nearest)->Apply(entityCounts);
+BENCHMARK(BM_Frustum)->Apply(entityCounts);
+BENCHMARK(BM_UpdateRefit)
+    ->ArgNames({"entities", "moving%"})
+    ->ArgsProduct({{500, 5000}, {0, 10, 100}});
+BENCHMARK(BM_Rebuild)->Apply(entityCounts);
+
+BENCHMARK_MAIN();
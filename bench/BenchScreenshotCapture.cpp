@@ -0,0 +1,150 @@
+/// \file BenchScreenshotCapture.cpp
+/// \brief Throughput (frames per second) of image capture: file encoding
+/// alone, asynchronous capture with ScreenshotCapture, and the synchronous
+/// dumpTextureImgToFile().
+#include "candlewick/core/CommandBuffer.h"
+#include "candlewick/core/Device.h"
+#include "candlewick/core/Texture.h"
+#include "candlewick/utils/ScreenshotCapture.h"
+#include "candlewick/utils/WriteTextureToImage.h"
+
+#include <benchmark/benchmark.h>
+#include <magic_enum/magic_enum.hpp>
+#include <SDL3/SDL_init.h>
+#include <SDL3/SDL_log.h>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <vector>
+
+using namespace candlewick;
+using media::ImageFileFormat;
+
+static constexpr Uint32 wWidth = 1920;
+static constexpr Uint32 wHeight = 1080;
+
+static std::optional<Device> g_device;
+static std::optional<Texture> g_colorTexture;
+
+static const std::filesystem::path g_outputDir =
+    std::filesystem::temp_directory_path() / "candlewick_bench_capture";
+
+static media::ImageWriteOptions getOptions(const benchmark::State &state) {
+  return {
+      .format = ImageFileFormat(state.range(0)),
+      .pngCompressionLevel = int(state.range(1)),
+  };
+}
+
+static std::string outputPath(const media::ImageWriteOptions &options,
+                              Sint64 index) {
+  auto name = std::format("frame_{:d}.{:s}", index,
+                          magic_enum::enum_name(options.format));
+  return (g_outputDir / name).string();
+}
+
+static void formatArgs(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"format", "png_level"});
+  b->Args({int(ImageFileFormat::PPM), 0});
+  b->Args({int(ImageFileFormat::PAM), 0});
+  b->Args({int(ImageFileFormat::NPY), 0});
+  for (int level : {1, 4, 8})
+    b->Args({int(ImageFileFormat::PNG), level});
+  b->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+/// Encoding and writing only, on the calling thread.
+static void BM_write_image(benchmark::State &state) {
+  const auto options = getOptions(state);
+  const Uint32 channels = media::imageFileChannels(options.format);
+  std::vector<Uint8> pixels(wWidth * wHeight * channels);
+  for (size_t i = 0; i < pixels.size(); i++)
+    pixels[i] = Uint8((i / 7) % 256);
+
+  Sint64 index = 0;
+  for (auto _ : state) {
+    media::writeImageFile(outputPath(options, index++), pixels.data(), wWidth,
+                          wHeight, channels, options);
+  }
+  state.counters["fps"] =
+      benchmark::Counter(double(state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_write_image)->Apply(formatArgs);
+
+/// Asynchronous capture of a GPU texture, until all files are written.
+static void BM_capture_async(benchmark::State &state) {
+  if (!g_device) {
+    state.SkipWithError("No GPU device.");
+    return;
+  }
+  const auto options = getOptions(state);
+  media::ScreenshotCapture capture{*g_device, 4, 8};
+  Sint64 index = 0;
+  for (auto _ : state) {
+    CommandBuffer cmdBuf{*g_device};
+    capture.capture(cmdBuf, *g_colorTexture, g_colorTexture->format(), wWidth,
+                    wHeight, outputPath(options, index++), options);
+  }
+  capture.waitAll();
+  const auto stats = capture.stats();
+  state.counters["fps"] =
+      benchmark::Counter(double(stats.written), benchmark::Counter::kIsRate);
+  state.counters["stalls"] = double(stats.stalls);
+}
+BENCHMARK(BM_capture_async)->Apply(formatArgs);
+
+/// Baseline: synchronous PNG capture.
+static void BM_capture_sync_png(benchmark::State &state) {
+  if (!g_device) {
+    state.SkipWithError("No GPU device.");
+    return;
+  }
+  Sint64 index = 0;
+  for (auto _ : state) {
+    media::dumpTextureImgToFile(
+        *g_device, *g_colorTexture, g_colorTexture->format(), wWidth, wHeight,
+        outputPath({.format = ImageFileFormat::PNG}, index++).c_str());
+  }
+  state.counters["fps"] =
+      benchmark::Counter(double(state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_capture_sync_png)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  std::filesystem::create_directories(g_outputDir);
+
+  if (SDL_Init(SDL_INIT_VIDEO)) {
+    try {
+      g_device.emplace(auto_detect_shader_format_subset());
+      g_colorTexture.emplace(
+          *g_device,
+          SDL_GPUTextureCreateInfo{
+              .type = SDL_GPU_TEXTURETYPE_2D,
+              .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+              .usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET,
+              .width = wWidth,
+              .height = wHeight,
+              .layer_count_or_depth = 1,
+              .num_levels = 1,
+              .sample_count = SDL_GPU_SAMPLECOUNT_1,
+              .props = 0,
+          },
+          "Capture source");
+    } catch (const std::exception &e) {
+      SDL_Log("GPU benchmarks disabled: %s", e.what());
+      g_device.reset();
+    }
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  g_colorTexture.reset();
+  g_device.reset();
+  SDL_Quit();
+  std::filesystem::remove_all(g_outputDir);
+  return 0;
+}
@@ -0,0 +1,135 @@
+/// \file BenchSharedMemoryState.cpp
+/// \brief Overhead of the shared-memory state channel: cost of publishing and
+/// reading a sample, and delivery latency with a producer publishing at
+/// 10 kHz.
+#include "candlewick/utils/SharedMemoryState.h"
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace candlewick;
+using std::chrono::steady_clock;
+
+static std::string channelName() {
+  return std::format("/candlewick_bench_{:d}", getpid());
+}
+
+/// Channel created by the benchmark process, playing the producer.
+struct ProducerChannel {
+  candlewick_shm_state state;
+  ProducerChannel(Uint32 dim, Uint32 capacity) {
+    if (candlewick_shm_state_create(channelName().c_str(),
+                                    CANDLEWICK_SHM_STATE_CONFIGURATION, dim,
+                                    capacity, &state) != 0)
+      throw std::runtime_error("Failed to create shared state channel.");
+  }
+  ~ProducerChannel() { candlewick_shm_state_destroy(&state, 1); }
+};
+
+static double nowNs() {
+  return double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    steady_clock::now().time_since_epoch())
+                    .count());
+}
+
+static void BM_Publish(benchmark::State &state) {
+  const Uint32 dim = Uint32(state.range(0));
+  ProducerChannel channel{dim, 8};
+  std::vector<double> q(dim, 0.5);
+  double t = 0.;
+  for (auto _ : state) {
+    candlewick_shm_state_publish(&channel.state, t, q.data());
+    t += 1e-4;
+  }
+  state.SetBytesProcessed(Sint64(state.iterations() * dim * sizeof(double)));
+}
+
+static void BM_PublishAndRead(benchmark::State &state) {
+  const Uint32 dim = Uint32(state.range(0));
+  ProducerChannel channel{dim, 8};
+  SharedStateReader reader{channelName()};
+  std::vector<double> q(dim, 0.5);
+  std::vector<double> out(dim);
+  double t = 0., t_read;
+  for (auto _ : state) {
+    candlewick_shm_state_publish(&channel.state, t, q.data());
+    benchmark::DoNotOptimize(reader.readLatest(out, t_read));
+    t += 1e-4;
+  }
+  state.SetBytesProcessed(Sint64(state.iterations() * dim * sizeof(double)));
+}
+
+/// No new sample: the cost of polling the channel once per frame.
+static void BM_PollEmpty(benchmark::State &state) {
+  ProducerChannel channel{7, 8};
+  SharedStateReader reader{channelName()};
+  std::vector<double> out(7);
+  double t_read;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(reader.readLatest(out, t_read));
+  }
+}
+
+/// A producer thread publishes at 10 kHz; each iteration waits for a new
+/// sample and reads it. The latency counter measures the delay between the
+/// publication and the end of the read.
+static void BM_Stream10kHz(benchmark::State &state) {
+  const Uint32 dim = Uint32(state.range(0));
+  ProducerChannel channel{dim, 8};
+  SharedStateReader reader{channelName()};
+  std::atomic<bool> stop{false};
+  std::atomic<Uint64> publish_ns{0};
+
+  std::thread producer{[&] {
+    constexpr std::chrono::microseconds period{100};
+    std::vector<double> q(dim, 0.5);
+    Uint64 count = 0;
+    auto next = steady_clock::now();
+    while (!stop.load(std::memory_order_relaxed)) {
+      // sleeping is too coarse for a 100 us period
+      while (steady_clock::now() < next)
+        std::this_thread::yield();
+      const double t = nowNs();
+      candlewick_shm_state_publish(&channel.state, t, q.data());
+      publish_ns.fetch_add(Uint64(nowNs() - t), std::memory_order_relaxed);
+      count++;
+      next += period;
+    }
+    state.counters["publish_ns"] =
+        double(publish_ns.load()) / double(std::max(count, Uint64(1)));
+  }};
+
+  std::vector<double> out(dim);
+  double latency_total = 0.;
+  for (auto _ : state) {
+    double t_pub;
+    while (!reader.readLatest(out, t_pub))
+      std::this_thread::yield();
+    latency_total += nowNs() - t_pub;
+  }
+  stop.store(true);
+  producer.join();
+
+  const SharedStateStats &stats = reader.stats();
+  state.counters["latency_ns"] = latency_total / double(state.iterations());
+  state.counters["skipped"] = double(stats.skipped);
+  state.counters["retries"] = double(stats.retries);
+}
+
+// nq of a manipulator, of a humanoid, and placements of 60 geometries
+BENCHMARK(BM_Publish)->Arg(7)->Arg(36)->Arg(12 * 60);
+BENCHMARK(BM_PublishAndRead)->Arg(7)->Arg(36)->Arg(12 * 60);
+BENCHMARK(BM_PollEmpty);
+BENCHMARK(BM_Stream10kHz)
+    ->Arg(7)
+    ->Arg(12 * 60)
+    ->Iterations(20000)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
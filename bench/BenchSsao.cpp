@@ -0,0 +1,107 @@
+/// \file BenchSsao.cpp
+/// \brief Benchmark of the SSAO pass (GPU time, measured with fences) for
+/// each quality preset, with and without temporal accumulation, and for
+/// other combinations of resolution and kernel size.
+#include "candlewick/core/Renderer.h"
+#include "candlewick/core/Camera.h"
+#include "candlewick/core/DefaultVertex.h"
+#include "candlewick/core/MeshLayout.h"
+#include "candlewick/posteffects/SSAO.h"
+
+#include <benchmark/benchmark.h>
+#include <SDL3/SDL_init.h>
+#include <format>
+#include <optional>
+
+using namespace candlewick;
+
+static constexpr Uint32 wWidth = 1920;
+static constexpr Uint32 wHeight = 1080;
+
+static std::optional<Renderer> g_renderer;
+static std::optional<Texture> g_normalMap;
+
+/// Frames of the SSAO pass alone, with the given configuration.
+static void renderSsao(benchmark::State &state,
+                       const ssao::SsaoConfig &config) {
+  Renderer &renderer = *g_renderer;
+  ssao::SsaoPass pass{renderer, meshLayoutFor<DefaultVertex>(), *g_normalMap,
+                      config};
+  const float aspect = float(wWidth) / float(wHeight);
+  const Camera camera{
+      .projection = perspectiveFromFov(55.0_degf, aspect, 0.01f, 10.f),
+      .view = Eigen::Isometry3f{lookAt({2.f, 0.f, 1.f}, Float3::Zero())},
+  };
+
+  for (auto _ : state) {
+    CommandBuffer cmdBuf = renderer.acquireCommandBuffer();
+    pass.render(cmdBuf, camera);
+    SDL_GPUFence *fence = cmdBuf.submitAndAcquireFence();
+    SDL_WaitForGPUFences(renderer.device, true, &fence, 1);
+    SDL_ReleaseGPUFence(renderer.device, fence);
+  }
+  state.counters["fps"] =
+      benchmark::Counter(double(state.iterations()), benchmark::Counter::kIsRate);
+  pass.release();
+}
+
+/// One run per quality preset and temporal mode.
+static void BM_ssao_quality(benchmark::State &state) {
+  static constexpr const char *names[] = {"low", "medium", "high", "ultra"};
+  const auto quality = ssao::SsaoQuality(state.range(0));
+  const bool temporal = bool(state.range(1));
+  state.SetLabel(std::format("{:s}{:s}", names[state.range(0)],
+                             temporal ? ", temporal" : ""));
+  renderSsao(state, ssao::ssaoConfigForQuality(quality, temporal));
+}
+BENCHMARK(BM_ssao_quality)
+    ->ArgsProduct({{0, 1, 2, 3}, {0, 1}})
+    ->ArgNames({"quality", "temporal"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+static void BM_ssao(benchmark::State &state) {
+  const ssao::SsaoConfig config{
+      .resolution = ssao::SsaoResolution(state.range(0)),
+      .kernel_samples = Uint32(state.range(1)),
+      .temporal_accumulation = bool(state.range(2)),
+  };
+  renderSsao(state, config);
+}
+BENCHMARK(BM_ssao)
+    ->ArgsProduct({{1, 2, 4}, {16, 32, 64}, {0, 1}})
+    ->ArgNames({"downsample", "samples", "temporal"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  // headless: no video subsystem, nor window, required
+  g_renderer.emplace(Device{auto_detect_shader_format_subset()},
+                     OffscreenTargetInfo{wWidth, wHeight},
+                     SDL_GPU_TEXTUREFORMAT_D32_FLOAT);
+  g_normalMap.emplace(g_renderer->device,
+                      SDL_GPUTextureCreateInfo{
+                          .type = SDL_GPU_TEXTURETYPE_2D,
+                          .format = SDL_GPU_TEXTUREFORMAT_R16G16_FLOAT,
+                          .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER |
+                                   SDL_GPU_TEXTUREUSAGE_COLOR_TARGET,
+                          .width = wWidth,
+                          .height = wHeight,
+                          .layer_count_or_depth = 1,
+                          .num_levels = 1,
+                          .sample_count = SDL_GPU_SAMPLECOUNT_1,
+                          .props = 0,
+                      },
+                      "Normal map");
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  g_normalMap.reset();
+  g_renderer.reset();
+  SDL_Quit();
+  return 0;
+}
@@ -0,0 +1,107 @@
+/// \file BenchTransformBatch.cpp
+/// \brief Per-frame cost of the robot transform update for 1k to 10k
+/// geometries: conversion of double placements to float transforms, and
+/// normal matrices.
+#include "candlewick/core/TransformBatch.h"
+
+#include <benchmark/benchmark.h>
+#include <Eigen/Geometry>
+#include <vector>
+
+using namespace candlewick;
+
+/// Layout of a pinocchio::SE3.
+struct Placement {
+  Eigen::Matrix3d rotation;
+  Eigen::Vector3d translation;
+};
+
+static std::vector<Placement> randomPlacements(Eigen::Index count) {
+  std::vector<Placement> placements(static_cast<size_t>(count));
+  for (auto &M : placements) {
+    M.rotation = Eigen::Quaterniond::UnitRandom().toRotationMatrix();
+    M.translation.setRandom();
+  }
+  return placements;
+}
+
+static void geometryCounts(benchmark::internal::Benchmark *b) {
+  b->ArgName("geoms");
+  for (int count : {1000, 3000, 10000})
+    b->Arg(count);
+}
+
+/// Per-object conversion, as done before batching: cast each placement and
+/// build its homogeneous matrix.
+static void BM_PerObject(benchmark::State &state) {
+  const auto placements = randomPlacements(state.range(0));
+  std::vector<Mat4f> transforms(placements.size());
+  for (auto _ : state) {
+    for (size_t i = 0; i < placements.size(); i++) {
+      Mat4f &M = transforms[i];
+      M.setIdentity();
+      M.topLeftCorner<3, 3>() = placements[i].rotation.cast<float>();
+      M.topRightCorner<3, 1>() = placements[i].translation.cast<float>();
+    }
+    benchmark::DoNotOptimize(transforms.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Batched update, with a fraction (in percent) of the objects moving.
+static void BM_Batch(benchmark::State &state) {
+  const Eigen::Index count = state.range(0);
+  const Eigen::Index moving = count * state.range(1) / 100;
+  auto placements = randomPlacements(count);
+  std::vector<Mat4f> transforms(placements.size());
+  TransformBatch batch;
+  batch.resize(count);
+  double t = 0.;
+  for (auto _ : state) {
+    t += 1e-3;
+    for (Eigen::Index i = 0; i < moving; i++)
+      placements[size_t(i)].translation.x() = t;
+    for (Eigen::Index i = 0; i < count; i++) {
+      const Placement &M = placements[size_t(i)];
+      batch.setPlacement(i, M.rotation, M.translation);
+    }
+    for (Uint32 i : batch.update())
+      transforms[i] = batch.matrix(i);
+    benchmark::DoNotOptimize(transforms.data());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void batchArgs(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"geoms", "moving%"});
+  for (int count : {1000, 3000, 10000})
+    for (int moving : {0, 10, 100})
+      b->Args({count, moving});
+}
+
+/// Normal matrices of the model-view matrices: inverse transpose, or
+/// rotation part for rigid objects.
+static void BM_NormalMatrix(benchmark::State &state) {
+  const bool rigid = state.range(1);
+  const auto placements = randomPlacements(state.range(0));
+  std::vector<Mat4f> modelViews(placements.size(), Mat4f::Identity());
+  for (size_t i = 0; i < placements.size(); i++) {
+    modelViews[i].topLeftCorner<3, 3>() = placements[i].rotation.cast<float>();
+  }
+  std::vector<Mat3f> normals(placements.size());
+  for (auto _ : state) {
+    for (size_t i = 0; i < modelViews.size(); i++)
+      normals[i] = rigid ? math::computeRigidNormalMatrix(modelViews[i])
+                         : math::computeNormalMatrix(modelViews[i]);
+    benchmark::DoNotOptimize(normals.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_PerObject)->Apply(geometryCounts);
+BENCHMARK(BM_Batch)->Apply(batchArgs);
+BENCHMARK(BM_NormalMatrix)
+    ->ArgNames({"geoms", "rigid"})
+    ->ArgsProduct({{1000, 10000}, {0, 1}});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,414 @@
+/// Offline batch renderer: render robot trajectories to video files, without a
+/// window, as fast as the GPU allows.
+///
+/// Trajectories are CSV or NPY files where each row holds a timestamp followed
+/// by a configuration vector \f$q\f$. They are resampled at a fixed timestep
+/// (the video frame rate) by interpolating on the configuration space.
+/// Meshes are loaded once, and shared by all the rollouts of an invocation.
+///
+/// The trajectory loaders below are part of this example, not of the library.
+/// They read just what the example needs, have no tests, and may change with
+/// it: copy them rather than include this file.
+#include "candlewick/core/Camera.h"
+#include "candlewick/core/CommandBuffer.h"
+#include "candlewick/core/DepthAndShadowPass.h"
+#include "candlewick/core/Renderer.h"
+#include "candlewick/multibody/RobotScene.h"
+#include "candlewick/primitives/Plane.h"
+#include "candlewick/utils/VideoRecorder.h"
+#include "candlewick/utils/WriteTextureToImage.h"
+#include "candlewick/utils/YuvConversion.h"
+
+#include <pinocchio/algorithm/geometry.hpp>
+#include <pinocchio/algorithm/joint-configuration.hpp>
+#include <pinocchio/algorithm/kinematics.hpp>
+#include <pinocchio/multibody/data.hpp>
+#include <pinocchio/multibody/geometry.hpp>
+#include <pinocchio/multibody/model.hpp>
+#include <pinocchio/parsers/srdf.hpp>
+#include <pinocchio/parsers/urdf.hpp>
+
+#include <SDL3/SDL_init.h>
+#include <SDL3/SDL_log.h>
+
+#include <CLI/App.hpp>
+#include <CLI/Config.hpp>
+#include <CLI/Formatter.hpp>
+
+#include <entt/entity/registry.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace pin = pinocchio;
+using namespace candlewick;
+using multibody::RobotScene;
+
+// Example-only trajectory loading, see the file comment.
+
+/// Timestamped configurations, one column per sample.
+struct Trajectory {
+  std::vector<double> times;
+  Eigen::MatrixXd qs;
+};
+
+/// Raw trajectory table: one row per sample, time in the first column.
+struct TrajectoryTable {
+  Eigen::Index rows = 0;
+  Eigen::Index cols = 0;
+  std::vector<double> data;
+};
+
+static TrajectoryTable loadTableCsv(const std::filesystem::path &path) {
+  std::ifstream file{path};
+  if (!file)
+    throw std::runtime_error(
+        std::format("Cannot open trajectory file {:s}", path.string()));
+  TrajectoryTable table;
+  std::string line;
+  bool first_line = true;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::vector<double> row;
+    std::istringstream ss{line};
+    std::string cell;
+    bool numeric = true;
+    while (std::getline(ss, cell, ',')) {
+      char *end = nullptr;
+      const double value = std::strtod(cell.c_str(), &end);
+      if (end == cell.c_str()) {
+        numeric = false;
+        break;
+      }
+      row.push_back(value);
+    }
+    if (!numeric) {
+      // allow a header line
+      if (first_line) {
+        first_line = false;
+        continue;
+      }
+      throw std::runtime_error(std::format(
+          "{:s}: non-numeric value in row {:d}", path.string(), table.rows));
+    }
+    first_line = false;
+    if (table.cols == 0)
+      table.cols = Eigen::Index(row.size());
+    if (Eigen::Index(row.size()) != table.cols)
+      throw std::runtime_error(std::format(
+          "{:s}: row {:d} has {:d} columns, expected {:d}", path.string(),
+          table.rows, row.size(), table.cols));
+    table.data.insert(table.data.end(), row.begin(), row.end());
+    table.rows++;
+  }
+  return table;
+}
+
+/// Load a 2D, C-ordered, little-endian float32 or float64 NPY array.
+static TrajectoryTable loadTableNpy(const std::filesystem::path &path) {
+  std::ifstream file{path, std::ios::binary};
+  if (!file)
+    throw std::runtime_error(
+        std::format("Cannot open trajectory file {:s}", path.string()));
+  auto fail = [&](const char *reason) {
+    return std::runtime_error(
+        std::format("{:s}: unsupported NPY file ({:s})", path.string(),
+                    reason));
+  };
+
+  char magic[8];
+  if (!file.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, "\x93NUMPY", 6) != 0)
+    throw fail("bad magic string");
+  const Uint8 major = Uint8(magic[6]);
+  Uint32 header_len = 0;
+  if (major == 1) {
+    Uint8 len[2];
+    file.read(reinterpret_cast<char *>(len), 2);
+    header_len = Uint32(len[0]) | Uint32(len[1]) << 8;
+  } else {
+    Uint8 len[4];
+    file.read(reinterpret_cast<char *>(len), 4);
+    header_len = Uint32(len[0]) | Uint32(len[1]) << 8 | Uint32(len[2]) << 16 |
+                 Uint32(len[3]) << 24;
+  }
+  std::string header(header_len, '\0');
+  if (!file.read(header.data(), header_len))
+    throw fail("truncated header");
+
+  const bool is_f8 = header.find("'<f8'") != std::string::npos;
+  const bool is_f4 = header.find("'<f4'") != std::string::npos;
+  if (!is_f8 && !is_f4)
+    throw fail("dtype must be float32 or float64");
+  if (header.find("'fortran_order': True") != std::string::npos)
+    throw fail("Fortran order");
+  const size_t open = header.find('(', header.find("'shape'"));
+  const size_t close = header.find(')', open);
+  if (open == std::string::npos || close == std::string::npos)
+    throw fail("no shape");
+  std::vector<long> shape;
+  std::istringstream ss{header.substr(open + 1, close - open - 1)};
+  std::string dim;
+  while (std::getline(ss, dim, ',')) {
+    if (dim.find_first_not_of(' ') != std::string::npos)
+      shape.push_back(std::stol(dim));
+  }
+  if (shape.size() != 2)
+    throw fail("array must be 2D");
+
+  TrajectoryTable table{shape[0], shape[1], {}};
+  const size_t count = size_t(table.rows * table.cols);
+  table.data.resize(count);
+  if (is_f8) {
+    file.read(reinterpret_cast<char *>(table.data.data()),
+              std::streamsize(count * sizeof(double)));
+  } else {
+    std::vector<float> values(count);
+    file.read(reinterpret_cast<char *>(values.data()),
+              std::streamsize(count * sizeof(float)));
+    std::copy(values.begin(), values.end(), table.data.begin());
+  }
+  if (!file)
+    throw fail("truncated data");
+  return table;
+}
+
+/// Load a trajectory. Configurations with fewer than `nq` coordinates are
+/// completed with the trailing coordinates of \p q_ref.
+static Trajectory loadTrajectory(const std::filesystem::path &path,
+                                 const Eigen::VectorXd &q_ref) {
+  const TrajectoryTable table =
+      path.extension() == ".npy" ? loadTableNpy(path) : loadTableCsv(path);
+  const Eigen::Index nq = q_ref.size();
+  const Eigen::Index ncoords = table.cols - 1;
+  if (table.rows == 0 || ncoords < 1 || ncoords > nq)
+    throw std::runtime_error(std::format(
+        "{:s}: expected rows of a time and up to {:d} coordinates, got {:d} "
+        "rows of {:d} columns",
+        path.string(), nq, table.rows, table.cols));
+
+  Trajectory traj;
+  traj.times.resize(size_t(table.rows));
+  traj.qs.resize(nq, table.rows);
+  for (Eigen::Index i = 0; i < table.rows; i++) {
+    const double *row = table.data.data() + i * table.cols;
+    traj.times[size_t(i)] = row[0];
+    traj.qs.col(i) = q_ref;
+    traj.qs.col(i).head(ncoords) =
+        Eigen::Map<const Eigen::VectorXd>(row + 1, ncoords);
+    if (i > 0 && !(row[0] >= traj.times[size_t(i - 1)]))
+      throw std::runtime_error(std::format(
+          "{:s}: timestamps must be non-decreasing (row {:d})", path.string(),
+          i));
+  }
+  return traj;
+}
+
+/// Sample a trajectory at time \p t. Samples must be requested in increasing
+/// time order: \p cursor holds the current segment.
+static void sampleTrajectory(const pin::Model &model, const Trajectory &traj,
+                             double t, size_t &cursor, Eigen::VectorXd &q) {
+  const size_t last = traj.times.size() - 1;
+  while (cursor < last && traj.times[cursor + 1] <= t)
+    cursor++;
+  if (cursor == last || t <= traj.times[cursor]) {
+    q = traj.qs.col(Eigen::Index(cursor));
+    return;
+  }
+  const double t0 = traj.times[cursor];
+  const double t1 = traj.times[cursor + 1];
+  const double alpha = (t - t0) / (t1 - t0);
+  q = pin::interpolate(model, traj.qs.col(Eigen::Index(cursor)),
+                       traj.qs.col(Eigen::Index(cursor + 1)), alpha);
+}
+
+int main(int argc, char **argv) {
+  CLI::App app{"Render robot trajectories to video files, headlessly."};
+  std::string urdf_path;
+  std::string srdf_path;
+  std::string reference_config = "half_sitting";
+  std::vector<std::string> package_dirs;
+  std::vector<std::filesystem::path> trajectory_paths;
+  std::filesystem::path output_dir = ".";
+  Uint32 width = 1280;
+  Uint32 height = 720;
+  int fps = 30;
+  long bit_rate = 8'000'000;
+  float fov = 55.f;
+  std::array<float, 3> eye{2.0f, 2.0f, 1.5f};
+  std::array<float, 3> target{0.f, 0.f, 0.5f};
+  Uint32 readback_slots = 3;
+  bool enable_shadows = true;
+
+  argv = app.ensure_utf8(argv);
+  app.add_option("--urdf", urdf_path, "Robot URDF file")
+      ->required()
+      ->check(CLI::ExistingFile);
+  app.add_option("--srdf", srdf_path,
+                 "Robot SRDF file, for the reference configuration")
+      ->check(CLI::ExistingFile);
+  app.add_option("--reference-config", reference_config,
+                 "SRDF reference configuration completing trajectories with "
+                 "fewer coordinates than the model")
+      ->capture_default_str();
+  app.add_option("--package-dir", package_dirs,
+                 "Directories to look for mesh packages in");
+  app.add_option("trajectories", trajectory_paths,
+                 "Trajectory files (CSV or NPY): rows of time, q")
+      ->required()
+      ->check(CLI::ExistingFile);
+  app.add_option("-o,--output-dir", output_dir,
+                 "Directory for the output videos, named after the "
+                 "trajectory files")
+      ->capture_default_str();
+  app.add_option("--width", width)->capture_default_str();
+  app.add_option("--height", height)->capture_default_str();
+  app.add_option("--fps", fps, "Video frame rate, i.e. sampling rate")
+      ->capture_default_str();
+  app.add_option("--bitrate", bit_rate)->capture_default_str();
+  app.add_option("--fov", fov, "Vertical field of view, in degrees")
+      ->capture_default_str();
+  app.add_option("--eye", eye, "Camera position")->capture_default_str();
+  app.add_option("--target", target, "Camera target")->capture_default_str();
+  app.add_option("--readback-slots", readback_slots,
+                 "Frames in flight between the GPU and the encoder")
+      ->capture_default_str();
+  app.add_flag("!--no-shadows", enable_shadows, "Disable shadow mapping");
+  CLI11_PARSE(app, argc, argv);
+
+  if (width % 2 != 0 || height % 2 != 0) {
+    SDL_Log("Video size must be even (got %u x %u).", width, height);
+    return 1;
+  }
+  std::filesystem::create_directories(output_dir);
+
+  pin::Model model;
+  pin::urdf::buildModel(urdf_path, model);
+  pin::GeometryModel geom_model;
+  pin::urdf::buildGeom(model, urdf_path, pin::VISUAL, geom_model,
+                       package_dirs);
+  pin::Data pin_data{model};
+  pin::GeometryData geom_data{geom_model};
+
+  Eigen::VectorXd q_ref = pin::neutral(model);
+  if (!srdf_path.empty()) {
+    pin::srdf::loadReferenceConfigurations(model, srdf_path, false);
+    auto it = model.referenceConfigurations.find(reference_config);
+    if (it != model.referenceConfigurations.end())
+      q_ref = it->second;
+  }
+
+  // headless: no window, no video subsystem
+  Renderer renderer{Device{auto_detect_shader_format_subset()},
+                    OffscreenTargetInfo{width, height},
+                    SDL_GPU_TEXTUREFORMAT_D16_UNORM};
+  SDL_Log("Device driver: %s", renderer.device.driverName());
+
+  entt::registry registry{};
+  RobotScene::Config robot_scene_config;
+  robot_scene_config.enable_shadows = enable_shadows;
+  robot_scene_config.enable_ssao = false;
+  RobotScene robot_scene{registry, renderer, geom_model, geom_data,
+                         robot_scene_config};
+  robot_scene.directionalLight = {
+      .direction = {0.f, -1.f, -1.f},
+      .color = {1.0f, 1.0f, 1.0f},
+      .intensity = 8.0f,
+  };
+  robot_scene.worldSpaceBounds.update({-1.f, -1.f, 0.f}, {+1.f, +1.f, 1.f});
+  robot_scene.addEnvironmentObject(loadPlaneTiled(0.5f, 25, 25),
+                                   Mat4f::Identity());
+
+  const Camera camera{
+      .projection = perspectiveFromFov(Degf(fov), float(width) / float(height),
+                                       0.01f, 100.f),
+      .view = Eigen::Isometry3f{
+          lookAt(Float3::Map(eye.data()), Float3::Map(target.data()))},
+  };
+
+  // RGB -> NV12 conversion happens on the GPU, only 1.5 bytes per pixel are
+  // read back.
+  media::YuvConverter yuv_converter{renderer.device, width, height};
+
+  Uint64 total_frames = 0;
+  const auto batch_start = std::chrono::steady_clock::now();
+  Eigen::VectorXd q = q_ref;
+
+  for (const auto &trajectory_path : trajectory_paths) {
+    const Trajectory traj = loadTrajectory(trajectory_path, q_ref);
+    const double t_begin = traj.times.front();
+    const double duration = traj.times.back() - t_begin;
+    const Uint64 num_frames = Uint64(std::floor(duration * fps)) + 1;
+    const auto video_path =
+        output_dir / trajectory_path.filename().replace_extension(".mp4");
+
+    // the encoder applies back-pressure instead of dropping frames
+    media::VideoRecorder recorder{width, height, video_path.string(),
+                                  {
+                                      .fps = fps,
+                                      .bit_rate = bit_rate,
+                                      .outputWidth = int(width),
+                                      .outputHeight = int(height),
+                                      .queue_capacity = 16u,
+                                      .queue_policy =
+                                          media::FrameQueuePolicy::BLOCK,
+                                  }};
+    media::FrameReadbackRing readback = media::createVideoReadbackRing(
+        renderer.device, recorder, yuv_converter, readback_slots);
+
+    const auto start = std::chrono::steady_clock::now();
+    size_t cursor = 0;
+    for (Uint64 frame = 0; frame < num_frames; frame++) {
+      // fixed timestep, independent of the wall clock
+      const double t = t_begin + double(frame) / fps;
+      sampleTrajectory(model, traj, t, cursor, q);
+      pin::forwardKinematics(model, pin_data, q);
+      pin::updateGeometryPlacements(model, pin_data, geom_model, geom_data);
+      robot_scene.updateTransforms();
+
+      CommandBuffer command_buffer = renderer.acquireCommandBuffer();
+      renderer.waitAndAcquireSwapchain(command_buffer);
+      robot_scene.uploadTransforms(command_buffer);
+      if (enable_shadows) {
+        robot_scene.collectOpaqueCastables();
+        renderShadowPassFromAABB(command_buffer, robot_scene.shadowPass,
+                                 robot_scene.directionalLight,
+                                 robot_scene.castables(),
+                                 robot_scene.transformBuffer(),
+                                 robot_scene.worldSpaceBounds);
+      }
+      robot_scene.render(command_buffer, camera);
+      yuv_converter.convert(command_buffer, renderer.swapchain);
+      readback.submitFrame(command_buffer, yuv_converter.planes());
+    }
+    readback.flush();
+    readback.release();
+    recorder.close();
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    const auto &stats = readback.stats();
+    SDL_Log("%s: %zu frames in %.3f s (%.1f frames/s), %zu dropped",
+            video_path.string().c_str(), size_t(stats.delivered),
+            elapsed.count(), double(stats.delivered) / elapsed.count(),
+            size_t(stats.dropped + recorder.droppedFrames()));
+    total_frames += stats.delivered;
+  }
+
+  const std::chrono::duration<double> total_elapsed =
+      std::chrono::steady_clock::now() - batch_start;
+  SDL_Log("Rendered %zu rollouts, %zu frames in %.3f s (%.1f frames/s)",
+          trajectory_paths.size(), size_t(total_frames), total_elapsed.count(),
+          double(total_frames) / total_elapsed.count());
+
+  SDL_WaitForGPUIdle(renderer.device);
+  yuv_converter.release();
+  robot_scene.release();
+  renderer.destroy();
+  SDL_Quit();
+  return 0;
+}
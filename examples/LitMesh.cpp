@@ -7,7 +7,7 @@
 #include "candlewick/utils/LoadMesh.h"
 #include "candlewick/core/CameraControls.h"
 #include "candlewick/core/LightUniforms.h"
-#include "candlewick/core/TransformUniforms.h"
+#include "candlewick/core/TransformBuffer.h"
 
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_gpu.h>
@@ -42,6 +42,12 @@ struct light_ubo_t {
   float intensity;
 };
 
+struct view_ubo_t {
+  GpuMat4 view;
+  GpuMat4 viewProj;
+  GpuMat4 lightViewProj;
+};
+
 int main() {
   if (!SDL_Init(SDL_INIT_VIDEO))
     return 1;
@@ -76,6 +82,7 @@ int main() {
     meshes.push_back(std::move(mesh));
   }
   SDL_assert(meshDatas[0].numIndices() == meshes[0].indexCount);
+  TransformBuffer transforms{device, 1};
 
   /** CREATE PIPELINE **/
   SDL_GPUDepthStencilTargetInfo depth_target_info;
@@ -180,10 +187,11 @@ int main() {
         }
       }
     }
-    // MVP matrix
-    const Eigen::Affine3f modelView = camera.camera.view * modelMat;
-    const Mat4f mvp = camera.camera.projection * modelView.matrix();
-    const Mat3f normalMatrix = math::computeNormalMatrix(modelView);
+    const view_ubo_t viewUbo{
+        camera.camera.view.matrix(),
+        camera.camera.viewProj(),
+        Mat4f::Identity(),
+    };
 
     // render pass
 
@@ -196,6 +204,9 @@ int main() {
       SDL_Log("Failed to acquire swapchain: %s", SDL_GetError());
       break;
     } else {
+      transforms.clear();
+      const Uint32 objectIndex = transforms.push(modelMat.matrix(), false);
+      transforms.upload(command_buffer);
 
       SDL_GPUColorTargetInfo ctinfo{
           .texture = ctx.swapchain,
@@ -212,12 +223,8 @@ int main() {
       SDL_BindGPUVertexBuffers(render_pass, 0, &vertex_binding, 1);
       SDL_BindGPUIndexBuffer(render_pass, &index_binding,
                              SDL_GPU_INDEXELEMENTSIZE_32BIT);
+      transforms.bind(render_pass);
 
-      TransformUniformData cameraUniform{
-          .modelView = modelView.matrix(),
-          .mvp = mvp,
-          .normalMatrix = normalMatrix,
-      };
       light_ubo_t lightUbo{
           camera.camera.transformVector(myLight.direction),
           myLight.color,
@@ -226,8 +233,10 @@ int main() {
 
       auto materialUbo = meshDatas[0].material;
 
-      SDL_PushGPUVertexUniformData(command_buffer, 0, &cameraUniform,
-                                   sizeof(cameraUniform));
+      SDL_PushGPUVertexUniformData(command_buffer, 0, &objectIndex,
+                                   sizeof(objectIndex));
+      SDL_PushGPUVertexUniformData(command_buffer, 1, &viewUbo,
+                                   sizeof(viewUbo));
       SDL_PushGPUFragmentUniformData(command_buffer, 0, &materialUbo,
                                      sizeof(materialUbo));
       SDL_PushGPUFragmentUniformData(command_buffer, 1, &lightUbo,
@@ -245,6 +254,7 @@ int main() {
   for (auto &mesh : meshes) {
     mesh.release();
   }
+  transforms.release();
   SDL_ReleaseGPUGraphicsPipeline(device, pipeline);
 
   ctx.destroy();
@@ -259,7 +259,7 @@ int main(int argc, char **argv) {
   robot_debug.addFrameVelocityArrow(debug_scene, ee_frame_id);
 
   auto depthPassInfo =
-      DepthPassInfo::create(renderer, plane_obj.mesh.layout(), NULL,
+      DepthPassInfo::create(renderer, plane_obj.mesh->layout(), NULL,
                             {SDL_GPU_CULLMODE_NONE, 0.05f, 0.f, true, false});
   auto &shadowPassInfo = robot_scene.shadowPass;
   auto shadowDebugPass =
@@ -338,7 +338,7 @@ int main(int argc, char **argv) {
                           1.f);
         ImGui::ColorEdit3("color", sceneLight.color.data());
         ImGui::Separator();
-        ImGui::ColorEdit4("grid color", grid.colors[0].data(),
+        ImGui::ColorEdit4("grid color", grid.color.data(),
                           ImGuiColorEditFlags_AlphaPreview);
         ImGui::ColorEdit4("plane color",
                           plane_obj.materials[0].baseColor.data());
@@ -357,17 +357,29 @@ int main(int argc, char **argv) {
 
 #ifdef CANDLEWICK_WITH_FFMPEG_SUPPORT
   media::VideoRecorder recorder{NoInit};
-  if (performRecording)
+  media::FrameReadbackRing readback{NoInit};
+  // swapchain textures cannot be sampled, the converter copies them first
+  media::YuvConverter yuv_converter{NoInit};
+  if (performRecording) {
     recorder = media::VideoRecorder{wWidth, wHeight, "ur5.mp4"};
+    yuv_converter =
+        media::YuvConverter{renderer.device, wWidth, wHeight,
+                            renderer.getSwapchainTextureFormat(), wWidth,
+                            wHeight};
+    readback =
+        media::createVideoReadbackRing(renderer.device, recorder, yuv_converter);
+  }
 #endif
 
-  auto record_callback = [&] {
+  auto submit_frame = [&](CommandBuffer &cmdBuf) {
 #ifdef CANDLEWICK_WITH_FFMPEG_SUPPORT
-    auto swapchain_format = renderer.getSwapchainTextureFormat();
-    media::videoWriteTextureToFrame(renderer.device, recorder,
-                                    renderer.swapchain, swapchain_format,
-                                    wWidth, wHeight);
+    if (performRecording) {
+      yuv_converter.convert(cmdBuf, renderer.swapchain);
+      readback.submitFrame(cmdBuf, yuv_converter.planes());
+      return;
+    }
 #endif
+    cmdBuf.submit();
   };
 
   AABB &worldSpaceBounds = robot_scene.worldSpaceBounds;
@@ -399,11 +411,14 @@ int main(int argc, char **argv) {
     if (renderer.waitAndAcquireSwapchain(command_buffer)) {
       const GpuMat4 viewProj = g_camera.camera.viewProj();
       robot_scene.updateTransforms();
+      robot_scene.uploadTransforms(command_buffer);
       robot_scene.collectOpaqueCastables();
-      auto &castables = robot_scene.castables();
+      std::span castables = robot_scene.castables();
+      const auto &transforms = robot_scene.transformBuffer();
       renderShadowPassFromAABB(command_buffer, shadowPassInfo, sceneLight,
-                               castables, worldSpaceBounds);
-      renderDepthOnlyPass(command_buffer, depthPassInfo, viewProj, castables);
+                               castables, transforms, worldSpaceBounds);
+      renderDepthOnlyPass(command_buffer, depthPassInfo, viewProj, castables,
+                          transforms);
       switch (g_showDebugViz) {
       case FULL_RENDER:
         robot_scene.render(command_buffer, g_camera);
@@ -429,15 +444,24 @@ int main(int argc, char **argv) {
       continue;
     }
 
-    command_buffer.submit();
-
-    if (performRecording) {
-      record_callback();
-    }
+    submit_frame(command_buffer);
     frameNo++;
   }
 
+#ifdef CANDLEWICK_WITH_FFMPEG_SUPPORT
+  if (performRecording) {
+    readback.flush();
+    const auto &stats = readback.stats();
+    SDL_Log("Recorded %zu frames (%zu delayed, %zu dropped)",
+            size_t(stats.delivered), size_t(stats.delayed),
+            size_t(stats.dropped));
+    readback.release();
+  }
+#endif
   SDL_WaitForGPUIdle(renderer.device);
+#ifdef CANDLEWICK_WITH_FFMPEG_SUPPORT
+  yuv_converter.release();
+#endif
   frustumBoundsDebug.release();
   depthPassInfo.release();
   shadowDebugPass.release(renderer.device);
@@ -1,45 +1,99 @@
 # Small util script to run our shaders through glslc
 # https://github.com/google/shaderc
-import subprocess
+#
+# Every compiled stage is recorded in shaders/compiled/sources.sha256 with the
+# hash of its source (includes expanded). Run with --check to verify that the
+# compiled shaders exist and are up to date with shaders/src.
 import argparse
+import hashlib
+import json
+import os
 import pathlib as pt
+import re
+import subprocess
+import sys
+import tempfile
 
-parser = argparse.ArgumentParser()
-parser.add_argument("shader_name")
-group = parser.add_mutually_exclusive_group(required=True)
-group.add_argument(
-    "--stages", nargs="+", help="Shader stages to be compiled to SPIR-V."
-)
-group.add_argument(
-    "--all-stages",
-    "-a",
-    action="store_true",
-    help="Process all available shader stages.",
-)
-parser.add_argument(
-    "--no-cross",
-    action="store_true",
-    help="Skip the SPIR-V -> MSL transpiling and JSON metadata step.",
-)
-args = parser.parse_args()
-
-shader_name = args.shader_name
 SHADER_SRC_DIR = pt.Path("shaders/src")
 SHADER_OUT_DIR = pt.Path("shaders/compiled")
-print("Shader src dir:", SHADER_SRC_DIR.absolute())
-if args.all_stages:
-    stages = list(SHADER_SRC_DIR.glob(f"{shader_name}.[a-z]*"))
-else:
-    stages = [SHADER_SRC_DIR / f"{shader_name}.{stage}" for stage in args.stages]
+MANIFEST = SHADER_OUT_DIR / "sources.sha256"
+STAGE_SUFFIXES = (".vert", ".frag", ".comp")
+OUTPUT_SUFFIXES = (".spv", ".msl", ".json")
 
-print(f"Processing files: {stages}")
-assert len(stages) > 0, "No stages found!"
+INCLUDE_RE = re.compile(r'^\s*#\s*include\s+"([^"]+)"\s*$')
 
-for stage_file in stages:
-    assert stage_file.exists()
-    spv_file = SHADER_OUT_DIR / stage_file.name
-    spv_file = spv_file.with_suffix(spv_file.suffix + ".spv")
-    proc = subprocess.run(
+
+def expand_includes(path: pt.Path, stack=()) -> str:
+    """Source of a shader stage with its #include directives expanded, as
+    glslc does with -I shaders/src."""
+    if path in stack:
+        raise RuntimeError(f"Recursive include of {path}")
+    lines = []
+    for line in path.read_text().splitlines():
+        m = INCLUDE_RE.match(line)
+        if m:
+            lines.append(expand_includes(SHADER_SRC_DIR / m.group(1), stack + (path,)))
+        else:
+            lines.append(line)
+    return "\n".join(lines) + "\n"
+
+
+def source_hash(stage_file: pt.Path) -> str:
+    return hashlib.sha256(expand_includes(stage_file).encode()).hexdigest()
+
+
+def read_manifest() -> dict:
+    entries = {}
+    if MANIFEST.exists():
+        for line in MANIFEST.read_text().splitlines():
+            digest, name = line.split(maxsplit=1)
+            entries[name] = digest
+    return entries
+
+
+def write_manifest(entries: dict):
+    with MANIFEST.open("w") as f:
+        for name in sorted(entries):
+            f.write(f"{entries[name]}  {name}\n")
+
+
+def all_stages():
+    return sorted(p for p in SHADER_SRC_DIR.iterdir() if p.suffix in STAGE_SUFFIXES)
+
+
+def output_file(stage_file: pt.Path, suffix: str) -> pt.Path:
+    return SHADER_OUT_DIR / (stage_file.name + suffix)
+
+
+def check(stages) -> int:
+    """Report stages whose compiled outputs are missing, or older than their
+    sources."""
+    manifest = read_manifest()
+    errors = []
+    for stage_file in stages:
+        missing = [
+            output_file(stage_file, s).name
+            for s in OUTPUT_SUFFIXES
+            if not output_file(stage_file, s).exists()
+        ]
+        if missing:
+            errors.append(f"{stage_file.name}: missing {', '.join(missing)}")
+        elif manifest.get(stage_file.name) != source_hash(stage_file):
+            errors.append(f"{stage_file.name}: compiled from an older source")
+    for error in errors:
+        print(error)
+    if errors:
+        print(
+            f"{len(errors)} shader stage(s) out of date, regenerate them with"
+            " process_shaders.py."
+        )
+    return 1 if errors else 0
+
+
+def compile_glslc(stage_file: pt.Path, no_cross: bool):
+    spv_file = output_file(stage_file, ".spv")
+    print(f"Compiling SPV file {spv_file}")
+    subprocess.run(
         [
             "glslc",
             stage_file,
@@ -50,13 +104,12 @@ for stage_file in stages:
             spv_file,
         ],
         shell=False,
+        check=True,
     )
-    print(f"Compiling SPV file {spv_file}")
-
-    if not args.no_cross:
+    if not no_cross:
         for ext in (".json", ".msl"):
             out_file = spv_file.with_suffix(ext)
-            proc2 = subprocess.run(
+            subprocess.run(
                 [
                     "shadercross",
                     spv_file,
@@ -66,7 +119,187 @@ for stage_file in stages:
                     "2.1.0",
                 ],
                 shell=False,
+                check=True,
             )
 
+
+# Qt's shader baker bundles glslang and SPIRV-Cross. Its MSL resource indices
+# follow declaration order, so they are remapped to the layout SDL expects
+# (see SDL_CreateGPUShader): uniform buffers then storage buffers in
+# [[buffer]], sampled then storage textures in [[texture]], each by binding.
+MSL_RESOURCE_RE = re.compile(
+    r"(?P<decl>[\w:<>, ]+?)(?P<ref>[&*]?)\s*(?P<name>\w+)\s*"
+    r"\[\[(?P<kind>buffer|texture|sampler)\((?P<index>\d+)\)\]\]"
+)
+
+
+def sdl_msl_indices(reflection: dict):
+    def ranked(items):
+        return sorted(items, key=lambda item: item["binding"])
+
+    uniforms = ranked(reflection.get("uniformBlocks", []))
+    storage = ranked(reflection.get("storageBlocks", []))
+    samplers = ranked(reflection.get("combinedImageSamplers", []))
+    images = ranked(reflection.get("storageImages", []))
+    buffers = {b["blockName"]: i for i, b in enumerate(uniforms)}
+    buffers.update({b["blockName"]: len(uniforms) + i for i, b in enumerate(storage)})
+    textures = {t["name"]: i for i, t in enumerate(samplers)}
+    textures.update({t["name"]: len(samplers) + i for i, t in enumerate(images)})
+    counts = {
+        "samplers": len(samplers),
+        "storage_textures": len(images),
+        "storage_buffers": len(storage),
+        "uniform_buffers": len(uniforms),
+    }
+    return buffers, textures, counts
+
+
+def remap_msl(msl: str, reflection: dict) -> str:
+    buffers, textures, _ = sdl_msl_indices(reflection)
+
+    def lookup(table, name):
+        # SPIRV-Cross appends 0 to names which are MSL keywords
+        for key in (name, name.removesuffix("0")):
+            if key in table:
+                return table[key]
+        raise RuntimeError(f"No reflection data for MSL resource '{name}'")
+
+    def replace(m):
+        kind, name = m.group("kind"), m.group("name")
+        if kind == "buffer":
+            type_name = m.group("decl").split()[-1]
+            index = lookup(buffers, type_name)
+        elif kind == "sampler":
+            index = lookup(textures, name.removesuffix("Smplr"))
+        else:
+            index = lookup(textures, name)
+        return m.group(0)[: m.start("index") - m.start()] + f"{index})]]"
+
+    out = []
+    for line in msl.splitlines():
+        if " main0(" in line:
+            line = sort_msl_resources(MSL_RESOURCE_RE.sub(replace, line))
+        out.append(line.rstrip())
+    return "\n".join(out).rstrip() + "\n"
+
+
+def sort_msl_resources(signature: str) -> str:
+    """Order the resources of each kind of an entry point by index, as
+    shadercross does."""
+    head, _, rest = signature.partition("main0(")
+    params, _, tail = rest.rpartition(")")
+    args, depth, current = [], 0, ""
+    for c in params:
+        depth += c in "<([" and 1 or c in ">)]" and -1 or 0
+        if c == "," and depth == 0:
+            args.append(current.strip())
+            current = ""
+        else:
+            current += c
+    args.append(current.strip())
+
+    def key(arg):
+        m = MSL_RESOURCE_RE.search(arg)
+        return (m.group("kind"), int(m.group("index"))) if m else None
+
+    out, run = [], []
+    for arg in args + [None]:
+        k = key(arg) if arg else None
+        if run and (k is None or k[0] != key(run[0])[0]):
+            out += sorted(run, key=key)
+            run = []
+        if k is not None:
+            run.append(arg)
+        elif arg is not None:
+            out.append(arg)
+    return f"{head}main0({', '.join(out)}){tail}"
+
+
+def compile_qsb(qsb: str, stage_file: pt.Path):
+    print(f"Compiling {stage_file} with {qsb}")
+    env = dict(os.environ, LC_ALL="C.UTF-8")
+
+    def run(*args):
+        subprocess.run([qsb, "-s", *args], shell=False, check=True, env=env)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        tmp = pt.Path(tmp)
+        src = tmp / stage_file.name
+        src.write_text(expand_includes(stage_file))
+        pack = tmp / "shader.qsb"
+        run("--msl", "21", "-o", pack, src)
+        run("-x", "spirv,100", "-o", output_file(stage_file, ".spv"), pack)
+        run("-x", "msl,21", "-o", tmp / "shader.msl", pack)
+        run("-x", "reflect", "-o", tmp / "reflect.json", pack)
+        reflection = json.loads((tmp / "reflect.json").read_text())
+        msl = remap_msl((tmp / "shader.msl").read_text(), reflection)
+    output_file(stage_file, ".msl").write_text(msl)
+    _, _, counts = sdl_msl_indices(reflection)
+    items = ", ".join(f'"{k}": {v}' for k, v in counts.items())
+    output_file(stage_file, ".json").write_text(f"{{ {items} }}\n")
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument("shader_names", nargs="*")
+group = parser.add_mutually_exclusive_group()
+group.add_argument(
+    "--stages", nargs="+", help="Shader stages to be compiled to SPIR-V."
+)
+group.add_argument(
+    "--all-stages",
+    "-a",
+    action="store_true",
+    help="Process all available shader stages.",
+)
+parser.add_argument(
+    "--no-cross",
+    action="store_true",
+    help="Skip the SPIR-V -> MSL transpiling and JSON metadata step.",
+)
+parser.add_argument(
+    "--qsb",
+    metavar="PATH",
+    help="Compile with Qt's qsb tool (glslang and SPIRV-Cross) instead of"
+    " glslc and shadercross.",
+)
+parser.add_argument(
+    "--check",
+    action="store_true",
+    help="Check that the compiled shaders of the given shaders (default: all)"
+    " are up to date, without compiling them.",
+)
+args = parser.parse_args()
+
+print("Shader src dir:", SHADER_SRC_DIR.absolute())
+if args.shader_names:
+    stages = []
+    for shader_name in args.shader_names:
+        if args.stages:
+            stages += [SHADER_SRC_DIR / f"{shader_name}.{stage}" for stage in args.stages]
+        else:
+            stages += sorted(SHADER_SRC_DIR.glob(f"{shader_name}.[a-z]*"))
+elif args.check:
+    stages = all_stages()
+else:
+    parser.error("no shader name given")
+if not args.check and not (args.stages or args.all_stages):
+    parser.error("one of the arguments --stages --all-stages/-a is required")
+
+print(f"Processing files: {stages}")
+assert len(stages) > 0, "No stages found!"
+
+if args.check:
+    sys.exit(check(stages))
+
+manifest = read_manifest()
+for stage_file in stages:
+    assert stage_file.exists()
+    if args.qsb:
+        compile_qsb(args.qsb, stage_file)
+    else:
+        compile_glslc(stage_file, args.no_cross)
+    manifest[stage_file.name] = source_hash(stage_file)
+write_manifest(manifest)
+
 if args.no_cross:
     print("Skipping SPIR-V -> MSL transpiling and JSON metadata steps.")
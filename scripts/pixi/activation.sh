@@ -40,3 +40,4 @@ export CANDLEWICK_BUILD_TYPE=${CANDLEWICK_BUILD_TYPE:=Release}
 export CANDLEWICK_WITH_PYTHON=${CANDLEWICK_WITH_PYTHON:=ON}
 export CANDLEWICK_WITH_PINOCCHIO=${CANDLEWICK_WITH_PINOCCHIO:=OFF}
 export CANDLEWICK_BUILD_TESTS=${CANDLEWICK_BUILD_TESTS:=OFF}
+export CANDLEWICK_BUILD_BENCHMARKS=${CANDLEWICK_BUILD_BENCHMARKS:=OFF}
@@ -0,0 +1,39 @@
+#version 450
+
+layout(location=0) in vec3 inPosition;
+layout(location=1) in vec3 inNormal;
+// per-instance data: rows of the affine model transform, and color
+layout(location=8) in vec4 inModelRow0;
+layout(location=9) in vec4 inModelRow1;
+layout(location=10) in vec4 inModelRow2;
+layout(location=11) in vec4 inColor;
+
+layout(location=0) out vec4 interpColor;
+
+layout(set=1, binding=0) uniform TransformBlock {
+    mat4 viewProj;
+    // 1 for shaded shapes, 0 for unlit ones (line grids)
+    float lighting;
+};
+
+const vec3 LIGHT_DIR = vec3(0.267261, 0.534522, 0.801784);
+
+void main() {
+    vec4 pos = vec4(inPosition, 1.0);
+    vec3 worldPos = vec3(dot(inModelRow0, pos),
+                         dot(inModelRow1, pos),
+                         dot(inModelRow2, pos));
+    // the instance scale is not uniform (e.g. arrows): transform the normal
+    // with the cofactor matrix of the linear part, which is its inverse
+    // transpose up to the determinant
+    mat3 linear = transpose(mat3(inModelRow0.xyz, inModelRow1.xyz,
+                                 inModelRow2.xyz));
+    mat3 cofactor = mat3(cross(linear[1], linear[2]),
+                         cross(linear[2], linear[0]),
+                         cross(linear[0], linear[1]));
+    vec3 normal = normalize(cofactor * inNormal);
+    float shade = mix(1.0, 0.55 + 0.45 * abs(dot(normal, LIGHT_DIR)), lighting);
+
+    gl_Position = viewProj * vec4(worldPos, 1.0);
+    interpColor = vec4(shade * inColor.rgb, inColor.a);
+}
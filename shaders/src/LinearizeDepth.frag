@@ -0,0 +1,25 @@
+// To be used with DrawQuad.vert
+// Convert a depth buffer to linear view-space depth, e.g. for readback.
+#version 450
+
+#include "depth_utils.glsl"
+
+layout(location=0) in vec2 inUV;
+layout(location=0) out float outDepth;
+
+layout(set=2, binding=0) uniform sampler2D depthTex;
+
+layout(set=3, binding=0) uniform CameraParams {
+    float near;
+    float far;
+    uint isOrtho; // 0 for perspective, 1 for ortho
+};
+
+void main() {
+    float depth = texture(depthTex, inUV).r;
+    if (isOrtho == 1) {
+        outDepth = linearizeDepthOrtho(depth, near, far);
+    } else {
+        outDepth = linearizeDepth(depth, near, far);
+    }
+}
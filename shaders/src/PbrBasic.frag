@@ -2,6 +2,7 @@
 #define HAS_SHADOW_MAPS
 #define HAS_G_BUFFER
 #define HAS_SSAO
+#define HAS_INSTANCE_ID
 
 #include "tone_mapping.glsl"
 #include "pbr_material.glsl"
@@ -9,6 +10,7 @@
 layout(location=0) in vec3 fragViewPos;
 layout(location=1) in vec3 fragViewNormal;
 layout(location=2) in vec3 fragLightPos;
+layout(location=3) flat in vec4 fragTint;
 
 // set=3 is required, see SDL3's documentation for SDL_CreateGPUShader
 // https://wiki.libsdl.org/SDL3/SDL_CreateGPUShader
@@ -29,6 +31,13 @@ layout(set=3, binding=2) uniform EffectParams {
     uint useSsao;
 } params;
 
+#ifdef HAS_INSTANCE_ID
+layout(set=3, binding=3) uniform InstanceBlock {
+    // 0 is reserved for the background
+    uint instanceId;
+};
+#endif
+
 #ifdef HAS_SHADOW_MAPS
     layout (set=2, binding=0) uniform sampler2DShadow shadowMap;
 #endif
@@ -41,6 +50,10 @@ layout(location=0) out vec4 fragColor;
     // output normals for post-effects
     layout(location=1) out vec2 outNormal;
 #endif
+#ifdef HAS_INSTANCE_ID
+    // per-object segmentation IDs
+    layout(location=2) out uint outInstanceId;
+#endif
 
 // Constants
 const float PI = 3.14159265359;
@@ -127,8 +140,11 @@ void main() {
         normal = -normal;
     }
 
+    // per-object tint, e.g. for highlights
+    vec3 baseColor = mix(material.baseColor.rgb, fragTint.rgb, fragTint.a);
+
     // Base reflectivity
-    vec3 specColor = mix(F0.rrr, material.baseColor.rgb, material.metalness);
+    vec3 specColor = mix(F0.rrr, baseColor, material.metalness);
 
     // Cook-Torrance BRDF
     float NDF = distributionGGX(normal, H, material.roughness);
@@ -149,7 +165,7 @@ void main() {
     // Combine lighting (no attenuation for directional light)
     float NdotL = max(dot(normal, lightDir), 0.0);
     const vec3 lightCol = light.intensity * light.color;
-    vec3 Lo = (kD * material.baseColor.rgb / PI + specular) * lightCol * NdotL;
+    vec3 Lo = (kD * baseColor / PI + specular) * lightCol * NdotL;
 
 #ifdef HAS_SHADOW_MAPS
     float shadowValue = calcShadowmap(NdotL);
@@ -157,7 +173,7 @@ void main() {
 #endif
 
     // Ambient term (very simple)
-    vec3 ambient = vec3(0.03) * material.baseColor.rgb * material.ao;
+    vec3 ambient = vec3(0.03) * baseColor * material.ao;
 #ifdef HAS_SSAO
     float ssao_val;
     vec2 ssaoTexSize = textureSize(ssaoTex, 0).xy;
@@ -181,4 +197,7 @@ void main() {
 #ifdef HAS_G_BUFFER
     outNormal = fragViewNormal.rg;
 #endif
+#ifdef HAS_INSTANCE_ID
+    outInstanceId = instanceId;
+#endif
 }
@@ -1,5 +1,7 @@
 #version 450
 
+#include "object_transforms.glsl"
+
 layout(location=0) in vec3 inPosition;
 layout(location=1) in vec3 inNormal;
 
@@ -7,19 +9,15 @@ layout(location=1) in vec3 inNormal;
 layout(location=0) out vec3 fragViewPos;
 layout(location=1) out vec3 fragViewNormal;
 layout(location=2) out vec3 fragLightPos;
+layout(location=3) flat out vec4 fragTint;
 
 
 // set=1 is required, for some reason
-layout(set=1, binding=0) uniform TranformBlock
+layout(set=1, binding=1) uniform ViewBlock
 {
-    mat4 modelView;
-    mat4 mvp;
-    mat3 normalMatrix;
-};
-
-layout(set=1, binding=1) uniform LightBlockV
-{
-    mat4 lightMvp;
+    mat4 view;
+    mat4 viewProj;
+    mat4 lightViewProj;
 };
 
 out gl_PerVertex {
@@ -27,11 +25,15 @@ out gl_PerVertex {
 };
 
 void main() {
-    vec4 hp = vec4(inPosition, 1.0);
-    fragViewPos = vec3(modelView * hp);
-    fragViewNormal = normalize(normalMatrix * inNormal);
-    gl_Position = mvp * hp;
-
-    vec4 flps = lightMvp * hp;
+    ObjectTransform object = objects[objectIndex];
+    // same expression as ShadowCast.vert, for depth pre-passes
+    vec4 worldPos = object.model * vec4(inPosition, 1.0);
+    fragViewPos = vec3(view * worldPos);
+    // the view matrix is rigid
+    fragViewNormal = normalize(mat3(view) * (object.normalMatrix * inNormal));
+    gl_Position = viewProj * worldPos;
+
+    vec4 flps = lightViewProj * worldPos;
     fragLightPos = flps.xyz / flps.w;
+    fragTint = object.tint;
 }
@@ -0,0 +1,18 @@
+// Interleaved chroma (UV) plane of an RGB -> YUV 4:2:0 conversion, rendered
+// at half the luma resolution. The bilinear sampler averages each 2x2 block
+// of source pixels (at 1:1 scale), which is kept with two extra bits.
+// BT.601 coefficients, limited ("MPEG") range, with libswscale's integer
+// coefficients and rounding.
+#version 450
+
+layout(location=0) in vec2 inUV;
+layout(location=0) out vec2 outChroma;
+
+layout(set=2, binding=0) uniform sampler2D sourceTex;
+
+void main() {
+    ivec3 rgb = ivec3(round(texture(sourceTex, inUV).rgb * 1020.0));
+    int cb = (-4865 * rgb.r - 9528 * rgb.g + 14392 * rgb.b + 16843776) >> 17;
+    int cr = (14392 * rgb.r - 12061 * rgb.g - 2332 * rgb.b + 16843776) >> 17;
+    outChroma = vec2(clamp(ivec2(cb, cr), 0, 255)) / 255.0;
+}
@@ -0,0 +1,16 @@
+// Luma (Y) plane of an RGB -> YUV 4:2:0 conversion.
+// BT.601 coefficients, limited ("MPEG") range. The integer coefficients and
+// rounding are those of libswscale's RGBA -> YUV420P conversion, so that both
+// produce the same bytes.
+#version 450
+
+layout(location=0) in vec2 inUV;
+layout(location=0) out float outLuma;
+
+layout(set=2, binding=0) uniform sampler2D sourceTex;
+
+void main() {
+    ivec3 rgb = ivec3(round(texture(sourceTex, inUV).rgb * 255.0));
+    int y = (8414 * rgb.r + 16519 * rgb.g + 3208 * rgb.b + 540928) >> 15;
+    outLuma = float(clamp(y, 0, 255)) / 255.0;
+}
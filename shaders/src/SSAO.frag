@@ -8,30 +8,41 @@ layout(set=2, binding=0) uniform sampler2D depthTex;
 layout(set=2, binding=1) uniform sampler2D normalMap;
 layout(set=2, binding=2) uniform sampler2D ssaoNoise;
 
-const int SSAO_KERNEL_SIZE = 64;
-const float SSAO_RADIUS = 1.0;
-const float SSAO_BIAS = 0.01;
-const float SSAO_INTENSITY = 1.5;
-
-layout(set=3, binding=0) uniform SSAOParams {
-    vec4 samples[SSAO_KERNEL_SIZE];
+// kernel samples, uploaded once
+layout(std430, set=2, binding=3) readonly buffer SSAOKernel {
+    vec4 samples[];
 } kernel;
 
-layout(set=3, binding=1) uniform Camera {
+layout(set=3, binding=0) uniform Camera {
     mat4 projection;
+    // precomputed on the CPU
+    mat4 invProjection;
 } camera;
 
+layout(set=3, binding=1) uniform SSAOParams {
+    int numSamples;
+    uint frameIndex;
+    float radius;
+    float bias;
+    float intensity;
+} params;
+
+const float GOLDEN_ANGLE = 2.39996323;
+
 vec3 getViewPos(float depth, vec2 uv) {
     vec4 clipPos = vec4(uv * 2.0 - 1.0, depth, 1.0);
-    vec4 viewPos = inverse(camera.projection) * clipPos;
+    vec4 viewPos = camera.invProjection * clipPos;
     return viewPos.xyz / viewPos.w;
 }
 
-vec3 sampleNoiseTexture(vec2 uv) {
-    vec2 viewport = textureSize(depthTex, 0).xy;
-    vec2 noiseScale = viewport / 4.0;
-    uv = uv * noiseScale;
-    return vec3(texture(ssaoNoise, uv).rg, 0);
+vec3 sampleNoiseTexture() {
+    // tile the 4x4 noise texture over the target, independently of its size
+    vec2 rand = texture(ssaoNoise, gl_FragCoord.xy / 4.0).rg;
+    // rotate the kernel every frame, for temporal accumulation
+    float angle = float(params.frameIndex) * GOLDEN_ANGLE;
+    float c = cos(angle);
+    float s = sin(angle);
+    return vec3(mat2(c, s, -s, c) * rand, 0);
 }
 
 float calculatePixelAO(vec2 uv) {
@@ -41,7 +52,7 @@ float calculatePixelAO(vec2 uv) {
     viewNormal.xy = texture(normalMap, uv).xy;
     viewNormal.z = sqrt(1 - dot(viewNormal.xy, viewNormal.xy));
 
-    vec3 randVec = sampleNoiseTexture(uv);
+    vec3 randVec = sampleNoiseTexture();
 
     // tbn matrix for rotating samples
     vec3 tangent = normalize(randVec - viewNormal * dot(randVec, viewNormal));
@@ -50,10 +61,10 @@ float calculatePixelAO(vec2 uv) {
 
     // accumulate occlusion
     float occlusion = 0.0;
-    for(int i = 0; i < SSAO_KERNEL_SIZE; i++) {
+    for(int i = 0; i < params.numSamples; i++) {
         // get sample position
         vec3 samplePos = TBN * kernel.samples[i].xyz; // Rotate sample vector
-        samplePos = viewPos + samplePos * SSAO_RADIUS;         // Move it to view-space position
+        samplePos = viewPos + samplePos * params.radius;  // Move it to view-space position
 
         // project sample to get its screen-space coordinates
         vec4 offset = camera.projection * vec4(samplePos, 1.0);
@@ -67,11 +78,11 @@ float calculatePixelAO(vec2 uv) {
         vec3 sampleViewPos = getViewPos(sampleDepth, offset.xy);
 
         // Rarnge check & accumulate
-        float rangeCheck = smoothstep(0.0, 1.0, SSAO_RADIUS / abs(viewPos.z - sampleViewPos.z - SSAO_BIAS));
-        occlusion += (sampleViewPos.z >= samplePos.z + SSAO_BIAS ? 1.0 : 0.0) * rangeCheck;
+        float rangeCheck = smoothstep(0.0, 1.0, params.radius / abs(viewPos.z - sampleViewPos.z - params.bias));
+        occlusion += (sampleViewPos.z >= samplePos.z + params.bias ? 1.0 : 0.0) * rangeCheck;
     }
 
-    occlusion = 1.0 - (occlusion / SSAO_KERNEL_SIZE) * SSAO_INTENSITY;
+    occlusion = 1.0 - (occlusion / float(params.numSamples)) * params.intensity;
     return occlusion;
 }
 
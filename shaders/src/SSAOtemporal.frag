@@ -0,0 +1,58 @@
+// Temporal accumulation of the (noisy) AO term.
+// To be used with DrawQuad.vert
+#version 450
+
+layout(location=0) in vec2 inUV;
+layout(location=0) out float aoValue;
+
+layout(set=2, binding=0) uniform sampler2D aoTex;
+layout(set=2, binding=1) uniform sampler2D historyTex;
+layout(set=2, binding=2) uniform sampler2D depthTex;
+
+layout(set=3, binding=0) uniform TemporalParams {
+    mat4 invViewProj;
+    mat4 prevViewProj;
+    float blend;
+    uint historyValid;
+};
+
+bool isCoordsInRange(vec2 uv) {
+    return uv.x >= 0.0 &&
+           uv.y >= 0.0 &&
+           uv.x <= 1.0 &&
+           uv.y <= 1.0;
+}
+
+void main() {
+    float current = texture(aoTex, inUV).r;
+    if (historyValid == 0) {
+        aoValue = current;
+        return;
+    }
+
+    // reproject the current pixel into the previous frame
+    float depth = texture(depthTex, inUV).r;
+    vec4 worldPos = invViewProj * vec4(inUV * 2.0 - 1.0, depth, 1.0);
+    worldPos /= worldPos.w;
+    vec4 prevClip = prevViewProj * worldPos;
+    vec2 prevUV = prevClip.xy / prevClip.w * 0.5 + 0.5;
+
+    if (!isCoordsInRange(prevUV)) {
+        aoValue = current;
+        return;
+    }
+
+    // clamp history to the current 3x3 neighbourhood to limit ghosting
+    vec2 texelSize = 1.0 / vec2(textureSize(aoTex, 0));
+    float aoMin = current;
+    float aoMax = current;
+    for (int i = -1; i <= 1; i++) {
+        for (int j = -1; j <= 1; j++) {
+            float s = texture(aoTex, inUV + vec2(i, j) * texelSize).r;
+            aoMin = min(aoMin, s);
+            aoMax = max(aoMax, s);
+        }
+    }
+    float history = clamp(texture(historyTex, prevUV).r, aoMin, aoMax);
+    aoValue = mix(history, current, blend);
+}
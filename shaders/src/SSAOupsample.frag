@@ -0,0 +1,51 @@
+// Depth-aware (bilateral) upsampling of a reduced-resolution AO map.
+// To be used with DrawQuad.vert
+#version 450
+
+layout(location=0) in vec2 inUV;
+layout(location=0) out float aoValue;
+
+layout(set=2, binding=0) uniform sampler2D aoTex;
+layout(set=2, binding=1) uniform sampler2D depthTex;
+
+layout(set=3, binding=0) uniform Camera {
+    mat4 projection;
+    mat4 invProjection;
+} camera;
+
+const float DEPTH_EPS = 1e-3;
+
+float viewDepth(vec2 uv) {
+    float depth = texture(depthTex, uv).r;
+    vec4 viewPos = camera.invProjection * vec4(uv * 2.0 - 1.0, depth, 1.0);
+    return viewPos.z / viewPos.w;
+}
+
+void main() {
+    ivec2 lowSize = textureSize(aoTex, 0);
+    vec2 p = inUV * vec2(lowSize) - 0.5;
+    ivec2 base = ivec2(floor(p));
+    vec2 f = fract(p);
+
+    float centerZ = viewDepth(inUV);
+    float bilinear[4] = float[](
+        (1.0 - f.x) * (1.0 - f.y),
+        f.x * (1.0 - f.y),
+        (1.0 - f.x) * f.y,
+        f.x * f.y
+    );
+    const ivec2 offsets[4] = ivec2[](ivec2(0, 0), ivec2(1, 0), ivec2(0, 1), ivec2(1, 1));
+
+    float total = 0.0;
+    float weightSum = 0.0;
+    for (int i = 0; i < 4; i++) {
+        ivec2 texel = clamp(base + offsets[i], ivec2(0), lowSize - 1);
+        // depth at the center of the low-resolution texel
+        vec2 lowUV = (vec2(texel) + 0.5) / vec2(lowSize);
+        float z = viewDepth(lowUV);
+        float w = bilinear[i] / (DEPTH_EPS + abs(centerZ - z));
+        total += w * texelFetch(aoTex, texel, 0).r;
+        weightSum += w;
+    }
+    aoValue = total / max(weightSum, 1e-6);
+}
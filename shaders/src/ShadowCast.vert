@@ -1,9 +1,11 @@
 #version 450
 
+#include "object_transforms.glsl"
+
 layout(location=0) in vec3 inPosition;
 
-layout(set=1, binding=0) uniform CameraBlock {
-    mat4 mvp;
+layout(set=1, binding=1) uniform CameraBlock {
+    mat4 viewProj;
 };
 
 out gl_PerVertex {
@@ -11,5 +13,6 @@ out gl_PerVertex {
 };
 
 void main() {
-    gl_Position = mvp * vec4(inPosition, 1.0);
+    vec4 worldPos = objects[objectIndex].model * vec4(inPosition, 1.0);
+    gl_Position = viewProj * worldPos;
 }
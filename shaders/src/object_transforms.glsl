@@ -0,0 +1,20 @@
+// Per-frame object transforms, see candlewick::TransformBuffer.
+
+struct ObjectTransform {
+    mat4 model;
+    // world-space normal matrix
+    mat3 normalMatrix;
+    // blended over the material, weighted by the alpha component
+    vec4 tint;
+};
+
+// set=0 holds the storage buffers of vertex shaders, see SDL3's documentation
+// for SDL_CreateGPUShader
+layout(std430, set=0, binding=0) readonly buffer TransformBuffer {
+    ObjectTransform objects[];
+};
+
+// index of the object in the buffer, pushed for each draw
+layout(set=1, binding=0) uniform DrawBlock {
+    uint objectIndex;
+};
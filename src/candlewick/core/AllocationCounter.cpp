@@ -0,0 +1,106 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace candlewick {
+
+#ifdef CANDLEWICK_COUNT_ALLOCATIONS
+static std::atomic<Uint64> g_allocationCount{0};
+
+bool heapAllocationsCounted() noexcept { return true; }
+
+Uint64 heapAllocationCount() noexcept {
+  return g_allocationCount.load(std::memory_order_relaxed);
+}
+
+static void *countedAlloc(std::size_t size) noexcept {
+  g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+
+static void *countedAlignedAlloc(std::size_t size,
+                                 std::align_val_t alignment) noexcept {
+  g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+  const std::size_t align = std::size_t(alignment);
+  // aligned_alloc() wants a multiple of the alignment
+  return std::aligned_alloc(align, (size + align - 1) / align * align);
+}
+#else
+bool heapAllocationsCounted() noexcept { return false; }
+
+Uint64 heapAllocationCount() noexcept { return 0; }
+#endif
+
+} // namespace candlewick
+
+#ifdef CANDLEWICK_COUNT_ALLOCATIONS
+// Replacements of the global allocation functions. They are exported by the
+// shared library, hence replace the default ones for the whole program.
+
+void *operator new(std::size_t size) {
+  if (void *ptr = candlewick::countedAlloc(size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return ::operator new(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return candlewick::countedAlloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return candlewick::countedAlloc(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  if (void *ptr = candlewick::countedAlignedAlloc(size, alignment))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  return ::operator new(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t &) noexcept {
+  return candlewick::countedAlignedAlloc(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t &) noexcept {
+  return candlewick::countedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+  std::free(ptr);
+}
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+  std::free(ptr);
+}
+void operator delete(void *ptr, std::align_val_t,
+                     const std::nothrow_t &) noexcept {
+  std::free(ptr);
+}
+void operator delete[](void *ptr, std::align_val_t,
+                       const std::nothrow_t &) noexcept {
+  std::free(ptr);
+}
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+
+namespace candlewick {
+
+/// \brief Whether heap allocations are counted, i.e. whether candlewick was
+/// built with the `CANDLEWICK_COUNT_ALLOCATIONS` CMake option (off by
+/// default, not supported on Windows). The option replaces the global
+/// `operator new` of the whole program.
+bool heapAllocationsCounted() noexcept;
+
+/// \brief Number of allocations made through the global `operator new` since
+/// the program started, on all threads. Always zero when
+/// heapAllocationsCounted() is false.
+///
+/// The difference between two calls gives the number of allocations of the
+/// code in between, e.g. the allocations made while recording a frame.
+Uint64 heapAllocationCount() noexcept;
+
+} // namespace candlewick
@@ -0,0 +1,304 @@
+#include "Bvh.h"
+#include "../utils/MeshData.h"
+
+#include <Eigen/Geometry>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace candlewick {
+
+void buildBvh(std::span<const Float3> lowers, std::span<const Float3> uppers,
+              Uint32 maxLeafSize, std::vector<BvhNode> &nodes,
+              std::vector<Uint32> &order, std::vector<Uint32> *parents) {
+  SDL_assert(lowers.size() == uppers.size());
+  const Uint32 count = Uint32(lowers.size());
+  nodes.clear();
+  order.resize(count);
+  std::iota(order.begin(), order.end(), 0u);
+  if (parents)
+    parents->clear();
+  if (count == 0)
+    return;
+
+  std::vector<Float3> centers(count);
+  for (Uint32 i = 0; i < count; i++)
+    centers[i] = 0.5f * (lowers[i] + uppers[i]);
+
+  // a binary tree with at least one primitive per leaf
+  nodes.reserve(2 * count - 1);
+  nodes.resize(1);
+  if (parents) {
+    parents->reserve(2 * count - 1);
+    parents->push_back(0);
+  }
+
+  struct Task {
+    Uint32 node;
+    Uint32 first;
+    Uint32 count;
+  };
+  std::vector<Task> tasks{{0, 0, count}};
+  while (!tasks.empty()) {
+    const Task task = tasks.back();
+    tasks.pop_back();
+    const auto begin = order.begin() + task.first;
+    const auto end = begin + task.count;
+
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    Float3 lower = Float3::Constant(inf), upper = Float3::Constant(-inf);
+    Float3 center_lower = lower, center_upper = upper;
+    for (auto it = begin; it != end; ++it) {
+      lower = lower.cwiseMin(lowers[*it]);
+      upper = upper.cwiseMax(uppers[*it]);
+      center_lower = center_lower.cwiseMin(centers[*it]);
+      center_upper = center_upper.cwiseMax(centers[*it]);
+    }
+    BvhNode &node = nodes[task.node];
+    node.lower = lower;
+    node.upper = upper;
+
+    Eigen::Index axis;
+    const float extent = (center_upper - center_lower).maxCoeff(&axis);
+    // coincident centers cannot be split
+    if (task.count <= maxLeafSize || extent <= 0.f) {
+      node.first = task.first;
+      node.count = task.count;
+      continue;
+    }
+
+    const Uint32 half = task.count / 2;
+    std::nth_element(begin, begin + half, end, [&](Uint32 a, Uint32 b) {
+      return centers[a][axis] < centers[b][axis];
+    });
+    const Uint32 left = Uint32(nodes.size());
+    node.first = left;
+    node.count = 0;
+    nodes.resize(left + 2);
+    if (parents) {
+      parents->push_back(task.node);
+      parents->push_back(task.node);
+    }
+    tasks.push_back({left + 1, task.first + half, task.count - half});
+    tasks.push_back({left, task.first, half});
+  }
+}
+
+Float3 closestPointOnTriangle(const Float3 &p, const Float3 &a,
+                              const Float3 &b, const Float3 &c) {
+  // Ericson, Real-Time Collision Detection, section 5.1.5
+  const Float3 ab = b - a;
+  const Float3 ac = c - a;
+  const Float3 ap = p - a;
+  const float d1 = ab.dot(ap);
+  const float d2 = ac.dot(ap);
+  if (d1 <= 0.f && d2 <= 0.f)
+    return a;
+
+  const Float3 bp = p - b;
+  const float d3 = ab.dot(bp);
+  const float d4 = ac.dot(bp);
+  if (d3 >= 0.f && d4 <= d3)
+    return b;
+
+  const float vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+    return a + d1 / (d1 - d3) * ab;
+
+  const Float3 cp = p - c;
+  const float d5 = ab.dot(cp);
+  const float d6 = ac.dot(cp);
+  if (d6 >= 0.f && d5 <= d6)
+    return c;
+
+  const float vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+    return a + d2 / (d2 - d6) * ac;
+
+  const float va = d3 * d6 - d5 * d4;
+  if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f)
+    return b + (d4 - d3) / ((d4 - d3) + (d5 - d6)) * (c - b);
+
+  const float denom = 1.f / (va + vb + vc);
+  return a + (vb * denom) * ab + (vc * denom) * ac;
+}
+
+TriangleBvh::TriangleBvh(std::span<const Float3> positions,
+                         std::span<const Uint32> indices) {
+  const bool indexed = !indices.empty();
+  const Uint32 num_triangles =
+      Uint32(indexed ? indices.size() / 3 : positions.size() / 3);
+  auto vertex = [&](Uint32 triangle, Uint32 k) -> const Float3 & {
+    const Uint32 i = 3 * triangle + k;
+    return positions[indexed ? indices[i] : i];
+  };
+
+  std::vector<Float3> lowers(num_triangles), uppers(num_triangles);
+  for (Uint32 t = 0; t < num_triangles; t++) {
+    lowers[t] = vertex(t, 0).cwiseMin(vertex(t, 1)).cwiseMin(vertex(t, 2));
+    uppers[t] = vertex(t, 0).cwiseMax(vertex(t, 1)).cwiseMax(vertex(t, 2));
+  }
+  buildBvh(lowers, uppers, kMaxLeafSize, m_nodes, m_triangleIds);
+
+  m_vertices.reserve(3 * num_triangles);
+  for (Uint32 t : m_triangleIds) {
+    for (Uint32 k = 0; k < 3; k++)
+      m_vertices.push_back(vertex(t, k));
+  }
+}
+
+using detail::BvhStackEntry;
+using detail::kBvhStackSize;
+
+bool TriangleBvh::raycast(const Ray &ray, float maxDistance,
+                          TriangleHit &hit) const {
+  if (m_nodes.empty())
+    return false;
+  const Float3 &o = ray.origin;
+  const Float3 &d = ray.direction;
+  const Float3 invDir = rayInverseDirection(d);
+  float best = maxDistance;
+  bool found = false;
+
+  BvhStackEntry stack[kBvhStackSize];
+  Uint32 top = 0;
+  const float t_root =
+      intersectRayBox(o, invDir, m_nodes[0].lower, m_nodes[0].upper, best);
+  if (t_root >= 0.f)
+    stack[top++] = {0, t_root};
+
+  while (top > 0) {
+    const BvhStackEntry entry = stack[--top];
+    if (entry.distance > best)
+      continue;
+    const BvhNode &node = m_nodes[entry.node];
+    if (node.isLeaf()) {
+      for (Uint32 i = node.first; i < node.first + node.count; i++) {
+        // Moller-Trumbore
+        const Float3 &a = m_vertices[3 * i];
+        const Float3 e1 = m_vertices[3 * i + 1] - a;
+        const Float3 e2 = m_vertices[3 * i + 2] - a;
+        const Float3 pvec = d.cross(e2);
+        const float det = e1.dot(pvec);
+        if (det == 0.f)
+          continue;
+        const float inv_det = 1.f / det;
+        const Float3 tvec = o - a;
+        const float u = tvec.dot(pvec) * inv_det;
+        if (u < 0.f || u > 1.f)
+          continue;
+        const Float3 qvec = tvec.cross(e1);
+        const float v = d.dot(qvec) * inv_det;
+        if (v < 0.f || u + v > 1.f)
+          continue;
+        const float t = e2.dot(qvec) * inv_det;
+        if (t < 0.f || t >= best)
+          continue;
+        best = t;
+        found = true;
+        hit.triangle = m_triangleIds[i];
+        hit.normal = e1.cross(e2);
+      }
+      continue;
+    }
+
+    const BvhNode &left = m_nodes[node.first];
+    const BvhNode &right = m_nodes[node.first + 1];
+    const float t_left =
+        intersectRayBox(o, invDir, left.lower, left.upper, best);
+    const float t_right =
+        intersectRayBox(o, invDir, right.lower, right.upper, best);
+    // push the farthest child first, to visit the nearest one first
+    BvhStackEntry nearer{node.first, t_left};
+    BvhStackEntry farther{node.first + 1, t_right};
+    if (t_right >= 0.f && (t_left < 0.f || t_right < t_left))
+      std::swap(nearer, farther);
+    if (farther.distance >= 0.f)
+      stack[top++] = farther;
+    if (nearer.distance >= 0.f)
+      stack[top++] = nearer;
+  }
+
+  if (found) {
+    hit.distance = best;
+    hit.normal.normalize();
+    if (hit.normal.dot(d) > 0.f)
+      hit.normal = -hit.normal;
+  }
+  return found;
+}
+
+bool TriangleBvh::closestPoint(const Float3 &p, float &maxDistSq,
+                               Float3 &closest) const {
+  if (m_nodes.empty())
+    return false;
+  bool found = false;
+
+  BvhStackEntry stack[kBvhStackSize];
+  Uint32 top = 0;
+  stack[top++] = {0, boxDistanceSq(p, m_nodes[0].lower, m_nodes[0].upper)};
+
+  while (top > 0) {
+    const BvhStackEntry entry = stack[--top];
+    if (entry.distance >= maxDistSq)
+      continue;
+    const BvhNode &node = m_nodes[entry.node];
+    if (node.isLeaf()) {
+      for (Uint32 i = node.first; i < node.first + node.count; i++) {
+        const Float3 q =
+            closestPointOnTriangle(p, m_vertices[3 * i], m_vertices[3 * i + 1],
+                                   m_vertices[3 * i + 2]);
+        const float dist_sq = (q - p).squaredNorm();
+        if (dist_sq < maxDistSq) {
+          maxDistSq = dist_sq;
+          closest = q;
+          found = true;
+        }
+      }
+      continue;
+    }
+
+    const BvhNode &left = m_nodes[node.first];
+    const BvhNode &right = m_nodes[node.first + 1];
+    BvhStackEntry nearer{node.first, boxDistanceSq(p, left.lower, left.upper)};
+    BvhStackEntry farther{node.first + 1,
+                          boxDistanceSq(p, right.lower, right.upper)};
+    if (farther.distance < nearer.distance)
+      std::swap(nearer, farther);
+    if (farther.distance < maxDistSq)
+      stack[top++] = farther;
+    if (nearer.distance < maxDistSq)
+      stack[top++] = nearer;
+  }
+  return found;
+}
+
+TriangleBvh buildTriangleBvh(std::span<const MeshData> meshDatas) {
+  std::vector<Float3> positions;
+  std::vector<Uint32> indices;
+  for (const MeshData &data : meshDatas) {
+    if (data.primitiveType != SDL_GPU_PRIMITIVETYPE_TRIANGLELIST)
+      continue;
+    auto posAttr = data.layout.getAttribute(VertexAttrib::Position);
+    if (!posAttr)
+      continue;
+    const Uint32 base = Uint32(positions.size());
+    const Uint32 stride = data.vertexSize();
+    const char *src = data.vertexData().data() + posAttr->offset;
+    for (Uint32 i = 0; i < data.numVertices(); i++) {
+      Float3 pos;
+      SDL_memcpy(pos.data(), src + i * stride, sizeof(Float3));
+      positions.push_back(pos);
+    }
+    if (data.isIndexed()) {
+      for (Uint32 index : data.indexData)
+        indices.push_back(base + index);
+    } else {
+      for (Uint32 i = 0; i < data.numVertices() / 3 * 3; i++)
+        indices.push_back(base + i);
+    }
+  }
+  return TriangleBvh{positions, indices};
+}
+
+} // namespace candlewick
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "math_types.h"
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <vector>
+
+namespace candlewick {
+
+class MeshData;
+
+/// \brief A ray, \f$ o + t d \f$ for \f$ t \geq 0 \f$. The direction needs
+/// not be normalized: distances along the ray are then expressed in units of
+/// its norm.
+struct Ray {
+  Float3 origin;
+  Float3 direction;
+
+  Float3 at(float t) const { return origin + t * direction; }
+};
+
+/// \brief Node of a flat bounding volume hierarchy.
+///
+/// Nodes are stored depth-first: the two children of an inner node are
+/// stored next to each other, after their parent.
+struct BvhNode {
+  Float3 lower;
+  /// First child for inner nodes, first primitive for leaves.
+  Uint32 first;
+  Float3 upper;
+  /// Number of primitives of a leaf, 0 for inner nodes.
+  Uint32 count;
+
+  bool isLeaf() const { return count > 0; }
+};
+static_assert(sizeof(BvhNode) == 32);
+
+/// \brief Build a BVH over the boxes of primitives, given by their corners
+/// \p lowers and \p uppers. Nodes are split at the median of the box centers
+/// along their longest axis.
+/// \param[out] order Primitives, in the order referenced by the leaves.
+/// \param[out] parents Parent of each node, if not null. The root is its own
+/// parent.
+void buildBvh(std::span<const Float3> lowers, std::span<const Float3> uppers,
+              Uint32 maxLeafSize, std::vector<BvhNode> &nodes,
+              std::vector<Uint32> &order,
+              std::vector<Uint32> *parents = nullptr);
+
+namespace detail {
+  /// \brief Entry of the traversal stacks of the BVH queries: a node, and
+  /// the distance at which the query enters it.
+  struct BvhStackEntry {
+    Uint32 node;
+    float distance;
+  };
+  /// \brief Depth of the traversal stacks, enough for any tree built by
+  /// buildBvh(), which is balanced.
+  inline constexpr Uint32 kBvhStackSize = 64;
+} // namespace detail
+
+/// \brief Component-wise inverse of a ray direction, for intersectRayBox().
+/// Zero components are nudged away from zero, so that rays starting on the
+/// planes of a box do not make NaNs.
+inline Float3 rayInverseDirection(const Float3 &direction) {
+  constexpr float eps = 1e-20f;
+  return direction
+      .unaryExpr([](float x) {
+        return std::abs(x) < eps ? std::copysign(eps, x) : x;
+      })
+      .cwiseInverse();
+}
+
+/// \brief Entry distance of \p ray in the box \p lower, \p upper, or a
+/// negative value if the ray misses it before \p tmax.
+/// \param invDir Inverse of the ray direction, see rayInverseDirection().
+inline float intersectRayBox(const Float3 &origin, const Float3 &invDir,
+                             const Float3 &lower, const Float3 &upper,
+                             float tmax) {
+  const Float3 t0 = (lower - origin).cwiseProduct(invDir);
+  const Float3 t1 = (upper - origin).cwiseProduct(invDir);
+  const float tnear = std::max(t0.cwiseMin(t1).maxCoeff(), 0.f);
+  const float tfar = std::min(t0.cwiseMax(t1).minCoeff(), tmax);
+  return tnear <= tfar ? tnear : -1.f;
+}
+
+/// \brief Squared distance from \p p to the box \p lower, \p upper, zero
+/// inside it.
+inline float boxDistanceSq(const Float3 &p, const Float3 &lower,
+                           const Float3 &upper) {
+  return (lower - p).cwiseMax(p - upper).cwiseMax(0.f).squaredNorm();
+}
+
+/// \brief Closest point to \p p on the triangle \p a, \p b, \p c.
+Float3 closestPointOnTriangle(const Float3 &p, const Float3 &a,
+                              const Float3 &b, const Float3 &c);
+
+/// \brief Hit of a ray on a TriangleBvh.
+struct TriangleHit {
+  float distance;
+  /// Index of the triangle in the source mesh.
+  Uint32 triangle;
+  /// Unit geometric normal of the triangle, facing the ray origin.
+  Float3 normal;
+};
+
+/// \brief A BVH over the triangles of a mesh, for exact ray and distance
+/// queries on the CPU.
+///
+/// Triangles are copied in leaf order, so that leaves read contiguous
+/// vertices. Build it once, when the mesh is loaded; it is immutable after
+/// that.
+class TriangleBvh {
+public:
+  static constexpr Uint32 kMaxLeafSize = 4;
+
+  TriangleBvh() = default;
+  /// \param indices Vertex indices, three per triangle. If empty, the
+  /// positions are a triangle list.
+  TriangleBvh(std::span<const Float3> positions,
+              std::span<const Uint32> indices = {});
+
+  bool empty() const { return m_nodes.empty(); }
+  Uint32 numTriangles() const { return Uint32(m_triangleIds.size()); }
+  std::span<const BvhNode> nodes() const { return m_nodes; }
+
+  /// \brief Closest hit of \p ray before distance \p maxDistance.
+  bool raycast(const Ray &ray, float maxDistance, TriangleHit &hit) const;
+  /// \brief Closest point to \p p, closer than \f$\sqrt{\text{maxDistSq}}\f$.
+  /// On success, \p maxDistSq is set to the squared distance to \p closest.
+  bool closestPoint(const Float3 &p, float &maxDistSq, Float3 &closest) const;
+
+private:
+  std::vector<BvhNode> m_nodes;
+  // vertices of the triangles, three per triangle, in leaf order
+  std::vector<Float3> m_vertices;
+  std::vector<Uint32> m_triangleIds;
+};
+
+/// \brief Build a TriangleBvh over the triangle lists of a batch of meshes,
+/// in their common local frame. Meshes with other primitives are skipped.
+/// Triangle indices count the triangles of the batch, in order.
+TriangleBvh buildTriangleBvh(std::span<const MeshData> meshDatas);
+
+} // namespace candlewick
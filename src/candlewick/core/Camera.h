@@ -104,6 +104,28 @@ inline float perspectiveProjFar(const Mat4f &proj) {
   return std::abs(proj(2, 3) / (proj(2, 2) + 1.f));
 }
 
+/// \brief Deduce the type of a projection matrix from its last row.
+inline CameraProjection projectionType(const Mat4f &proj) {
+  return proj(3, 3) == 1.f ? CameraProjection::ORTHOGRAPHIC
+                           : CameraProjection::PERSPECTIVE;
+}
+
+/// \name Depth linearization.
+/// Convert depth buffer values to view-space distances along the camera axis.
+/// These match the functions of the same name in `depth_utils.glsl`.
+/// \{
+
+inline float linearizeDepth(float depth, float zNear, float zFar) {
+  float z_ndc = 2.f * depth - 1.f;
+  return (2.f * zNear * zFar) / (zFar + zNear - z_ndc * (zFar - zNear));
+}
+
+inline float linearizeDepthOrtho(float depth, float zNear, float zFar) {
+  return zNear + depth * (zFar - zNear);
+}
+
+/// \}
+
 /// \brief Extract the array of frustum corners, given a camera projection
 /// matrix.
 inline FrustumCornersType frustumFromCameraProjection(const Mat4f &camProj) {
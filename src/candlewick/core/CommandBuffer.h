@@ -73,8 +73,14 @@ public:
     return *this;
   }
 
-  SDL_GPUFence *submitAndAcquireFence() {
-    return SDL_SubmitGPUCommandBufferAndAcquireFence(_cmdBuf);
+  /// \brief Submit the command buffer, and acquire a fence to wait on.
+  /// \returns The fence (null on failure), to be released by the caller.
+  SDL_GPUFence *submitAndAcquireFence() noexcept {
+    if (!active())
+      return nullptr;
+    SDL_GPUFence *fence = SDL_SubmitGPUCommandBufferAndAcquireFence(_cmdBuf);
+    _cmdBuf = nullptr;
+    return fence;
   }
 };
 
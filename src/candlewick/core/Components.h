@@ -2,6 +2,9 @@
 #include "math_types.h"
 #include "Mesh.h"
 #include "MaterialUniform.h"
+#include "Culling.h"
+
+#include <memory>
 
 namespace candlewick {
 
@@ -14,17 +17,46 @@ struct Disable {};
 // Tag environment entities
 struct EnvironmentTag {};
 
+/// Tag struct for entities whose transform is rigid (rotation and translation,
+/// no scaling): their normal matrix is the linear part of the model-view
+/// matrix.
+struct RigidTransformTag {};
+
 struct TransformComponent : Mat4f {
   using Mat4f::Mat4f;
   using Mat4f::operator=;
 };
 
+/// Bounding box of an entity's mesh in its local frame, used for culling.
+/// Entities without this component are never culled.
+struct LocalBoundsComponent : BoundingBox {};
+
+/// Color blended over the materials of an entity, e.g. to highlight it. The
+/// alpha component is the blend weight. It is written to the per-object data
+/// of the frame (see TransformBuffer), so changing it does not touch the
+/// materials.
+struct HighlightComponent {
+  Float4 color;
+};
+
+/// Triangle BVH of the mesh of an entity, in its local frame, refining the
+/// hits of SceneQuery. Shared by the entities drawing the same mesh.
+struct PickingMeshComponent {
+  std::shared_ptr<const TriangleBvh> bvh;
+};
+
 struct MeshMaterialComponent {
-  Mesh mesh;
+  /// Shared by the entities drawing the same asset, e.g. a link of a robot
+  /// in its visual and collision models.
+  std::shared_ptr<const Mesh> mesh;
   std::vector<PbrMaterial> materials;
   MeshMaterialComponent(Mesh &&mesh, std::vector<PbrMaterial> &&materials)
+      : MeshMaterialComponent(std::make_shared<const Mesh>(std::move(mesh)),
+                              std::move(materials)) {}
+  MeshMaterialComponent(std::shared_ptr<const Mesh> mesh,
+                        std::vector<PbrMaterial> &&materials)
       : mesh(std::move(mesh)), materials(std::move(materials)) {
-    assert(mesh.numViews() == materials.size());
+    assert(this->mesh->numViews() == this->materials.size());
   }
 };
 
@@ -11,6 +11,7 @@ class Mesh;
 class MeshView;
 class MeshLayout;
 struct Shader;
+class TriangleBvh;
 struct Renderer;
 struct Window;
 
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "math_types.h"
+#include <array>
+
+namespace candlewick {
+
+/// \brief Axis-aligned box, stored as center and half-extents for fast
+/// transforms and plane tests.
+struct BoundingBox {
+  Float3 center;
+  Float3 halfExtents;
+
+  /// \brief Axis-aligned box enclosing this box transformed by \p M.
+  BoundingBox transformed(const Mat4f &M) const {
+    const auto R = M.topLeftCorner<3, 3>();
+    return {R * center + M.topRightCorner<3, 1>(),
+            R.cwiseAbs() * halfExtents};
+  }
+};
+
+/// \brief The six clipping planes of a view frustum, as \f$(n, d)\f$ with
+/// \f$ n^\top x + d \geq 0 \f$ inside the frustum. The planes are not
+/// normalized.
+struct FrustumPlanes {
+  std::array<Float4, 6> planes;
+
+  /// \brief Extract the planes of a view-projection matrix (Gribb-Hartmann).
+  ///
+  /// This uses the \f$[-1, 1]\f$ depth range of the projection matrices in
+  /// Camera.h, which is also conservative for \f$[0, 1]\f$ depth projections.
+  static FrustumPlanes fromViewProj(const Mat4f &viewProj) {
+    const Float4 r0 = viewProj.row(0);
+    const Float4 r1 = viewProj.row(1);
+    const Float4 r2 = viewProj.row(2);
+    const Float4 r3 = viewProj.row(3);
+    return {{r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2}};
+  }
+
+  /// \brief Whether the box intersects or is inside the frustum. This test is
+  /// conservative: boxes near the frustum corners may be reported visible.
+  bool intersects(const BoundingBox &box) const {
+    for (const Float4 &p : planes) {
+      const Float3 n = p.head<3>();
+      const float dist = n.dot(box.center) + p.w();
+      const float radius = n.cwiseAbs().dot(box.halfExtents);
+      if (dist + radius < 0.f)
+        return false;
+    }
+    return true;
+  }
+};
+
+} // namespace candlewick
@@ -0,0 +1,137 @@
+#include "DebugDraw.h"
+
+#include <Eigen/Geometry>
+#include <algorithm>
+
+namespace candlewick {
+
+Float4 debugColorMap(float t) {
+  // polynomial approximation of Turbo, by Google LLC (Apache-2.0)
+  t = std::clamp(t, 0.f, 1.f);
+  const Eigen::Array<float, 6, 1> powers{
+      1.f, t, t * t, t * t * t, t * t * t * t, t * t * t * t * t};
+  Eigen::Matrix<float, 3, 6> coeffs;
+  coeffs << 0.13572138f, 4.61539260f, -42.66032258f, 132.13108234f,
+      -152.94239396f, 59.28637943f, //
+      0.09140261f, 2.19418839f, 4.84296658f, -14.18503333f, 4.27729857f,
+      2.82956604f, //
+      0.10667330f, 12.64194608f, -60.58204836f, 110.36276771f,
+      -89.90310912f, 27.34824973f;
+  const Float3 rgb = (coeffs * powers.matrix()).cwiseMax(0.f).cwiseMin(1.f);
+  return rgb.homogeneous();
+}
+
+std::array<DebugShapeInstance, 3> makeTriadInstances(const Mat4f &pose) {
+  // arrows of a triad, from the unit arrow along +z
+  static const std::array<Mat3f, 3> triad_axes = [] {
+    const Eigen::DiagonalMatrix<float, 3> arrow_scale{0.01f, 0.01f, 0.5f};
+    const Eigen::AngleAxisf aax{constants::Pi_2f, Float3::UnitY()};
+    const Eigen::AngleAxisf aay{constants::Pi_2f, -Float3::UnitX()};
+    return std::array<Mat3f, 3>{
+        aax.toRotationMatrix() * arrow_scale,
+        aay.toRotationMatrix() * arrow_scale,
+        Mat3f{arrow_scale},
+    };
+  }();
+  std::array<DebugShapeInstance, 3> instances;
+  for (size_t j = 0; j < 3; j++) {
+    Float4 color = Float4::UnitW();
+    color[Eigen::Index(j)] = 1.f;
+    Eigen::Matrix<float, 3, 4> model;
+    model << pose.topLeftCorner<3, 3>() * triad_axes[j],
+        pose.topRightCorner<3, 1>();
+    instances[j] = makeDebugShapeInstance(model, color);
+  }
+  return instances;
+}
+
+void DebugDrawList::clear() {
+  m_lineVertices.clear();
+  for (auto &instances : m_instances)
+    instances.clear();
+}
+
+bool DebugDrawList::empty() const { return size() == 0; }
+
+size_t DebugDrawList::size() const {
+  size_t count = m_lineVertices.size() / 2;
+  for (const auto &instances : m_instances)
+    count += instances.size();
+  return count;
+}
+
+void DebugDrawList::reserve(size_t lines, size_t shapes) {
+  m_lineVertices.reserve(2 * lines);
+  for (auto &instances : m_instances)
+    instances.reserve(shapes);
+}
+
+void DebugDrawList::line(const Float3 &from, const Float3 &to,
+                         const Float4 &color) {
+  const Uint32 c = packColorRgba8(color);
+  m_lineVertices.push_back({from, c});
+  m_lineVertices.push_back({to, c});
+}
+
+void DebugDrawList::polyline(std::span<const Float3> points,
+                             const Float4 &color, bool closed) {
+  if (points.size() < 2)
+    return;
+  const Uint32 c = packColorRgba8(color);
+  const size_t segments = closed ? points.size() : points.size() - 1;
+  m_lineVertices.reserve(m_lineVertices.size() + 2 * segments);
+  for (size_t i = 0; i < segments; i++) {
+    m_lineVertices.push_back({points[i], c});
+    m_lineVertices.push_back({points[(i + 1) % points.size()], c});
+  }
+}
+
+void DebugDrawList::addInstance(DebugShape shape,
+                                const Eigen::Matrix<float, 3, 4> &model,
+                                const Float4 &color) {
+  m_instances[size_t(shape)].push_back(makeDebugShapeInstance(model, color));
+}
+
+void DebugDrawList::point(const Float3 &pos, float size, const Float4 &color) {
+  Eigen::Matrix<float, 3, 4> model;
+  model << Mat3f::Identity() * size, pos;
+  addInstance(DebugShape::POINT, model, color);
+}
+
+void DebugDrawList::box(const Mat4f &pose, const Float3 &halfExtents,
+                        const Float4 &color) {
+  Eigen::Matrix<float, 3, 4> model = pose.topRows<3>();
+  model.leftCols<3>().applyOnTheRight(halfExtents.asDiagonal());
+  addInstance(DebugShape::BOX, model, color);
+}
+
+void DebugDrawList::sphere(const Float3 &center, float radius,
+                           const Float4 &color) {
+  Eigen::Matrix<float, 3, 4> model;
+  model << Mat3f::Identity() * radius, center;
+  addInstance(DebugShape::SPHERE, model, color);
+}
+
+void DebugDrawList::arrow(const Float3 &from, const Float3 &to,
+                          const Float4 &color, float radius) {
+  const Float3 dir = to - from;
+  const float length = dir.norm();
+  if (length <= 1e-6f)
+    return;
+  // the unit arrow points along +z
+  const Mat3f R =
+      Eigen::Quaternionf::FromTwoVectors(Float3::UnitZ(), dir).toRotationMatrix();
+  Eigen::Matrix<float, 3, 4> model;
+  model << R * Float3{radius, radius, length}.asDiagonal(), from;
+  addInstance(DebugShape::ARROW, model, color);
+}
+
+void DebugDrawList::frame(const Mat4f &pose, float scale) {
+  const Float3 origin = pose.topRightCorner<3, 1>();
+  const Mat3f axes = scale * pose.topLeftCorner<3, 3>();
+  line(origin, origin + axes.col(0), Float4{1.f, 0.f, 0.f, 1.f});
+  line(origin, origin + axes.col(1), Float4{0.f, 1.f, 0.f, 1.f});
+  line(origin, origin + axes.col(2), Float4{0.f, 0.f, 1.f, 1.f});
+}
+
+} // namespace candlewick
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "math_types.h"
+
+#include <array>
+#include <span>
+#include <vector>
+
+namespace candlewick {
+
+/// \brief Vertex of an immediate-mode debug line. The color is packed as
+/// RGBA8, red in the lowest byte.
+struct alignas(16) DebugLineVertex {
+  GpuVec3 pos;
+  Uint32 color;
+};
+static_assert(sizeof(DebugLineVertex) == 16);
+
+/// \brief Per-instance data of a debug shape: the rows of its
+/// affine transform (scale included), and its color.
+struct alignas(16) DebugShapeInstance {
+  GpuVec4 modelRows[3];
+  GpuVec4 color;
+};
+static_assert(sizeof(DebugShapeInstance) == 64);
+
+/// \brief Shapes drawn with instancing, by the immediate-mode debug API and
+/// for DebugShapeComponent entities. Each one maps to a mesh of the shared
+/// library of the DebugScene.
+enum class DebugShape : Uint8 {
+  /// Cube with unit half-extents.
+  BOX,
+  /// Sphere of unit radius.
+  SPHERE,
+  /// Octahedron of unit radius, cheaper than a sphere.
+  POINT,
+  /// Arrow of unit length along +z, with a shaft of unit radius.
+  ARROW,
+  /// Line grid in the xy plane, see loadGrid().
+  GRID,
+};
+inline constexpr size_t kNumDebugShapes = 5;
+
+/// \brief Pack a color to RGBA8.
+inline Uint32 packColorRgba8(const Float4 &color) {
+  const Eigen::Array4f c = 255.f * color.array().max(0.f).min(1.f) + 0.5f;
+  return Uint32(c[0]) | Uint32(c[1]) << 8 | Uint32(c[2]) << 16 |
+         Uint32(c[3]) << 24;
+}
+
+/// \brief Map \p t in [0, 1] to a color of the Turbo colormap, from dark
+/// blue to dark red. Values out of range are clamped.
+Float4 debugColorMap(float t);
+
+/// \brief Instance data for the affine transform \p model.
+inline DebugShapeInstance
+makeDebugShapeInstance(const Eigen::Matrix<float, 3, 4> &model,
+                       const Float4 &color) {
+  return {
+      .modelRows = {model.row(0).transpose(), model.row(1).transpose(),
+                    model.row(2).transpose()},
+      .color = color,
+  };
+}
+
+/// \brief Instances of the red, green and blue arrows of a triad along the
+/// axes of \p pose, of length 0.5 and shaft radius 0.01 (the dimensions of
+/// loadTriadSolid()).
+std::array<DebugShapeInstance, 3> makeTriadInstances(const Mat4f &pose);
+
+/// \brief CPU-side list of immediate-mode debug primitives.
+///
+/// Lines (and line-based primitives, e.g. polylines and frames) are expanded
+/// to vertices, the other shapes are stored as instances of a unit mesh. The
+/// list keeps its capacity when cleared, so that filling it every frame
+/// does not allocate in the steady state.
+/// \sa DebugScene
+class DebugDrawList {
+public:
+  void clear();
+  bool empty() const;
+  /// \brief Number of primitives, lines and shapes included.
+  size_t size() const;
+
+  /// \brief Reserve storage for \p lines lines and \p shapes shapes of each
+  /// type.
+  void reserve(size_t lines, size_t shapes);
+
+  void line(const Float3 &from, const Float3 &to, const Float4 &color);
+  /// \brief Draw consecutive segments between \p points.
+  /// \param closed Also link the last point to the first one.
+  void polyline(std::span<const Float3> points, const Float4 &color,
+                bool closed = false);
+  /// \param size Radius of the point, in world units.
+  void point(const Float3 &pos, float size, const Float4 &color);
+  void box(const Mat4f &pose, const Float3 &halfExtents, const Float4 &color);
+  void sphere(const Float3 &center, float radius, const Float4 &color);
+  /// \param radius Radius of the shaft. The head is twice as wide.
+  void arrow(const Float3 &from, const Float3 &to, const Float4 &color,
+             float radius = 0.01f);
+  /// \brief Draw the axes of \p pose as red, green and blue lines.
+  void frame(const Mat4f &pose, float scale = 0.1f);
+
+  std::span<const DebugLineVertex> lineVertices() const {
+    return m_lineVertices;
+  }
+  std::span<const DebugShapeInstance> instances(DebugShape shape) const {
+    return m_instances[size_t(shape)];
+  }
+
+private:
+  void addInstance(DebugShape shape, const Eigen::Matrix<float, 3, 4> &model,
+                   const Float4 &color);
+
+  std::vector<DebugLineVertex> m_lineVertices;
+  std::array<std::vector<DebugShapeInstance>, kNumDebugShapes> m_instances;
+};
+
+} // namespace candlewick
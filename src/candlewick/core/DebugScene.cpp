@@ -2,50 +2,97 @@
 #include "Camera.h"
 #include "Shader.h"
 #include "Components.h"
+#include "errors.h"
 
 #include "../primitives/Arrow.h"
+#include "../primitives/Cube.h"
 #include "../primitives/Grid.h"
+#include "../primitives/Internal.h"
+#include "../primitives/Sphere.h"
+#include "../utils/MeshDataView.h"
+
+#include <Eigen/Geometry>
 
 namespace candlewick {
 
+// vertex attribute locations of the per-instance data in DebugShape.vert,
+// after those of VertexAttrib
+enum : Uint32 {
+  INSTANCE_MODEL_ROW0_LOC = 8,
+  INSTANCE_COLOR_LOC = 11,
+};
+enum : Uint32 { INSTANCE_BUFFER_SLOT = 1 };
+
+// uniform block of DebugShape.vert
+struct alignas(16) DebugShapeUniforms {
+  GpuMat4 viewProj;
+  // 1 for shaded shapes, 0 for unlit ones (line grids)
+  float lighting;
+};
+
+/// Convert to the position-normal layout shared by the debug shapes. Meshes
+/// without normals, e.g. line grids, get +z normals.
+static MeshData toPosNormalMesh(MeshData data) {
+  const bool has_normals = data.layout.getAttribute(VertexAttrib::Normal);
+  std::vector<PosNormalVertex> vertices(data.numVertices());
+  for (Uint32 i = 0; i < data.numVertices(); i++) {
+    vertices[i].pos = data.getAttribute<GpuVec3>(i, VertexAttrib::Position);
+    vertices[i].normal =
+        has_normals ? data.getAttribute<GpuVec3>(i, VertexAttrib::Normal)
+                    : GpuVec3{Float3::UnitZ()};
+  }
+  return MeshData{data.primitiveType, std::move(vertices),
+                  std::move(data.indexData)};
+}
+
+static MeshData loadOctahedron() {
+  std::vector<PosNormalVertex> vertices;
+  std::vector<MeshData::IndexType> indices;
+  for (float sx : {-1.f, 1.f}) {
+    for (float sy : {-1.f, 1.f}) {
+      for (float sz : {-1.f, 1.f}) {
+        const GpuVec3 normal = Float3{sx, sy, sz}.normalized();
+        for (const Float3 v :
+             {Float3{sx, 0., 0.}, Float3{0., sy, 0.}, Float3{0., 0., sz}}) {
+          indices.push_back(Uint32(vertices.size()));
+          vertices.push_back({v, normal});
+        }
+      }
+    }
+  }
+  return MeshData{SDL_GPU_PRIMITIVETYPE_TRIANGLELIST, std::move(vertices),
+                  std::move(indices)};
+}
+
 DebugScene::DebugScene(entt::registry &reg, const Renderer &renderer)
     : _registry(reg), _renderer(renderer), _trianglePipeline(nullptr),
       _linePipeline(nullptr) {
   _swapchainTextureFormat = renderer.getSwapchainTextureFormat();
   _depthFormat = renderer.depthFormat();
+  setupSharedResources();
 }
 
-std::tuple<entt::entity, DebugMeshComponent &> DebugScene::addTriad() {
-  auto triad_datas = loadTriadSolid();
-  std::vector<GpuVec4> triad_colors(3);
-  Mesh triad = createMeshFromBatch(device(), triad_datas, true);
-  for (size_t i = 0; i < 3; i++) {
-    triad_colors[i] = triad_datas[i].material.baseColor;
-  }
-  setupPipelines(triad.layout());
+std::tuple<entt::entity, DebugTriadComponent &> DebugScene::addTriad() {
   auto entity = _registry.create();
-  auto &item = _registry.emplace<DebugMeshComponent>(
-      entity, DebugPipelines::TRIANGLE_FILL, std::move(triad), triad_colors);
+  auto &item = _registry.emplace<DebugTriadComponent>(entity);
   _registry.emplace<TransformComponent>(entity, Mat4f::Identity());
   return {entity, item};
 }
 
-std::tuple<entt::entity, DebugMeshComponent &>
-DebugScene::addLineGrid(std::optional<Float4> color) {
-  auto grid_data = loadGrid(20);
-  Mesh grid = createMesh(device(), grid_data, true);
-  GpuVec4 grid_color = color.value_or(grid_data.material.baseColor);
-
-  setupPipelines(grid.layout());
+std::tuple<entt::entity, DebugShapeComponent &>
+DebugScene::addShape(DebugShape shape, const Float4 &color) {
   auto entity = _registry.create();
-  auto &item = _registry.emplace<DebugMeshComponent>(
-      entity, DebugPipelines::LINE, std::move(grid), std::vector{grid_color});
+  auto &item = _registry.emplace<DebugShapeComponent>(entity, shape, color);
   _registry.emplace<TransformComponent>(entity, Mat4f::Identity());
   return {entity, item};
 }
 
-void DebugScene::renderMeshComponents(CommandBuffer &cmdBuf,
-                                      SDL_GPURenderPass *render_pass,
+std::tuple<entt::entity, DebugShapeComponent &>
+DebugScene::addLineGrid(std::optional<Float4> color) {
+  return addShape(DebugShape::GRID, color.value_or(PbrMaterial{}.baseColor));
+}
+
+void DebugScene::renderMeshComponents(RenderPassEncoder &encoder,
                                       const Camera &camera) const {
   const Mat4f viewProj = camera.viewProj();
 
@@ -56,22 +103,23 @@ void DebugScene::renderMeshComponents(CommandBuffer &cmdBuf,
     if (!cmd.enable)
       return;
 
+    // the encoder skips the bind if the pipeline type did not change
     switch (cmd.pipeline_type) {
     case DebugPipelines::TRIANGLE_FILL:
-      SDL_BindGPUGraphicsPipeline(render_pass, _trianglePipeline);
+      encoder.bindPipeline(_trianglePipeline);
       break;
     case DebugPipelines::LINE:
-      SDL_BindGPUGraphicsPipeline(render_pass, _linePipeline);
+      encoder.bindPipeline(_linePipeline);
       break;
     }
 
     const GpuMat4 mvp = viewProj * tr;
-    cmdBuf.pushVertexUniform(TRANSFORM_SLOT, &mvp, sizeof(mvp));
-    rend::bindMesh(render_pass, cmd.mesh);
+    encoder.pushVertexUniform(TRANSFORM_SLOT, &mvp, sizeof(mvp));
+    encoder.bindMesh(cmd.mesh);
     for (size_t i = 0; i < cmd.mesh.numViews(); i++) {
       const auto &color = cmd.colors[i];
-      cmdBuf.pushFragmentUniform(COLOR_SLOT, &color, sizeof(color));
-      rend::drawView(render_pass, cmd.mesh.view(i));
+      encoder.pushFragmentUniform(COLOR_SLOT, &color, sizeof(color));
+      encoder.drawView(cmd.mesh.view(i));
     }
   });
 }
@@ -113,7 +161,206 @@ void DebugScene::setupPipelines(const MeshLayout &layout) {
     _linePipeline = SDL_CreateGPUGraphicsPipeline(device(), &info);
 }
 
+void DebugScene::setupSharedResources() {
+  if (_shapePipeline)
+    return;
+
+  // shared meshes, in DebugShape order
+  _shapeMeshes.push_back(
+      createMesh(device(), toPosNormalMesh(loadCubeSolid().toOwned()), true));
+  _shapeMeshes.push_back(
+      createMesh(device(), toPosNormalMesh(loadUvSphereSolid(8, 16)), true));
+  _shapeMeshes.push_back(createMesh(device(), loadOctahedron(), true));
+  _shapeMeshes.push_back(createMesh(
+      device(),
+      toPosNormalMesh(loadArrowSolid(true, 0.8f, 1.f, 0.2f, 2.f, 16)), true));
+  _shapeMeshes.push_back(
+      createMesh(device(), toPosNormalMesh(loadGrid(20)), true));
+  for (size_t i = 0; i < kNumDebugShapes; i++) {
+    _entityInstanceBuffers.emplace_back(
+        device(), SDL_GPU_BUFFERUSAGE_VERTEX,
+        Uint32(64 * sizeof(DebugShapeInstance)), "Debug entity instances");
+    _instanceBuffers.emplace_back(device(), SDL_GPU_BUFFERUSAGE_VERTEX,
+                                  Uint32(256 * sizeof(DebugShapeInstance)),
+                                  "Debug shape instances");
+  }
+  _lineVertexBuffer =
+      DynamicBuffer{device(), SDL_GPU_BUFFERUSAGE_VERTEX,
+                    Uint32(1024 * sizeof(DebugLineVertex)), "Debug lines"};
+
+  SDL_GPUColorTargetDescription color_desc;
+  SDL_zero(color_desc);
+  color_desc.format = _swapchainTextureFormat;
+  SDL_GPUGraphicsPipelineCreateInfo info{
+      .primitive_type = SDL_GPU_PRIMITIVETYPE_LINELIST,
+      .rasterizer_state{.fill_mode = SDL_GPU_FILLMODE_FILL,
+                        .cull_mode = SDL_GPU_CULLMODE_NONE,
+                        .enable_depth_clip = true},
+      .depth_stencil_state{.compare_op = SDL_GPU_COMPAREOP_LESS_OR_EQUAL,
+                           .enable_depth_test = true,
+                           .enable_depth_write = true},
+      .target_info{.color_target_descriptions = &color_desc,
+                   .num_color_targets = 1,
+                   .depth_stencil_format = _depthFormat,
+                   .has_depth_stencil_target = true},
+      .props = 0,
+  };
+
+  auto fragmentShader = Shader::fromMetadata(device(), "VertexColor.frag");
+  info.fragment_shader = fragmentShader;
+  {
+    auto vertexShader = Shader::fromMetadata(device(), "VertexColor.vert");
+    const SDL_GPUVertexBufferDescription buffer_desc{
+        .slot = 0,
+        .pitch = sizeof(DebugLineVertex),
+        .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+        .instance_step_rate = 0,
+    };
+    const SDL_GPUVertexAttribute attrs[]{
+        {Uint32(VertexAttrib::Position), 0, SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
+         offsetof(DebugLineVertex, pos)},
+        {Uint32(VertexAttrib::Color0), 0,
+         SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM,
+         offsetof(DebugLineVertex, color)},
+    };
+    info.vertex_shader = vertexShader;
+    info.vertex_input_state = {&buffer_desc, 1, attrs, SDL_arraysize(attrs)};
+    _immediateLinePipeline = SDL_CreateGPUGraphicsPipeline(device(), &info);
+  }
+  {
+    auto vertexShader = Shader::fromMetadata(device(), "DebugShape.vert");
+    const MeshLayout &layout = _shapeMeshes[0].layout();
+    std::vector<SDL_GPUVertexBufferDescription> buffer_descs =
+        layout.m_bufferDescs;
+    buffer_descs.push_back({
+        .slot = INSTANCE_BUFFER_SLOT,
+        .pitch = sizeof(DebugShapeInstance),
+        .input_rate = SDL_GPU_VERTEXINPUTRATE_INSTANCE,
+        .instance_step_rate = 0,
+    });
+    std::vector<SDL_GPUVertexAttribute> attrs = layout.m_attrs;
+    for (Uint32 i = 0; i < 3; i++) {
+      attrs.push_back({INSTANCE_MODEL_ROW0_LOC + i, INSTANCE_BUFFER_SLOT,
+                       SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4,
+                       Uint32(offsetof(DebugShapeInstance, modelRows) +
+                              i * sizeof(GpuVec4))});
+    }
+    attrs.push_back({INSTANCE_COLOR_LOC, INSTANCE_BUFFER_SLOT,
+                     SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4,
+                     offsetof(DebugShapeInstance, color)});
+    info.vertex_shader = vertexShader;
+    info.vertex_input_state = {buffer_descs.data(), Uint32(buffer_descs.size()),
+                               attrs.data(), Uint32(attrs.size())};
+    // re-use for the grid
+    _shapeLinePipeline = SDL_CreateGPUGraphicsPipeline(device(), &info);
+    info.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST;
+    _shapePipeline = SDL_CreateGPUGraphicsPipeline(device(), &info);
+  }
+  if (!_immediateLinePipeline || !_shapeLinePipeline || !_shapePipeline)
+    terminate_with_message(std::format(
+        "Failed to create debug shape pipelines: {:s}", SDL_GetError()));
+}
+
+void DebugScene::uploadInstances(CommandBuffer &cmdBuf) const {
+  // entity instances change with their transforms: upload them every frame
+  std::array<FrameVector<DebugShapeInstance>, kNumDebugShapes> entity_instances;
+  for (auto &instances : entity_instances)
+    instances = FrameVector<DebugShapeInstance>{_renderer.frameArena};
+
+  auto shapes =
+      _registry.view<const DebugShapeComponent, const TransformComponent>(
+          entt::exclude<Disable>);
+  for (auto &&[ent, shape, tr] : shapes.each()) {
+    if (shape.enable)
+      entity_instances[size_t(shape.shape)].push_back(
+          makeDebugShapeInstance(tr.topRows<3>(), shape.color));
+  }
+  auto triads =
+      _registry.view<const DebugTriadComponent, const TransformComponent>(
+          entt::exclude<Disable>);
+  auto &arrows = entity_instances[size_t(DebugShape::ARROW)];
+  arrows.reserve(arrows.size() + 3 * triads.size_hint());
+  for (auto &&[ent, triad, tr] : triads.each()) {
+    if (!triad.enable)
+      continue;
+    for (const auto &instance : makeTriadInstances(tr))
+      arrows.push_back(instance);
+  }
+  bool has_entities = false;
+  for (size_t i = 0; i < kNumDebugShapes; i++) {
+    _numEntityInstances[i] = Uint32(entity_instances[i].size());
+    has_entities |= _numEntityInstances[i] > 0;
+  }
+
+  // immediate primitives are only uploaded when they changed
+  bool has_immediate = false;
+  if (_immediateDirty) {
+    _immediateDirty = false;
+    _numLineVertices = Uint32(_immediate.lineVertices().size());
+    has_immediate = _numLineVertices > 0;
+    for (size_t i = 0; i < kNumDebugShapes; i++) {
+      _numInstances[i] = Uint32(_immediate.instances(DebugShape(i)).size());
+      has_immediate |= _numInstances[i] > 0;
+    }
+  }
+  if (!has_entities && !has_immediate)
+    return;
+
+  SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(cmdBuf);
+  for (size_t i = 0; i < kNumDebugShapes; i++) {
+    const auto &instances = entity_instances[i];
+    _entityInstanceBuffers[i].upload(
+        copy_pass, instances.data(),
+        Uint32(instances.size() * sizeof(DebugShapeInstance)));
+  }
+  if (has_immediate) {
+    auto lines = _immediate.lineVertices();
+    _lineVertexBuffer.upload(copy_pass, lines.data(),
+                             Uint32(lines.size_bytes()));
+    for (size_t i = 0; i < kNumDebugShapes; i++) {
+      auto instances = _immediate.instances(DebugShape(i));
+      _instanceBuffers[i].upload(copy_pass, instances.data(),
+                                 Uint32(instances.size_bytes()));
+    }
+  }
+  SDL_EndGPUCopyPass(copy_pass);
+}
+
+void DebugScene::renderInstances(RenderPassEncoder &encoder,
+                                 const Camera &camera) const {
+  const GpuMat4 viewProj = camera.viewProj();
+  if (_numLineVertices > 0) {
+    encoder.bindPipeline(_immediateLinePipeline);
+    encoder.pushVertexUniform(TRANSFORM_SLOT, &viewProj, sizeof(viewProj));
+    const SDL_GPUBufferBinding binding{_lineVertexBuffer, 0};
+    encoder.bindVertexBuffers(0, {&binding, 1});
+    encoder.drawPrimitives(_numLineVertices);
+  }
+
+  for (size_t i = 0; i < kNumDebugShapes; i++) {
+    if (_numEntityInstances[i] == 0 && _numInstances[i] == 0)
+      continue;
+    const bool is_grid = DebugShape(i) == DebugShape::GRID;
+    encoder.bindPipeline(is_grid ? _shapeLinePipeline : _shapePipeline);
+    const DebugShapeUniforms uniforms{viewProj, is_grid ? 0.f : 1.f};
+    encoder.pushVertexUniform(TRANSFORM_SLOT, &uniforms, sizeof(uniforms));
+    const Mesh &mesh = _shapeMeshes[i];
+    encoder.bindMesh(mesh);
+    auto draw_instances = [&](SDL_GPUBuffer *buffer, Uint32 count) {
+      if (count == 0)
+        return;
+      const SDL_GPUBufferBinding binding{buffer, 0};
+      encoder.bindVertexBuffers(INSTANCE_BUFFER_SLOT, {&binding, 1});
+      encoder.drawView(mesh.view(0), count);
+    };
+    draw_instances(_entityInstanceBuffers[i], _numEntityInstances[i]);
+    draw_instances(_instanceBuffers[i], _numInstances[i]);
+  }
+}
+
 void DebugScene::render(CommandBuffer &cmdBuf, const Camera &camera) const {
+  // before the render pass: copy passes cannot be nested
+  uploadInstances(cmdBuf);
 
   SDL_GPUColorTargetInfo color_target_info;
   SDL_zero(color_target_info);
@@ -129,19 +376,37 @@ void DebugScene::render(CommandBuffer &cmdBuf, const Camera &camera) const {
   depth_target_info.texture = _renderer.depth_texture;
   depth_target_info.cycle = false;
 
-  SDL_GPURenderPass *render_pass =
-      SDL_BeginGPURenderPass(cmdBuf, &color_target_info, 1, &depth_target_info);
+  RenderPassEncoder encoder{
+      cmdBuf,
+      SDL_BeginGPURenderPass(cmdBuf, &color_target_info, 1, &depth_target_info),
+      &_renderer.passStats};
 
-  renderMeshComponents(cmdBuf, render_pass, camera);
+  renderMeshComponents(encoder, camera);
+  renderInstances(encoder, camera);
 
-  SDL_EndGPURenderPass(render_pass);
+  encoder.end();
+  // the next primitive drawn starts a new list
+  _immediateRendered = true;
 }
 
 void DebugScene::release() {
   if (device()) {
-    SDL_ReleaseGPUGraphicsPipeline(device(), _trianglePipeline);
-    SDL_ReleaseGPUGraphicsPipeline(device(), _linePipeline);
+    auto release_pipeline = [this](SDL_GPUGraphicsPipeline *&pipeline) {
+      if (pipeline)
+        SDL_ReleaseGPUGraphicsPipeline(device(), pipeline);
+      pipeline = nullptr;
+    };
+    release_pipeline(_trianglePipeline);
+    release_pipeline(_linePipeline);
+    release_pipeline(_immediateLinePipeline);
+    release_pipeline(_shapePipeline);
+    release_pipeline(_shapeLinePipeline);
   }
+  _shapeMeshes.clear();
+  _entityInstanceBuffers.clear();
+  _instanceBuffers.clear();
+  _lineVertexBuffer.release();
+  _immediate.clear();
   // clean up all DebugMeshComponent objects.
   _registry.clear<DebugMeshComponent>();
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Scene.h"
+#include "DebugDraw.h"
+#include "DynamicBuffer.h"
 #include "Mesh.h"
 #include "Renderer.h"
 #include "math_types.h"
@@ -36,9 +38,42 @@ struct DebugMeshComponent {
   Float3 scale = Float3::Ones();
 };
 
+/// \brief Debug entity drawn as an instance of a mesh of the shared library
+/// of the DebugScene. Its TransformComponent maps the unit shape (see
+/// DebugShape) to the world.
+struct DebugShapeComponent {
+  DebugShape shape;
+  Float4 color;
+  bool enable = true;
+};
+
+/// \brief Debug entity drawn as a 3D triad: red, green and blue arrows along
+/// the axes of its TransformComponent, of length 0.5.
+struct DebugTriadComponent {
+  bool enable = true;
+  /// Scale applied by the systems updating the transform of the triad.
+  Float3 scale = Float3::Ones();
+};
+
 /// \brief %Scene for organizing debug entities and render systems.
 ///
-/// This implements a basic render system for DebugMeshComponent.
+/// This implements a basic render system for DebugMeshComponent, and an
+/// immediate-mode API (line(), sphere(), arrow()...) for transient
+/// primitives.
+///
+/// The scene keeps a library of shared meshes (box, sphere, point, arrow,
+/// grid), created once. DebugShapeComponent and DebugTriadComponent entities
+/// are drawn as instances of these meshes, with one instanced draw call per
+/// mesh; their instance data is uploaded every frame.
+///
+/// Immediate primitives are accumulated in a DebugDrawList, and drawn with
+/// one draw call for all lines and one instanced draw call per shape type.
+/// A list is drawn by every render() until a new one starts: the first
+/// primitive drawn or update() after a render() clears it. Primitives drawn
+/// before update() in a frame are therefore kept along with those of the
+/// subsystems, and frames rendered without drawing anything (e.g. when only
+/// the camera moved) show the last list. Their vertex and instance data is
+/// only uploaded when it changed.
 class DebugScene {
   entt::registry &_registry;
   const Renderer &_renderer;
@@ -47,9 +82,38 @@ class DebugScene {
   SDL_GPUTextureFormat _swapchainTextureFormat, _depthFormat;
   std::vector<std::unique_ptr<IDebugSubSystem>> _systems;
 
-  void renderMeshComponents(CommandBuffer &cmdBuf,
-                            SDL_GPURenderPass *render_pass,
+  // shared mesh library, indexed by DebugShape
+  std::vector<Mesh> _shapeMeshes;
+  SDL_GPUGraphicsPipeline *_shapePipeline = nullptr;
+  SDL_GPUGraphicsPipeline *_shapeLinePipeline = nullptr;
+  // instances of DebugShapeComponent and DebugTriadComponent entities,
+  // uploaded by render()
+  mutable std::vector<DynamicBuffer> _entityInstanceBuffers;
+  mutable std::array<Uint32, kNumDebugShapes> _numEntityInstances{};
+
+  // immediate-mode primitives
+  DebugDrawList _immediate;
+  mutable bool _immediateDirty = false;
+  // whether _immediate was rendered, and is cleared by the next draw
+  mutable bool _immediateRendered = false;
+  SDL_GPUGraphicsPipeline *_immediateLinePipeline = nullptr;
+  mutable std::vector<DynamicBuffer> _instanceBuffers;
+  mutable DynamicBuffer _lineVertexBuffer{NoInit};
+  mutable Uint32 _numLineVertices = 0;
+  mutable std::array<Uint32, kNumDebugShapes> _numInstances{};
+
+  void renderMeshComponents(RenderPassEncoder &encoder,
                             const Camera &camera) const;
+  void setupSharedResources();
+  void uploadInstances(CommandBuffer &cmdBuf) const;
+  /// The immediate list to draw into, started anew after a render().
+  DebugDrawList &immediateList() {
+    if (_immediateRendered)
+      clearImmediate();
+    _immediateDirty = true;
+    return _immediate;
+  }
+  void renderInstances(RenderPassEncoder &encoder, const Camera &camera) const;
 
 public:
   enum { TRANSFORM_SLOT = 0 };
@@ -75,12 +139,62 @@ public:
   void setupPipelines(const MeshLayout &layout);
 
   /// \brief Just the basic 3D triad.
-  std::tuple<entt::entity, DebugMeshComponent &> addTriad();
+  std::tuple<entt::entity, DebugTriadComponent &> addTriad();
+  /// \brief Add an entity drawn as a shape of the shared mesh library.
+  std::tuple<entt::entity, DebugShapeComponent &>
+  addShape(DebugShape shape, const Float4 &color);
   /// \brief Add a basic line grid.
-  std::tuple<entt::entity, DebugMeshComponent &>
+  std::tuple<entt::entity, DebugShapeComponent &>
   addLineGrid(std::optional<Float4> color = std::nullopt);
 
+  /// \name Immediate-mode primitives
+  /// \sa DebugDrawList
+  /// \{
+  void line(const Float3 &from, const Float3 &to, const Float4 &color) {
+    immediateList().line(from, to, color);
+  }
+  void polyline(std::span<const Float3> points, const Float4 &color,
+                bool closed = false) {
+    immediateList().polyline(points, color, closed);
+  }
+  void point(const Float3 &pos, float size, const Float4 &color) {
+    immediateList().point(pos, size, color);
+  }
+  void box(const Mat4f &pose, const Float3 &halfExtents, const Float4 &color) {
+    immediateList().box(pose, halfExtents, color);
+  }
+  void sphere(const Float3 &center, float radius, const Float4 &color) {
+    immediateList().sphere(center, radius, color);
+  }
+  void arrow(const Float3 &from, const Float3 &to, const Float4 &color,
+             float radius = 0.01f) {
+    immediateList().arrow(from, to, color, radius);
+  }
+  void frame(const Mat4f &pose, float scale = 0.1f) {
+    immediateList().frame(pose, scale);
+  }
+  /// \brief Record immediate-mode primitives directly in the list, e.g. in
+  /// bulk.
+  template <std::invocable<DebugDrawList &> F> void drawImmediate(F &&f) {
+    std::forward<F>(f)(immediateList());
+  }
+  /// \brief Remove all immediate-mode primitives.
+  void clearImmediate() {
+    if (!_immediate.empty())
+      _immediateDirty = true;
+    _immediate.clear();
+    _immediateRendered = false;
+  }
+  const DebugDrawList &immediatePrimitives() const { return _immediate; }
+  /// \}
+
+  /// \brief Update the subsystems, which may draw immediate-mode primitives.
+  ///
+  /// If the immediate primitives were rendered, they are cleared first.
+  /// Those drawn since the last render() are kept.
   void update() {
+    if (_immediateRendered)
+      clearImmediate();
     for (auto &system : _systems) {
       system->update(*this);
     }
@@ -126,7 +126,8 @@ void ShadowPassInfo::release() {
 
 void renderDepthOnlyPass(CommandBuffer &cmdBuf, const DepthPassInfo &passInfo,
                          const Mat4f &viewProj,
-                         std::span<const OpaqueCastable> castables) {
+                         std::span<const OpaqueCastable> castables,
+                         const TransformBuffer &transforms) {
   SDL_GPUDepthStencilTargetInfo depth_info;
   SDL_zero(depth_info);
   depth_info.load_op = SDL_GPU_LOADOP_CLEAR;
@@ -143,15 +144,16 @@ void renderDepthOnlyPass(CommandBuffer &cmdBuf, const DepthPassInfo &passInfo,
 
   assert(passInfo.pipeline);
   SDL_BindGPUGraphicsPipeline(render_pass, passInfo.pipeline);
+  transforms.bind(render_pass);
+  cmdBuf.pushVertexUniform(DepthPassInfo::VIEW_SLOT, &viewProj,
+                           sizeof(viewProj));
 
-  Mat4f mvp;
   for (auto &cs : castables) {
-    auto &[ent, mesh, tr] = cs;
-    assert(validateMesh(mesh));
-    rend::bindMesh(render_pass, mesh);
-    mvp.noalias() = viewProj * tr;
-    cmdBuf.pushVertexUniform(DepthPassInfo::TRANSFORM_SLOT, &mvp, sizeof(mvp));
-    rend::draw(render_pass, mesh);
+    assert(validateMesh(cs.mesh));
+    rend::bindMesh(render_pass, cs.mesh);
+    cmdBuf.pushVertexUniform(DepthPassInfo::OBJECT_INDEX_SLOT,
+                             &cs.transformIndex, sizeof(cs.transformIndex));
+    rend::draw(render_pass, cs.mesh);
   }
 
   SDL_EndGPURenderPass(render_pass);
@@ -161,6 +163,7 @@ void renderShadowPassFromFrustum(CommandBuffer &cmdBuf,
                                  ShadowPassInfo &passInfo,
                                  const DirectionalLight &dirLight,
                                  std::span<const OpaqueCastable> castables,
+                                 const TransformBuffer &transforms,
                                  const FrustumCornersType &worldSpaceCorners) {
 
   auto [frustumCenter, radius] =
@@ -180,12 +183,13 @@ void renderShadowPassFromFrustum(CommandBuffer &cmdBuf,
                                float(bounds.min_.z()), float(bounds.max_.z()));
 
   Mat4f viewProj = passInfo.cam.viewProj();
-  renderDepthOnlyPass(cmdBuf, passInfo, viewProj, castables);
+  renderDepthOnlyPass(cmdBuf, passInfo, viewProj, castables, transforms);
 }
 
 void renderShadowPassFromAABB(CommandBuffer &cmdBuf, ShadowPassInfo &passInfo,
                               const DirectionalLight &dirLight,
                               std::span<const OpaqueCastable> castables,
+                              const TransformBuffer &transforms,
                               const AABB &worldSceneBounds) {
   Float3 center = worldSceneBounds.center().cast<float>();
   float radius = 0.5f * float(worldSceneBounds.size());
@@ -202,6 +206,6 @@ void renderShadowPassFromAABB(CommandBuffer &cmdBuf, ShadowPassInfo &passInfo,
                                float(bounds.min_.z()), float(bounds.max_.z()));
 
   Mat4f viewProj = lightProj * lightView.matrix();
-  renderDepthOnlyPass(cmdBuf, passInfo, viewProj, castables);
+  renderDepthOnlyPass(cmdBuf, passInfo, viewProj, castables, transforms);
 }
 } // namespace candlewick
@@ -6,14 +6,13 @@
 ///
 /// When using a depth pre-pass with `EQUAL` depth comparison in the main pass,
 /// ensure identical vertex transformations between passes by:
-/// 1. Computing the MVP matrix on CPU side
-/// 2. Using the same MVP matrix in both pre-pass and main pass shaders
-/// 3. Avoiding shader-side matrix multiplication that might cause precision
-/// differences.
+/// 1. Reading the model matrices from the same TransformBuffer
+/// 2. Computing the position with the same expression in both pre-pass and
+/// main pass shaders, \f$ (VP)(M p) \f$
+/// 3. Declaring `gl_Position` as `invariant` in both shaders.
 ///
 /// Failing to do this can result in z-fighting/Moiré patterns due to
-/// floating-point precision differences between CPU and GPU matrix
-/// calculations.
+/// floating-point precision differences between the two passes.
 ///
 /// \image html depth-prepass.png "Rendering the depth buffer after early pass"
 ///
@@ -25,6 +24,7 @@
 #include "Mesh.h"
 #include "math_types.h"
 #include "LightUniforms.h"
+#include "TransformBuffer.h"
 
 #include <entt/entity/fwd.hpp>
 #include <span>
@@ -38,7 +38,10 @@ namespace candlewick {
 /// culling enabled.
 struct DepthPassInfo {
   enum DepthPassSlots : Uint32 {
-    TRANSFORM_SLOT = 0,
+    /// Index of the object in the TransformBuffer.
+    OBJECT_INDEX_SLOT = 0,
+    /// View-projection matrix of the pass.
+    VIEW_SLOT = 1,
   };
   struct Config {
     SDL_GPUCullMode cull_mode;
@@ -100,13 +103,17 @@ struct OpaqueCastable {
   entt::entity ent;
   const Mesh &mesh;
   Mat4f transform;
+  /// Index of the object transform in the frame's TransformBuffer.
+  Uint32 transformIndex;
 };
 
 /// \ingroup depth_pass
 /// \brief Render a depth-only pass, built from a set of OpaqueCastable.
+/// \param transforms Transforms of the frame, already uploaded.
 void renderDepthOnlyPass(CommandBuffer &cmdBuf, const DepthPassInfo &passInfo,
                          const Mat4f &viewProj,
-                         std::span<const OpaqueCastable> castables);
+                         std::span<const OpaqueCastable> castables,
+                         const TransformBuffer &transforms);
 
 /// \addtogroup depth_pass
 /// \section depth_testing Depth testing in modern APIs
@@ -126,6 +133,7 @@ void renderDepthOnlyPass(CommandBuffer &cmdBuf, const DepthPassInfo &passInfo,
 void renderShadowPassFromAABB(CommandBuffer &cmdBuf, ShadowPassInfo &passInfo,
                               const DirectionalLight &dirLight,
                               std::span<const OpaqueCastable> castables,
+                              const TransformBuffer &transforms,
                               const AABB &worldSceneBounds);
 
 /// \brief Render shadow pass, using a provided world-space frustum.
@@ -139,6 +147,7 @@ void renderShadowPassFromFrustum(CommandBuffer &cmdBuf,
                                  ShadowPassInfo &passInfo,
                                  const DirectionalLight &dirLight,
                                  std::span<const OpaqueCastable> castables,
+                                 const TransformBuffer &transforms,
                                  const FrustumCornersType &worldSpaceCorners);
 
 /// \brief Orthographic matrix which maps to the negative-Z half-volume of the
@@ -0,0 +1,95 @@
+#include "DynamicBuffer.h"
+#include "Device.h"
+#include "errors.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace candlewick {
+
+DynamicBuffer::DynamicBuffer(const Device &device,
+                             SDL_GPUBufferUsageFlags usage, Uint32 capacity,
+                             const char *name)
+    : _device(device), m_usage(usage), m_name(name) {
+  allocate(std::max(capacity, 1u));
+}
+
+DynamicBuffer::DynamicBuffer(DynamicBuffer &&other) noexcept
+    : _device(std::exchange(other._device, nullptr)),
+      m_buffer(std::exchange(other.m_buffer, nullptr)),
+      m_transferBuffer(std::exchange(other.m_transferBuffer, nullptr)),
+      m_usage(other.m_usage),
+      m_capacity(std::exchange(other.m_capacity, 0u)), m_name(other.m_name) {}
+
+DynamicBuffer &DynamicBuffer::operator=(DynamicBuffer &&other) noexcept {
+  if (this == &other)
+    return *this;
+  this->release();
+  _device = std::exchange(other._device, nullptr);
+  m_buffer = std::exchange(other.m_buffer, nullptr);
+  m_transferBuffer = std::exchange(other.m_transferBuffer, nullptr);
+  m_usage = other.m_usage;
+  m_capacity = std::exchange(other.m_capacity, 0u);
+  m_name = other.m_name;
+  return *this;
+}
+
+void DynamicBuffer::allocate(Uint32 capacity) {
+  // released buffers are only destroyed once the frames using them complete
+  if (m_buffer)
+    SDL_ReleaseGPUBuffer(_device, m_buffer);
+  if (m_transferBuffer)
+    SDL_ReleaseGPUTransferBuffer(_device, m_transferBuffer);
+
+  SDL_GPUBufferCreateInfo buffer_ci{
+      .usage = m_usage,
+      .size = capacity,
+      .props = 0,
+  };
+  m_buffer = SDL_CreateGPUBuffer(_device, &buffer_ci);
+  SDL_GPUTransferBufferCreateInfo tb_ci{
+      .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+      .size = capacity,
+      .props = 0,
+  };
+  m_transferBuffer = SDL_CreateGPUTransferBuffer(_device, &tb_ci);
+  if (!m_buffer || !m_transferBuffer) {
+    this->release();
+    throw RAIIException(SDL_GetError());
+  }
+  if (m_name)
+    SDL_SetGPUBufferName(_device, m_buffer, m_name);
+  m_capacity = capacity;
+}
+
+void DynamicBuffer::upload(SDL_GPUCopyPass *copy_pass, const void *data,
+                           Uint32 size) {
+  if (size == 0)
+    return;
+  if (size > m_capacity)
+    allocate(std::max(size, 2 * m_capacity));
+
+  void *mapped = SDL_MapGPUTransferBuffer(_device, m_transferBuffer, true);
+  SDL_memcpy(mapped, data, size);
+  SDL_UnmapGPUTransferBuffer(_device, m_transferBuffer);
+
+  SDL_GPUTransferBufferLocation src{.transfer_buffer = m_transferBuffer,
+                                    .offset = 0};
+  SDL_GPUBufferRegion dst{.buffer = m_buffer, .offset = 0, .size = size};
+  SDL_UploadToGPUBuffer(copy_pass, &src, &dst, true);
+}
+
+void DynamicBuffer::release() noexcept {
+  if (!_device)
+    return;
+  if (m_buffer)
+    SDL_ReleaseGPUBuffer(_device, m_buffer);
+  if (m_transferBuffer)
+    SDL_ReleaseGPUTransferBuffer(_device, m_transferBuffer);
+  m_buffer = nullptr;
+  m_transferBuffer = nullptr;
+  m_capacity = 0;
+  _device = nullptr;
+}
+
+} // namespace candlewick
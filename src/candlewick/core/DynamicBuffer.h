@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Core.h"
+#include "Tags.h"
+#include <SDL3/SDL_gpu.h>
+
+namespace candlewick {
+
+/// \brief GPU buffer whose contents are rewritten from the CPU, e.g. once per
+/// frame, such as vertex or instance data of immediate-mode draws.
+///
+/// Uploads go through a cycled transfer buffer, and cycle the GPU buffer: the
+/// frames in flight keep reading their own copy. The buffers grow as needed.
+/// \sa TransformBuffer
+class DynamicBuffer {
+public:
+  DynamicBuffer(NoInitT) {}
+  /// \param capacity Initial capacity, in bytes.
+  DynamicBuffer(const Device &device, SDL_GPUBufferUsageFlags usage,
+                Uint32 capacity, const char *name = nullptr);
+  DynamicBuffer(const DynamicBuffer &) = delete;
+  DynamicBuffer &operator=(const DynamicBuffer &) = delete;
+  DynamicBuffer(DynamicBuffer &&other) noexcept;
+  DynamicBuffer &operator=(DynamicBuffer &&other) noexcept;
+
+  bool initialized() const { return _device != nullptr; }
+  operator SDL_GPUBuffer *() const noexcept { return m_buffer; }
+  Uint32 capacity() const { return m_capacity; }
+
+  /// \brief Record the upload of \p size bytes at the start of the buffer,
+  /// growing it if needed.
+  void upload(SDL_GPUCopyPass *copy_pass, const void *data, Uint32 size);
+
+  void release() noexcept;
+  ~DynamicBuffer() noexcept { this->release(); }
+
+private:
+  void allocate(Uint32 capacity);
+
+  SDL_GPUDevice *_device = nullptr;
+  SDL_GPUBuffer *m_buffer = nullptr;
+  SDL_GPUTransferBuffer *m_transferBuffer = nullptr;
+  SDL_GPUBufferUsageFlags m_usage = 0;
+  Uint32 m_capacity = 0;
+  const char *m_name = nullptr;
+};
+
+} // namespace candlewick
@@ -0,0 +1,78 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace candlewick {
+
+// regions grow to page multiples, which leaves room for alignment padding
+static size_t roundUpCapacity(size_t size) {
+  constexpr size_t page = 4096;
+  return (size + page - 1) / page * page;
+}
+
+FrameArena::FrameArena(size_t capacity, Uint32 framesInFlight)
+    : m_regions(std::max(framesInFlight, 1u)) {
+  for (Region &region : m_regions)
+    region.capacity = capacity;
+}
+
+void FrameArena::beginFrame() {
+  m_current = (m_current + 1) % Uint32(m_regions.size());
+  Region &region = m_regions[m_current];
+  if (region.overflowBytes > 0) {
+    // reallocated on the next allocation
+    region.capacity = roundUpCapacity(std::max(m_highWaterMark, region.used()));
+    region.data.reset();
+  }
+  region.offset = 0;
+  region.overflow.clear();
+  region.overflowBytes = 0;
+}
+
+void *FrameArena::allocate(size_t size, size_t alignment) {
+  SDL_assert((alignment & (alignment - 1)) == 0);
+  Region &region = m_regions[m_current];
+  if (!region.data && region.overflowBytes == 0 && region.capacity > 0)
+    region.data = std::make_unique_for_overwrite<std::byte[]>(region.capacity);
+
+  void *ptr = nullptr;
+  if (region.data) {
+    const auto base = reinterpret_cast<std::uintptr_t>(region.data.get());
+    const std::uintptr_t aligned =
+        (base + region.offset + alignment - 1) & ~std::uintptr_t(alignment - 1);
+    const size_t end = size_t(aligned - base) + size;
+    if (end <= region.capacity) {
+      region.offset = end;
+      ptr = reinterpret_cast<void *>(aligned);
+    }
+  }
+  if (!ptr)
+    ptr = allocateOverflow(region, size, alignment);
+  m_highWaterMark = std::max(m_highWaterMark, region.used());
+  return ptr;
+}
+
+void *FrameArena::allocateOverflow(Region &region, size_t size,
+                                   size_t alignment) {
+  const size_t bytes = size + alignment;
+  auto &block = region.overflow.emplace_back(
+      std::make_unique_for_overwrite<std::byte[]>(bytes));
+  region.overflowBytes += bytes;
+  m_overflows++;
+  const auto base = reinterpret_cast<std::uintptr_t>(block.get());
+  return reinterpret_cast<void *>((base + alignment - 1) &
+                                  ~std::uintptr_t(alignment - 1));
+}
+
+FrameArenaStats FrameArena::stats() const {
+  const Region &region = m_regions[m_current];
+  return {
+      .capacity = region.capacity,
+      .used = region.used(),
+      .highWaterMark = m_highWaterMark,
+      .overflows = m_overflows,
+  };
+}
+
+} // namespace candlewick
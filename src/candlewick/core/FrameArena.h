@@ -0,0 +1,123 @@
+#pragma once
+
+#include <SDL3/SDL_assert.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace candlewick {
+
+/// \brief Statistics of a FrameArena, used to size it.
+struct FrameArenaStats {
+  /// Capacity of each region, in bytes.
+  size_t capacity = 0;
+  /// Bytes allocated in the current frame, alignment padding included.
+  size_t used = 0;
+  /// Largest number of bytes allocated in a single frame.
+  size_t highWaterMark = 0;
+  /// Number of allocations which did not fit in their region, and were
+  /// served by the heap.
+  Uint64 overflows = 0;
+};
+
+/// \brief Linear (bump) allocator for the transient data of a frame, e.g.
+/// draw lists, culling results or shadow castables.
+///
+/// The arena holds one region per frame in flight. beginFrame() moves to the
+/// next region and frees everything which was allocated in it: data allocated
+/// during a frame stays valid for the next `framesInFlight - 1` frames.
+/// Deallocation is a no-op, and destructors are not run.
+///
+/// Allocations which do not fit in their region are served by the heap, and
+/// the region grows to the high-water mark the next time it is reset. After a
+/// few frames, the arena stops making heap allocations.
+///
+/// \sa FrameAllocator
+class FrameArena {
+public:
+  explicit FrameArena(size_t capacity = 64 * 1024, Uint32 framesInFlight = 2);
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+  FrameArena(FrameArena &&) noexcept = default;
+  FrameArena &operator=(FrameArena &&) noexcept = default;
+
+  /// \brief Start a new frame: move to the next region, and release its
+  /// allocations.
+  void beginFrame();
+
+  /// \brief Allocate \p size bytes, aligned to \p alignment (a power of two).
+  [[nodiscard]] void *allocate(size_t size, size_t alignment);
+
+  /// \brief Allocate an uninitialized array of \p count elements.
+  template <typename T>
+  [[nodiscard]] std::span<T> allocateArray(size_t count) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "Arena arrays are not destroyed.");
+    return {static_cast<T *>(allocate(count * sizeof(T), alignof(T))), count};
+  }
+
+  Uint32 framesInFlight() const { return Uint32(m_regions.size()); }
+  FrameArenaStats stats() const;
+
+private:
+  struct Region {
+    std::unique_ptr<std::byte[]> data;
+    size_t capacity;
+    size_t offset = 0;
+    // heap allocations which did not fit, freed when the region is reset
+    std::vector<std::unique_ptr<std::byte[]>> overflow;
+    size_t overflowBytes = 0;
+
+    size_t used() const { return offset + overflowBytes; }
+  };
+
+  void *allocateOverflow(Region &region, size_t size, size_t alignment);
+
+  std::vector<Region> m_regions;
+  Uint32 m_current = 0;
+  size_t m_highWaterMark = 0;
+  Uint64 m_overflows = 0;
+};
+
+/// \brief STL allocator adaptor for FrameArena. Containers using it must not
+/// outlive the frame data of the arena.
+///
+/// A default-constructed allocator has no arena, and cannot allocate.
+template <typename T> class FrameAllocator {
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  FrameAllocator() noexcept = default;
+  FrameAllocator(FrameArena &arena) noexcept : m_arena(&arena) {}
+  template <typename U>
+  FrameAllocator(const FrameAllocator<U> &other) noexcept
+      : m_arena(other.arena()) {}
+
+  [[nodiscard]] T *allocate(size_t n) {
+    SDL_assert(m_arena);
+    return static_cast<T *>(m_arena->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T *, size_t) noexcept {}
+
+  FrameArena *arena() const noexcept { return m_arena; }
+
+  template <typename U>
+  bool operator==(const FrameAllocator<U> &other) const noexcept {
+    return m_arena == other.arena();
+  }
+
+private:
+  FrameArena *m_arena = nullptr;
+};
+
+/// \brief Vector allocated from a FrameArena.
+template <typename T> using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+} // namespace candlewick
@@ -11,7 +11,9 @@ namespace candlewick {
 MeshView::MeshView(const MeshView &parent, Uint32 subVertexOffset,
                    Uint32 subVertexCount, Uint32 subIndexOffset,
                    Uint32 subIndexCount)
-    : vertexBuffers(parent.vertexBuffers), indexBuffer(parent.indexBuffer),
+    : vertexBuffers(parent.vertexBuffers),
+      numVertexBuffers(parent.numVertexBuffers),
+      indexBuffer(parent.indexBuffer),
       vertexOffset(parent.vertexOffset + subVertexOffset),
       vertexCount(subVertexCount),
       indexOffset(parent.indexOffset + subIndexOffset),
@@ -27,6 +29,8 @@ Mesh::Mesh(NoInitT) {}
 Mesh::Mesh(const Device &device, const MeshLayout &layout)
     : m_device(device), m_layout(layout) {
   const Uint32 count = this->m_layout.numBuffers();
+  if (count > kMaxVertexBuffers)
+    terminate_with_message("Mesh layout has too many vertex buffers.");
   vertexBuffers.resize(count, nullptr);
 }
 
@@ -100,14 +104,15 @@ void Mesh::release() noexcept {
 MeshView &Mesh::addView(Uint32 vertexOffset, Uint32 vertexSubCount,
                         Uint32 indexOffset, Uint32 indexSubCount) {
   MeshView v;
-  v.vertexBuffers = vertexBuffers;
+  v.vertexBuffers = vertexBuffers.data();
+  v.numVertexBuffers = numVertexBuffers();
   v.indexBuffer = indexBuffer;
   v.vertexOffset = vertexOffset;
   v.vertexCount = vertexSubCount;
   v.indexOffset = indexOffset;
   v.indexCount = indexSubCount;
 
-  return m_views.emplace_back(std::move(v));
+  return m_views.emplace_back(v);
 }
 
 } // namespace candlewick
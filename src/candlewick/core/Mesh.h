@@ -6,26 +6,35 @@
 
 #include <vector>
 #include <span>
+#include <type_traits>
 #include <SDL3/SDL_assert.h>
 #include <entt/entity/registry.hpp>
 #include <entt/entity/handle.hpp>
 
 namespace candlewick {
 
+/// \brief Maximum number of vertex buffers of a Mesh, which is the capacity
+/// of the binding arrays of rend::bindMesh().
+inline constexpr Uint32 kMaxVertexBuffers = 16;
+
 /// \brief A view into a Mesh object.
 ///
-/// Objects of this class are copyable and movable, since they only "borrow" the
-/// buffers.
+/// Objects of this class are trivially copyable: they reference the vertex
+/// buffers of their parent Mesh, and copying them does not allocate.
 /// \warning A MeshView is expected to be non-empty: positive vertex count and
 /// index count (if initial Mesh is indexed).
+/// \warning The buffers are those of the parent Mesh, which must outlive the
+/// view.
 /// \sa Mesh
 class MeshView {
   friend class Mesh;
   MeshView() noexcept = default;
 
 public:
-  /// Vertex buffers.
-  std::vector<SDL_GPUBuffer *> vertexBuffers;
+  /// Vertex buffers, owned by the parent Mesh.
+  SDL_GPUBuffer *const *vertexBuffers;
+  /// Number of vertex buffers.
+  Uint32 numVertexBuffers;
   /// Index buffer.
   SDL_GPUBuffer *indexBuffer;
 
@@ -44,6 +53,7 @@ public:
   MeshView(const MeshView &parent, Uint32 subVertexOffset,
            Uint32 vertexSubCount, Uint32 subIndexOffset, Uint32 indexSubCount);
 };
+static_assert(std::is_trivially_copyable_v<MeshView>);
 
 /// \brief Handle class for meshes (vertex buffers and an optional index buffer)
 /// on the GPU.
@@ -70,6 +80,9 @@ public:
   /// e.g. the vertex positions, normals, and colors may be in different vertex
   /// buffers in GPU memory, instead of being laid out as
   /// `[pos0, norm0, col0, pos1, ...]`.
+  ///
+  /// The size of this vector is fixed at construction, since the views of
+  /// the Mesh point to its storage.
   std::vector<SDL_GPUBuffer *> vertexBuffers;
 
   /// Index buffer for the mesh's index data. If this is null, then the
@@ -162,8 +175,8 @@ public:
 /// \param view Input view to validate.
 /// \sa validateMesh()
 [[nodiscard]] inline bool validateMeshView(const MeshView &view) {
-  for (auto vb : view.vertexBuffers) {
-    if (!vb)
+  for (Uint32 i = 0; i < view.numVertexBuffers; i++) {
+    if (!view.vertexBuffers[i])
       return false;
   }
   // views of indexed meshes cannot have zero indices.
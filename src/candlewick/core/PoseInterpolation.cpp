@@ -0,0 +1,39 @@
+#include "PoseInterpolation.h"
+
+#include <SDL3/SDL_assert.h>
+
+namespace candlewick {
+
+void interpolatePoses(const PoseArray &from, const PoseArray &to, float alpha,
+                      PoseArray &out) {
+  SDL_assert(from.size() == to.size());
+  out.resize(from.size());
+
+  auto q0 = from.rotations.array();
+  auto q1 = to.rotations.array();
+  // q and -q are the same rotation: take the shortest arc
+  const Eigen::Array<float, 1, Eigen::Dynamic> dot =
+      (q0 * q1).colwise().sum();
+  const Eigen::Array<float, 1, Eigen::Dynamic> sign =
+      (dot < 0.f).select(-1.f, Eigen::Array<float, 1, Eigen::Dynamic>::Ones(
+                                   dot.size()));
+  const auto cos_theta = (dot * sign).min(1.f);
+  const Eigen::Array<float, 1, Eigen::Dynamic> theta = cos_theta.acos();
+  const Eigen::Array<float, 1, Eigen::Dynamic> sin_theta = theta.sin();
+
+  // for nearly identical rotations, fall back to linear interpolation (the
+  // result is normalized below)
+  constexpr float eps = 1e-4f;
+  const auto nearly_equal = sin_theta < eps;
+  const Eigen::Array<float, 1, Eigen::Dynamic> s0 = nearly_equal.select(
+      1.f - alpha, ((1.f - alpha) * theta).sin() / sin_theta);
+  const Eigen::Array<float, 1, Eigen::Dynamic> s1 =
+      nearly_equal.select(alpha, (alpha * theta).sin() / sin_theta) * sign;
+
+  out.rotations.array() = q0.rowwise() * s0 + q1.rowwise() * s1;
+  out.rotations.colwise().normalize();
+  out.translations =
+      (1.f - alpha) * from.translations + alpha * to.translations;
+}
+
+} // namespace candlewick
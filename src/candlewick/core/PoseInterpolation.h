@@ -0,0 +1,45 @@
+#pragma once
+
+#include "math_types.h"
+#include <Eigen/Geometry>
+
+namespace candlewick {
+
+/// \brief Rigid poses of a set of objects, stored as a structure of arrays
+/// (one column per object) so that interpolation is vectorized across
+/// objects.
+struct PoseArray {
+  /// Unit quaternion coefficients \f$(x, y, z, w)\f$.
+  Eigen::Matrix4Xf rotations;
+  Eigen::Matrix3Xf translations;
+
+  Eigen::Index size() const { return translations.cols(); }
+  void resize(Eigen::Index count) {
+    rotations.resize(4, count);
+    translations.resize(3, count);
+  }
+
+  void set(Eigen::Index i, const Eigen::Quaternionf &R, const Float3 &p) {
+    rotations.col(i) = R.coeffs();
+    translations.col(i) = p;
+  }
+
+  /// \brief Homogeneous transformation matrix of object \p i.
+  Mat4f matrix(Eigen::Index i) const {
+    Mat4f M = Mat4f::Identity();
+    M.topLeftCorner<3, 3>() =
+        Eigen::Quaternionf{rotations.col(i)}.toRotationMatrix();
+    M.topRightCorner<3, 1>() = translations.col(i);
+    return M;
+  }
+};
+
+/// \brief Interpolate each pose between \p from and \p to: spherical linear
+/// interpolation of the rotations, and linear interpolation of the
+/// translations.
+/// \param alpha Interpolation parameter, 0 for \p from and 1 for \p to.
+/// \param out Interpolated poses, resized as needed.
+void interpolatePoses(const PoseArray &from, const PoseArray &to, float alpha,
+                      PoseArray &out);
+
+} // namespace candlewick
@@ -0,0 +1,190 @@
+#include "RenderPassEncoder.h"
+#include "CommandBuffer.h"
+#include "Renderer.h"
+
+#include <cstring>
+
+namespace candlewick {
+
+RenderPassStats &RenderPassStats::operator+=(const RenderPassStats &other) {
+  passes += other.passes;
+  pipelineBinds += other.pipelineBinds;
+  skippedPipelineBinds += other.skippedPipelineBinds;
+  bufferBinds += other.bufferBinds;
+  skippedBufferBinds += other.skippedBufferBinds;
+  samplerBinds += other.samplerBinds;
+  skippedSamplerBinds += other.skippedSamplerBinds;
+  uniformPushes += other.uniformPushes;
+  skippedUniformPushes += other.skippedUniformPushes;
+  draws += other.draws;
+  return *this;
+}
+
+static bool operator==(const SDL_GPUBufferBinding &lhs,
+                       const SDL_GPUBufferBinding &rhs) {
+  return lhs.buffer == rhs.buffer && lhs.offset == rhs.offset;
+}
+
+static bool operator==(const SDL_GPUTextureSamplerBinding &lhs,
+                       const SDL_GPUTextureSamplerBinding &rhs) {
+  return lhs.texture == rhs.texture && lhs.sampler == rhs.sampler;
+}
+
+RenderPassEncoder::RenderPassEncoder(CommandBuffer &command_buffer,
+                                     SDL_GPURenderPass *render_pass,
+                                     RenderPassStats *stats)
+    : m_cmdBuf(&command_buffer), m_pass(render_pass), m_statsSink(stats) {}
+
+void RenderPassEncoder::bindPipeline(SDL_GPUGraphicsPipeline *pipeline) {
+  if (pipeline == m_pipeline) {
+    m_stats.skippedPipelineBinds++;
+    return;
+  }
+  SDL_BindGPUGraphicsPipeline(m_pass, pipeline);
+  m_pipeline = pipeline;
+  m_stats.pipelineBinds++;
+  for (Uint32 i = 0; i < kMaxUniformSlots; i++) {
+    m_vertexUniforms[i].length = 0;
+    m_fragmentUniforms[i].length = 0;
+  }
+}
+
+void RenderPassEncoder::bindVertexBuffers(
+    Uint32 first_slot, std::span<const SDL_GPUBufferBinding> bindings) {
+  const Uint32 count = Uint32(bindings.size());
+  SDL_assert(first_slot + count <= kMaxVertexBuffers);
+  bool bound = true;
+  for (Uint32 i = 0; i < count; i++) {
+    if (!(m_vertexBuffers[first_slot + i] == bindings[i])) {
+      bound = false;
+      m_vertexBuffers[first_slot + i] = bindings[i];
+    }
+  }
+  if (bound) {
+    m_stats.skippedBufferBinds++;
+    return;
+  }
+  SDL_BindGPUVertexBuffers(m_pass, first_slot, bindings.data(), count);
+  m_stats.bufferBinds++;
+}
+
+void RenderPassEncoder::bindIndexBuffer(const SDL_GPUBufferBinding &binding,
+                                        SDL_GPUIndexElementSize element_size) {
+  if (m_indexBuffer == binding && m_indexElementSize == element_size) {
+    m_stats.skippedBufferBinds++;
+    return;
+  }
+  SDL_BindGPUIndexBuffer(m_pass, &binding, element_size);
+  m_indexBuffer = binding;
+  m_indexElementSize = element_size;
+  m_stats.bufferBinds++;
+}
+
+void RenderPassEncoder::bindBuffers(SDL_GPUBuffer *const *vertex_buffers,
+                                    Uint32 num_buffers,
+                                    SDL_GPUBuffer *index_buffer) {
+  SDL_assert(num_buffers <= kMaxVertexBuffers);
+  SDL_GPUBufferBinding vertex_bindings[kMaxVertexBuffers];
+  for (Uint32 j = 0; j < num_buffers; j++) {
+    vertex_bindings[j] = {vertex_buffers[j], 0u};
+  }
+  bindVertexBuffers(0, {vertex_bindings, num_buffers});
+  if (index_buffer)
+    bindIndexBuffer({index_buffer, 0u});
+}
+
+void RenderPassEncoder::bindMesh(const Mesh &mesh) {
+  bindBuffers(mesh.vertexBuffers.data(), mesh.numVertexBuffers(),
+              mesh.indexBuffer);
+}
+
+void RenderPassEncoder::bindMeshView(const MeshView &view) {
+  bindBuffers(view.vertexBuffers, view.numVertexBuffers, view.indexBuffer);
+}
+
+void RenderPassEncoder::bindFragmentSamplers(
+    Uint32 first_slot, std::span<const SDL_GPUTextureSamplerBinding> bindings) {
+  const Uint32 count = Uint32(bindings.size());
+  SDL_assert(first_slot + count <= kMaxSamplerSlots);
+  bool bound = true;
+  for (Uint32 i = 0; i < count; i++) {
+    if (!(m_fragmentSamplers[first_slot + i] == bindings[i])) {
+      bound = false;
+      m_fragmentSamplers[first_slot + i] = bindings[i];
+    }
+  }
+  if (bound) {
+    m_stats.skippedSamplerBinds++;
+    return;
+  }
+  SDL_BindGPUFragmentSamplers(m_pass, first_slot, bindings.data(), count);
+  m_stats.samplerBinds++;
+}
+
+bool RenderPassEncoder::updateUniformCache(UniformCache &cache,
+                                           const void *data, Uint32 length) {
+  if (length > kMaxCachedUniformSize) {
+    // too large to be cached: forget the previous payload
+    cache.length = 0;
+    return true;
+  }
+  if (cache.length == length && std::memcmp(cache.data, data, length) == 0)
+    return false;
+  cache.length = length;
+  std::memcpy(cache.data, data, length);
+  return true;
+}
+
+RenderPassEncoder &RenderPassEncoder::pushVertexUniform(Uint32 slot,
+                                                        const void *data,
+                                                        Uint32 length) {
+  SDL_assert(slot < kMaxUniformSlots);
+  if (!updateUniformCache(m_vertexUniforms[slot], data, length)) {
+    m_stats.skippedUniformPushes++;
+    return *this;
+  }
+  m_cmdBuf->pushVertexUniform(slot, data, length);
+  m_stats.uniformPushes++;
+  return *this;
+}
+
+RenderPassEncoder &RenderPassEncoder::pushFragmentUniform(Uint32 slot,
+                                                          const void *data,
+                                                          Uint32 length) {
+  SDL_assert(slot < kMaxUniformSlots);
+  if (!updateUniformCache(m_fragmentUniforms[slot], data, length)) {
+    m_stats.skippedUniformPushes++;
+    return *this;
+  }
+  m_cmdBuf->pushFragmentUniform(slot, data, length);
+  m_stats.uniformPushes++;
+  return *this;
+}
+
+void RenderPassEncoder::drawView(const MeshView &view, Uint32 numInstances) {
+  rend::drawView(m_pass, view, numInstances);
+  m_stats.draws++;
+}
+
+void RenderPassEncoder::draw(const Mesh &mesh, Uint32 numInstances) {
+  rend::draw(m_pass, mesh, numInstances);
+  m_stats.draws += Uint32(mesh.numViews());
+}
+
+void RenderPassEncoder::drawPrimitives(Uint32 numVertices, Uint32 numInstances,
+                                       Uint32 firstVertex) {
+  SDL_DrawGPUPrimitives(m_pass, numVertices, numInstances, firstVertex, 0);
+  m_stats.draws++;
+}
+
+void RenderPassEncoder::end() noexcept {
+  if (!m_pass)
+    return;
+  SDL_EndGPURenderPass(m_pass);
+  m_pass = nullptr;
+  m_stats.passes++;
+  if (m_statsSink)
+    *m_statsSink += m_stats;
+}
+
+} // namespace candlewick
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Core.h"
+#include "Mesh.h"
+#include <SDL3/SDL_gpu.h>
+
+#include <initializer_list>
+#include <span>
+
+namespace candlewick {
+
+/// \brief Counters of a RenderPassEncoder: commands forwarded to SDL, and
+/// commands skipped because they would not change the state of the pass.
+struct RenderPassStats {
+  /// Render passes ended.
+  Uint32 passes = 0;
+  Uint32 pipelineBinds = 0;
+  Uint32 skippedPipelineBinds = 0;
+  /// Vertex and index buffer bindings.
+  Uint32 bufferBinds = 0;
+  Uint32 skippedBufferBinds = 0;
+  Uint32 samplerBinds = 0;
+  Uint32 skippedSamplerBinds = 0;
+  Uint32 uniformPushes = 0;
+  Uint32 skippedUniformPushes = 0;
+  Uint32 draws = 0;
+
+  Uint32 commands() const {
+    return pipelineBinds + bufferBinds + samplerBinds + uniformPushes + draws;
+  }
+  Uint32 skipped() const {
+    return skippedPipelineBinds + skippedBufferBinds + skippedSamplerBinds +
+           skippedUniformPushes;
+  }
+  RenderPassStats &operator+=(const RenderPassStats &other);
+};
+
+/// \brief Stateful wrapper around a render pass, which skips redundant state
+/// changes.
+///
+/// The encoder caches the bound pipeline, vertex and index buffers, fragment
+/// samplers, and the last uniform payload of each slot. Binding the same
+/// state again, or pushing the same uniform data to a slot, is not forwarded
+/// to SDL. Uniform payloads are compared exactly: payloads larger than
+/// kMaxCachedUniformSize are always pushed. Since the uniform slots of
+/// different pipelines need not match, binding another pipeline clears the
+/// uniform cache.
+///
+/// \warning All the commands of the pass must go through the encoder, or the
+/// cache will not match the actual state.
+class RenderPassEncoder {
+public:
+  static constexpr Uint32 kMaxUniformSlots = 4;
+  static constexpr Uint32 kMaxSamplerSlots = 16;
+  static constexpr Uint32 kMaxCachedUniformSize = 256;
+
+  /// \param stats Optional counters, to which the counters of this pass are
+  /// added when it ends.
+  RenderPassEncoder(CommandBuffer &command_buffer,
+                    SDL_GPURenderPass *render_pass,
+                    RenderPassStats *stats = nullptr);
+  RenderPassEncoder(const RenderPassEncoder &) = delete;
+  RenderPassEncoder &operator=(const RenderPassEncoder &) = delete;
+  ~RenderPassEncoder() noexcept { end(); }
+
+  operator SDL_GPURenderPass *() const { return m_pass; }
+  bool active() const { return m_pass != nullptr; }
+
+  void bindPipeline(SDL_GPUGraphicsPipeline *pipeline);
+
+  void bindVertexBuffers(Uint32 first_slot,
+                         std::span<const SDL_GPUBufferBinding> bindings);
+  void bindIndexBuffer(const SDL_GPUBufferBinding &binding,
+                       SDL_GPUIndexElementSize element_size =
+                           SDL_GPU_INDEXELEMENTSIZE_32BIT);
+  /// \brief Bind the vertex and index buffers of a Mesh.
+  /// \sa rend::bindMesh()
+  void bindMesh(const Mesh &mesh);
+  /// \sa rend::bindMeshView()
+  void bindMeshView(const MeshView &view);
+
+  void
+  bindFragmentSamplers(Uint32 first_slot,
+                       std::span<const SDL_GPUTextureSamplerBinding> bindings);
+  void bindFragmentSamplers(
+      Uint32 first_slot,
+      std::initializer_list<SDL_GPUTextureSamplerBinding> bindings) {
+    bindFragmentSamplers(first_slot, std::span(bindings));
+  }
+
+  RenderPassEncoder &pushVertexUniform(Uint32 slot, const void *data,
+                                       Uint32 length);
+  RenderPassEncoder &pushFragmentUniform(Uint32 slot, const void *data,
+                                         Uint32 length);
+
+  /// \sa rend::drawView()
+  void drawView(const MeshView &view, Uint32 numInstances = 1);
+  /// \brief Draw all the views of a Mesh.
+  /// \sa rend::draw()
+  void draw(const Mesh &mesh, Uint32 numInstances = 1);
+  void drawPrimitives(Uint32 numVertices, Uint32 numInstances = 1,
+                      Uint32 firstVertex = 0);
+
+  /// \brief End the render pass, and add its counters to the stats passed
+  /// at construction.
+  void end() noexcept;
+
+  const RenderPassStats &stats() const { return m_stats; }
+
+private:
+  struct UniformCache {
+    Uint32 length = 0;
+    Uint8 data[kMaxCachedUniformSize];
+  };
+  bool updateUniformCache(UniformCache &cache, const void *data,
+                          Uint32 length);
+  void bindBuffers(SDL_GPUBuffer *const *vertex_buffers, Uint32 num_buffers,
+                   SDL_GPUBuffer *index_buffer);
+
+  CommandBuffer *m_cmdBuf;
+  SDL_GPURenderPass *m_pass;
+  RenderPassStats *m_statsSink;
+  RenderPassStats m_stats;
+
+  SDL_GPUGraphicsPipeline *m_pipeline = nullptr;
+  SDL_GPUBufferBinding m_vertexBuffers[kMaxVertexBuffers]{};
+  SDL_GPUBufferBinding m_indexBuffer{};
+  SDL_GPUIndexElementSize m_indexElementSize = SDL_GPU_INDEXELEMENTSIZE_32BIT;
+  SDL_GPUTextureSamplerBinding m_fragmentSamplers[kMaxSamplerSlots]{};
+  UniformCache m_vertexUniforms[kMaxUniformSlots];
+  UniformCache m_fragmentUniforms[kMaxUniformSlots];
+};
+
+} // namespace candlewick
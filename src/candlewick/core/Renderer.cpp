@@ -10,7 +10,7 @@
 namespace candlewick {
 Renderer::Renderer(Device &&device_, Window &&window_)
     : device(std::move(device_)), window(std::move(window_)),
-      swapchain(nullptr) {
+      swapchain(nullptr), swapchainThread(SDL_GetCurrentThreadID()) {
   if (!SDL_ClaimWindowForGPUDevice(device, window))
     throw RAIIException(SDL_GetError());
 }
@@ -21,8 +21,34 @@ Renderer::Renderer(Device &&device_, Window &&window_,
   createDepthTexture(suggested_depth_format);
 }
 
+Renderer::Renderer(Device &&device_, const OffscreenTargetInfo &target,
+                   SDL_GPUTextureFormat suggested_depth_format)
+    : device(std::move(device_)), window(nullptr), swapchain(nullptr) {
+  offscreen_texture = Texture{this->device,
+                              {
+                                  .type = SDL_GPU_TEXTURETYPE_2D,
+                                  .format = target.format,
+                                  .usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET |
+                                           SDL_GPU_TEXTUREUSAGE_SAMPLER,
+                                  .width = target.width,
+                                  .height = target.height,
+                                  .layer_count_or_depth = 1,
+                                  .num_levels = 1,
+                                  .sample_count = SDL_GPU_SAMPLECOUNT_1,
+                                  .props = 0,
+                              },
+                              "Offscreen color target"};
+  createDepthTexture(suggested_depth_format);
+}
+
+std::array<int, 2> Renderer::size() const {
+  if (headless())
+    return {int(offscreen_texture.width()), int(offscreen_texture.height())};
+  return window.size();
+}
+
 void Renderer::createDepthTexture(SDL_GPUTextureFormat suggested_depth_format) {
-  auto [width, height] = window.size();
+  auto [width, height] = size();
 
   SDL_GPUTextureCreateInfo texInfo{
       .type = SDL_GPU_TEXTURETYPE_2D,
@@ -56,13 +82,25 @@ void Renderer::createDepthTexture(SDL_GPUTextureFormat suggested_depth_format) {
 }
 
 bool Renderer::waitAndAcquireSwapchain(CommandBuffer &command_buffer) {
-  assert(SDL_IsMainThread());
+  frameArena.beginFrame();
+  passStats = {};
+  if (headless()) {
+    swapchain = offscreen_texture;
+    return true;
+  }
+  assert(SDL_GetCurrentThreadID() == swapchainThread);
   return SDL_WaitAndAcquireGPUSwapchainTexture(command_buffer, window,
                                                &swapchain, NULL, NULL);
 }
 
 bool Renderer::acquireSwapchain(CommandBuffer &command_buffer) {
-  assert(SDL_IsMainThread());
+  frameArena.beginFrame();
+  passStats = {};
+  if (headless()) {
+    swapchain = offscreen_texture;
+    return true;
+  }
+  assert(SDL_GetCurrentThreadID() == swapchainThread);
   return SDL_AcquireGPUSwapchainTexture(command_buffer, window, &swapchain,
                                         NULL, NULL);
 }
@@ -71,41 +109,39 @@ void Renderer::destroy() noexcept {
   if (device && window) {
     SDL_ReleaseWindowFromGPUDevice(device, window);
   }
+  offscreen_texture.destroy();
+  depth_texture.destroy();
   device.destroy();
   window.destroy();
 }
 
 namespace rend {
-  void bindMesh(SDL_GPURenderPass *pass, const Mesh &mesh) {
-    const Uint32 num_buffers = Uint32(mesh.vertexBuffers.size());
-    std::vector<SDL_GPUBufferBinding> vertex_bindings;
-    vertex_bindings.reserve(num_buffers);
+  // binds whole buffers: draws use the vertex and index offsets
+  static void bindBuffers(SDL_GPURenderPass *pass,
+                          SDL_GPUBuffer *const *vertex_buffers,
+                          Uint32 num_buffers, SDL_GPUBuffer *index_buffer) {
+    SDL_assert(num_buffers <= kMaxVertexBuffers);
+    SDL_GPUBufferBinding vertex_bindings[kMaxVertexBuffers];
     for (Uint32 j = 0; j < num_buffers; j++) {
-      vertex_bindings.push_back(mesh.getVertexBinding(j));
+      vertex_bindings[j] = {vertex_buffers[j], 0u};
     }
 
-    SDL_BindGPUVertexBuffers(pass, 0, vertex_bindings.data(), num_buffers);
-    if (mesh.isIndexed()) {
-      SDL_GPUBufferBinding index_binding = mesh.getIndexBinding();
+    SDL_BindGPUVertexBuffers(pass, 0, vertex_bindings, num_buffers);
+    if (index_buffer) {
+      SDL_GPUBufferBinding index_binding = {index_buffer, 0u};
       SDL_BindGPUIndexBuffer(pass, &index_binding,
                              SDL_GPU_INDEXELEMENTSIZE_32BIT);
     }
   }
 
-  void bindMeshView(SDL_GPURenderPass *pass, const MeshView &meshView) {
-    const Uint32 num_buffers = Uint32(meshView.vertexBuffers.size());
-    std::vector<SDL_GPUBufferBinding> vertex_bindings;
-    vertex_bindings.reserve(num_buffers);
-    for (Uint32 j = 0; j < num_buffers; j++) {
-      vertex_bindings.push_back({meshView.vertexBuffers[j], 0u});
-    }
+  void bindMesh(SDL_GPURenderPass *pass, const Mesh &mesh) {
+    bindBuffers(pass, mesh.vertexBuffers.data(), mesh.numVertexBuffers(),
+                mesh.indexBuffer);
+  }
 
-    SDL_BindGPUVertexBuffers(pass, 0, vertex_bindings.data(), num_buffers);
-    if (meshView.isIndexed()) {
-      SDL_GPUBufferBinding index_binding = {meshView.indexBuffer, 0u};
-      SDL_BindGPUIndexBuffer(pass, &index_binding,
-                             SDL_GPU_INDEXELEMENTSIZE_32BIT);
-    }
+  void bindMeshView(SDL_GPURenderPass *pass, const MeshView &meshView) {
+    bindBuffers(pass, meshView.vertexBuffers, meshView.numVertexBuffers,
+                meshView.indexBuffer);
   }
 
   void drawView(SDL_GPURenderPass *pass, const MeshView &mesh,
@@ -128,8 +164,8 @@ namespace rend {
 
 #ifndef NDEBUG
     const auto ib = meshViews[0].indexBuffer;
-    const auto &vbs = meshViews[0].vertexBuffers;
-    const auto n_vbs = vbs.size();
+    const auto vbs = meshViews[0].vertexBuffers;
+    const auto n_vbs = meshViews[0].numVertexBuffers;
 #endif
     for (auto &view : meshViews) {
 #ifndef NDEBUG
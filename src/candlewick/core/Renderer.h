@@ -2,18 +2,33 @@
 
 #include "Device.h"
 #include "CommandBuffer.h"
+#include "FrameArena.h"
+#include "RenderPassEncoder.h"
 #include "Texture.h"
 #include "Mesh.h"
 #include "Window.h"
 
 #include <span>
 #include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_thread.h>
 
 namespace candlewick {
 
+/// \brief Description of the color texture rendered to by a headless Renderer.
+struct OffscreenTargetInfo {
+  Uint32 width;
+  Uint32 height;
+  SDL_GPUTextureFormat format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+};
+
 /// \brief The Renderer class provides a rendering context for a graphical
 /// application.
 ///
+/// In headless mode, there is no window: the Renderer owns an offscreen color
+/// texture, which is handed out in place of the swapchain texture. This only
+/// requires a GPU device, e.g. a software Vulkan implementation such as
+/// lavapipe, and no video driver.
+///
 /// \sa Scene
 /// \sa Device
 /// \sa Mesh
@@ -22,6 +37,20 @@ struct Renderer {
   Window window;
   SDL_GPUTexture *swapchain;
   Texture depth_texture{NoInit};
+  /// Color target of a headless renderer.
+  Texture offscreen_texture{NoInit};
+  /// \brief Allocator for the transient data of the scenes and passes,
+  /// which moves to the next frame when the swapchain is acquired.
+  ///
+  /// It is mutable so that scenes holding a const Renderer can allocate from
+  /// it.
+  mutable FrameArena frameArena;
+  /// \brief Counters of the RenderPassEncoder objects of the scenes, summed
+  /// over the current frame. Reset when the swapchain is acquired.
+  mutable RenderPassStats passStats;
+  /// \brief Thread which created the renderer and claimed its window for the
+  /// device. Only this thread can acquire the swapchain.
+  SDL_ThreadID swapchainThread = 0;
 
   Renderer(NoInitT) : device(NoInit), window(nullptr), swapchain(nullptr) {}
   /// \brief Constructor without a depth format.
@@ -29,6 +58,10 @@ struct Renderer {
   /// \brief Constructor with a depth format. This will create a depth texture.
   Renderer(Device &&device, Window &&window,
            SDL_GPUTextureFormat suggested_depth_format);
+  /// \brief Headless constructor, rendering to an offscreen texture. This
+  /// will create the color and depth textures.
+  Renderer(Device &&device, const OffscreenTargetInfo &target,
+           SDL_GPUTextureFormat suggested_depth_format);
 
   /// \brief Add a depth texture to the rendering context.
   /// \see hasDepthTexture()
@@ -36,21 +69,39 @@ struct Renderer {
 
   bool initialized() const { return bool(device); }
 
+  /// \brief Whether this renders to an offscreen texture rather than to a
+  /// window.
+  bool headless() const { return offscreen_texture.hasValue(); }
+
+  /// \brief Size of the render target: the window size, or the size of the
+  /// offscreen texture.
+  std::array<int, 2> size() const;
+
   /// Acquire the command buffer, starting a frame.
   CommandBuffer acquireCommandBuffer() const { return CommandBuffer(device); }
 
-  /// \brief Wait until swapchain is available, then acquire it.
+  /// \brief Wait until swapchain is available, then acquire it. In headless
+  /// mode, this sets the offscreen texture as the swapchain.
+  ///
+  /// This starts a new frame of the frame arena, and resets passStats.
+  /// \warning This can only be called from #swapchainThread.
   /// \sa acquireSwapchain()
   bool waitAndAcquireSwapchain(CommandBuffer &command_buffer);
 
-  /// \brief Acquire GPU swapchain.
-  /// \warning This can only be called from the main thread (see SDL docs for
-  /// the meaning of "main thread").
+  /// \brief Acquire GPU swapchain. This starts a new frame of the frame
+  /// arena, and resets passStats.
+  /// \warning This can only be called from #swapchainThread, the thread which
+  /// created the renderer. This is the main thread, unless the renderer was
+  /// created by a render thread (as done by the asynchronous Visualizer).
   bool acquireSwapchain(CommandBuffer &command_buffer);
 
-  bool waitForSwapchain() { return SDL_WaitForGPUSwapchain(device, window); }
+  bool waitForSwapchain() {
+    return headless() || SDL_WaitForGPUSwapchain(device, window);
+  }
 
   SDL_GPUTextureFormat getSwapchainTextureFormat() const {
+    if (headless())
+      return offscreen_texture.format();
     return SDL_GetGPUSwapchainTextureFormat(device, window);
   }
 
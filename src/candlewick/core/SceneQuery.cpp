@@ -0,0 +1,371 @@
+#include "SceneQuery.h"
+#include "Camera.h"
+#include "Components.h"
+
+#include <entt/entity/registry.hpp>
+
+namespace candlewick {
+
+Ray cameraRay(const Camera &camera, const Float2 &ndc) {
+  const Mat4f invViewProj = camera.viewProj().inverse();
+  // depth range of the projections of Camera.h is [-1, 1]
+  const Float4 near_point = invViewProj * Float4{ndc.x(), ndc.y(), -1.f, 1.f};
+  const Float4 far_point = invViewProj * Float4{ndc.x(), ndc.y(), 1.f, 1.f};
+  const Float3 origin = near_point.head<3>() / near_point.w();
+  const Float3 target = far_point.head<3>() / far_point.w();
+  return {origin, (target - origin).normalized()};
+}
+
+FrustumPlanes cameraRectFrustum(const Camera &camera, const Float2 &ndcMin,
+                                const Float2 &ndcMax) {
+  // map the rectangle to the whole clip space
+  const Float2 size = ndcMax - ndcMin;
+  const Float2 center = ndcMax + ndcMin;
+  Mat4f rect = Mat4f::Identity();
+  rect(0, 0) = 2.f / size.x();
+  rect(1, 1) = 2.f / size.y();
+  rect(0, 3) = -center.x() / size.x();
+  rect(1, 3) = -center.y() / size.y();
+  return FrustumPlanes::fromViewProj(rect * camera.viewProj());
+}
+
+static float surfaceArea(const BvhNode &node) {
+  const Float3 d = (node.upper - node.lower).cwiseMax(0.f);
+  return 2.f * (d.x() * d.y() + d.y() * d.z() + d.z() * d.x());
+}
+
+void SceneQuery::update(const entt::registry &registry) {
+  auto view =
+      registry.view<const TransformComponent, const LocalBoundsComponent>(
+          entt::exclude<Disable>);
+
+  bool rebuild_needed = !m_valid;
+  size_t count = 0;
+  m_stats.movedEntities = 0;
+  for (auto [ent, tr, bounds] : view.each()) {
+    const bool added = count == m_objects.size();
+    if (added)
+      m_objects.emplace_back();
+    Object &obj = m_objects[count];
+    const bool replaced = obj.entity != ent;
+    rebuild_needed |= added || replaced;
+    obj.entity = ent;
+
+    auto *picking = registry.try_get<PickingMeshComponent>(ent);
+    if (!picking)
+      obj.mesh.reset();
+    else if (obj.mesh != picking->bvh)
+      obj.mesh = picking->bvh;
+
+    const bool moved = added || replaced || obj.transform != tr ||
+                       obj.localBounds.center != bounds.center ||
+                       obj.localBounds.halfExtents != bounds.halfExtents;
+    if (moved) {
+      obj.transform = tr;
+      obj.localBounds = bounds;
+      const BoundingBox world = bounds.transformed(tr);
+      obj.lower = world.center - world.halfExtents;
+      obj.upper = world.center + world.halfExtents;
+      m_stats.movedEntities++;
+      if (!rebuild_needed)
+        m_dirty[m_leafOf[count]] = 1;
+    }
+    count++;
+  }
+  if (count != m_objects.size()) {
+    m_objects.resize(count);
+    rebuild_needed = true;
+  }
+
+  if (rebuild_needed)
+    rebuild();
+  else if (m_stats.movedEntities > 0)
+    refit();
+}
+
+void SceneQuery::rebuild() {
+  const size_t count = m_objects.size();
+  m_lowers.resize(count);
+  m_uppers.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    m_lowers[i] = m_objects[i].lower;
+    m_uppers[i] = m_objects[i].upper;
+  }
+  buildBvh(m_lowers, m_uppers, kMaxLeafSize, m_nodes, m_order, &m_parents);
+
+  m_leafOf.resize(count);
+  m_builtArea = 0.f;
+  for (Uint32 n = 0; n < m_nodes.size(); n++) {
+    const BvhNode &node = m_nodes[n];
+    m_builtArea += surfaceArea(node);
+    for (Uint32 i = node.first; i < node.first + node.count; i++)
+      m_leafOf[m_order[i]] = n;
+  }
+  m_dirty.assign(m_nodes.size(), 0);
+  m_valid = true;
+  m_stats.rebuilds++;
+}
+
+void SceneQuery::refit() {
+  // children are stored after their parents: a reverse sweep updates them
+  // first
+  float area = 0.f;
+  for (Uint32 n = Uint32(m_nodes.size()); n-- > 0;) {
+    BvhNode &node = m_nodes[n];
+    if (m_dirty[n]) {
+      m_dirty[n] = 0;
+      if (node.isLeaf()) {
+        const Object &first = m_objects[m_order[node.first]];
+        node.lower = first.lower;
+        node.upper = first.upper;
+        for (Uint32 i = node.first + 1; i < node.first + node.count; i++) {
+          const Object &obj = m_objects[m_order[i]];
+          node.lower = node.lower.cwiseMin(obj.lower);
+          node.upper = node.upper.cwiseMax(obj.upper);
+        }
+      } else {
+        const BvhNode &left = m_nodes[node.first];
+        const BvhNode &right = m_nodes[node.first + 1];
+        node.lower = left.lower.cwiseMin(right.lower);
+        node.upper = left.upper.cwiseMax(right.upper);
+      }
+      if (n > 0)
+        m_dirty[m_parents[n]] = 1;
+    }
+    area += surfaceArea(node);
+  }
+  m_stats.refits++;
+
+  // the topology no longer fits the motion of the entities
+  if (area > 2.f * m_builtArea)
+    rebuild();
+}
+
+using detail::BvhStackEntry;
+using detail::kBvhStackSize;
+
+bool SceneQuery::raycastObject(const Object &object, const Ray &ray,
+                               float maxDistance, RayHit &hit) const {
+  const Eigen::Affine3f M{object.transform};
+  const Eigen::Affine3f inv = M.inverse(Eigen::Affine);
+  // keep the direction unnormalized, so that distances are the same in both
+  // frames
+  const Ray local{inv * ray.origin, inv.linear() * ray.direction};
+
+  Float3 local_normal;
+  float t;
+  if (object.mesh && !object.mesh->empty()) {
+    TriangleHit triangle_hit;
+    if (!object.mesh->raycast(local, maxDistance, triangle_hit))
+      return false;
+    t = triangle_hit.distance;
+    local_normal = triangle_hit.normal;
+  } else {
+    const BoundingBox &box = object.localBounds;
+    t = intersectRayBox(local.origin, rayInverseDirection(local.direction),
+                        box.center - box.halfExtents,
+                        box.center + box.halfExtents, maxDistance);
+    if (t < 0.f)
+      return false;
+    // normal of the face the hit is on
+    const Float3 rel = (local.at(t) - box.center)
+                           .cwiseQuotient(box.halfExtents.cwiseMax(1e-12f));
+    Eigen::Index axis;
+    rel.cwiseAbs().maxCoeff(&axis);
+    local_normal = Float3::Unit(axis) * (rel[axis] < 0.f ? -1.f : 1.f);
+  }
+
+  hit.entity = object.entity;
+  hit.distance = t;
+  hit.point = ray.at(t);
+  hit.normal = (inv.linear().transpose() * local_normal).normalized();
+  if (hit.normal.dot(ray.direction) > 0.f)
+    hit.normal = -hit.normal;
+  return true;
+}
+
+std::optional<SceneQuery::RayHit> SceneQuery::raycast(const Ray &ray,
+                                                      float maxDistance) const {
+  if (m_nodes.empty())
+    return std::nullopt;
+  const Float3 invDir = rayInverseDirection(ray.direction);
+  std::optional<RayHit> result;
+  float best = maxDistance;
+
+  BvhStackEntry stack[kBvhStackSize];
+  Uint32 top = 0;
+  const float t_root = intersectRayBox(ray.origin, invDir, m_nodes[0].lower,
+                                       m_nodes[0].upper, best);
+  if (t_root >= 0.f)
+    stack[top++] = {0, t_root};
+
+  while (top > 0) {
+    const BvhStackEntry entry = stack[--top];
+    if (entry.distance > best)
+      continue;
+    const BvhNode &node = m_nodes[entry.node];
+    if (node.isLeaf()) {
+      for (Uint32 i = node.first; i < node.first + node.count; i++) {
+        const Object &obj = m_objects[m_order[i]];
+        if (intersectRayBox(ray.origin, invDir, obj.lower, obj.upper, best) <
+            0.f)
+          continue;
+        RayHit hit;
+        if (raycastObject(obj, ray, best, hit)) {
+          best = hit.distance;
+          result = hit;
+        }
+      }
+      continue;
+    }
+
+    const BvhNode &left = m_nodes[node.first];
+    const BvhNode &right = m_nodes[node.first + 1];
+    BvhStackEntry nearer{
+        node.first,
+        intersectRayBox(ray.origin, invDir, left.lower, left.upper, best)};
+    BvhStackEntry farther{
+        node.first + 1,
+        intersectRayBox(ray.origin, invDir, right.lower, right.upper, best)};
+    if (farther.distance >= 0.f &&
+        (nearer.distance < 0.f || farther.distance < nearer.distance))
+      std::swap(nearer, farther);
+    if (farther.distance >= 0.f)
+      stack[top++] = farther;
+    if (nearer.distance >= 0.f)
+      stack[top++] = nearer;
+  }
+  return result;
+}
+
+void SceneQuery::queryFrustum(const FrustumPlanes &frustum,
+                              std::vector<entt::entity> &entities) const {
+  auto to_box = [](const Float3 &lower, const Float3 &upper) {
+    return BoundingBox{0.5f * (lower + upper), 0.5f * (upper - lower)};
+  };
+  if (m_nodes.empty())
+    return;
+  Uint32 stack[kBvhStackSize];
+  Uint32 top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    const BvhNode &node = m_nodes[stack[--top]];
+    if (!frustum.intersects(to_box(node.lower, node.upper)))
+      continue;
+    if (node.isLeaf()) {
+      for (Uint32 i = node.first; i < node.first + node.count; i++) {
+        const Object &obj = m_objects[m_order[i]];
+        if (frustum.intersects(to_box(obj.lower, obj.upper)))
+          entities.push_back(obj.entity);
+      }
+      continue;
+    }
+    stack[top++] = node.first + 1;
+    stack[top++] = node.first;
+  }
+}
+
+void SceneQuery::queryBox(const BoundingBox &box,
+                          std::vector<entt::entity> &entities) const {
+  const Float3 lower = box.center - box.halfExtents;
+  const Float3 upper = box.center + box.halfExtents;
+  auto overlaps = [&](const Float3 &l, const Float3 &u) {
+    return (l.array() <= upper.array()).all() &&
+           (lower.array() <= u.array()).all();
+  };
+  if (m_nodes.empty())
+    return;
+  Uint32 stack[kBvhStackSize];
+  Uint32 top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    const BvhNode &node = m_nodes[stack[--top]];
+    if (!overlaps(node.lower, node.upper))
+      continue;
+    if (node.isLeaf()) {
+      for (Uint32 i = node.first; i < node.first + node.count; i++) {
+        const Object &obj = m_objects[m_order[i]];
+        if (overlaps(obj.lower, obj.upper))
+          entities.push_back(obj.entity);
+      }
+      continue;
+    }
+    stack[top++] = node.first + 1;
+    stack[top++] = node.first;
+  }
+}
+
+bool SceneQuery::nearestOnObject(const Object &object, const Float3 &point,
+                                 float &maxDistSq, Float3 &closest) const {
+  const Eigen::Affine3f M{object.transform};
+  const Eigen::Affine3f inv = M.inverse(Eigen::Affine);
+  const Float3 local_point = inv * point;
+
+  Float3 local_closest;
+  if (object.mesh && !object.mesh->empty()) {
+    // world distances are at least the local ones times the smallest scale,
+    // which bounds the local search
+    const float min_scale = M.linear().colwise().norm().minCoeff();
+    float local_max_sq =
+        min_scale > 0.f ? maxDistSq / (min_scale * min_scale) : kInfinity;
+    if (!object.mesh->closestPoint(local_point, local_max_sq, local_closest))
+      return false;
+  } else {
+    const BoundingBox &box = object.localBounds;
+    local_closest = local_point.cwiseMax(box.center - box.halfExtents)
+                        .cwiseMin(box.center + box.halfExtents);
+  }
+
+  const Float3 world_closest = M * local_closest;
+  const float dist_sq = (world_closest - point).squaredNorm();
+  if (dist_sq >= maxDistSq)
+    return false;
+  maxDistSq = dist_sq;
+  closest = world_closest;
+  return true;
+}
+
+std::optional<SceneQuery::NearestHit>
+SceneQuery::nearest(const Float3 &point, float maxDistance) const {
+  if (m_nodes.empty())
+    return std::nullopt;
+  std::optional<NearestHit> result;
+  float best_sq = maxDistance * maxDistance;
+
+  BvhStackEntry stack[kBvhStackSize];
+  Uint32 top = 0;
+  stack[top++] = {0, boxDistanceSq(point, m_nodes[0].lower, m_nodes[0].upper)};
+  while (top > 0) {
+    const BvhStackEntry entry = stack[--top];
+    if (entry.distance >= best_sq)
+      continue;
+    const BvhNode &node = m_nodes[entry.node];
+    if (node.isLeaf()) {
+      for (Uint32 i = node.first; i < node.first + node.count; i++) {
+        const Object &obj = m_objects[m_order[i]];
+        if (boxDistanceSq(point, obj.lower, obj.upper) >= best_sq)
+          continue;
+        Float3 closest;
+        if (nearestOnObject(obj, point, best_sq, closest))
+          result = NearestHit{obj.entity, std::sqrt(best_sq), closest};
+      }
+      continue;
+    }
+
+    const BvhNode &left = m_nodes[node.first];
+    const BvhNode &right = m_nodes[node.first + 1];
+    BvhStackEntry nearer{node.first,
+                         boxDistanceSq(point, left.lower, left.upper)};
+    BvhStackEntry farther{node.first + 1,
+                          boxDistanceSq(point, right.lower, right.upper)};
+    if (farther.distance < nearer.distance)
+      std::swap(nearer, farther);
+    if (farther.distance < best_sq)
+      stack[top++] = farther;
+    if (nearer.distance < best_sq)
+      stack[top++] = nearer;
+  }
+  return result;
+}
+
+} // namespace candlewick
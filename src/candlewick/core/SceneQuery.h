@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Core.h"
+#include "Bvh.h"
+#include "Culling.h"
+
+#include <entt/entity/fwd.hpp>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace candlewick {
+
+/// \brief World-space ray through the point \p ndc of the image of \p camera,
+/// in normalized device coordinates (\f$[-1, 1]^2\f$, y up), starting on the
+/// near plane. The direction is normalized.
+Ray cameraRay(const Camera &camera, const Float2 &ndc);
+
+/// \brief Frustum of the rectangle from \p ndcMin to \p ndcMax of the image
+/// of \p camera, in normalized device coordinates, e.g. for box selection.
+FrustumPlanes cameraRectFrustum(const Camera &camera, const Float2 &ndcMin,
+                                const Float2 &ndcMax);
+
+/// \brief CPU scene queries over the entities of a registry: ray casts, for
+/// picking and hovering, frustum and box overlaps, and nearest entity.
+///
+/// The queried entities are those with a TransformComponent and a
+/// LocalBoundsComponent, without Disable. update() builds a BVH over their
+/// world-space bounding boxes. As long as the set of entities does not
+/// change, later updates refit the BVH: only the boxes of the moved entities,
+/// and their ancestors, are recomputed. The BVH is rebuilt when the set
+/// changes, or when the refits made its nodes much larger than at build time.
+///
+/// Hits on the boxes are refined against the PickingMeshComponent of the
+/// entities, in their local frame. Entities without one are hit on their
+/// local bounding box. No GPU work is involved: queries never wait for a
+/// frame.
+///
+/// The results refer to the state of the last update(). Queries are const,
+/// and can run concurrently with each other.
+class SceneQuery {
+public:
+  static constexpr Uint32 kMaxLeafSize = 2;
+  static constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+  struct RayHit {
+    entt::entity entity;
+    /// Distance along the ray, in units of its direction's norm.
+    float distance;
+    Float3 point;
+    /// Unit world-space normal at the hit, facing the ray origin.
+    Float3 normal;
+  };
+
+  struct NearestHit {
+    entt::entity entity;
+    float distance;
+    /// Closest point of the entity.
+    Float3 point;
+  };
+
+  struct Stats {
+    Uint32 rebuilds = 0;
+    Uint32 refits = 0;
+    /// Entities which moved at the last update().
+    Uint32 movedEntities = 0;
+  };
+
+  /// \brief Update the BVH from the current state of \p registry.
+  void update(const entt::registry &registry);
+  /// \brief Rebuild the BVH at the next update().
+  void invalidate() { m_valid = false; }
+
+  /// \brief Number of entities in the BVH.
+  size_t size() const { return m_objects.size(); }
+  const Stats &stats() const { return m_stats; }
+
+  /// \brief Closest entity hit by \p ray, before distance \p maxDistance.
+  std::optional<RayHit> raycast(const Ray &ray,
+                                float maxDistance = kInfinity) const;
+
+  /// \brief Append the entities whose world bounding box intersects
+  /// \p frustum to \p entities. The test is conservative, see
+  /// FrustumPlanes::intersects().
+  void queryFrustum(const FrustumPlanes &frustum,
+                    std::vector<entt::entity> &entities) const;
+  /// \brief Append the entities whose world bounding box overlaps \p box to
+  /// \p entities.
+  void queryBox(const BoundingBox &box,
+                std::vector<entt::entity> &entities) const;
+
+  /// \brief Entity closest to \p point, within \p maxDistance.
+  ///
+  /// Distances to picking meshes are exact for rigid and uniformly scaled
+  /// transforms, and approximate for other scalings.
+  std::optional<NearestHit> nearest(const Float3 &point,
+                                    float maxDistance = kInfinity) const;
+
+private:
+  struct Object {
+    entt::entity entity;
+    Mat4f transform;
+    BoundingBox localBounds;
+    // world-space bounding box
+    Float3 lower;
+    Float3 upper;
+    std::shared_ptr<const TriangleBvh> mesh;
+  };
+
+  void rebuild();
+  void refit();
+  bool raycastObject(const Object &object, const Ray &ray, float maxDistance,
+                     RayHit &hit) const;
+  bool nearestOnObject(const Object &object, const Float3 &point,
+                       float &maxDistSq, Float3 &closest) const;
+
+  std::vector<Object> m_objects;
+  std::vector<BvhNode> m_nodes;
+  // objects, in the order of the leaves
+  std::vector<Uint32> m_order;
+  std::vector<Uint32> m_parents;
+  // leaf of each object
+  std::vector<Uint32> m_leafOf;
+  std::vector<Uint8> m_dirty;
+  std::vector<Float3> m_lowers;
+  std::vector<Float3> m_uppers;
+  // summed surface areas of the nodes after the last build
+  float m_builtArea = 0.f;
+  bool m_valid = false;
+  Stats m_stats;
+};
+
+} // namespace candlewick
@@ -0,0 +1,31 @@
+#include "TransformBatch.h"
+
+namespace candlewick {
+
+void TransformBatch::resize(Eigen::Index count) {
+  // identity placements
+  Eigen::Matrix<double, 12, 1> identity;
+  identity << 1., 0., 0., 0., 1., 0., 0., 0., 1., 0., 0., 0.;
+  m_placements = identity.replicate(1, count);
+  m_transforms = m_placements.cast<float>();
+  m_isChanged.assign(size_t(count), 0);
+  m_changed.clear();
+  m_changed.reserve(size_t(count));
+  m_updated.reserve(size_t(count));
+  invalidate();
+}
+
+void TransformBatch::invalidate() {
+  for (Eigen::Index i = 0; i < size(); i++)
+    markChanged(i);
+}
+
+std::span<const Uint32> TransformBatch::update() {
+  for (Uint32 i : m_changed)
+    m_isChanged[i] = 0;
+  m_updated.swap(m_changed);
+  m_changed.clear();
+  return m_updated;
+}
+
+} // namespace candlewick
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "math_types.h"
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace candlewick {
+
+/// \brief Batched conversion of double-precision rigid placements (e.g. the
+/// geometry placements of a pinocchio::GeometryData) to the float transforms
+/// used for rendering.
+///
+/// Placements are stored as structures of arrays: one column of 12
+/// coefficients per object, the 3x4 matrix \f$[R | p]\f$ in column-major
+/// order, both in double precision (as last set) and in single precision.
+/// Placements are compared bitwise with the previous ones, and only those
+/// which changed are converted.
+class TransformBatch {
+public:
+  using Placements = Eigen::Matrix<double, 12, Eigen::Dynamic>;
+  using Transforms = Eigen::Matrix<float, 12, Eigen::Dynamic>;
+
+  Eigen::Index size() const { return m_placements.cols(); }
+
+  /// \brief Resize the batch, with identity placements. All objects are
+  /// marked as changed.
+  void resize(Eigen::Index count);
+
+  /// \brief Mark all objects as changed, e.g. after their transforms were
+  /// overwritten by other means.
+  void invalidate();
+
+  /// \brief Set the placement of object \p i. If it differs from the
+  /// previous one, it is converted and marked as changed.
+  void setPlacement(Eigen::Index i, const Eigen::Matrix3d &R,
+                    const Eigen::Vector3d &p) {
+    double *col = m_placements.col(i).data();
+    // unchanged placements are copies of the previous ones: comparing bits
+    // is enough
+    if (std::memcmp(col, R.data(), 9 * sizeof(double)) == 0 &&
+        std::memcmp(col + 9, p.data(), 3 * sizeof(double)) == 0)
+      return;
+    std::memcpy(col, R.data(), 9 * sizeof(double));
+    std::memcpy(col + 9, p.data(), 3 * sizeof(double));
+    // fixed-size casts, vectorized; reading the source rather than the copy
+    // avoids store-to-load forwarding stalls
+    float *out = m_transforms.col(i).data();
+    Eigen::Map<Eigen::Matrix<float, 9, 1>>{out} =
+        Eigen::Map<const Eigen::Matrix<double, 9, 1>>{R.data()}.cast<float>();
+    Eigen::Map<Float3>{out + 9} = p.cast<float>();
+    markChanged(i);
+  }
+
+  /// \brief Reset the change tracking.
+  /// \returns Indices of the objects which changed since the last call,
+  /// valid until the next call.
+  std::span<const Uint32> update();
+
+  /// \brief Single-precision placements, one column per object.
+  const Transforms &transforms() const { return m_transforms; }
+
+  /// \brief Homogeneous transformation matrix of object \p i, as of the last
+  /// update().
+  Mat4f matrix(Eigen::Index i) const {
+    Mat4f M;
+    M.topRows<3>() =
+        Eigen::Map<const Eigen::Matrix<float, 3, 4>>(m_transforms.col(i).data());
+    M.row(3) << 0.f, 0.f, 0.f, 1.f;
+    return M;
+  }
+
+private:
+  void markChanged(Eigen::Index i) {
+    if (!m_isChanged[size_t(i)]) {
+      m_isChanged[size_t(i)] = 1;
+      m_changed.push_back(Uint32(i));
+    }
+  }
+
+  Placements m_placements;
+  Transforms m_transforms;
+  std::vector<Uint8> m_isChanged;
+  // changed since the last update(), and changed at the last update()
+  std::vector<Uint32> m_changed;
+  std::vector<Uint32> m_updated;
+};
+
+} // namespace candlewick
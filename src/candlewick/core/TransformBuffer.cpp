@@ -0,0 +1,98 @@
+#include "TransformBuffer.h"
+#include "CommandBuffer.h"
+#include "Device.h"
+#include "errors.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace candlewick {
+
+TransformBuffer::TransformBuffer(const Device &device, Uint32 capacity)
+    : _device(device) {
+  allocate(std::max(capacity, 1u));
+}
+
+TransformBuffer::TransformBuffer(TransformBuffer &&other) noexcept
+    : _device(std::exchange(other._device, nullptr)),
+      m_buffer(std::exchange(other.m_buffer, nullptr)),
+      m_transferBuffer(std::exchange(other.m_transferBuffer, nullptr)),
+      m_capacity(std::exchange(other.m_capacity, 0u)),
+      m_data(std::move(other.m_data)) {}
+
+TransformBuffer &TransformBuffer::operator=(TransformBuffer &&other) noexcept {
+  if (this == &other)
+    return *this;
+  this->release();
+  _device = std::exchange(other._device, nullptr);
+  m_buffer = std::exchange(other.m_buffer, nullptr);
+  m_transferBuffer = std::exchange(other.m_transferBuffer, nullptr);
+  m_capacity = std::exchange(other.m_capacity, 0u);
+  m_data = std::move(other.m_data);
+  return *this;
+}
+
+void TransformBuffer::allocate(Uint32 capacity) {
+  // released buffers are only destroyed once the frames using them complete
+  if (m_buffer)
+    SDL_ReleaseGPUBuffer(_device, m_buffer);
+  if (m_transferBuffer)
+    SDL_ReleaseGPUTransferBuffer(_device, m_transferBuffer);
+
+  const Uint32 size = capacity * Uint32(sizeof(ObjectTransformData));
+  SDL_GPUBufferCreateInfo buffer_ci{
+      .usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ,
+      .size = size,
+      .props = 0,
+  };
+  m_buffer = SDL_CreateGPUBuffer(_device, &buffer_ci);
+  SDL_GPUTransferBufferCreateInfo tb_ci{
+      .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+      .size = size,
+      .props = 0,
+  };
+  m_transferBuffer = SDL_CreateGPUTransferBuffer(_device, &tb_ci);
+  if (!m_buffer || !m_transferBuffer) {
+    this->release();
+    throw RAIIException(SDL_GetError());
+  }
+  SDL_SetGPUBufferName(_device, m_buffer, "Object transforms");
+  m_capacity = capacity;
+  m_data.reserve(capacity);
+}
+
+void TransformBuffer::upload(CommandBuffer &command_buffer) {
+  if (m_data.empty())
+    return;
+  if (size() > m_capacity)
+    allocate(std::max(size(), 2 * m_capacity));
+
+  const Uint32 payload_size = size() * Uint32(sizeof(ObjectTransformData));
+  // cycling: the transfer buffer and storage buffer of previous frames may
+  // still be in use
+  void *data = SDL_MapGPUTransferBuffer(_device, m_transferBuffer, true);
+  SDL_memcpy(data, m_data.data(), payload_size);
+  SDL_UnmapGPUTransferBuffer(_device, m_transferBuffer);
+
+  SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(command_buffer);
+  SDL_GPUTransferBufferLocation src{.transfer_buffer = m_transferBuffer,
+                                    .offset = 0};
+  SDL_GPUBufferRegion dst{.buffer = m_buffer, .offset = 0, .size = payload_size};
+  SDL_UploadToGPUBuffer(copy_pass, &src, &dst, true);
+  SDL_EndGPUCopyPass(copy_pass);
+}
+
+void TransformBuffer::release() noexcept {
+  if (!_device)
+    return;
+  if (m_buffer)
+    SDL_ReleaseGPUBuffer(_device, m_buffer);
+  if (m_transferBuffer)
+    SDL_ReleaseGPUTransferBuffer(_device, m_transferBuffer);
+  m_buffer = nullptr;
+  m_transferBuffer = nullptr;
+  m_capacity = 0;
+  _device = nullptr;
+}
+
+} // namespace candlewick
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Core.h"
+#include "Tags.h"
+#include "TransformUniforms.h"
+#include <Eigen/LU>
+#include <SDL3/SDL_gpu.h>
+#include <vector>
+
+namespace candlewick {
+
+/// \brief GPU storage buffer holding the transforms of all objects drawn in a
+/// frame, read by vertex shaders.
+///
+/// Transforms are appended on the CPU, then uploaded once per frame, before
+/// the first render pass, through a cycled transfer buffer: the frames in
+/// flight keep reading their own copy. Draw calls then only pass the index of
+/// their object, and the view and projection matrices are set once per pass.
+///
+/// Matching GLSL declarations are in `object_transforms.glsl`.
+class TransformBuffer {
+public:
+  TransformBuffer(NoInitT) {}
+  /// \param capacity Initial number of objects. The buffers grow as needed.
+  TransformBuffer(const Device &device, Uint32 capacity = 256);
+  TransformBuffer(const TransformBuffer &) = delete;
+  TransformBuffer &operator=(const TransformBuffer &) = delete;
+  TransformBuffer(TransformBuffer &&other) noexcept;
+  TransformBuffer &operator=(TransformBuffer &&other) noexcept;
+
+  bool initialized() const { return _device != nullptr; }
+  operator SDL_GPUBuffer *() const noexcept { return m_buffer; }
+  Uint32 size() const { return Uint32(m_data.size()); }
+  Uint32 capacity() const { return m_capacity; }
+
+  /// \brief Remove all transforms, e.g. at the start of a frame.
+  void clear() { m_data.clear(); }
+
+  /// \brief Append the transform of an object.
+  /// \param rigid Whether \p model is a rigid transformation, in which case
+  /// its normal matrix is its rotation part.
+  /// \param tint Color blended over the materials of the object, see
+  /// HighlightComponent.
+  /// \returns The index of the object in the buffer.
+  Uint32 push(const Mat4f &model, bool rigid,
+              const Float4 &tint = Float4::Zero()) {
+    m_data.push_back({
+        .model = model,
+        .normalMatrix = rigid ? math::computeRigidNormalMatrix(model)
+                              : math::computeNormalMatrix(model),
+        .tint = tint,
+    });
+    return Uint32(m_data.size() - 1);
+  }
+
+  /// \brief Record the upload of the transforms in a copy pass. Must be
+  /// called outside of any render pass, before the draws using them.
+  void upload(CommandBuffer &command_buffer);
+
+  /// \brief Bind the buffer to vertex storage buffer slot \p slot.
+  void bind(SDL_GPURenderPass *render_pass, Uint32 slot = 0) const {
+    SDL_BindGPUVertexStorageBuffers(render_pass, slot, &m_buffer, 1);
+  }
+
+  void release() noexcept;
+  ~TransformBuffer() noexcept { this->release(); }
+
+private:
+  void allocate(Uint32 capacity);
+
+  SDL_GPUDevice *_device = nullptr;
+  SDL_GPUBuffer *m_buffer = nullptr;
+  SDL_GPUTransferBuffer *m_transferBuffer = nullptr;
+  Uint32 m_capacity = 0;
+  std::vector<ObjectTransformData> m_data;
+};
+
+} // namespace candlewick
@@ -10,4 +10,16 @@ struct alignas(16) TransformUniformData {
   alignas(16) GpuMat3 normalMatrix;
 };
 
+/// \brief Transform of an object in a TransformBuffer, matching the
+/// `ObjectTransform` struct of `object_transforms.glsl` (std430 layout).
+struct alignas(16) ObjectTransformData {
+  GpuMat4 model;
+  /// World-space normal matrix.
+  alignas(16) GpuMat3 normalMatrix;
+  /// Color blended over the materials of the object, weighted by its alpha
+  /// component. Zero for no tint.
+  GpuVec4 tint;
+};
+static_assert(sizeof(ObjectTransformData) == 128);
+
 } // namespace candlewick
@@ -0,0 +1,54 @@
+#include "Contacts.h"
+
+#include <algorithm>
+
+namespace candlewick {
+
+void drawContacts(DebugDrawList &list, std::span<const ContactRecord> contacts,
+                  const ContactDrawStyle &style) {
+  for (const ContactRecord &contact : contacts) {
+    const float magnitude = contact.force.norm();
+    const float t = style.maxForce > 0.f ? magnitude / style.maxForce : 0.f;
+    const Float4 color = debugColorMap(t);
+    if (style.showPoints) {
+      const float radius =
+          style.minPointRadius +
+          std::min(t, 1.f) * (style.maxPointRadius - style.minPointRadius);
+      list.sphere(contact.point, radius, color);
+    }
+    if (style.showNormals) {
+      list.line(contact.point,
+                contact.point + style.normalLength * contact.normal,
+                style.normalColor);
+    }
+    if (style.showForces) {
+      // arrows of zero-length forces are skipped by the list
+      list.arrow(contact.point,
+                 contact.point + style.forceScale * contact.force, color,
+                 style.arrowRadius);
+    }
+  }
+}
+
+void ContactDebugSystem::setContacts(std::span<const ContactRecord> contacts) {
+  std::lock_guard lock{m_mutex};
+  m_pending.assign(contacts.begin(), contacts.end());
+  m_hasPending = true;
+}
+
+void ContactDebugSystem::update(DebugScene &scene) {
+  {
+    std::lock_guard lock{m_mutex};
+    if (m_hasPending) {
+      // keep both capacities
+      m_contacts.swap(m_pending);
+      m_hasPending = false;
+    }
+  }
+  if (m_contacts.empty())
+    return;
+  scene.drawImmediate(
+      [&](DebugDrawList &list) { drawContacts(list, m_contacts, style); });
+}
+
+} // namespace candlewick
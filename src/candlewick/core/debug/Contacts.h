@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../DebugScene.h"
+
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace candlewick {
+
+/// \brief A contact, as reported by a simulator, in the world frame.
+struct ContactRecord {
+  Float3 point;
+  /// Unit contact normal.
+  Float3 normal;
+  /// Contact force, in newtons.
+  Float3 force;
+};
+
+/// \brief Appearance of the contacts drawn by drawContacts().
+struct ContactDrawStyle {
+  bool showPoints = true;
+  bool showNormals = true;
+  bool showForces = true;
+  /// Radius of the contact spheres, for zero and maximal forces.
+  float minPointRadius = 0.004f;
+  float maxPointRadius = 0.012f;
+  float normalLength = 0.05f;
+  Float4 normalColor = 0xFFFFFFff_rgbaf;
+  /// Length of the force arrows per newton, in meters.
+  float forceScale = 0.002f;
+  float arrowRadius = 0.002f;
+  /// Force magnitude mapped to the end of the colormap, and to the largest
+  /// contact spheres.
+  float maxForce = 100.f;
+};
+
+/// \brief Draw contacts as spheres, normal lines and force arrows, colored
+/// and scaled by the force magnitude (see debugColorMap()).
+void drawContacts(DebugDrawList &list, std::span<const ContactRecord> contacts,
+                  const ContactDrawStyle &style = {});
+
+/// \brief A debug subsystem drawing the contacts of a simulation step.
+///
+/// Contacts are drawn as immediate-mode primitives of the DebugScene, i.e.
+/// as instances of shared meshes: the cost of a step only depends on its
+/// number of contacts, and no entity is created. setContacts() may be called
+/// from any thread; the contacts are drawn from the next
+/// DebugScene::update() on, until they are replaced.
+class ContactDebugSystem final : public IDebugSubSystem {
+public:
+  ContactDrawStyle style;
+
+  explicit ContactDebugSystem(const ContactDrawStyle &style = {})
+      : style(style) {}
+
+  /// \brief Replace the contacts to draw. The records are copied.
+  void setContacts(std::span<const ContactRecord> contacts);
+  void clearContacts() { setContacts({}); }
+
+  void update(DebugScene &scene) override;
+
+private:
+  std::mutex m_mutex;
+  // written by setContacts(), swapped in by update()
+  std::vector<ContactRecord> m_pending;
+  bool m_hasPending = false;
+  std::vector<ContactRecord> m_contacts;
+};
+
+} // namespace candlewick
@@ -168,5 +168,11 @@ namespace math {
   inline Mat3f computeNormalMatrix(const Mat4f &M) {
     return M.topLeftCorner<3, 3>().inverse().transpose();
   }
+
+  /// \brief Normal matrix of a rigid transformation \p M, whose linear part
+  /// is a rotation and thus its own inverse transpose.
+  inline Mat3f computeRigidNormalMatrix(const Mat4f &M) {
+    return M.topLeftCorner<3, 3>();
+  }
 } // namespace math
 } // namespace candlewick
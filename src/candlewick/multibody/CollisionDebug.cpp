@@ -0,0 +1,85 @@
+#include "CollisionDebug.h"
+#include "RobotScene.h"
+
+#include <pinocchio/multibody/geometry.hpp>
+
+#include <cmath>
+
+namespace candlewick::multibody {
+
+Uint32 drawCollisionResults(DebugDrawList &list,
+                            const pin::GeometryModel &geom_model,
+                            const pin::GeometryData &geom_data,
+                            const CollisionDrawStyle &style) {
+  const auto &pairs = geom_model.collisionPairs;
+  const auto &active = geom_data.activeCollisionPairs;
+  const auto &collisions = geom_data.collisionResults;
+  const auto &distances = geom_data.distanceResults;
+  Uint32 num_colliding = 0;
+
+  for (size_t k = 0; k < pairs.size(); k++) {
+    if (k < active.size() && !active[k])
+      continue;
+
+    if (k < collisions.size() && collisions[k].isCollision()) {
+      num_colliding++;
+      if (!style.showContacts)
+        continue;
+      const coal::CollisionResult &result = collisions[k];
+      for (size_t i = 0; i < result.numContacts(); i++) {
+        const coal::Contact &contact = result.getContact(i);
+        const Float3 pos = contact.pos.cast<float>();
+        const Float3 normal = contact.normal.cast<float>();
+        const float depth = std::abs(float(contact.penetration_depth));
+        list.point(pos, style.pointRadius, style.collidingColor);
+        list.arrow(pos, pos + depth * normal, style.collidingColor,
+                   style.arrowRadius);
+      }
+      // the distance result of a colliding pair is its penetration
+      continue;
+    }
+
+    // results of pairs never computed have an infinite distance
+    if (k >= distances.size() ||
+        distances[k].min_distance > double(style.maxDistance))
+      continue;
+    const coal::DistanceResult &result = distances[k];
+    const float t = style.maxDistance > 0.f
+                        ? float(result.min_distance) / style.maxDistance
+                        : 0.f;
+    const Float4 color = debugColorMap(1.f - t);
+    const Float3 p1 = result.nearest_points[0].cast<float>();
+    const Float3 p2 = result.nearest_points[1].cast<float>();
+    if (style.showNearestPoints) {
+      list.point(p1, style.pointRadius, color);
+      list.point(p2, style.pointRadius, color);
+    }
+    if (style.showSeparation)
+      list.arrow(p1, p2, color, style.arrowRadius);
+  }
+  return num_colliding;
+}
+
+void CollisionDebugSystem::update(DebugScene &scene) {
+  const pin::GeometryModel *coll_model = m_robotScene.collisionModel();
+  const pin::GeometryData *coll_data = m_robotScene.collisionData();
+  if (!enable || !coll_model) {
+    m_numColliding = 0;
+    m_robotScene.clearCollisionHighlights();
+    return;
+  }
+
+  scene.drawImmediate([&](DebugDrawList &list) {
+    m_numColliding =
+        drawCollisionResults(list, *coll_model, *coll_data, style);
+  });
+  if (style.highlightColliding) {
+    Float4 color = style.collidingColor;
+    color.w() = style.highlightWeight;
+    m_robotScene.highlightCollisions(color);
+  } else {
+    m_robotScene.clearCollisionHighlights();
+  }
+}
+
+} // namespace candlewick::multibody
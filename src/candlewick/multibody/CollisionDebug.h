@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Multibody.h"
+#include "../core/DebugScene.h"
+
+namespace candlewick::multibody {
+
+/// \brief Appearance of the collision results drawn by drawCollisionResults().
+struct CollisionDrawStyle {
+  bool showNearestPoints = true;
+  bool showSeparation = true;
+  bool showContacts = true;
+  /// Highlight the colliding geometries of the collision model, see
+  /// RobotScene::highlightCollisions().
+  bool highlightColliding = true;
+  float pointRadius = 0.005f;
+  float arrowRadius = 0.002f;
+  /// Pairs further apart are not drawn. Closer ones are colored with
+  /// debugColorMap(), from blue at this distance to red when touching.
+  float maxDistance = 0.1f;
+  /// Color of the contacts, and of the highlights of colliding geometries.
+  Float4 collidingColor = 0xFF2020ff_rgbaf;
+  /// Blend weight of the highlights over the materials.
+  float highlightWeight = 0.75f;
+};
+
+/// \brief Draw the distance and collision results of the collision pairs of
+/// \p geom_model, as stored in \p geom_data.
+///
+/// Pairs closer than CollisionDrawStyle::maxDistance are drawn as their two
+/// nearest points, linked by the separation vector from the first geometry
+/// to the second. Colliding pairs are drawn as their contact points, with
+/// arrows along the contact normals as long as the penetration depths.
+/// Inactive pairs are skipped.
+///
+/// Distance results are set by pinocchio::computeDistances(), and collision
+/// results by pinocchio::computeCollisions().
+/// \returns The number of colliding pairs.
+Uint32 drawCollisionResults(DebugDrawList &list,
+                            const pin::GeometryModel &geom_model,
+                            const pin::GeometryData &geom_data,
+                            const CollisionDrawStyle &style = {});
+
+/// \brief A debug subsystem overlaying the collision results of the
+/// collision model of a RobotScene (see RobotScene::setCollisionModel()).
+///
+/// Results are drawn as immediate-mode primitives of the DebugScene, and the
+/// colliding geometries are highlighted when the collision model is shown.
+/// The collision GeometryData is read by update(): like the robot data of
+/// RobotDebugSystem, it must be updated before DebugScene::update() on the
+/// render thread. The Visualizer updates a copy of the results passed to
+/// display(), see Visualizer::setCollisionModel().
+class CollisionDebugSystem final : public IDebugSubSystem {
+public:
+  CollisionDrawStyle style;
+  /// Draw the overlay. When disabled, update() only removes the highlights.
+  bool enable = true;
+
+  explicit CollisionDebugSystem(RobotScene &robot_scene,
+                                const CollisionDrawStyle &style = {})
+      : style(style), m_robotScene(robot_scene) {}
+
+  void update(DebugScene &scene) override;
+
+  /// \brief Number of colliding pairs at the last update().
+  Uint32 numColliding() const { return m_numColliding; }
+
+private:
+  RobotScene &m_robotScene;
+  Uint32 m_numColliding = 0;
+};
+
+} // namespace candlewick::multibody
@@ -10,6 +10,18 @@ struct PinGeomObjComponent {
   operator auto() const { return geom_index; }
 };
 
+/// Geometry of the collision model of a RobotScene, by its index in the
+/// collision GeometryModel.
+struct PinCollisionGeomComponent {
+  pin::GeomIndex geom_index;
+  operator auto() const { return geom_index; }
+};
+
+/// Tag of the robot geometries hidden by RobotScene::showCollisionModel() or
+/// RobotScene::showVisualModel(): their Disable tag was added by the scene,
+/// which removes it when showing them again.
+struct HiddenGeometryTag {};
+
 struct PinFrameComponent {
   pin::FrameIndex frame_id;
   operator auto() const { return frame_id; }
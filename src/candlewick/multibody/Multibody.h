@@ -11,6 +11,7 @@ namespace candlewick {
 namespace multibody {
   namespace pin = pinocchio;
   struct RobotDebugSystem;
+  class CollisionDebugSystem;
   class RobotScene;
   class Visualizer;
 
@@ -1,7 +1,6 @@
 #include "RobotDebug.h"
 
 #include "../core/Components.h"
-#include "../primitives/Arrow.h"
 
 #include <pinocchio/algorithm/frames.hpp>
 
@@ -19,35 +18,30 @@ entt::entity RobotDebugSystem::addFrameTriad(DebugScene &scene,
 entt::entity RobotDebugSystem::addFrameVelocityArrow(DebugScene &scene,
                                                      pin::FrameIndex frame_id) {
   entt::registry &reg = scene.registry();
-  MeshData arrow_data = loadArrowSolid(false);
-  Mesh mesh = createMesh(scene.device(), arrow_data, true);
-  GpuVec4 color = 0xFF217Eff_rgbaf;
-
-  auto entity = reg.create();
-  reg.emplace<DebugMeshComponent>(entity, DebugPipelines::TRIANGLE_FILL,
-                                  std::move(mesh), std::vector{color});
+  auto [entity, arrow] = scene.addShape(DebugShape::ARROW, 0xFF217Eff_rgbaf);
   reg.emplace<PinFrameVelocityComponent>(entity, frame_id);
-  reg.emplace<TransformComponent>(entity, Mat4f::Identity());
   return entity;
 }
 
 void RobotDebugSystem::updateFrames(entt::registry &reg) {
-  auto view = reg.view<const PinFrameComponent, const DebugMeshComponent,
+  auto view = reg.view<const PinFrameComponent, const DebugTriadComponent,
                        TransformComponent>();
-  for (auto &&[ent, frame_id, dmc, tr] : view.each()) {
+  for (auto &&[ent, frame_id, triad, tr] : view.each()) {
     Mat4f pose{m_robotData.oMf[frame_id].cast<float>()};
-    auto D = dmc.scale.asDiagonal();
+    auto D = triad.scale.asDiagonal();
     pose.topLeftCorner<3, 3>().applyOnTheRight(D);
     tr = pose;
   }
 }
 
 void RobotDebugSystem::updateFrameVelocities(entt::registry &reg) {
-  constexpr float vel_scale = 0.5f;
+  // the unit arrow has unit length and shaft radius
+  constexpr float vel_scale = 0.25f;
+  constexpr float arrow_radius = 0.003f;
 
   auto view = reg.view<const PinFrameVelocityComponent,
-                       const DebugMeshComponent, TransformComponent>();
-  for (auto &&[ent, fvc, dmc, tr] : view.each()) {
+                       const DebugShapeComponent, TransformComponent>();
+  for (auto &&[ent, fvc, arrow, tr] : view.each()) {
     Motionf vel =
         pin::getFrameVelocity(m_robotModel, m_robotData, fvc, pin::LOCAL)
             .cast<float>();
@@ -56,7 +50,7 @@ void RobotDebugSystem::updateFrameVelocities(entt::registry &reg) {
     Eigen::Quaternionf quatf;
     tr = pose.toHomogeneousMatrix();
     auto v = vel.linear();
-    Eigen::DiagonalMatrix<float, 3> scaleMatrix(0.3f, 0.3f,
+    Eigen::DiagonalMatrix<float, 3> scaleMatrix(arrow_radius, arrow_radius,
                                                 vel_scale * v.norm());
 
     // the arrow mesh is posed z-up by default.
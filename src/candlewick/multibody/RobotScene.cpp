@@ -7,6 +7,7 @@
 #include "../core/Components.h"
 #include "../core/TransformUniforms.h"
 #include "../core/Camera.h"
+#include "../core/Bvh.h"
 #include "../core/errors.h"
 
 #include <entt/entity/registry.hpp>
@@ -17,6 +18,9 @@
 #include <magic_enum/magic_enum_utility.hpp>
 #include <magic_enum/magic_enum_switch.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace candlewick::multibody {
 
 struct alignas(16) light_ubo_t {
@@ -26,6 +30,13 @@ struct alignas(16) light_ubo_t {
   alignas(16) GpuMat4 projMat;
 };
 
+/// Per-pass matrices of the triangle mesh vertex shader.
+struct alignas(16) view_ubo_t {
+  GpuMat4 view;
+  GpuMat4 viewProj;
+  GpuMat4 lightViewProj;
+};
+
 template <typename T>
   requires std::is_enum_v<T>
 [[noreturn]] void
@@ -79,10 +90,16 @@ entt::entity RobotScene::addEnvironmentObject(MeshData &&data, Mat4f placement,
   uploadMeshToDevice(device(), mesh, data);
   entt::entity entity = m_registry.create();
   m_registry.emplace<TransformComponent>(entity, placement);
+  m_registry.emplace<LocalBoundsComponent>(
+      entity, computeBoundingBox(std::span{&data, 1}));
   if (pipe_type != PIPELINE_POINTCLOUD)
     m_registry.emplace<Opaque>(entity);
   // add tag type
   m_registry.emplace<EnvironmentTag>(entity);
+  if (pipe_type == PIPELINE_TRIANGLEMESH && m_config.build_picking_meshes)
+    m_registry.emplace<PickingMeshComponent>(
+        entity, std::make_shared<const TriangleBvh>(
+                    buildTriangleBvh(std::span{&data, 1})));
   m_registry.emplace<MeshMaterialComponent>(
       entity, std::move(mesh), std::vector{std::move(data.material)});
   add_pipeline_tag_component(m_registry, entity, pipe_type);
@@ -97,6 +114,196 @@ void RobotScene::clearEnvironment() {
 void RobotScene::clearRobotGeometries() {
   auto view = m_registry.view<PinGeomObjComponent>();
   m_registry.destroy(view.begin(), view.end());
+  auto coll_view = m_registry.view<PinCollisionGeomComponent>();
+  m_registry.destroy(coll_view.begin(), coll_view.end());
+  m_geomEntities.clear();
+  m_collisionEntities.clear();
+  m_meshCache.clear();
+  m_transformBatch.resize(0);
+}
+
+/// Key of the meshes of a geometry object in the cache of the scene. Meshes
+/// loaded from files are shared by path and scale, whatever their coal
+/// geometry; the others by coal geometry, which geometry models copied from
+/// one another share. The cache holds these geometries, so that their
+/// addresses cannot be reused by other geometries while they are keys.
+static std::string meshAssetKey(const pin::GeometryObject &geom_obj) {
+  const Eigen::Vector3d &scale = geom_obj.meshScale;
+  if (geom_obj.geometry->getObjectType() == coal::OT_BVH &&
+      !geom_obj.meshPath.empty())
+    return std::format("{:s}|{},{},{}", geom_obj.meshPath, scale.x(),
+                       scale.y(), scale.z());
+  return std::format("{}|{},{},{}",
+                     static_cast<const void *>(geom_obj.geometry.get()),
+                     scale.x(), scale.y(), scale.z());
+}
+
+auto RobotScene::loadMeshAsset(const pin::GeometryObject &geom_obj)
+    -> const MeshAsset & {
+  std::string key = meshAssetKey(geom_obj);
+  if (auto it = m_meshCache.find(key); it != m_meshCache.end())
+    return it->second;
+
+  auto meshDatas = loadGeometryObject(geom_obj);
+  auto mesh = createMeshFromBatch(device(), meshDatas, true);
+  assert(validateMesh(mesh));
+  MeshAsset asset{
+      .mesh = std::make_shared<const Mesh>(std::move(mesh)),
+      .materials = extractMaterials(meshDatas),
+      .bounds = computeBoundingBox(meshDatas),
+      .pipelineType = pinGeomToPipeline(*geom_obj.geometry),
+      .geometry = geom_obj.geometry,
+  };
+  if (asset.pipelineType == PIPELINE_TRIANGLEMESH &&
+      m_config.build_picking_meshes)
+    asset.pickingMesh =
+        std::make_shared<const TriangleBvh>(buildTriangleBvh(meshDatas));
+  return m_meshCache.emplace(std::move(key), std::move(asset)).first->second;
+}
+
+entt::entity
+RobotScene::createGeometryEntity(const pin::GeometryObject &geom_obj) {
+  const MeshAsset &asset = loadMeshAsset(geom_obj);
+  const PipelineType pipeline_type = asset.pipelineType;
+  // the cached materials are those of the first object loading the meshes
+  std::vector<PbrMaterial> materials = asset.materials;
+  if (geom_obj.overrideMaterial) {
+    for (auto &material : materials)
+      material.baseColor = geom_obj.meshColor.cast<float>();
+  }
+
+  entt::entity entity = m_registry.create();
+  m_registry.emplace<TransformComponent>(entity);
+  // mesh scales are applied to the vertices
+  m_registry.emplace<RigidTransformTag>(entity);
+  m_registry.emplace<LocalBoundsComponent>(entity, asset.bounds);
+  if (pipeline_type != PIPELINE_POINTCLOUD)
+    m_registry.emplace<Opaque>(entity);
+  m_registry.emplace<MeshMaterialComponent>(entity, asset.mesh,
+                                            std::move(materials));
+  if (asset.pickingMesh)
+    m_registry.emplace<PickingMeshComponent>(entity, asset.pickingMesh);
+  add_pipeline_tag_component(m_registry, entity, pipeline_type);
+  createPipelinesForType(asset.mesh->layout(), pipeline_type);
+  return entity;
+}
+
+void RobotScene::createPipelinesForType(const MeshLayout &layout,
+                                        PipelineType pipeline_type) {
+  if (pipeline_type == PIPELINE_TRIANGLEMESH) {
+    if (!ssaoPass.pipeline) {
+      ssaoPass = ssao::SsaoPass(m_renderer, layout, gBuffer.normalMap,
+                                m_config.ssao_config);
+    }
+    // configure shadow pass
+    if (m_config.enable_shadows && !shadowPass.pipeline) {
+      shadowPass =
+          ShadowPassInfo::create(m_renderer, layout, m_config.shadow_config);
+    }
+  }
+
+  if (!renderPipelines[pipeline_type]) {
+    SDL_Log("Building pipeline for type %s",
+            magic_enum::enum_name(pipeline_type).data());
+    SDL_GPUGraphicsPipeline *pipeline =
+        createPipeline(layout, m_renderer.getSwapchainTextureFormat(),
+                       m_renderer.depthFormat(), pipeline_type);
+    assert(pipeline);
+    renderPipelines[pipeline_type] = pipeline;
+  }
+}
+
+/// Show or hide robot geometries. Only the Disable tags added when hiding
+/// them are removed: entities disabled by the user stay disabled.
+static void setEntitiesEnabled(entt::registry &registry,
+                               std::span<const entt::entity> entities,
+                               bool enabled) {
+  for (entt::entity ent : entities) {
+    if (enabled) {
+      if (registry.remove<HiddenGeometryTag>(ent))
+        registry.remove<Disable>(ent);
+    } else if (!registry.all_of<Disable>(ent)) {
+      registry.emplace<Disable>(ent);
+      registry.emplace<HiddenGeometryTag>(ent);
+    }
+  }
+}
+
+void RobotScene::setCollisionModel(const pin::GeometryModel &coll_model,
+                                   const pin::GeometryData &coll_data) {
+  m_registry.destroy(m_collisionEntities.begin(), m_collisionEntities.end());
+  m_collisionEntities.clear();
+  m_collModel = &coll_model;
+  m_collData = &coll_data;
+  if (m_showCollision)
+    showCollisionModel(true);
+}
+
+void RobotScene::loadCollisionGeometries() {
+  const pin::GeometryModel &coll_model = *m_collModel;
+  const size_t num_cached = m_meshCache.size();
+  m_collisionEntities.reserve(coll_model.ngeoms);
+  for (pin::GeomIndex geom_id = 0; geom_id < coll_model.ngeoms; geom_id++) {
+    entt::entity entity =
+        createGeometryEntity(coll_model.geometryObjects[geom_id]);
+    m_registry.emplace<PinCollisionGeomComponent>(entity, geom_id);
+    m_collisionEntities.push_back(entity);
+  }
+  SDL_Log("Loaded %zu collision geometries (%zu new meshes)",
+          m_collisionEntities.size(), m_meshCache.size() - num_cached);
+}
+
+void RobotScene::showCollisionModel(bool show) {
+  m_showCollision = show;
+  if (!m_collModel)
+    return;
+  if (show && m_collisionEntities.empty())
+    loadCollisionGeometries();
+  setEntitiesEnabled(m_registry, m_collisionEntities, show);
+  updateCollisionTransforms();
+}
+
+void RobotScene::showVisualModel(bool show) {
+  m_showVisual = show;
+  setEntitiesEnabled(m_registry, m_geomEntities, show);
+}
+
+void RobotScene::updateCollisionTransforms() {
+  if (!m_showCollision || m_collisionEntities.empty())
+    return;
+  const pin::GeometryData &coll_data = *m_collData;
+  for (size_t i = 0; i < m_collisionEntities.size(); i++) {
+    const SE3f pose = coll_data.oMg[i].cast<float>();
+    m_registry.get<TransformComponent>(m_collisionEntities[i]) =
+        pose.toHomogeneousMatrix();
+  }
+}
+
+Uint32 RobotScene::highlightCollisions(const Float4 &color) {
+  clearCollisionHighlights();
+  if (!m_collModel)
+    return 0;
+  const auto &pairs = m_collModel->collisionPairs;
+  const auto &results = m_collData->collisionResults;
+  Uint32 num_colliding = 0;
+  for (size_t k = 0; k < std::min(pairs.size(), results.size()); k++) {
+    if (!results[k].isCollision())
+      continue;
+    num_colliding++;
+    // not loaded yet
+    if (m_collisionEntities.empty())
+      continue;
+    for (pin::GeomIndex geom_id : {pairs[k].first, pairs[k].second}) {
+      m_registry.emplace_or_replace<HighlightComponent>(
+          m_collisionEntities[geom_id], color);
+    }
+  }
+  return num_colliding;
+}
+
+void RobotScene::clearCollisionHighlights() {
+  m_registry.remove<HighlightComponent>(m_collisionEntities.begin(),
+                                        m_collisionEntities.end());
 }
 
 RobotScene::RobotScene(entt::registry &registry, const Renderer &renderer,
@@ -121,54 +328,18 @@ RobotScene::RobotScene(entt::registry &registry, const Renderer &renderer,
 
   // initialize render target for GBuffer
   this->initGBuffer(renderer);
-  const bool enable_shadows = m_config.enable_shadows;
+  m_transformBuffer = TransformBuffer{renderer.device};
 
   for (pin::GeomIndex geom_id = 0; geom_id < geom_model.ngeoms; geom_id++) {
-
     const auto &geom_obj = geom_model.geometryObjects[geom_id];
-    auto meshDatas = loadGeometryObject(geom_obj);
-    PipelineType pipeline_type = pinGeomToPipeline(*geom_obj.geometry);
-    auto mesh = createMeshFromBatch(device(), meshDatas, true);
-    assert(validateMesh(mesh));
-
-    // local copy for use
-    const auto layout = mesh.layout();
-
-    // add entity for this geometry
-    entt::entity entity = registry.create();
+    entt::entity entity = createGeometryEntity(geom_obj);
     registry.emplace<PinGeomObjComponent>(entity, geom_id);
-    registry.emplace<TransformComponent>(entity);
-    if (pipeline_type != PIPELINE_POINTCLOUD)
-      registry.emplace<Opaque>(entity);
-    registry.emplace<MeshMaterialComponent>(entity, std::move(mesh),
-                                            extractMaterials(meshDatas));
-    add_pipeline_tag_component(m_registry, entity, pipeline_type);
-
-    if (pipeline_type == PIPELINE_TRIANGLEMESH) {
-      if (!ssaoPass.pipeline) {
-        ssaoPass = ssao::SsaoPass(renderer, layout, gBuffer.normalMap);
-      }
-      // configure shadow pass
-      if (enable_shadows && !shadowPass.pipeline) {
-        shadowPass =
-            ShadowPassInfo::create(renderer, layout, config.shadow_config);
-      }
-    }
-
-    if (!renderPipelines[pipeline_type]) {
-      SDL_Log("Building pipeline for type %s",
-              magic_enum::enum_name(pipeline_type).data());
-      SDL_GPUGraphicsPipeline *pipeline =
-          createPipeline(layout, renderer.getSwapchainTextureFormat(),
-                         renderer.depthFormat(), pipeline_type);
-      assert(pipeline);
-      renderPipelines[pipeline_type] = pipeline;
-    }
+    m_geomEntities.push_back(entity);
   }
 }
 
 void RobotScene::initGBuffer(const Renderer &renderer) {
-  auto [width, height] = renderer.window.size();
+  auto [width, height] = renderer.size();
   gBuffer.normalMap = Texture{renderer.device,
                               {
                                   .type = SDL_GPU_TEXTURETYPE_2D,
@@ -183,6 +354,54 @@ void RobotScene::initGBuffer(const Renderer &renderer) {
                                   .props = 0,
                               },
                               "GBuffer normal"};
+  if (m_config.enable_instance_id_target) {
+    gBuffer.instanceIdMap =
+        Texture{renderer.device,
+                {
+                    .type = SDL_GPU_TEXTURETYPE_2D,
+                    .format = SDL_GPU_TEXTUREFORMAT_R32_UINT,
+                    .usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET |
+                             SDL_GPU_TEXTUREUSAGE_SAMPLER,
+                    .width = Uint32(width),
+                    .height = Uint32(height),
+                    .layer_count_or_depth = 1,
+                    .num_levels = 1,
+                    .sample_count = SDL_GPU_SAMPLECOUNT_1,
+                    .props = 0,
+                },
+                "GBuffer instance ID"};
+  }
+}
+
+Uint32 RobotScene::instanceIdForEntity(entt::entity entity) const {
+  switch (m_config.instance_id_source) {
+  case InstanceIdSource::ENTITY:
+    return entt::to_integral(entity) + 1u;
+  case InstanceIdSource::GEOM_INDEX:
+    if (auto *geom_id = m_registry.try_get<PinGeomObjComponent>(entity))
+      return Uint32(geom_id->geom_index) + 1u;
+    return INSTANCE_ID_BACKGROUND;
+  }
+  return INSTANCE_ID_BACKGROUND;
+}
+
+entt::entity RobotScene::entityFromInstanceId(Uint32 instance_id) const {
+  if (instance_id == INSTANCE_ID_BACKGROUND)
+    return entt::null;
+  switch (m_config.instance_id_source) {
+  case InstanceIdSource::ENTITY: {
+    auto entity = entt::entity(instance_id - 1u);
+    return m_registry.valid(entity) ? entity : entt::entity{entt::null};
+  }
+  case InstanceIdSource::GEOM_INDEX: {
+    const size_t geom_id = instance_id - 1u;
+    if (geom_id < m_geomEntities.size() &&
+        m_registry.valid(m_geomEntities[geom_id]))
+      return m_geomEntities[geom_id];
+    break;
+  }
+  }
+  return entt::null;
 }
 
 void updateRobotTransforms(entt::registry &registry,
@@ -196,7 +415,88 @@ void updateRobotTransforms(entt::registry &registry,
 }
 
 void RobotScene::updateTransforms() {
-  ::candlewick::multibody::updateRobotTransforms(m_registry, m_geomData);
+  const pin::GeometryData &geom_data = m_geomData;
+  const auto count = Eigen::Index(geom_data.oMg.size());
+  if (m_transformBatch.size() != count)
+    m_transformBatch.resize(count);
+  for (Eigen::Index i = 0; i < count; i++) {
+    const pin::SE3 &M = geom_data.oMg[size_t(i)];
+    m_transformBatch.setPlacement(i, M.rotation(), M.translation());
+  }
+  for (Uint32 geom_id : m_transformBatch.update()) {
+    if (geom_id >= m_geomEntities.size())
+      continue;
+    if (auto *tr = m_registry.try_get<TransformComponent>(
+            m_geomEntities[geom_id]))
+      *tr = m_transformBatch.matrix(geom_id);
+  }
+  updateCollisionTransforms();
+}
+
+void RobotScene::pushPlacementKeyframe(double timestamp) {
+  const pin::GeometryData &geom_data = m_geomData;
+  // a keyframe at the same time replaces the latest one
+  if (m_numKeyframes == 0 || timestamp > m_keyframeTimes[m_latestKeyframe]) {
+    m_latestKeyframe = 1 - m_latestKeyframe;
+    m_numKeyframes = std::min(m_numKeyframes + 1, 2u);
+  }
+  PoseArray &keyframe = m_keyframes[m_latestKeyframe];
+  const auto count = Eigen::Index(geom_data.oMg.size());
+  keyframe.resize(count);
+  for (Eigen::Index i = 0; i < count; i++) {
+    const pin::SE3 &M = geom_data.oMg[size_t(i)];
+    keyframe.set(i, Eigen::Quaternionf{M.rotation().cast<float>()},
+                 M.translation().cast<float>());
+  }
+  m_keyframeTimes[m_latestKeyframe] = timestamp;
+}
+
+double RobotScene::keyframeInterval() const {
+  if (m_numKeyframes < 2)
+    return 0.;
+  return m_keyframeTimes[m_latestKeyframe] -
+         m_keyframeTimes[1 - m_latestKeyframe];
+}
+
+bool RobotScene::updateTransformsInterpolated(double t) {
+  if (m_numKeyframes == 0)
+    return false;
+  const PoseArray &to = m_keyframes[m_latestKeyframe];
+  const PoseArray &from = m_keyframes[1 - m_latestKeyframe];
+  const double interval = keyframeInterval();
+  if (interval <= 0. || from.size() != to.size()) {
+    m_interpolatedPoses = to;
+  } else {
+    const double t0 = m_keyframeTimes[1 - m_latestKeyframe];
+    const float alpha = float(std::clamp((t - t0) / interval, 0., 1.));
+    interpolatePoses(from, to, alpha, m_interpolatedPoses);
+  }
+
+  auto robot_view =
+      m_registry.view<const PinGeomObjComponent, TransformComponent>();
+  for (auto [ent, geom_id, tr] : robot_view.each()) {
+    if (Eigen::Index(geom_id) < m_interpolatedPoses.size())
+      tr = m_interpolatedPoses.matrix(Eigen::Index(geom_id));
+  }
+  // the next updateTransforms() must rewrite all transforms
+  m_transformBatch.invalidate();
+  updateCollisionTransforms();
+  return t < m_keyframeTimes[m_latestKeyframe];
+}
+
+void RobotScene::uploadTransforms(CommandBuffer &command_buffer) {
+  // objects are stored in the order of the TransformComponent storage, so
+  // that draws get their index from the storage
+  const auto &storage = m_registry.storage<TransformComponent>();
+  m_transformBuffer.clear();
+  for (size_t i = 0; i < storage.size(); i++) {
+    const entt::entity ent = storage.data()[i];
+    const auto *highlight = m_registry.try_get<HighlightComponent>(ent);
+    m_transformBuffer.push(storage.get(ent),
+                           m_registry.all_of<RigidTransformTag>(ent),
+                           highlight ? highlight->color : Float4::Zero());
+  }
+  m_transformBuffer.upload(command_buffer);
 }
 
 void RobotScene::collectOpaqueCastables() {
@@ -206,12 +506,14 @@ void RobotScene::collectOpaqueCastables() {
                       pipeline_tag_component<PIPELINE_TRIANGLEMESH>>(
           entt::exclude<Disable>);
 
-  m_castables.clear();
+  m_castables = FrameVector<OpaqueCastable>{m_renderer.frameArena};
+  m_castables.reserve(all_view.size_hint());
 
   // collect castable objects
+  const auto &transforms = m_registry.storage<TransformComponent>();
   for (auto [ent, tr, meshMaterial] : all_view.each()) {
-    const Mesh &mesh = meshMaterial.mesh;
-    m_castables.emplace_back(ent, mesh, tr);
+    const Mesh &mesh = *meshMaterial.mesh;
+    m_castables.emplace_back(ent, mesh, tr, Uint32(transforms.index(ent)));
   }
 }
 
@@ -231,7 +533,7 @@ void RobotScene::render(CommandBuffer &command_buffer, const Camera &camera) {
 static SDL_GPURenderPass *
 getRenderPass(const Renderer &renderer, CommandBuffer &command_buffer,
               SDL_GPULoadOp color_load_op, SDL_GPULoadOp depth_load_op,
-              bool has_normals_target, const RobotScene::GBuffer &gbuffer) {
+              Uint32 num_gbuffer_targets, const RobotScene::GBuffer &gbuffer) {
   SDL_GPUColorTargetInfo main_color_target;
   SDL_zero(main_color_target);
   main_color_target.texture = renderer.swapchain;
@@ -248,23 +550,41 @@ getRenderPass(const Renderer &renderer, CommandBuffer &command_buffer,
   depth_target.store_op = SDL_GPU_STOREOP_STORE;
   depth_target.stencil_load_op = SDL_GPU_LOADOP_DONT_CARE;
   depth_target.stencil_store_op = SDL_GPU_STOREOP_DONT_CARE;
-  if (!has_normals_target) {
+  if (num_gbuffer_targets == 0) {
     return SDL_BeginGPURenderPass(command_buffer, &main_color_target, 1,
                                   &depth_target);
   } else {
-    SDL_GPUColorTargetInfo color_targets[2];
+    // GBuffer targets are cleared to zero, i.e. INSTANCE_ID_BACKGROUND for the
+    // instance ID target.
+    SDL_GPUTexture *gbuffer_textures[] = {gbuffer.normalMap,
+                                          gbuffer.instanceIdMap};
+    SDL_GPUColorTargetInfo color_targets[3];
     SDL_zero(color_targets);
     color_targets[0] = main_color_target;
-    color_targets[1].texture = gbuffer.normalMap;
-    color_targets[1].clear_color = SDL_FColor{};
-    color_targets[1].load_op = SDL_GPU_LOADOP_CLEAR;
-    color_targets[1].store_op = SDL_GPU_STOREOP_STORE;
-    color_targets[1].cycle = false;
+    for (Uint32 i = 1; i <= num_gbuffer_targets; i++) {
+      color_targets[i].texture = gbuffer_textures[i - 1];
+      color_targets[i].clear_color = SDL_FColor{};
+      color_targets[i].load_op = SDL_GPU_LOADOP_CLEAR;
+      color_targets[i].store_op = SDL_GPU_STOREOP_STORE;
+      color_targets[i].cycle = false;
+    }
     return SDL_BeginGPURenderPass(command_buffer, color_targets,
-                                  SDL_arraysize(color_targets), &depth_target);
+                                  1 + num_gbuffer_targets, &depth_target);
   }
 }
 
+/// Color of the pipelines without per-object data, with the highlight of the
+/// object blended in as in PbrBasic.frag.
+static Float4 tintedColor(const Float4 &base,
+                          const HighlightComponent *highlight) {
+  if (!highlight)
+    return base;
+  Float4 color = base;
+  color.head<3>() += highlight->color.w() *
+                     (highlight->color.head<3>() - base.head<3>());
+  return color;
+}
+
 enum FragmentSamplerSlots {
   SHADOW_MAP_SLOT,
   SSAO_SLOT,
@@ -287,75 +607,84 @@ void RobotScene::renderPBRTriangleGeometry(CommandBuffer &command_buffer,
   };
 
   const bool enable_shadows = m_config.enable_shadows;
-  const Mat4f lightViewProj = shadowPass.cam.viewProj();
-  const Mat4f viewProj = camera.viewProj();
+  const bool enable_instance_id = m_config.enable_instance_id_target;
+  const view_ubo_t viewUbo{
+      camera.view.matrix(),
+      camera.viewProj(),
+      shadowPass.cam.viewProj(),
+  };
 
   // this is the first render pass, hence:
   // clear the color texture (swapchain), either load or clear the depth texture
-  SDL_GPURenderPass *render_pass =
+  RenderPassEncoder encoder{
+      command_buffer,
       getRenderPass(m_renderer, command_buffer, SDL_GPU_LOADOP_CLEAR,
                     m_config.triangle_has_prepass ? SDL_GPU_LOADOP_LOAD
                                                   : SDL_GPU_LOADOP_CLEAR,
-                    m_config.enable_normal_target, gBuffer);
+                    numGBufferTargets(), gBuffer),
+      &m_renderer.passStats};
 
   if (enable_shadows) {
-    rend::bindFragmentSamplers(render_pass, SHADOW_MAP_SLOT,
-                               {{
-                                   .texture = shadowPass.depthTexture,
-                                   .sampler = shadowPass.sampler,
-                               }});
-  }
-  rend::bindFragmentSamplers(render_pass, SSAO_SLOT,
-                             {{
-                                 .texture = ssaoPass.ssaoMap,
-                                 .sampler = ssaoPass.texSampler,
-                             }});
+    encoder.bindFragmentSamplers(SHADOW_MAP_SLOT,
+                                 {{
+                                     .texture = shadowPass.depthTexture,
+                                     .sampler = shadowPass.sampler,
+                                 }});
+  }
+  encoder.bindFragmentSamplers(SSAO_SLOT, {{
+                                              .texture = ssaoPass.ssaoMap,
+                                              .sampler = ssaoPass.texSampler,
+                                          }});
   int _useSsao = m_config.enable_ssao;
-  command_buffer
+  encoder
       .pushFragmentUniform(FragmentUniformSlots::LIGHTING, &lightUbo,
                            sizeof(lightUbo))
-      .pushFragmentUniform(2, &_useSsao, sizeof(_useSsao));
+      .pushFragmentUniform(FragmentUniformSlots::EFFECTS, &_useSsao,
+                           sizeof(_useSsao));
 
   auto *pipeline = renderPipelines[PIPELINE_TRIANGLEMESH];
   assert(pipeline);
-  SDL_BindGPUGraphicsPipeline(render_pass, pipeline);
+  encoder.bindPipeline(pipeline);
+
+  m_transformBuffer.bind(encoder);
+  encoder.pushVertexUniform(VertexUniformSlots::VIEW, &viewUbo,
+                            sizeof(viewUbo));
 
+  const auto &transforms = m_registry.storage<TransformComponent>();
   auto all_view =
       m_registry.view<const TransformComponent, const MeshMaterialComponent,
                       pipeline_tag_component<PIPELINE_TRIANGLEMESH>>(
           entt::exclude<Disable>);
   for (auto [ent, tr, obj] : all_view.each()) {
-    const Mat4f modelView = camera.view * tr;
-    const Mesh &mesh = obj.mesh;
-    Mat4f mvp = viewProj * tr;
-    TransformUniformData data{
-        .modelView = modelView,
-        .mvp = mvp,
-        .normalMatrix = math::computeNormalMatrix(modelView),
-    };
-    command_buffer.pushVertexUniform(VertexUniformSlots::TRANSFORM, &data,
-                                     sizeof(data));
-    if (enable_shadows) {
-      Mat4f lightMvp = lightViewProj * tr;
-      command_buffer.pushVertexUniform(1, &lightMvp, sizeof(lightMvp));
+    const Mesh &mesh = *obj.mesh;
+    const Uint32 object_index = Uint32(transforms.index(ent));
+    encoder.pushVertexUniform(VertexUniformSlots::OBJECT_INDEX, &object_index,
+                              sizeof(object_index));
+    if (enable_instance_id) {
+      const Uint32 instance_id = instanceIdForEntity(ent);
+      encoder.pushFragmentUniform(FragmentUniformSlots::INSTANCE_ID,
+                                  &instance_id, sizeof(instance_id));
     }
-    rend::bindMesh(render_pass, mesh);
+    encoder.bindMesh(mesh);
     for (size_t j = 0; j < mesh.numViews(); j++) {
-      const auto material = obj.materials[j];
-      command_buffer.pushFragmentUniform(FragmentUniformSlots::MATERIAL,
-                                         &material, sizeof(material));
-      rend::drawView(render_pass, mesh.view(j));
+      // identical materials (e.g. of robot links) are not pushed again
+      const auto &material = obj.materials[j];
+      encoder.pushFragmentUniform(FragmentUniformSlots::MATERIAL, &material,
+                                  sizeof(material));
+      encoder.drawView(mesh.view(j));
     }
   }
 
-  SDL_EndGPURenderPass(render_pass);
+  encoder.end();
 }
 
 void RobotScene::renderOtherGeometry(CommandBuffer &command_buffer,
                                      const Camera &camera) {
-  SDL_GPURenderPass *render_pass =
-      getRenderPass(m_renderer, command_buffer, SDL_GPU_LOADOP_LOAD,
-                    SDL_GPU_LOADOP_LOAD, false, gBuffer);
+  RenderPassEncoder encoder{command_buffer,
+                            getRenderPass(m_renderer, command_buffer,
+                                          SDL_GPU_LOADOP_LOAD,
+                                          SDL_GPU_LOADOP_LOAD, 0u, gBuffer),
+                            &m_renderer.passStats};
 
   const Mat4f viewProj = camera.viewProj();
 
@@ -365,7 +694,7 @@ void RobotScene::renderOtherGeometry(CommandBuffer &command_buffer,
       return;
 
     auto *pipeline = renderPipelines[current_pipeline_type];
-    SDL_BindGPUGraphicsPipeline(render_pass, pipeline);
+    encoder.bindPipeline(pipeline);
 
     auto env_view =
         m_registry.view<const TransformComponent, const MeshMaterialComponent,
@@ -373,18 +702,241 @@ void RobotScene::renderOtherGeometry(CommandBuffer &command_buffer,
             entt::exclude<Disable>);
     for (auto [entity, tr, obj] : env_view.each()) {
       auto &modelMat = tr;
-      const Mesh &mesh = obj.mesh;
+      const Mesh &mesh = *obj.mesh;
       const Mat4f mvp = viewProj * modelMat;
-      const auto &color = obj.materials[0].baseColor;
-      command_buffer
+      const Float4 color =
+          tintedColor(obj.materials[0].baseColor,
+                      m_registry.try_get<HighlightComponent>(entity));
+      encoder
           .pushVertexUniform(VertexUniformSlots::TRANSFORM, &mvp, sizeof(mvp))
           .pushFragmentUniform(FragmentUniformSlots::MATERIAL, &color,
                                sizeof(color));
-      rend::bindMesh(render_pass, mesh);
-      rend::draw(render_pass, mesh);
+      encoder.bindMesh(mesh);
+      encoder.draw(mesh);
     }
   });
-  SDL_EndGPURenderPass(render_pass);
+  encoder.end();
+}
+
+void RobotScene::initViewAtlas(const ViewAtlasConfig &config) {
+  for (auto &pipeline : viewAtlas.pipelines) {
+    SDL_ReleaseGPUGraphicsPipeline(device(), pipeline);
+    pipeline = nullptr;
+  }
+  const Uint32 num_views = std::max(config.num_views, 1u);
+  const Uint32 columns = Uint32(std::ceil(std::sqrt(float(num_views))));
+  const Uint32 rows = (num_views + columns - 1) / columns;
+  viewAtlas.view_width = config.view_width;
+  viewAtlas.view_height = config.view_height;
+  viewAtlas.num_views = num_views;
+  viewAtlas.columns = columns;
+
+  SDL_GPUTextureCreateInfo texture_desc{
+      .type = SDL_GPU_TEXTURETYPE_2D,
+      .format = config.color_format,
+      .usage =
+          SDL_GPU_TEXTUREUSAGE_COLOR_TARGET | SDL_GPU_TEXTUREUSAGE_SAMPLER,
+      .width = columns * config.view_width,
+      .height = rows * config.view_height,
+      .layer_count_or_depth = 1,
+      .num_levels = 1,
+      .sample_count = SDL_GPU_SAMPLECOUNT_1,
+      .props = 0,
+  };
+  viewAtlas.color = Texture{device(), texture_desc, "View atlas color"};
+  texture_desc.format = m_renderer.depthFormat();
+  texture_desc.usage =
+      SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET | SDL_GPU_TEXTUREUSAGE_SAMPLER;
+  viewAtlas.depth = Texture{device(), texture_desc, "View atlas depth"};
+
+  // build the pipelines from the layout of any mesh using them
+  magic_enum::enum_for_each<PipelineType>([&](auto current_pipeline_type) {
+    auto view = m_registry.view<const MeshMaterialComponent,
+                                pipeline_tag_component<current_pipeline_type>>();
+    if (view.begin() == view.end() ||
+        !m_config.pipeline_configs.contains(current_pipeline_type))
+      return;
+    const Mesh &mesh =
+        *m_registry.get<const MeshMaterialComponent>(*view.begin()).mesh;
+    auto *pipeline =
+        createPipeline(mesh.layout(), viewAtlas.color.format(),
+                       viewAtlas.depth.format(), current_pipeline_type, true);
+    if (!pipeline)
+      terminate_with_message(
+          std::format("Failed to create view atlas pipeline: {:s}",
+                      SDL_GetError()));
+    viewAtlas.pipelines[current_pipeline_type] = pipeline;
+  });
+}
+
+void RobotScene::collectDrawItems() {
+  magic_enum::enum_for_each<PipelineType>([&](auto current_pipeline_type) {
+    const auto &transforms = m_registry.storage<TransformComponent>();
+    auto view =
+        m_registry.view<const TransformComponent, const MeshMaterialComponent,
+                        pipeline_tag_component<current_pipeline_type>>(
+            entt::exclude<Disable>);
+    auto &items = m_drawItems[current_pipeline_type];
+    items = FrameVector<DrawItem>{m_renderer.frameArena};
+    items.reserve(view.size_hint());
+    for (auto [ent, tr, obj] : view.each()) {
+      DrawItem item{&tr,
+                    Uint32(transforms.index(ent)),
+                    &obj,
+                    m_registry.try_get<HighlightComponent>(ent),
+                    {},
+                    false};
+      if (auto *bounds = m_registry.try_get<LocalBoundsComponent>(ent)) {
+        item.worldBounds = bounds->transformed(tr);
+        item.cullable = true;
+      }
+      items.push_back(item);
+    }
+  });
+}
+
+auto RobotScene::renderViews(CommandBuffer &command_buffer,
+                             std::span<const Camera> cameras)
+    -> ViewCullStats {
+  SDL_assert(viewAtlas.initialized());
+  // checked in all builds: extra views would be drawn outside of the atlas
+  if (cameras.size() > viewAtlas.num_views)
+    terminate_with_message(
+        std::format("Cannot render {:d} views into an atlas of {:d}.",
+                    cameras.size(), viewAtlas.num_views));
+  ViewCullStats stats;
+
+  // per-frame work shared by all views
+  collectDrawItems();
+  m_viewFrustums = FrameVector<FrustumPlanes>{m_renderer.frameArena};
+  m_viewFrustums.reserve(cameras.size());
+  for (const Camera &camera : cameras)
+    m_viewFrustums.push_back(FrustumPlanes::fromViewProj(camera.viewProj()));
+
+  SDL_GPUColorTargetInfo color_target;
+  SDL_zero(color_target);
+  color_target.texture = viewAtlas.color;
+  color_target.clear_color = SDL_FColor{0., 0., 0., 0.};
+  color_target.load_op = SDL_GPU_LOADOP_CLEAR;
+  color_target.store_op = SDL_GPU_STOREOP_STORE;
+
+  SDL_GPUDepthStencilTargetInfo depth_target;
+  SDL_zero(depth_target);
+  depth_target.texture = viewAtlas.depth;
+  depth_target.clear_depth = 1.0f;
+  depth_target.load_op = SDL_GPU_LOADOP_CLEAR;
+  depth_target.store_op = SDL_GPU_STOREOP_STORE;
+  depth_target.stencil_load_op = SDL_GPU_LOADOP_DONT_CARE;
+  depth_target.stencil_store_op = SDL_GPU_STOREOP_DONT_CARE;
+
+  RenderPassEncoder encoder{
+      command_buffer,
+      SDL_BeginGPURenderPass(command_buffer, &color_target, 1, &depth_target),
+      &m_renderer.passStats};
+
+  const bool enable_shadows = m_config.enable_shadows;
+  const Mat4f lightViewProj = shadowPass.cam.viewProj();
+
+  auto set_view = [&](Uint32 index) {
+    const SDL_Rect rect = viewAtlas.viewRect(index);
+    const SDL_GPUViewport viewport{
+        .x = float(rect.x),
+        .y = float(rect.y),
+        .w = float(rect.w),
+        .h = float(rect.h),
+        .min_depth = 0.f,
+        .max_depth = 1.f,
+    };
+    SDL_SetGPUViewport(encoder, &viewport);
+    SDL_SetGPUScissor(encoder, &rect);
+  };
+
+  magic_enum::enum_for_each<PipelineType>([&](auto current_pipeline_type) {
+    auto *pipeline = viewAtlas.pipelines[current_pipeline_type];
+    const auto &items = m_drawItems[current_pipeline_type];
+    if (!pipeline || items.empty())
+      return;
+    constexpr bool is_triangle_mesh =
+        current_pipeline_type == PIPELINE_TRIANGLEMESH;
+    encoder.bindPipeline(pipeline);
+
+    if constexpr (is_triangle_mesh) {
+      if (enable_shadows) {
+        encoder.bindFragmentSamplers(SHADOW_MAP_SLOT,
+                                     {{
+                                         .texture = shadowPass.depthTexture,
+                                         .sampler = shadowPass.sampler,
+                                     }});
+      }
+      // the shader declares the SSAO sampler, which needs a binding
+      encoder.bindFragmentSamplers(SSAO_SLOT,
+                                   {{
+                                       .texture = ssaoPass.ssaoMap,
+                                       .sampler = ssaoPass.texSampler,
+                                   }});
+      const int _useSsao = 0;
+      encoder.pushFragmentUniform(FragmentUniformSlots::EFFECTS, &_useSsao,
+                                  sizeof(_useSsao));
+      m_transformBuffer.bind(encoder);
+    }
+
+    for (Uint32 v = 0; v < cameras.size(); v++) {
+      const Camera &camera = cameras[v];
+      const FrustumPlanes &frustum = m_viewFrustums[v];
+      const Mat4f viewProj = camera.viewProj();
+      set_view(v);
+
+      if constexpr (is_triangle_mesh) {
+        const view_ubo_t viewUbo{camera.view.matrix(), viewProj,
+                                 lightViewProj};
+        encoder.pushVertexUniform(VertexUniformSlots::VIEW, &viewUbo,
+                                  sizeof(viewUbo));
+        const light_ubo_t lightUbo{
+            camera.transformVector(directionalLight.direction),
+            directionalLight.color,
+            directionalLight.intensity,
+            camera.projection,
+        };
+        encoder.pushFragmentUniform(FragmentUniformSlots::LIGHTING, &lightUbo,
+                                    sizeof(lightUbo));
+      }
+
+      for (const DrawItem &item : items) {
+        if (item.cullable && !frustum.intersects(item.worldBounds)) {
+          stats.culled++;
+          continue;
+        }
+        stats.drawn++;
+        const Mat4f &tr = *item.transform;
+        const Mesh &mesh = *item.meshMaterial->mesh;
+        const auto &materials = item.meshMaterial->materials;
+        encoder.bindMesh(mesh);
+        if constexpr (is_triangle_mesh) {
+          encoder.pushVertexUniform(VertexUniformSlots::OBJECT_INDEX,
+                                    &item.transformIndex,
+                                    sizeof(item.transformIndex));
+          for (size_t j = 0; j < mesh.numViews(); j++) {
+            encoder.pushFragmentUniform(FragmentUniformSlots::MATERIAL,
+                                        &materials[j], sizeof(materials[j]));
+            encoder.drawView(mesh.view(j));
+          }
+        } else {
+          const Mat4f mvp = viewProj * tr;
+          const Float4 color =
+              tintedColor(materials[0].baseColor, item.highlight);
+          encoder
+              .pushVertexUniform(VertexUniformSlots::TRANSFORM, &mvp,
+                                 sizeof(mvp))
+              .pushFragmentUniform(FragmentUniformSlots::MATERIAL, &color,
+                                   sizeof(color));
+          encoder.draw(mesh);
+        }
+      }
+    }
+  });
+
+  encoder.end();
+  return stats;
 }
 
 void RobotScene::release() {
@@ -392,20 +944,30 @@ void RobotScene::release() {
     return;
 
   m_registry.clear<MeshMaterialComponent>();
+  m_meshCache.clear();
 
   for (auto &pipeline : renderPipelines) {
     SDL_ReleaseGPUGraphicsPipeline(device(), pipeline);
     pipeline = nullptr;
   }
+  for (auto &pipeline : viewAtlas.pipelines) {
+    SDL_ReleaseGPUGraphicsPipeline(device(), pipeline);
+    pipeline = nullptr;
+  }
+  viewAtlas.color.destroy();
+  viewAtlas.depth.destroy();
 
   gBuffer.normalMap.destroy();
+  gBuffer.instanceIdMap.destroy();
   ssaoPass.release();
   shadowPass.release();
+  m_transformBuffer.release();
 }
 
 SDL_GPUGraphicsPipeline *RobotScene::createPipeline(
     const MeshLayout &layout, SDL_GPUTextureFormat render_target_format,
-    SDL_GPUTextureFormat depth_stencil_format, PipelineType type) {
+    SDL_GPUTextureFormat depth_stencil_format, PipelineType type,
+    bool offscreen) {
 
   SDL_assert(validateMeshLayout(layout));
 
@@ -415,20 +977,21 @@ SDL_GPUGraphicsPipeline *RobotScene::createPipeline(
   auto fragmentShader =
       Shader::fromMetadata(device(), pipe_config.fragment_shader_path);
 
-  SDL_GPUColorTargetDescription color_targets[2];
+  SDL_GPUColorTargetDescription color_targets[3];
   SDL_zero(color_targets);
   color_targets[0].format = render_target_format;
-  bool had_prepass =
-      (type == PIPELINE_TRIANGLEMESH) && m_config.triangle_has_prepass;
+  bool had_prepass = !offscreen && (type == PIPELINE_TRIANGLEMESH) &&
+                     m_config.triangle_has_prepass;
   SDL_GPUCompareOp depth_compare_op = SDL_GPU_COMPAREOP_LESS_OR_EQUAL;
   SDL_Log("Pipeline type %s uses depth compare op %s (prepass: %d)",
           magic_enum::enum_name(type).data(),
           magic_enum::enum_name(depth_compare_op).data(), had_prepass);
 
   Uint32 num_color_targets = 1;
-  if (type == PIPELINE_TRIANGLEMESH && m_config.enable_normal_target) {
-    num_color_targets = 2;
+  if (type == PIPELINE_TRIANGLEMESH && !offscreen) {
+    num_color_targets += numGBufferTargets();
     color_targets[1].format = gBuffer.normalMap.format();
+    color_targets[2].format = gBuffer.instanceIdMap.format();
   }
 
   SDL_GPUGraphicsPipelineCreateInfo desc{
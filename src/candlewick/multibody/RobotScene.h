@@ -5,7 +5,12 @@
 #include "../core/Scene.h"
 #include "../core/LightUniforms.h"
 #include "../core/Collision.h"
+#include "../core/Culling.h"
+#include "../core/PoseInterpolation.h"
+#include "../core/TransformBatch.h"
+#include "../core/TransformBuffer.h"
 #include "../core/DepthAndShadowPass.h"
+#include "../core/FrameArena.h"
 #include "../core/Texture.h"
 #include "../posteffects/SSAO.h"
 #include "../utils/MeshData.h"
@@ -15,8 +20,15 @@
 #include <coal/fwd.hh>
 #include <pinocchio/multibody/fwd.hpp>
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+
 namespace candlewick {
 
+struct MeshMaterialComponent;
+struct HighlightComponent;
+
 namespace multibody {
 
   void updateRobotTransforms(entt::registry &registry,
@@ -32,8 +44,31 @@ namespace multibody {
     };
     static constexpr size_t kNumPipelineTypes =
         magic_enum::enum_count<PipelineType>();
-    enum VertexUniformSlots : Uint32 { TRANSFORM = 0 };
-    enum FragmentUniformSlots : Uint32 { MATERIAL = 0, LIGHTING = 1 };
+    enum VertexUniformSlots : Uint32 {
+      /// MVP matrix, for pipelines other than triangle meshes.
+      TRANSFORM = 0,
+      /// Index of the object in the TransformBuffer, for triangle meshes.
+      OBJECT_INDEX = 0,
+      /// View and projection matrices of the pass, for triangle meshes.
+      VIEW = 1,
+    };
+    enum FragmentUniformSlots : Uint32 {
+      MATERIAL = 0,
+      LIGHTING = 1,
+      EFFECTS = 2,
+      INSTANCE_ID = 3
+    };
+
+    /// \brief Value written to the instance ID target by each object.
+    enum class InstanceIdSource {
+      /// The object's entity identifier, plus one.
+      ENTITY,
+      /// The pinocchio geometry index, plus one. Environment objects, which
+      /// have no geometry index, are written as the background.
+      GEOM_INDEX,
+    };
+    /// Instance ID of pixels not covered by any object.
+    static constexpr Uint32 INSTANCE_ID_BACKGROUND = 0u;
 
     /// Map hpp-fcl/coal collision geometry to desired pipeline type.
     static PipelineType pinGeomToPipeline(const coal::CollisionGeometry &geom);
@@ -79,18 +114,106 @@ namespace multibody {
       bool enable_ssao = true;
       bool triangle_has_prepass = false;
       bool enable_normal_target = false;
+      /// Write per-object IDs to GBuffer::instanceIdMap in the PBR pass. This
+      /// also enables the normal target, which comes before it.
+      bool enable_instance_id_target = false;
+      InstanceIdSource instance_id_source = InstanceIdSource::GEOM_INDEX;
+      /// Build a TriangleBvh of the triangle meshes when loading them, and
+      /// attach it to their entities as a PickingMeshComponent, for exact
+      /// SceneQuery ray casts.
+      bool build_picking_meshes = true;
       SDL_GPUSampleCount msaa_samples = SDL_GPU_SAMPLECOUNT_1;
       ShadowPassConfig shadow_config;
+      ssao::SsaoConfig ssao_config;
+    };
+
+    /// \brief Offscreen targets for renderViews().
+    struct ViewAtlasConfig {
+      Uint32 view_width;
+      Uint32 view_height;
+      Uint32 num_views;
+      SDL_GPUTextureFormat color_format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+    };
+
+    /// \brief Color and depth atlases holding the views rendered by
+    /// renderViews(), laid out in a grid. View \f$i\f$ is the tile at column
+    /// \f$i \bmod c\f$ and row \f$\lfloor i / c \rfloor\f$ where \f$c\f$ is
+    /// the number of columns.
+    struct ViewAtlas {
+      Texture color{NoInit};
+      Texture depth{NoInit};
+      Uint32 view_width = 0;
+      Uint32 view_height = 0;
+      Uint32 num_views = 0;
+      Uint32 columns = 0;
+      /// Pipelines for the atlas formats, without G-buffer targets.
+      SDL_GPUGraphicsPipeline *pipelines[kNumPipelineTypes]{};
+
+      bool initialized() const { return color.hasValue(); }
+      /// Pixel rectangle of view \p index in the atlas.
+      SDL_Rect viewRect(Uint32 index) const {
+        return {int(index % columns * view_width),
+                int(index / columns * view_height), int(view_width),
+                int(view_height)};
+      }
+    };
+
+    /// \brief Counters returned by renderViews(), summed over the views.
+    struct ViewCullStats {
+      Uint32 drawn = 0;
+      Uint32 culled = 0;
     };
 
     RobotScene(entt::registry &registry, const Renderer &renderer,
                const pin::GeometryModel &geom_model,
                const pin::GeometryData &geom_data, Config config);
 
+    /// \brief Update the robot transforms from the placements of the
+    /// referenced GeometryData.
+    ///
+    /// Placements are converted to float as a batch, and only the transforms
+    /// of the geometries which moved since the last call are written.
     void updateTransforms();
 
+    /// \brief Record the placements of the referenced GeometryData as the
+    /// latest keyframe for interpolation, at time \p timestamp (in seconds).
+    /// The previous latest keyframe becomes the first one.
+    ///
+    /// This is meant for states arriving at a lower rate than the display
+    /// rate: forward kinematics only runs at the state rate, and
+    /// updateTransformsInterpolated() smooths the motion in between.
+    void pushPlacementKeyframe(double timestamp);
+
+    /// \brief Time between the last two keyframes, or 0 if there are fewer
+    /// than two.
+    double keyframeInterval() const;
+
+    /// \brief Set the robot transforms to the placements interpolated between
+    /// the last two keyframes at time \p t, clamped to the keyframe interval.
+    ///
+    /// Rotations are interpolated with slerp and translations linearly, for
+    /// all geometries at once.
+    /// \returns Whether \p t is before the latest keyframe, i.e. whether the
+    /// transforms will change at a later time.
+    bool updateTransformsInterpolated(double t);
+
+    /// \brief Upload the transforms of all objects to the transform buffer,
+    /// with their HighlightComponent tints.
+    /// Call once per frame, after updating the transforms and before any
+    /// render pass of the scene (including shadow and depth pre-passes).
+    void uploadTransforms(CommandBuffer &command_buffer);
+    /// \brief Per-frame storage buffer of object transforms, read by the
+    /// triangle mesh, depth and shadow pipelines.
+    const TransformBuffer &transformBuffer() const { return m_transformBuffer; }
+
+    /// \brief Collect the shadow castables of the frame, in the frame arena
+    /// of the renderer.
+    /// \warning Call uploadTransforms() first: castables refer to the
+    /// transform buffer.
     void collectOpaqueCastables();
-    const std::vector<OpaqueCastable> &castables() const { return m_castables; }
+    /// \brief Castables of the last collectOpaqueCastables() call, valid
+    /// until the frame arena reuses their frame.
+    std::span<const OpaqueCastable> castables() const { return m_castables; }
 
     entt::entity
     addEnvironmentObject(MeshData &&data, Mat4f placement,
@@ -103,11 +226,56 @@ namespace multibody {
     }
 
     void clearEnvironment();
+    /// \brief Destroy the geometries of the visual and collision models,
+    /// and the cached meshes.
     void clearRobotGeometries();
 
-    [[nodiscard]] SDL_GPUGraphicsPipeline *createPipeline(
-        const MeshLayout &layout, SDL_GPUTextureFormat render_target_format,
-        SDL_GPUTextureFormat depth_stencil_format, PipelineType type);
+    /// \brief Reference the collision model to draw with
+    /// showCollisionModel(), and its data. Geometries of a previous collision
+    /// model are destroyed.
+    ///
+    /// The geometries are only loaded when the model is first shown. Their
+    /// meshes are shared with the geometries already loaded which have the
+    /// same mesh file and scale, or the same coal geometry: usually, the
+    /// visual model.
+    /// \warning \p coll_model and \p coll_data must outlive the scene.
+    void setCollisionModel(const pin::GeometryModel &coll_model,
+                           const pin::GeometryData &coll_data);
+    bool hasCollisionModel() const { return m_collModel != nullptr; }
+    const pin::GeometryModel *collisionModel() const { return m_collModel; }
+    const pin::GeometryData *collisionData() const { return m_collData; }
+
+    /// \brief Show or hide the collision model, loading its geometries the
+    /// first time it is shown.
+    ///
+    /// Shown collision geometries are placed by updateTransforms() and
+    /// updateTransformsInterpolated() at the placements of the collision
+    /// GeometryData, which are not interpolated. Update them with e.g.
+    /// pinocchio::updateGeometryPlacements().
+    void showCollisionModel(bool show);
+    bool collisionModelShown() const { return m_showCollision; }
+    /// \brief Show or hide the geometries of the visual model.
+    void showVisualModel(bool show);
+    bool visualModelShown() const { return m_showVisual; }
+
+    /// \brief Highlight the collision geometries of the colliding pairs of
+    /// the collision GeometryData with \p color, i.e. the pairs whose
+    /// collision result has contacts (see pinocchio::computeCollisions()).
+    /// Highlights of the other collision geometries are removed.
+    ///
+    /// Highlights are HighlightComponent tints, uploaded with the transforms.
+    /// \returns The number of colliding pairs.
+    Uint32 highlightCollisions(const Float4 &color);
+    /// \brief Remove the highlights of the collision geometries.
+    void clearCollisionHighlights();
+
+    /// \param offscreen Build a pipeline for renderViews(): no G-buffer
+    /// targets, and no depth prepass.
+    [[nodiscard]] SDL_GPUGraphicsPipeline *
+    createPipeline(const MeshLayout &layout,
+                   SDL_GPUTextureFormat render_target_format,
+                   SDL_GPUTextureFormat depth_stencil_format, PipelineType type,
+                   bool offscreen = false);
 
     /// \warning Call updateRobotTransforms() before rendering the objects with
     /// this function.
@@ -118,12 +286,42 @@ namespace multibody {
     /// \brief Render pass for other geometry.
     void renderOtherGeometry(CommandBuffer &command_buffer,
                              const Camera &camera);
+
+    /// \brief Create the offscreen atlas and pipelines used by renderViews().
+    void initViewAtlas(const ViewAtlasConfig &config);
+
+    /// \brief Render several cameras into the tiles of the view atlas, in a
+    /// single render pass.
+    ///
+    /// The world-space bounds of the objects, the shadow map and the materials
+    /// are shared by all views; each pipeline is bound once. Objects are
+    /// frustum-culled per view, using their LocalBoundsComponent. The SSAO
+    /// and G-buffer targets of the main view are not used.
+    /// \warning Call updateRobotTransforms(), and render the shadow map if
+    /// enabled, before calling this. There can be at most
+    /// ViewAtlasConfig::num_views cameras: more terminates the program.
+    ViewCullStats renderViews(CommandBuffer &command_buffer,
+                              std::span<const Camera> cameras);
     void release();
 
     Config &config() { return m_config; }
     const Config &config() const { return m_config; }
     inline bool pbrHasPrepass() const { return m_config.triangle_has_prepass; }
     inline bool shadowsEnabled() const { return m_config.enable_shadows; }
+    /// Number of GBuffer color targets written by the PBR pass.
+    Uint32 numGBufferTargets() const {
+      if (m_config.enable_instance_id_target)
+        return 2u;
+      return m_config.enable_normal_target ? 1u : 0u;
+    }
+
+    /// \brief Instance ID written for the given entity, following
+    /// Config::instance_id_source.
+    Uint32 instanceIdForEntity(entt::entity entity) const;
+    /// \brief Entity corresponding to an instance ID read back from
+    /// GBuffer::instanceIdMap, or `entt::null` for the background. This is a
+    /// direct lookup, cheap enough to run per pixel.
+    entt::entity entityFromInstanceId(Uint32 instance_id) const;
 
     /// \brief Getter for the referenced pinocchio GeometryModel object.
     const pin::GeometryModel &geomModel() const { return m_geomModel; }
@@ -141,18 +339,75 @@ namespace multibody {
     DirectionalLight directionalLight;
     ssao::SsaoPass ssaoPass{NoInit};
     struct GBuffer {
+      /// View-space normals (xy components), `R16G16_FLOAT`.
       Texture normalMap{NoInit};
+      /// Per-object segmentation IDs, `R32_UINT`. Only created if
+      /// Config::enable_instance_id_target is set.
+      Texture instanceIdMap{NoInit};
     } gBuffer;
     ShadowPassInfo shadowPass;
     AABB worldSpaceBounds;
+    ViewAtlas viewAtlas;
 
   private:
+    struct DrawItem {
+      const Mat4f *transform;
+      Uint32 transformIndex;
+      const MeshMaterialComponent *meshMaterial;
+      const HighlightComponent *highlight;
+      BoundingBox worldBounds;
+      bool cullable;
+    };
+    /// GPU mesh of a geometry object, with the data needed by its entities.
+    struct MeshAsset {
+      std::shared_ptr<const Mesh> mesh;
+      std::vector<PbrMaterial> materials;
+      BoundingBox bounds;
+      PipelineType pipelineType;
+      /// Null unless Config::build_picking_meshes is set.
+      std::shared_ptr<const TriangleBvh> pickingMesh;
+      /// Geometry the meshes were loaded from, whose address may be part of
+      /// the cache key.
+      std::shared_ptr<const coal::CollisionGeometry> geometry;
+    };
+    /// Gather the visible objects and their world-space bounds.
+    void collectDrawItems();
+    /// Load the meshes of \p geom_obj, or get them from the cache.
+    const MeshAsset &loadMeshAsset(const pin::GeometryObject &geom_obj);
+    /// Create the render entity of a geometry object, and the pipelines and
+    /// passes its type needs.
+    entt::entity createGeometryEntity(const pin::GeometryObject &geom_obj);
+    void createPipelinesForType(const MeshLayout &layout, PipelineType type);
+    void loadCollisionGeometries();
+    void updateCollisionTransforms();
+
     entt::registry &m_registry;
     Config m_config;
     const Renderer &m_renderer;
     std::reference_wrapper<pin::GeometryModel const> m_geomModel;
     std::reference_wrapper<pin::GeometryData const> m_geomData;
-    std::vector<OpaqueCastable> m_castables;
+    // transient, allocated in the frame arena of the renderer
+    FrameVector<OpaqueCastable> m_castables;
+    FrameVector<DrawItem> m_drawItems[kNumPipelineTypes];
+    FrameVector<FrustumPlanes> m_viewFrustums;
+    // robot geometry entities, by geometry index
+    std::vector<entt::entity> m_geomEntities;
+    // collision model, and its entities once loaded
+    const pin::GeometryModel *m_collModel = nullptr;
+    const pin::GeometryData *m_collData = nullptr;
+    std::vector<entt::entity> m_collisionEntities;
+    bool m_showCollision = false;
+    bool m_showVisual = true;
+    // meshes by file and scale, or coal geometry
+    std::unordered_map<std::string, MeshAsset> m_meshCache;
+    TransformBatch m_transformBatch;
+    TransformBuffer m_transformBuffer{NoInit};
+    // the two last keyframes; m_latestKeyframe indexes the latest one
+    PoseArray m_keyframes[2];
+    double m_keyframeTimes[2]{0., 0.};
+    Uint32 m_numKeyframes = 0;
+    Uint32 m_latestKeyframe = 0;
+    PoseArray m_interpolatedPoses;
   };
   static_assert(Scene<RobotScene>);
 
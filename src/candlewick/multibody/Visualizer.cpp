@@ -1,40 +1,144 @@
 #include "Visualizer.h"
+#include "../core/AllocationCounter.h"
 #include "../core/Device.h"
 #include "../core/CameraControls.h"
 #include "../core/DepthAndShadowPass.h"
 #include "../primitives/Plane.h"
+#include "CollisionDebug.h"
 #include "RobotDebug.h"
 
+#include <pinocchio/algorithm/frames.hpp>
+#include <pinocchio/algorithm/geometry.hpp>
+#include <pinocchio/algorithm/joint-configuration.hpp>
+#include <pinocchio/algorithm/kinematics.hpp>
+#include <SDL3/SDL_timer.h>
+#include <SDL3/SDL_video.h>
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <utility>
+
 namespace candlewick::multibody {
 
+/// Size the state buffers once, so that publishing does not allocate.
+static VisualizerState initialState(const pin::Data &data,
+                                    const pin::GeometryData &geom_data) {
+  return {
+      .jointPlacements = {data.oMi.begin(), data.oMi.end()},
+      .jointVelocities = {data.v.begin(), data.v.end()},
+      .geometryPlacements = {geom_data.oMg.begin(), geom_data.oMg.end()},
+  };
+}
+
+/// Construct \p renderer again in place, Renderer being neither movable nor
+/// assignable. The placeholder is destroyed first, so that its frame arena is
+/// released; if construction fails, the placeholder is restored.
+template <typename... Args>
+static void emplaceRenderer(Renderer &renderer, Args &&...args) {
+  std::destroy_at(&renderer);
+  try {
+    std::construct_at(&renderer, std::forward<Args>(args)...);
+  } catch (...) {
+    std::construct_at(&renderer, NoInit);
+    throw;
+  }
+}
+
 Visualizer::Visualizer(const Config &config, const pin::Model &model,
                        const pin::GeometryModel &visual_model,
                        GuiSystem::GuiBehavior gui_callback)
     : BaseVisualizer(model, visual_model), registry{}, renderer{NoInit},
-      guiSystem{NoInit, std::move(gui_callback)} {
-  if (!SDL_Init(SDL_INIT_VIDEO)) {
-    throw std::runtime_error(
-        std::format("Failed to init video: {}", SDL_GetError()));
+      guiSystem{NoInit, std::move(gui_callback)},
+      m_interpolateStates(config.interpolate_states), m_renderData(model),
+      m_renderGeomData(visual_model),
+      m_state(initialState(m_renderData, m_renderGeomData)) {
+  if (!config.asynchronous) {
+    initRenderContext(config);
+    return;
   }
 
-  SDL_Log("Video driver: %s", SDL_GetCurrentVideoDriver());
-  ::new (&renderer) Renderer{Device{auto_detect_shader_format_subset()},
-                             Window{"Candlewick Pinocchio visualizer",
-                                    int(config.width), int(config.height), 0},
-                             config.depth_stencil_format};
+  // the window, device and scenes are created by the render thread, which
+  // owns them for their whole lifetime
+  std::promise<void> ready;
+  std::future<void> ready_future = ready.get_future();
+  m_renderThread =
+      std::thread{[this, config, ready = std::move(ready)]() mutable {
+        try {
+          initRenderContext(config);
+        } catch (...) {
+          ready.set_exception(std::current_exception());
+          return;
+        }
+        ready.set_value();
+        renderLoop();
+        releaseRenderContext();
+      }};
+  try {
+    ready_future.get();
+  } catch (...) {
+    m_renderThread.join();
+    throw;
+  }
+}
+
+void Visualizer::initRenderContext(const Config &config) {
+  if (config.headless) {
+    // no video subsystem required
+    emplaceRenderer(renderer, Device{auto_detect_shader_format_subset()},
+                    OffscreenTargetInfo{config.width, config.height,
+                                        config.offscreen_format},
+                    config.depth_stencil_format);
+  } else {
+    if (!SDL_Init(SDL_INIT_VIDEO)) {
+      throw std::runtime_error(
+          std::format("Failed to init video: {}", SDL_GetError()));
+    }
+
+    SDL_Log("Video driver: %s", SDL_GetCurrentVideoDriver());
+    emplaceRenderer(renderer, Device{auto_detect_shader_format_subset()},
+                    Window{"Candlewick Pinocchio visualizer", int(config.width),
+                           int(config.height), 0},
+                    config.depth_stencil_format);
+    if (config.present_mode != SDL_GPU_PRESENTMODE_VSYNC) {
+      if (SDL_WindowSupportsGPUPresentMode(renderer.device, renderer.window,
+                                           config.present_mode)) {
+        SDL_SetGPUSwapchainParameters(renderer.device, renderer.window,
+                                      SDL_GPU_SWAPCHAINCOMPOSITION_SDR,
+                                      config.present_mode);
+      } else {
+        SDL_Log("Present mode %d not supported, using VSYNC.",
+                int(config.present_mode));
+      }
+    }
+    const SDL_DisplayMode *mode = SDL_GetCurrentDisplayMode(
+        SDL_GetDisplayForWindow(renderer.window));
+    if (mode && mode->refresh_rate > 0.f)
+      m_idlePeriodNs = Uint64(1e9f / mode->refresh_rate);
+  }
+  if (config.max_fps > 0.f) {
+    m_minFramePeriodNs = Uint64(1e9f / config.max_fps);
+    m_idlePeriodNs = std::max(m_idlePeriodNs, m_minFramePeriodNs);
+  }
+  m_skipIdleFrames = config.skip_idle_frames;
 
   RobotScene::Config rconfig;
   rconfig.enable_shadows = true;
-  robotScene.emplace(registry, renderer, visualModel(), visualData(), rconfig);
+  robotScene.emplace(registry, renderer, visualModel(), m_renderGeomData,
+                     rconfig);
   debugScene.emplace(registry, renderer);
-  debugScene->addSystem<RobotDebugSystem>(m_model, data());
+  debugScene->addSystem<RobotDebugSystem>(m_model, m_renderData);
+  m_contactSystem = &debugScene->addSystem<ContactDebugSystem>();
+  // shown along with the collision model
+  m_collisionSystem = &debugScene->addSystem<CollisionDebugSystem>(*robotScene);
+  m_collisionSystem->enable = false;
 
   robotScene->directionalLight = {
       .direction = {0., -1., -1.},
       .color = {1.0, 1.0, 1.0},
       .intensity = 8.0,
   };
-  guiSystem.init(renderer);
+  if (!renderer.headless())
+    guiSystem.init(renderer);
 
   robotScene->worldSpaceBounds.update({-1., -1., 0.}, {+1., +1., 1.});
 
@@ -46,6 +150,10 @@ Visualizer::Visualizer(const Config &config, const pin::Model &model,
     debugScene->addTriad();
   }
   this->resetCamera();
+  m_lastCamera = controller.camera;
+  m_lastLight = robotScene->directionalLight;
+  // render the initial state at least once
+  m_pendingFrames = 1;
 }
 
 void Visualizer::resetCamera() {
@@ -54,7 +162,7 @@ void Visualizer::resetCamera() {
   Float3 eye{std::cos(xy_plane_view_angle), std::sin(xy_plane_view_angle),
              0.5f};
   eye *= radius;
-  auto [w, h] = renderer.window.size();
+  auto [w, h] = renderer.size();
   float aspectRatio = float(w) / float(h);
   controller.lookAt(eye, {0., 0., 0.});
   controller.camera.projection =
@@ -64,52 +172,360 @@ void Visualizer::resetCamera() {
 void Visualizer::loadViewerModel() {}
 
 void Visualizer::setCameraTarget(const Eigen::Ref<const Vector3> &target) {
-  controller.lookAt1(target.cast<float>());
+  runOnRenderThread(
+      [this, target = Float3{target.cast<float>()}] {
+        controller.lookAt1(target);
+      });
 }
 
 void Visualizer::setCameraPosition(const Eigen::Ref<const Vector3> &position) {
-  auto &camera = controller.camera;
-  camera_util::setWorldPosition(camera, position.cast<float>());
+  runOnRenderThread([this, position = Float3{position.cast<float>()}] {
+    camera_util::setWorldPosition(controller.camera, position);
+  });
 }
 
 void Visualizer::setCameraPose(const Eigen::Ref<const Matrix4> &pose) {
-  auto &camera = controller.camera;
-  camera.view = pose.cast<float>().inverse();
+  runOnRenderThread([this, pose = Mat4f{pose.cast<float>()}] {
+    controller.camera.view = pose.inverse();
+  });
+}
+
+void Visualizer::runOnRenderThread(std::function<void()> command) {
+  if (!asynchronous()) {
+    command();
+    return;
+  }
+  std::lock_guard lock{m_commandMutex};
+  m_commands.push_back(std::move(command));
+}
+
+void Visualizer::setCollisionModel(const pin::GeometryModel &coll_model,
+                                   const pin::GeometryData &coll_data) {
+  m_collisionData = &coll_data;
+  runOnRenderThread([this, &coll_model] {
+    m_renderCollData.emplace(coll_model);
+    robotScene->setCollisionModel(coll_model, *m_renderCollData);
+  });
+}
+
+void Visualizer::showCollisionModel(bool show) {
+  runOnRenderThread([this, show] {
+    robotScene->showCollisionModel(show);
+    m_collisionSystem->enable = show;
+    // redraw the overlay without waiting for the next state, once per frame
+    m_debugSceneDirty = true;
+  });
+}
+
+#ifdef CANDLEWICK_WITH_SHARED_STATE
+void Visualizer::attachSharedState(const std::string &name) {
+  auto reader = std::make_shared<SharedStateReader>(name);
+  reader->checkDim(Uint32(m_model.nq), Uint32(visualModel().ngeoms));
+  runOnRenderThread([this, reader] {
+    m_sharedSample.resize(reader->dim());
+    // no previous sample to estimate velocities from
+    m_sharedPrevQ.resize(0);
+    m_sharedState = std::move(*reader);
+  });
+}
+
+void Visualizer::detachSharedState() {
+  runOnRenderThread([this] { m_sharedState.release(); });
+}
+
+void Visualizer::reopenSharedState() {
+  try {
+    SharedStateReader reader{m_sharedState.name()};
+    reader.checkDim(Uint32(m_model.nq), Uint32(visualModel().ngeoms));
+    m_sharedState = std::move(reader);
+    m_sharedPrevQ.resize(0);
+    SDL_Log("Reopened shared state '%s'.", m_sharedState.name().c_str());
+  } catch (const std::invalid_argument &e) {
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s Detaching shared state.",
+                 e.what());
+    m_sharedState.release();
+  } catch (const std::runtime_error &) {
+    // not created again yet: retry on the next frame
+  }
+}
+
+bool Visualizer::readSharedState() {
+  double timestamp;
+  if (m_sharedState.initialized() && m_sharedState.stale())
+    reopenSharedState();
+  if (!m_sharedState.initialized() ||
+      !m_sharedState.readLatest(m_sharedSample, timestamp))
+    return false;
+
+  if (m_sharedState.kind() == SharedStateKind::CONFIGURATION) {
+    const Eigen::Map<const Eigen::VectorXd> q{m_sharedSample.data(),
+                                              m_model.nq};
+    // samples have no velocities: estimate them from the previous sample,
+    // so that the joint velocities match the configuration
+    const double dt = timestamp - m_sharedPrevTime;
+    if (m_sharedPrevQ.size() == q.size() && dt > 0.) {
+      pin::difference(m_model, m_sharedPrevQ, q, m_sharedVelocity);
+      m_sharedVelocity /= dt;
+    } else {
+      m_sharedVelocity.setZero(m_model.nv);
+    }
+    m_sharedPrevQ = q;
+    m_sharedPrevTime = timestamp;
+    pin::forwardKinematics(m_model, m_renderData, q, m_sharedVelocity);
+    pin::updateGeometryPlacements(m_model, m_renderData, visualModel(),
+                                  m_renderGeomData);
+  } else {
+    // placements say nothing of the joint velocities
+    std::fill(m_renderData.v.begin(), m_renderData.v.end(),
+              pin::Motion::Zero());
+    const double *M = m_sharedSample.data();
+    for (pin::SE3 &oMg : m_renderGeomData.oMg) {
+      // row-major 3x4 [R | p]
+      oMg.rotation() = Eigen::Map<const Eigen::Matrix<double, 3, 3,
+                                                      Eigen::RowMajor>,
+                                  0, Eigen::OuterStride<4>>{M};
+      oMg.translation() << M[3], M[7], M[11];
+      M += 12;
+    }
+  }
+  return true;
+}
+#endif
+
+VisualizerStats Visualizer::stats() const noexcept {
+  return {
+      .published = m_statesPublished.load(std::memory_order_relaxed),
+      .rendered = m_statesRendered.load(std::memory_order_relaxed),
+      .frames = m_framesRendered.load(std::memory_order_relaxed),
+      .lastLatencyNs = m_lastLatencyNs.load(std::memory_order_relaxed),
+      .avgLatencyNs = m_avgLatencyNs.load(std::memory_order_relaxed),
+      .skippedFrames = m_framesSkipped.load(std::memory_order_relaxed),
+      .frameAllocations = m_frameAllocations.load(std::memory_order_relaxed),
+      .frameArenaHighWater =
+          m_frameArenaHighWater.load(std::memory_order_relaxed),
+      .renderCommands = m_renderCommands.load(std::memory_order_relaxed),
+      .skippedRenderCommands =
+          m_skippedRenderCommands.load(std::memory_order_relaxed),
+  };
 }
 
 Visualizer::~Visualizer() {
+  if (m_renderThread.joinable()) {
+    m_stopRequested.store(true, std::memory_order_relaxed);
+    m_renderThread.join();
+  } else {
+    releaseRenderContext();
+  }
+}
+
+void Visualizer::releaseRenderContext() {
   robotScene->release();
   debugScene->release();
-  guiSystem.release();
+  if (guiSystem.initialized())
+    guiSystem.release();
   renderer.destroy();
   SDL_Quit();
 }
 
 void Visualizer::displayImpl() {
-  this->processEvents();
+  // display() computed the placements in data() and visualData() on this
+  // thread: copy them out, without allocating.
+  VisualizerState &state = m_state.writeBuffer();
+  const pin::Data &pin_data = data();
+  const pin::GeometryData &geom_data = visualData();
+  std::copy(pin_data.oMi.begin(), pin_data.oMi.end(),
+            state.jointPlacements.begin());
+  std::copy(pin_data.v.begin(), pin_data.v.end(),
+            state.jointVelocities.begin());
+  // the geometry model can grow, e.g. if geometries were added
+  state.geometryPlacements.assign(geom_data.oMg.begin(), geom_data.oMg.end());
+  if (m_collisionData) {
+    // results with contacts may allocate, unlike the placements
+    const pin::GeometryData &coll_data = *m_collisionData;
+    state.collisionPlacements.assign(coll_data.oMg.begin(),
+                                     coll_data.oMg.end());
+    state.collisionResults.assign(coll_data.collisionResults.begin(),
+                                  coll_data.collisionResults.end());
+    state.distanceResults.assign(coll_data.distanceResults.begin(),
+                                 coll_data.distanceResults.end());
+    state.activeCollisionPairs.assign(
+        coll_data.activeCollisionPairs.begin(),
+        coll_data.activeCollisionPairs.end());
+  }
+  state.publishTimeNs = SDL_GetTicksNS();
+  m_state.publish();
+  m_statesPublished.fetch_add(1, std::memory_order_relaxed);
+
+  if (!asynchronous())
+    renderFrame();
+}
+
+void Visualizer::renderLoop() {
+  while (!m_stopRequested.load(std::memory_order_relaxed) && !m_shouldExit) {
+    if (m_minFramePeriodNs > 0) {
+      const Uint64 deadline = m_lastFrameNs + m_minFramePeriodNs;
+      const Uint64 now = SDL_GetTicksNS();
+      if (now < deadline)
+        SDL_DelayPrecise(deadline - now);
+    }
+    // when idle, poll for changes at the display rate
+    if (!renderFrame())
+      SDL_DelayNS(m_idlePeriodNs);
+  }
+}
+
+bool Visualizer::viewChanged() const {
+  const Camera &camera = controller.camera;
+  const DirectionalLight &light = robotScene->directionalLight;
+  return camera.view.matrix() != m_lastCamera.view.matrix() ||
+         camera.projection != m_lastCamera.projection ||
+         light.direction != m_lastLight.direction ||
+         light.color != m_lastLight.color ||
+         light.intensity != m_lastLight.intensity;
+}
+
+bool Visualizer::renderFrame() {
+  // ImGui needs a few frames to settle after an input
+  constexpr Uint32 gui_settle_frames = 3;
+  {
+    std::lock_guard lock{m_commandMutex};
+    m_runningCommands.swap(m_commands);
+  }
+  bool changed = !m_runningCommands.empty();
+  for (auto &command : m_runningCommands)
+    command();
+  m_runningCommands.clear();
+  if (m_redrawRequested.exchange(false, std::memory_order_relaxed))
+    changed = true;
+
+  if (this->processEvents())
+    m_pendingFrames = gui_settle_frames;
+
+  // over the frame rate cap, leave the latest state in its buffer: it is
+  // consumed by the next frame which renders
+  const Uint64 now_ns = SDL_GetTicksNS();
+  if (m_minFramePeriodNs > 0 && now_ns < m_lastFrameNs + m_minFramePeriodNs) {
+    if (changed)
+      m_pendingFrames = std::max(m_pendingFrames, 1u);
+    m_framesSkipped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  const bool new_state = m_state.consume();
+  const VisualizerState &state = m_state.readBuffer();
+  if (new_state) {
+    std::copy(state.jointPlacements.begin(), state.jointPlacements.end(),
+              m_renderData.oMi.begin());
+    std::copy(state.jointVelocities.begin(), state.jointVelocities.end(),
+              m_renderData.v.begin());
+    m_renderGeomData.oMg.assign(state.geometryPlacements.begin(),
+                                state.geometryPlacements.end());
+    // states published before setCollisionModel() have no collision data
+    if (m_renderCollData &&
+        state.collisionPlacements.size() == m_renderCollData->oMg.size()) {
+      pin::GeometryData &coll_data = *m_renderCollData;
+      coll_data.oMg.assign(state.collisionPlacements.begin(),
+                           state.collisionPlacements.end());
+      coll_data.collisionResults.assign(state.collisionResults.begin(),
+                                        state.collisionResults.end());
+      coll_data.distanceResults.assign(state.distanceResults.begin(),
+                                       state.distanceResults.end());
+      coll_data.activeCollisionPairs.assign(
+          state.activeCollisionPairs.begin(),
+          state.activeCollisionPairs.end());
+    }
+    m_pendingPublishNs = state.publishTimeNs;
+  }
+  bool new_shared_state = false;
+#ifdef CANDLEWICK_WITH_SHARED_STATE
+  // an external process has the last word over display()
+  new_shared_state = readSharedState();
+#endif
+  if (new_state || new_shared_state) {
+    changed = true;
+    // frame placements are only needed for rendering: compute them here
+    // rather than in display()
+    pin::updateFramePlacements(m_model, m_renderData);
+
+    m_debugSceneDirty = true;
+    if (m_interpolateStates) {
+      // shared states are timed on arrival, producer clocks may differ
+      const Uint64 time_ns = new_shared_state ? now_ns : state.publishTimeNs;
+      robotScene->pushPlacementKeyframe(1e-9 * double(time_ns));
+    } else {
+      robotScene->updateTransforms();
+    }
+  }
+  // the debug systems append their primitives: update them once per frame
+  if (std::exchange(m_debugSceneDirty, false)) {
+    changed = true;
+    debugScene->update();
+  }
+  if (m_interpolateStates) {
+    // render one state interval in the past, between the last two states
+    const double t = 1e-9 * double(now_ns) - robotScene->keyframeInterval();
+    changed |= robotScene->updateTransformsInterpolated(t);
+  }
+  if (changed || viewChanged())
+    m_pendingFrames = std::max(m_pendingFrames, 1u);
+
+  // offscreen frames are only worth rendering if something changed
+  const bool idle = m_pendingFrames == 0 &&
+                    (m_skipIdleFrames || renderer.headless());
+  if (idle) {
+    m_framesSkipped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
 
-  debugScene->update();
-  robotScene->updateTransforms();
   render();
+  m_lastFrameNs = now_ns;
+  m_lastCamera = controller.camera;
+  m_lastLight = robotScene->directionalLight;
+  if (m_pendingFrames > 0)
+    m_pendingFrames--;
+
+  m_framesRendered.fetch_add(1, std::memory_order_relaxed);
+  if (m_pendingPublishNs != 0) {
+    const Uint64 latency = SDL_GetTicksNS() - m_pendingPublishNs;
+    const Uint64 avg = m_avgLatencyNs.load(std::memory_order_relaxed);
+    m_lastLatencyNs.store(latency, std::memory_order_relaxed);
+    m_avgLatencyNs.store(avg == 0 ? latency : (7 * avg + latency) / 8,
+                         std::memory_order_relaxed);
+    m_statesRendered.fetch_add(1, std::memory_order_relaxed);
+    m_pendingPublishNs = 0;
+  }
+  return true;
 }
 
 void Visualizer::render() {
+  const Uint64 allocations = heapAllocationCount();
 
   CommandBuffer cmdBuf = renderer.acquireCommandBuffer();
   if (renderer.waitAndAcquireSwapchain(cmdBuf)) {
+    robotScene->uploadTransforms(cmdBuf);
     robotScene->collectOpaqueCastables();
     std::span castables = robotScene->castables();
     renderShadowPassFromAABB(cmdBuf, robotScene->shadowPass,
                              robotScene->directionalLight, castables,
+                             robotScene->transformBuffer(),
                              robotScene->worldSpaceBounds);
 
     auto &camera = controller.camera;
     robotScene->render(cmdBuf, camera);
     debugScene->render(cmdBuf, camera);
-    guiSystem.render(cmdBuf);
+    if (guiSystem.initialized())
+      guiSystem.render(cmdBuf);
   }
 
   cmdBuf.submit();
+  m_frameAllocations.store(heapAllocationCount() - allocations,
+                           std::memory_order_relaxed);
+  m_frameArenaHighWater.store(renderer.frameArena.stats().highWaterMark,
+                              std::memory_order_relaxed);
+  m_renderCommands.store(renderer.passStats.commands(),
+                         std::memory_order_relaxed);
+  m_skippedRenderCommands.store(renderer.passStats.skipped(),
+                                std::memory_order_relaxed);
 }
 
 } // namespace candlewick::multibody
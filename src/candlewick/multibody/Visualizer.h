@@ -5,12 +5,24 @@
 #include "../core/CameraControls.h"
 #include "../core/GuiSystem.h"
 #include "../core/DebugScene.h"
+#include "../core/debug/Contacts.h"
 #include "../core/Renderer.h"
+#include "../utils/TripleBuffer.h"
+#ifdef CANDLEWICK_WITH_SHARED_STATE
+#include "../utils/SharedMemoryState.h"
+#endif
 
 #include <pinocchio/visualizers/base-visualizer.hpp>
+#include <pinocchio/multibody/data.hpp>
+#include <pinocchio/multibody/geometry.hpp>
 #include <SDL3/SDL_init.h>
 #include <entt/entity/registry.hpp>
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+
 namespace candlewick::multibody {
 
 namespace {
@@ -35,12 +47,67 @@ struct CameraControlParams {
   } mouseButtons;
 };
 
-/// \brief A Pinocchio robot visualizer. The display() function will perform the
-/// draw calls.
+/// \brief Robot state passed from display() to the render thread.
+struct VisualizerState {
+  std::vector<pin::SE3> jointPlacements;
+  std::vector<pin::Motion> jointVelocities;
+  std::vector<pin::SE3> geometryPlacements;
+  /// Placements and results of the collision model, see
+  /// Visualizer::setCollisionModel(). Empty without a collision model.
+  std::vector<pin::SE3> collisionPlacements;
+  std::vector<coal::CollisionResult> collisionResults;
+  std::vector<coal::DistanceResult> distanceResults;
+  std::vector<bool> activeCollisionPairs;
+  /// Time of the display() call, from SDL_GetTicksNS().
+  Uint64 publishTimeNs = 0;
+};
+
+/// \brief Render thread statistics of the Visualizer.
+struct VisualizerStats {
+  /// Number of states published by display().
+  Uint64 published = 0;
+  /// Number of published states which were rendered. The others were
+  /// overwritten by newer states before the render thread got to them.
+  Uint64 rendered = 0;
+  /// Number of frames submitted by the render thread.
+  Uint64 frames = 0;
+  /// Latency from display() to the submission of the frame showing its
+  /// state, for the last rendered state.
+  Uint64 lastLatencyNs = 0;
+  /// Exponential moving average of the latency.
+  Uint64 avgLatencyNs = 0;
+  /// Number of frames which were not rendered, because nothing changed or
+  /// because of the frame rate cap.
+  Uint64 skippedFrames = 0;
+  /// Heap allocations made while recording the last frame. Only counted
+  /// with the `CANDLEWICK_COUNT_ALLOCATIONS` build option, see
+  /// heapAllocationsCounted().
+  Uint64 frameAllocations = 0;
+  /// Largest size of the transient data of a frame, in bytes, from the
+  /// frame arena of the renderer.
+  Uint64 frameArenaHighWater = 0;
+  /// Render pass commands recorded in the last frame, and commands skipped
+  /// because they were redundant.
+  Uint64 renderCommands = 0;
+  Uint64 skippedRenderCommands = 0;
+};
+
+/// \brief A Pinocchio robot visualizer.
 ///
-/// This visualizer is asynchronous. It will create its render context
-/// (Renderer) in a separate thread along with the GPU device and window, and
-/// run until shouldExit() returns true.
+/// This visualizer is asynchronous: it creates its render context (Renderer,
+/// GPU device and window) in a dedicated render thread, which renders the
+/// latest robot state at its own rate (usually the display refresh rate),
+/// until shouldExit() returns true or the Visualizer is destroyed.
+///
+/// display() only copies the joint and geometry placements into a lock-free
+/// triple buffer and returns, so it can be called from a high-rate control
+/// loop. Unless noted otherwise, other members (renderer, scenes, camera
+/// controller) belong to the render thread: use runOnRenderThread() to
+/// access them from another thread. The GUI callback runs on the render
+/// thread.
+///
+/// On platforms where windows must be handled by the main thread (macOS),
+/// set Config::asynchronous to false: display() then renders synchronously.
 class Visualizer final : public BaseVisualizer {
 public:
   enum EnvElements : int {
@@ -49,6 +116,11 @@ public:
   };
 
   static constexpr Radf DEFAULT_FOV = 55.0_degf;
+#ifdef SDL_PLATFORM_APPLE
+  static constexpr bool DEFAULT_ASYNCHRONOUS = false;
+#else
+  static constexpr bool DEFAULT_ASYNCHRONOUS = true;
+#endif
 
   using BaseVisualizer::setCameraPose;
   entt::registry registry;
@@ -63,6 +135,31 @@ public:
     Uint32 width;
     Uint32 height;
     SDL_GPUTextureFormat depth_stencil_format = SDL_GPU_TEXTUREFORMAT_D16_UNORM;
+    /// Render to an offscreen texture (Renderer::offscreen_texture) without
+    /// opening a window. The GUI and input events are disabled.
+    bool headless = false;
+    SDL_GPUTextureFormat offscreen_format =
+        SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+    /// Render in a dedicated thread. Otherwise, display() renders and waits
+    /// for the swapchain on the caller's thread.
+    bool asynchronous = DEFAULT_ASYNCHRONOUS;
+    /// Interpolate the robot placements between the last two states, for
+    /// smooth motion at the display rate when states arrive at a lower rate
+    /// (e.g. logs or remote simulations). The display then lags one state
+    /// interval behind.
+    bool interpolate_states = false;
+    /// Skip frames when nothing changed since the last rendered frame: robot
+    /// state, camera, lights, GUI input, or commands. The window keeps
+    /// showing the last presented frame. Changes which the Visualizer cannot
+    /// see, e.g. to the scenes' entities, must then call requestRedraw().
+    bool skip_idle_frames = false;
+    /// Present mode of the window. Unsupported modes fall back to
+    /// `SDL_GPU_PRESENTMODE_VSYNC`.
+    SDL_GPUPresentMode present_mode = SDL_GPU_PRESENTMODE_VSYNC;
+    /// Maximum frame rate, 0 for no limit other than the present mode's.
+    /// In synchronous mode, a display() call over the cap does not render:
+    /// its state is rendered by the next call which does.
+    float max_fps = 0.f;
   };
 
   /// \brief Default GUI callback for the Visualizer; provide your own callback
@@ -84,6 +181,8 @@ public:
   ~Visualizer() override;
 
   void displayPrecall() override {}
+  /// \brief Publish the placements computed by display() to the render
+  /// thread. In synchronous mode, also render a frame.
   void displayImpl() override;
 
   void setCameraTarget(const Eigen::Ref<const Vector3> &target) override;
@@ -94,22 +193,153 @@ public:
 
   void enableCameraControl(bool v) override { m_cameraControl = v; }
 
-  void processEvents();
+  /// \brief Process window events. Called by the render thread.
+  /// \returns Whether any event was received.
+  bool processEvents();
 
+  /// \brief Whether the window was closed. Thread-safe.
   bool shouldExit() const noexcept { return m_shouldExit; }
 
+  /// \brief Render the next frame even if skip_idle_frames finds nothing
+  /// changed. Thread-safe.
+  void requestRedraw() noexcept {
+    m_redrawRequested.store(true, std::memory_order_relaxed);
+  }
+
+  bool asynchronous() const noexcept { return m_renderThread.joinable(); }
+
+  /// \brief Run \p command on the render thread, before the next frame. In
+  /// synchronous mode, the command runs immediately. Thread-safe.
+  void runOnRenderThread(std::function<void()> command);
+
+  /// \brief Statistics of the render thread. Thread-safe.
+  VisualizerStats stats() const noexcept;
+
+  /// \brief Set the contacts drawn along with the next state passed to
+  /// display(), until they are replaced. Thread-safe.
+  /// \sa ContactDebugSystem
+  void setContacts(std::span<const ContactRecord> contacts) {
+    m_contactSystem->setContacts(contacts);
+  }
+  /// \brief Appearance of the contacts. Only use on the render thread, e.g.
+  /// through runOnRenderThread().
+  ContactDrawStyle &contactStyle() { return m_contactSystem->style; }
+
+  /// \brief Set the collision model of the robot, drawn with an overlay of
+  /// its collision results (see CollisionDebugSystem) once shown with
+  /// showCollisionModel().
+  ///
+  /// display() copies the placements of \p coll_data along with the robot
+  /// state, and its collision and distance results as last computed, e.g.
+  /// by pinocchio::computeCollisions() and pinocchio::computeDistances().
+  /// The render thread only reads these copies.
+  /// \warning Call from the thread calling display(), which must also be the
+  /// one updating \p coll_data. \p coll_model and \p coll_data must outlive
+  /// the Visualizer.
+  void setCollisionModel(const pin::GeometryModel &coll_model,
+                         const pin::GeometryData &coll_data);
+  /// \brief Show or hide the collision model and its overlay. Thread-safe.
+  void showCollisionModel(bool show);
+
+#ifdef CANDLEWICK_WITH_SHARED_STATE
+  /// \brief Read robot states published by another process in the shared
+  /// memory object \p name (see shm_state.h), instead of display(). The
+  /// newest sample is read before each frame. Thread-safe.
+  ///
+  /// Samples are either configurations of the model, or placements of the
+  /// geometries of the visual model. The joint velocities, e.g. for velocity
+  /// arrows, are estimated from successive configurations by finite
+  /// differences, and zero with placements.
+  ///
+  /// If the producer re-creates the channel (e.g. after a restart), it is
+  /// opened again once initialized, as long as its dimension still matches.
+  /// \throws std::runtime_error if the channel cannot be opened.
+  /// \throws std::invalid_argument if its dimension does not match the model.
+  void attachSharedState(const std::string &name);
+  /// \brief Stop reading the shared state channel. Thread-safe.
+  void detachSharedState();
+#endif
+
   /// \brief Clear objects
   void clean() override {
-    robotScene->clearEnvironment();
-    robotScene->clearRobotGeometries();
-    debugScene->registry().clear();
+    runOnRenderThread([this] {
+      robotScene->clearEnvironment();
+      robotScene->clearRobotGeometries();
+      debugScene->registry().clear();
+    });
   }
 
 private:
-  bool m_cameraControl = true;
-  bool m_shouldExit = false;
+  std::atomic<bool> m_cameraControl = true;
+  std::atomic<bool> m_shouldExit = false;
+  std::atomic<bool> m_redrawRequested = false;
   EnvElements m_environmentFlags = ENV_EL_TRIAD;
+  bool m_interpolateStates = false;
+  bool m_skipIdleFrames = false;
+  // debugScene must be updated before the next frame
+  bool m_debugSceneDirty = false;
+  Uint64 m_minFramePeriodNs = 0;
+  // polling period of the render thread when idle
+  Uint64 m_idlePeriodNs = 500'000;
+  Uint64 m_lastFrameNs = 0;
+  // publish time of the newest state not rendered yet, 0 if none
+  Uint64 m_pendingPublishNs = 0;
+  // frames to render after the last change, so that the GUI settles
+  Uint32 m_pendingFrames = 0;
+  // what the last frame was rendered with
+  Camera m_lastCamera;
+  DirectionalLight m_lastLight;
+  // owned by debugScene, created with the render context
+  ContactDebugSystem *m_contactSystem = nullptr;
+  CollisionDebugSystem *m_collisionSystem = nullptr;
+  // collision data read by display(), on the caller's thread
+  const pin::GeometryData *m_collisionData = nullptr;
+
+  // render thread copies of the robot state, which the scenes refer to
+  pin::Data m_renderData;
+  pin::GeometryData m_renderGeomData;
+  std::optional<pin::GeometryData> m_renderCollData;
+  TripleBuffer<VisualizerState> m_state;
+
+#ifdef CANDLEWICK_WITH_SHARED_STATE
+  SharedStateReader m_sharedState{NoInit};
+  std::vector<double> m_sharedSample;
+  // previous configuration sample, and the velocity estimated from it
+  Eigen::VectorXd m_sharedPrevQ;
+  double m_sharedPrevTime = 0.;
+  Eigen::VectorXd m_sharedVelocity;
+  /// Read the latest sample of m_sharedState into the render state.
+  bool readSharedState();
+  /// Open m_sharedState again after its producer re-created it.
+  void reopenSharedState();
+#endif
+
+  std::thread m_renderThread;
+  std::atomic<bool> m_stopRequested = false;
+  std::mutex m_commandMutex;
+  std::vector<std::function<void()>> m_commands;
+  std::vector<std::function<void()>> m_runningCommands;
+
+  std::atomic<Uint64> m_statesPublished = 0;
+  std::atomic<Uint64> m_statesRendered = 0;
+  std::atomic<Uint64> m_framesRendered = 0;
+  std::atomic<Uint64> m_lastLatencyNs = 0;
+  std::atomic<Uint64> m_avgLatencyNs = 0;
+  std::atomic<Uint64> m_framesSkipped = 0;
+  std::atomic<Uint64> m_frameAllocations = 0;
+  std::atomic<Uint64> m_frameArenaHighWater = 0;
+  std::atomic<Uint64> m_renderCommands = 0;
+  std::atomic<Uint64> m_skippedRenderCommands = 0;
 
+  void initRenderContext(const Config &config);
+  void releaseRenderContext();
+  void renderLoop();
+  /// Run pending commands, process events, and render the latest state if
+  /// anything changed.
+  /// \returns Whether a frame was rendered.
+  bool renderFrame();
+  /// Whether the camera or the light changed since the last frame.
+  bool viewChanged() const;
   void render();
 };
 
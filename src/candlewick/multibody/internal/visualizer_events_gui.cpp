@@ -52,6 +52,11 @@ void Visualizer::default_gui_exec(Visualizer &viz) {
                          ENV_EL_GRID);
     ImGui::CheckboxFlags("hud.Triad", (int *)&viz.m_environmentFlags,
                          ENV_EL_TRIAD);
+    if (viz.robotScene->hasCollisionModel()) {
+      bool show_collision = viz.robotScene->collisionModelShown();
+      if (ImGui::Checkbox("Collision model", &show_collision))
+        viz.showCollisionModel(show_collision);
+    }
     ImGui::TreePop();
   }
 
@@ -83,11 +88,15 @@ void mouse_motion_handler(CylindricalCamera &controller,
   }
 }
 
-void Visualizer::processEvents() {
+bool Visualizer::processEvents() {
+  if (renderer.headless())
+    return false;
   ImGuiIO &io = ImGui::GetIO();
 
+  bool received = false;
   SDL_Event event;
   while (SDL_PollEvent(&event)) {
+    received = true;
     ImGui_ImplSDL3_ProcessEvent(&event);
 
     if (event.type == SDL_EVENT_QUIT) {
@@ -110,6 +119,7 @@ void Visualizer::processEvents() {
       break;
     }
   }
+  return received;
 }
 
 } // namespace candlewick::multibody
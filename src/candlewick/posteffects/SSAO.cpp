@@ -4,7 +4,9 @@
 #include "../core/Shader.h"
 #include "../core/Camera.h"
 #include "../core/Renderer.h"
+#include "../core/errors.h"
 #include "../third-party/float16_t.hpp"
+#include <algorithm>
 #include <random>
 
 namespace candlewick {
@@ -14,6 +16,51 @@ namespace ssao {
 
   float lerp(float a, float b, float f) { return a + f * (b - a); }
 
+  struct alignas(16) ssao_camera_ubo_t {
+    GpuMat4 projection;
+    alignas(16) GpuMat4 invProjection;
+  };
+
+  struct alignas(16) ssao_params_ubo_t {
+    Sint32 numSamples;
+    Uint32 frameIndex;
+    float radius;
+    float bias;
+    float intensity;
+  };
+
+  struct alignas(16) temporal_ubo_t {
+    GpuMat4 invViewProj;
+    alignas(16) GpuMat4 prevViewProj;
+    float blend;
+    Uint32 historyValid;
+  };
+
+  SsaoConfig ssaoConfigForQuality(SsaoQuality quality,
+                                  bool temporal_accumulation) {
+    SsaoConfig config;
+    switch (quality) {
+    case SsaoQuality::LOW:
+      config.resolution = SsaoResolution::QUARTER;
+      config.kernel_samples = 16u;
+      break;
+    case SsaoQuality::MEDIUM:
+      config.resolution = SsaoResolution::HALF;
+      config.kernel_samples = 32u;
+      break;
+    case SsaoQuality::HIGH:
+      config.resolution = SsaoResolution::HALF;
+      config.kernel_samples = 64u;
+      break;
+    case SsaoQuality::ULTRA:
+      config.resolution = SsaoResolution::FULL;
+      config.kernel_samples = 64u;
+      break;
+    }
+    config.temporal_accumulation = temporal_accumulation;
+    return config;
+  }
+
   // https://sudonull.com/post/102169-Normal-oriented-Hemisphere-SSAO-for-Dummies
   std::vector<GpuVec4> generateSsaoKernel(size_t kernelSize = 64ul) {
     std::random_device rd;
@@ -42,8 +89,6 @@ namespace ssao {
     return kernel;
   }
 
-  static const std::vector KERNEL_SAMPLES = generateSsaoKernel();
-
   Texture create_noise_texture(const Device &device, Uint32 size) {
     return Texture{device,
                    {.type = SDL_GPU_TEXTURETYPE_2D,
@@ -116,49 +161,111 @@ namespace ssao {
     SDL_UploadToGPUTexture(copy_pass, &tex_trans_info, &tex_region, false);
 
     SDL_EndGPUCopyPass(copy_pass);
+    SDL_ReleaseGPUTransferBuffer(dev, texTransferBuffer);
     return command_buffer.submit();
   }
 
-  SsaoPass::SsaoPass(const Renderer &renderer, const MeshLayout &layout,
-                     SDL_GPUTexture *normalMap)
-      : inDepthMap(renderer.depth_texture), inNormalMap(normalMap) {
-    const auto &device = renderer.device;
+  /// Upload the kernel samples to a storage buffer. This is done once, instead
+  /// of pushing the samples as uniform data every frame.
+  SDL_GPUBuffer *createKernelBuffer(const Device &device,
+                                    std::span<const GpuVec4> samples) {
+    const auto payload_size = Uint32(samples.size_bytes());
+    SDL_GPUBufferCreateInfo buffer_ci{
+        .usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ,
+        .size = payload_size,
+        .props = 0,
+    };
+    SDL_GPUBuffer *buffer = SDL_CreateGPUBuffer(device, &buffer_ci);
+    if (!buffer)
+      throw RAIIException(SDL_GetError());
+    SDL_SetGPUBufferName(device, buffer, "SSAO kernel samples");
 
-    SDL_GPUSamplerCreateInfo samplers_ci{
-        .min_filter = SDL_GPU_FILTER_NEAREST,
-        .mag_filter = SDL_GPU_FILTER_NEAREST,
-        .mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST,
-        .address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
-        .address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
-        .address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+    SDL_GPUTransferBufferCreateInfo tb_ci{
+        .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+        .size = payload_size,
+        .props = 0,
     };
-    texSampler = SDL_CreateGPUSampler(device, &samplers_ci);
+    SDL_GPUTransferBuffer *transfer_buffer =
+        SDL_CreateGPUTransferBuffer(device, &tb_ci);
+    void *data = SDL_MapGPUTransferBuffer(device, transfer_buffer, false);
+    SDL_memcpy(data, samples.data(), payload_size);
+    SDL_UnmapGPUTransferBuffer(device, transfer_buffer);
 
-    auto [width, height] = renderer.window.size();
+    CommandBuffer command_buffer(device);
+    SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(command_buffer);
+    SDL_GPUTransferBufferLocation src{.transfer_buffer = transfer_buffer,
+                                      .offset = 0};
+    SDL_GPUBufferRegion dst{.buffer = buffer, .offset = 0, .size = payload_size};
+    SDL_UploadToGPUBuffer(copy_pass, &src, &dst, false);
+    SDL_EndGPUCopyPass(copy_pass);
+    SDL_ReleaseGPUTransferBuffer(device, transfer_buffer);
+    command_buffer.submit();
+    return buffer;
+  }
+
+  static Texture createAoTarget(const Device &device, Uint32 width,
+                                Uint32 height, const char *name) {
     SDL_GPUTextureCreateInfo texture_desc{
         .type = SDL_GPU_TEXTURETYPE_2D,
         .format = SDL_GPU_TEXTUREFORMAT_R32_FLOAT,
         .usage =
             SDL_GPU_TEXTUREUSAGE_COLOR_TARGET | SDL_GPU_TEXTUREUSAGE_SAMPLER,
-        .width = Uint32(width),
-        .height = Uint32(height),
+        .width = width,
+        .height = height,
         .layer_count_or_depth = 1,
         .num_levels = 1,
         .sample_count = SDL_GPU_SAMPLECOUNT_1,
         .props = 0,
     };
-    ssaoMap = Texture{device, texture_desc, "SSAO map (pre-blur)"};
-    blurPass1Tex = Texture{device, texture_desc, "SSAO output map"};
+    return Texture{device, texture_desc, name};
+  }
+
+  SsaoPass::SsaoPass(const Renderer &renderer, const MeshLayout &layout,
+                     SDL_GPUTexture *normalMap, const SsaoConfig &config)
+      : inDepthMap(renderer.depth_texture), inNormalMap(normalMap),
+        m_config(config), _device(renderer.device) {
+    const auto &device = renderer.device;
+    m_config.kernel_samples =
+        std::clamp(m_config.kernel_samples, 1u, MAX_KERNEL_SAMPLES);
+
+    SDL_GPUSamplerCreateInfo samplers_ci{
+        .min_filter = SDL_GPU_FILTER_NEAREST,
+        .mag_filter = SDL_GPU_FILTER_NEAREST,
+        .mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST,
+        .address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+        .address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+        .address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+    };
+    texSampler = SDL_CreateGPUSampler(device, &samplers_ci);
+
+    auto [width, height] = renderer.size();
+    const Uint32 factor = downsampleFactor();
+    const Uint32 lowWidth = std::max(Uint32(width) / factor, 1u);
+    const Uint32 lowHeight = std::max(Uint32(height) / factor, 1u);
+
+    ssaoMap = createAoTarget(device, Uint32(width), Uint32(height),
+                             "SSAO output map");
+    blurPass1Tex =
+        createAoTarget(device, lowWidth, lowHeight, "SSAO blur pass 1");
+    if (factor > 1) {
+      lowResMap = createAoTarget(device, lowWidth, lowHeight,
+                                 "SSAO map (reduced resolution)");
+    }
+    if (m_config.temporal_accumulation) {
+      historyTex[0] =
+          createAoTarget(device, lowWidth, lowHeight, "SSAO history 0");
+      historyTex[1] =
+          createAoTarget(device, lowWidth, lowHeight, "SSAO history 1");
+    }
 
     auto vertexShader = Shader::fromMetadata(device, "DrawQuad.vert");
-    auto fragmentShader = Shader::fromMetadata(device, "SSAO.frag");
     SDL_GPUColorTargetDescription color_desc;
     SDL_zero(color_desc);
-    // render AO map to 16-bit float texture
-    color_desc.format = texture_desc.format;
+    // render AO map to 32-bit float texture
+    color_desc.format = ssaoMap.format();
     SDL_GPUGraphicsPipelineCreateInfo pipeline_desc{
         .vertex_shader = vertexShader,
-        .fragment_shader = fragmentShader,
+        .fragment_shader = nullptr,
         .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
         .rasterizer_state{.fill_mode = SDL_GPU_FILLMODE_FILL,
                           .cull_mode = SDL_GPU_CULLMODE_BACK},
@@ -166,11 +273,20 @@ namespace ssao {
                      .num_color_targets = 1,
                      .has_depth_stencil_target = false},
     };
-    pipeline = SDL_CreateGPUGraphicsPipeline(device, &pipeline_desc);
-    auto blurShader = Shader::fromMetadata(device, "SSAOblur.frag");
-    SDL_GPUGraphicsPipelineCreateInfo blur_pipeline_desc = pipeline_desc;
-    blur_pipeline_desc.fragment_shader = blurShader;
-    blurPipeline = SDL_CreateGPUGraphicsPipeline(device, &blur_pipeline_desc);
+    auto createQuadPipeline = [&](const char *fragment_shader_name) {
+      auto fragmentShader = Shader::fromMetadata(device, fragment_shader_name);
+      pipeline_desc.fragment_shader = fragmentShader;
+      return SDL_CreateGPUGraphicsPipeline(device, &pipeline_desc);
+    };
+    pipeline = createQuadPipeline("SSAO.frag");
+    blurPipeline = createQuadPipeline("SSAOblur.frag");
+    if (factor > 1)
+      upsamplePipeline = createQuadPipeline("SSAOupsample.frag");
+    if (m_config.temporal_accumulation)
+      temporalPipeline = createQuadPipeline("SSAOtemporal.frag");
+
+    auto kernel = generateSsaoKernel(m_config.kernel_samples);
+    kernelBuffer = createKernelBuffer(device, kernel);
 
     // Now, we create the noise texture
     Uint32 num_pixels_rows = 4u;
@@ -180,9 +296,22 @@ namespace ssao {
   }
 
   void SsaoPass::render(CommandBuffer &cmdBuf, const Camera &camera) {
-    GpuMat4 proj = camera.projection;
+    const bool temporal = m_config.temporal_accumulation;
+    // AO is computed (and blurred) in this texture, which is the final output
+    // when running at full resolution.
+    SDL_GPUTexture *aoTarget = downsampleFactor() > 1 ? lowResMap : ssaoMap;
+    const ssao_camera_ubo_t cam_ubo{camera.projection,
+                                    camera.projection.inverse()};
+    const ssao_params_ubo_t params{
+        .numSamples = Sint32(m_config.kernel_samples),
+        .frameIndex = temporal ? frameIndex : 0u,
+        .radius = m_config.radius,
+        .bias = m_config.bias,
+        .intensity = m_config.intensity,
+    };
+
     SDL_GPUColorTargetInfo color_info{
-        .texture = ssaoMap,
+        .texture = aoTarget,
         .layer_or_depth_plane = 0,
         .load_op = SDL_GPU_LOADOP_CLEAR,
         .store_op = SDL_GPU_STOREOP_STORE,
@@ -197,19 +326,50 @@ namespace ssao {
             {.texture = inNormalMap, .sampler = texSampler},
             {.texture = ssaoNoise.tex, .sampler = ssaoNoise.sampler},
         });
-    auto SAMPLES_PAYLOAD_BYTES =
-        Uint32(KERNEL_SAMPLES.size() * sizeof(GpuVec4));
-    cmdBuf.pushFragmentUniform(0, KERNEL_SAMPLES.data(), SAMPLES_PAYLOAD_BYTES);
-    cmdBuf.pushFragmentUniform(1, &proj, sizeof(proj));
+    SDL_BindGPUFragmentStorageBuffers(render_pass, 0, &kernelBuffer, 1);
+    cmdBuf.pushFragmentUniform(0, &cam_ubo, sizeof(cam_ubo))
+        .pushFragmentUniform(1, &params, sizeof(params));
     SDL_BindGPUGraphicsPipeline(render_pass, pipeline);
     SDL_DrawGPUPrimitives(render_pass, 6, 1, 0, 0);
     SDL_EndGPURenderPass(render_pass);
 
+    SDL_GPUTexture *blurInput = aoTarget;
+    if (temporal) {
+      const Mat4f viewProj = camera.viewProj();
+      Texture &history = historyTex[frameIndex % 2];
+      Texture &prevHistory = historyTex[(frameIndex + 1) % 2];
+      const temporal_ubo_t temporal_ubo{
+          .invViewProj = viewProj.inverse(),
+          .prevViewProj = prevViewProj,
+          .blend = m_config.temporal_blend,
+          .historyValid = historyValid,
+      };
+
+      color_info.texture = history;
+      render_pass = SDL_BeginGPURenderPass(cmdBuf, &color_info, 1, nullptr);
+      SDL_BindGPUGraphicsPipeline(render_pass, temporalPipeline);
+      rend::bindFragmentSamplers(
+          render_pass, 0,
+          {
+              {.texture = aoTarget, .sampler = texSampler},
+              {.texture = prevHistory, .sampler = texSampler},
+              {.texture = inDepthMap, .sampler = texSampler},
+          });
+      cmdBuf.pushFragmentUniform(0, &temporal_ubo, sizeof(temporal_ubo));
+      SDL_DrawGPUPrimitives(render_pass, 6, 1, 0, 0);
+      SDL_EndGPURenderPass(render_pass);
+
+      blurInput = history;
+      prevViewProj = viewProj;
+      historyValid = true;
+      frameIndex++;
+    }
+
     const GpuVec2 blurDirections[] = {{1, 0}, {0, 1}};
     for (size_t i = 0; i < 2; i++) {
       const GpuVec2 blurDir = blurDirections[i];
       // if i = 0, render to pass 1 blur texture
-      color_info.texture = (i == 0) ? blurPass1Tex : ssaoMap;
+      color_info.texture = (i == 0) ? blurPass1Tex : aoTarget;
 
       render_pass = SDL_BeginGPURenderPass(cmdBuf, &color_info, 1, nullptr);
       SDL_BindGPUGraphicsPipeline(render_pass, blurPipeline);
@@ -218,32 +378,60 @@ namespace ssao {
       rend::bindFragmentSamplers(
           render_pass, 0,
           {{
-              .texture = (i == 0) ? ssaoMap : blurPass1Tex,
+              .texture = (i == 0) ? blurInput : blurPass1Tex,
               .sampler = texSampler,
           }});
       SDL_DrawGPUPrimitives(render_pass, 6, 1, 0, 0);
       SDL_EndGPURenderPass(render_pass);
     }
+
+    if (downsampleFactor() > 1) {
+      // depth-aware bilateral upsample to the full-resolution output
+      color_info.texture = ssaoMap;
+      render_pass = SDL_BeginGPURenderPass(cmdBuf, &color_info, 1, nullptr);
+      SDL_BindGPUGraphicsPipeline(render_pass, upsamplePipeline);
+      rend::bindFragmentSamplers(
+          render_pass, 0,
+          {
+              {.texture = lowResMap, .sampler = texSampler},
+              {.texture = inDepthMap, .sampler = texSampler},
+          });
+      cmdBuf.pushFragmentUniform(0, &cam_ubo, sizeof(cam_ubo));
+      SDL_DrawGPUPrimitives(render_pass, 6, 1, 0, 0);
+      SDL_EndGPURenderPass(render_pass);
+    }
   }
 
   void SsaoPass::release() {
-    auto &device = ssaoMap.device();
+    if (!_device)
+      return;
     // release neither input texture because they are **borrowed**.
 
     if (texSampler)
-      SDL_ReleaseGPUSampler(device, texSampler);
-    if (pipeline)
-      SDL_ReleaseGPUGraphicsPipeline(device, pipeline);
+      SDL_ReleaseGPUSampler(_device, texSampler);
+    texSampler = nullptr;
+    for (auto *pipe : {&pipeline, &blurPipeline, &upsamplePipeline,
+                       &temporalPipeline}) {
+      if (*pipe)
+        SDL_ReleaseGPUGraphicsPipeline(_device, *pipe);
+      *pipe = nullptr;
+    }
+    if (kernelBuffer)
+      SDL_ReleaseGPUBuffer(_device, kernelBuffer);
+    kernelBuffer = nullptr;
 
     ssaoMap.destroy();
+    lowResMap.destroy();
+    historyTex[0].destroy();
+    historyTex[1].destroy();
 
     ssaoNoise.tex.destroy();
     if (ssaoNoise.sampler)
-      SDL_ReleaseGPUSampler(device, ssaoNoise.sampler);
+      SDL_ReleaseGPUSampler(_device, ssaoNoise.sampler);
+    ssaoNoise.sampler = nullptr;
 
-    if (blurPipeline)
-      SDL_ReleaseGPUGraphicsPipeline(device, blurPipeline);
     blurPass1Tex.destroy();
+    _device = nullptr;
   }
 
 } // namespace ssao
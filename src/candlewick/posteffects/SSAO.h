@@ -2,16 +2,65 @@
 
 #include "../core/Core.h"
 #include "../core/Texture.h"
+#include "../core/math_types.h"
 #include <SDL3/SDL_gpu.h>
 
 namespace candlewick {
 namespace ssao {
+
+  /// \brief Resolution at which the ambient occlusion term is computed,
+  /// relative to the main render target.
+  enum class SsaoResolution : Uint32 {
+    FULL = 1,
+    HALF = 2,
+    QUARTER = 4,
+  };
+
+  /// \brief Quality/performance settings for the SSAO pass.
+  struct SsaoConfig {
+    SsaoResolution resolution = SsaoResolution::FULL;
+    /// Number of hemisphere kernel samples per pixel (at most
+    /// SsaoPass::MAX_KERNEL_SAMPLES).
+    Uint32 kernel_samples = 64u;
+    float radius = 1.0f;
+    float bias = 0.01f;
+    float intensity = 1.5f;
+    /// Reproject and accumulate the AO term over frames. The kernel is
+    /// rotated every frame, so that fewer samples per frame can be used.
+    bool temporal_accumulation = false;
+    /// Weight of the current frame in the temporal accumulation.
+    float temporal_blend = 0.1f;
+  };
+
+  /// \brief Quality presets, from the cheapest to the full-resolution pass
+  /// with the whole kernel.
+  enum class SsaoQuality {
+    /// Quarter resolution, 16 samples.
+    LOW,
+    /// Half resolution, 32 samples.
+    MEDIUM,
+    /// Half resolution, 64 samples.
+    HIGH,
+    /// Full resolution, 64 samples.
+    ULTRA,
+  };
+
+  /// \brief Configuration for a quality preset. The other settings keep their
+  /// defaults.
+  SsaoConfig ssaoConfigForQuality(SsaoQuality quality,
+                                  bool temporal_accumulation = false);
+
   struct SsaoPass {
+    static constexpr Uint32 MAX_KERNEL_SAMPLES = 64u;
+
     SDL_GPUTexture *inDepthMap = nullptr;
     SDL_GPUTexture *inNormalMap = nullptr;
     SDL_GPUSampler *texSampler = nullptr;
     SDL_GPUGraphicsPipeline *pipeline = nullptr;
+    /// Final, full-resolution AO map (to be sampled by the lighting pass).
     Texture ssaoMap{NoInit};
+    /// Kernel samples, uploaded once to a GPU storage buffer.
+    SDL_GPUBuffer *kernelBuffer = nullptr;
 
     struct SsaoNoise {
       Texture tex{NoInit};
@@ -24,14 +73,40 @@ namespace ssao {
     // first blur pass target
     Texture blurPass1Tex{NoInit};
 
+    /// \name Reduced-resolution resources
+    /// Only created if SsaoConfig::resolution is not SsaoResolution::FULL.
+    /// \{
+    Texture lowResMap{NoInit};
+    SDL_GPUGraphicsPipeline *upsamplePipeline = nullptr;
+    /// \}
+
+    /// \name Temporal accumulation resources
+    /// \{
+    Texture historyTex[2]{Texture{NoInit}, Texture{NoInit}};
+    SDL_GPUGraphicsPipeline *temporalPipeline = nullptr;
+    Mat4f prevViewProj = Mat4f::Identity();
+    Uint32 frameIndex = 0;
+    bool historyValid = false;
+    /// \}
+
     SsaoPass(NoInitT) {}
     SsaoPass(const Renderer &renderer, const MeshLayout &layout,
-             SDL_GPUTexture *normalMap);
+             SDL_GPUTexture *normalMap, const SsaoConfig &config = {});
+
+    const SsaoConfig &config() const { return m_config; }
+    Uint32 downsampleFactor() const { return Uint32(m_config.resolution); }
 
     void render(CommandBuffer &cmdBuf, const Camera &camera);
 
+    /// \brief Discard the temporal history, e.g. on camera cuts.
+    void resetHistory() { historyValid = false; }
+
     // cleanup function
     void release();
+
+  private:
+    SsaoConfig m_config;
+    SDL_GPUDevice *_device = nullptr;
   };
 
 } // namespace ssao
@@ -40,7 +40,7 @@ namespace effects {
     pipeline = SDL_CreateGPUGraphicsPipeline(device, &pipeline_desc);
     assert(pipeline);
 
-    auto [width, height] = renderer.window.sizeInPixels();
+    auto [width, height] = renderer.size();
     SDL_GPUTextureCreateInfo texture_desc{
         .type = SDL_GPU_TEXTURETYPE_2D,
         .format = outputAttachmentFormat,
@@ -90,7 +90,8 @@ namespace effects {
   void
   ScreenSpaceShadowPass::render(CommandBuffer &cmdBuf, const Camera &camera,
                                 const DirectionalLight &light,
-                                std::span<const OpaqueCastable> castables) {
+                                std::span<const OpaqueCastable> castables,
+                                const TransformBuffer &transforms) {
     SDL_GPUColorTargetInfo color_target_info;
     SDL_zero(color_target_info);
     color_target_info.texture = targetTexture;
@@ -119,9 +120,11 @@ namespace effects {
                                    .sampler = depthSampler,
                                }});
 
+    transforms.bind(render_pass);
+    cmdBuf.pushVertexUniform(DepthPassInfo::VIEW_SLOT, &vp, sizeof(vp));
     for (auto &cs : castables) {
-      GpuMat4 mvp = vp * cs.transform;
-      cmdBuf.pushVertexUniform(0, &mvp, sizeof(mvp));
+      cmdBuf.pushVertexUniform(DepthPassInfo::OBJECT_INDEX_SLOT,
+                               &cs.transformIndex, sizeof(cs.transformIndex));
       rend::bindMesh(render_pass, cs.mesh);
       rend::draw(render_pass, cs.mesh);
     }
@@ -9,6 +9,7 @@
 
 namespace candlewick {
 struct OpaqueCastable;
+class TransformBuffer;
 namespace effects {
 
   /// \brief WIP screen space shadows
@@ -36,7 +37,8 @@ namespace effects {
 
     void render(CommandBuffer &cmdBuf, const Camera &camera,
                 const DirectionalLight &light,
-                std::span<const OpaqueCastable> castables);
+                std::span<const OpaqueCastable> castables,
+                const TransformBuffer &transforms);
   };
 
 } // namespace effects
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+namespace candlewick {
+
+/// \brief Bounded lock-free FIFO queue, with a single producer and any number
+/// of consumers.
+///
+/// Items are stored in a fixed ring of atomics, so \p T should be small and
+/// trivially copyable (e.g. an index into a pool of larger objects). Pushing
+/// is wait-free; popping is lock-free (consumers race on the head index using
+/// compare-and-swap). No operation blocks: waiting, if needed, is left to the
+/// caller.
+template <typename T> class BoundedQueue {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "BoundedQueue items must be trivially copyable.");
+
+public:
+  explicit BoundedQueue(size_t capacity)
+      : m_slots(std::make_unique<std::atomic<T>[]>(capacity)),
+        m_capacity(capacity) {}
+
+  BoundedQueue(const BoundedQueue &) = delete;
+  BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+  size_t capacity() const noexcept { return m_capacity; }
+
+  /// \brief Approximate number of items in the queue.
+  size_t size() const noexcept {
+    const size_t head = m_head.load(std::memory_order_acquire);
+    const size_t tail = m_tail.load(std::memory_order_acquire);
+    return tail - head;
+  }
+
+  bool empty() const noexcept { return size() == 0; }
+
+  /// \brief Push an item. Must only be called from the producer thread.
+  /// \returns false if the queue is full.
+  bool tryPush(const T &value) noexcept {
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t head = m_head.load(std::memory_order_acquire);
+    if (tail - head >= m_capacity)
+      return false;
+    m_slots[tail % m_capacity].store(value, std::memory_order_relaxed);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// \brief Pop the oldest item. Can be called from any thread.
+  /// \returns std::nullopt if the queue is empty.
+  std::optional<T> tryPop() noexcept {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    while (true) {
+      const size_t tail = m_tail.load(std::memory_order_acquire);
+      if (head == tail)
+        return std::nullopt;
+      // If the slot gets overwritten after this read, the head has moved and
+      // the CAS below fails.
+      T value = m_slots[head % m_capacity].load(std::memory_order_relaxed);
+      if (m_head.compare_exchange_weak(head, head + 1,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_relaxed))
+        return value;
+    }
+  }
+
+private:
+  std::unique_ptr<std::atomic<T>[]> m_slots;
+  size_t m_capacity;
+  alignas(64) std::atomic<size_t> m_head{0};
+  alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+} // namespace candlewick
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "BoundedQueue.h"
+#include <SDL3/SDL_stdinc.h>
+
+#include <atomic>
+#include <optional>
+
+namespace candlewick {
+namespace media {
+
+  /// \brief Behaviour of FrameQueue::acquire() when the queue is full, i.e.
+  /// when the consumer cannot keep up.
+  enum class FrameQueuePolicy {
+    /// Wait for the consumer to release a frame.
+    BLOCK,
+    /// Discard the oldest frame which is not yet being consumed.
+    DROP_OLDEST,
+    /// Discard the incoming frame.
+    DROP_NEWEST,
+  };
+
+  /// \brief Hand-off of pooled frames from a producer thread to a consumer
+  /// thread (e.g. an encoder), with a policy for when the consumer falls
+  /// behind.
+  ///
+  /// The frames themselves are kept by the caller, in a pool of capacity()
+  /// frames indexed by slot. The producer acquire()s a free slot, fills it
+  /// and submit()s it; the consumer pops it with popReady(), and release()s it
+  /// once done. Built on two BoundedQueue, so only the producer can acquire
+  /// and submit.
+  class FrameQueue {
+  public:
+    FrameQueue(Uint32 capacity, FrameQueuePolicy policy)
+        : m_policy(policy), m_free(capacity), m_ready(capacity) {
+      for (Uint32 i = 0; i < capacity; i++)
+        m_free.tryPush(i);
+    }
+
+    FrameQueuePolicy policy() const { return m_policy; }
+    Uint32 capacity() const { return Uint32(m_free.capacity()); }
+    /// \brief Number of frames waiting for the consumer.
+    Uint32 queued() const { return Uint32(m_ready.size()); }
+    /// \brief Number of frames discarded because the queue was full.
+    Uint32 dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /// \brief Slot to write the next frame to. When every slot is in use,
+    /// applies the policy: waits for a slot, or takes the oldest queued
+    /// frame's slot, or drops the incoming frame.
+    /// \returns std::nullopt if the frame must be dropped, or if the queue was
+    /// aborted.
+    std::optional<Uint32> acquire() {
+      while (true) {
+        const Uint32 events = m_freeEvents.load(std::memory_order_acquire);
+        if (auto index = m_free.tryPop())
+          return index;
+        if (m_aborted.load(std::memory_order_acquire))
+          return std::nullopt;
+
+        switch (m_policy) {
+        case FrameQueuePolicy::DROP_NEWEST:
+          m_dropped.fetch_add(1, std::memory_order_relaxed);
+          return std::nullopt;
+        case FrameQueuePolicy::DROP_OLDEST:
+          if (auto index = m_ready.tryPop()) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return index;
+          }
+          // every frame is held by the consumer: wait for one.
+          break;
+        case FrameQueuePolicy::BLOCK:
+          break;
+        }
+        m_freeEvents.wait(events, std::memory_order_acquire);
+      }
+    }
+
+    /// \brief Queue the frame written to an acquired slot.
+    void submit(Uint32 index) {
+      // cannot fail: there are as many slots as frames
+      m_ready.tryPush(index);
+      m_readyEvents.fetch_add(1, std::memory_order_release);
+      m_readyEvents.notify_one();
+    }
+
+    /// \brief Wait for the oldest queued frame. Called by the consumer.
+    /// \returns std::nullopt once the queue is closed and drained.
+    std::optional<Uint32> popReady() {
+      while (true) {
+        const Uint32 events = m_readyEvents.load(std::memory_order_acquire);
+        if (auto index = m_ready.tryPop())
+          return index;
+        if (m_closed.load(std::memory_order_acquire))
+          return std::nullopt;
+        m_readyEvents.wait(events, std::memory_order_acquire);
+      }
+    }
+
+    /// \brief Give a consumed frame's slot back to the producer.
+    void release(Uint32 index) {
+      m_free.tryPush(index);
+      m_freeEvents.fetch_add(1, std::memory_order_release);
+      m_freeEvents.notify_one();
+    }
+
+    /// \brief No more frames will be submitted: popReady() returns
+    /// std::nullopt once the queued frames are consumed.
+    void close() {
+      m_closed.store(true, std::memory_order_release);
+      m_readyEvents.fetch_add(1, std::memory_order_release);
+      m_readyEvents.notify_all();
+    }
+
+    /// \brief The consumer stopped: wake up, and fail, the producer waiting
+    /// in acquire().
+    void abort() {
+      m_aborted.store(true, std::memory_order_release);
+      m_freeEvents.fetch_add(1, std::memory_order_release);
+      m_freeEvents.notify_all();
+    }
+
+  private:
+    FrameQueuePolicy m_policy;
+    /// Slots available to the producer. Pushed by the consumer.
+    BoundedQueue<Uint32> m_free;
+    /// Slots waiting to be consumed. Popped by the consumer, and by the
+    /// producer to drop the oldest frame.
+    BoundedQueue<Uint32> m_ready;
+    /// Bumped (and notified) whenever a frame is queued, or on close.
+    std::atomic<Uint32> m_readyEvents{0};
+    /// Bumped (and notified) whenever a slot is released, or on abort.
+    std::atomic<Uint32> m_freeEvents{0};
+    std::atomic<Uint32> m_dropped{0};
+    std::atomic<bool> m_closed{false};
+    std::atomic<bool> m_aborted{false};
+  };
+
+} // namespace media
+} // namespace candlewick
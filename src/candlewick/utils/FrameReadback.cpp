@@ -0,0 +1,185 @@
+#include "FrameReadback.h"
+#include "../core/CommandBuffer.h"
+#include "../core/Device.h"
+#include "../core/errors.h"
+
+#include <SDL3/SDL_assert.h>
+#include <SDL3/SDL_log.h>
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace candlewick::media {
+
+FrameReadbackRing::FrameReadbackRing(const Device &device, Uint32 width,
+                                     Uint32 height,
+                                     SDL_GPUTextureFormat format,
+                                     FrameCallback callback, Uint32 numSlots,
+                                     ReadbackFullPolicy policy)
+    : FrameReadbackRing(device, std::array{ReadbackPlane{width, height, format}},
+                        std::move(callback), numSlots, policy) {}
+
+FrameReadbackRing::FrameReadbackRing(const Device &device,
+                                     std::span<const ReadbackPlane> planes,
+                                     FrameCallback callback, Uint32 numSlots,
+                                     ReadbackFullPolicy policy)
+    : _device(device), m_slots(std::max(numSlots, 1u)),
+      m_callback(std::move(callback)), m_planes(planes.begin(), planes.end()),
+      m_policy(policy) {
+  for (const ReadbackPlane &plane : m_planes)
+    m_payloadSize += SDL_CalculateGPUTextureFormatSize(
+        plane.format, plane.width, plane.height, 1);
+
+  SDL_GPUTransferBufferCreateInfo info{
+      .usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD,
+      .size = m_payloadSize,
+      .props = 0,
+  };
+  for (Slot &slot : m_slots) {
+    slot.buffer = SDL_CreateGPUTransferBuffer(_device, &info);
+    if (!slot.buffer) {
+      this->release();
+      throw RAIIException(SDL_GetError());
+    }
+  }
+}
+
+FrameReadbackRing::FrameReadbackRing(FrameReadbackRing &&other) noexcept
+    : _device(std::exchange(other._device, nullptr)),
+      m_slots(std::move(other.m_slots)),
+      m_callback(std::move(other.m_callback)),
+      m_planes(std::move(other.m_planes)), m_payloadSize(other.m_payloadSize),
+      m_policy(other.m_policy), m_head(other.m_head),
+      m_pendingCount(std::exchange(other.m_pendingCount, 0u)),
+      m_stats(other.m_stats) {}
+
+FrameReadbackRing &
+FrameReadbackRing::operator=(FrameReadbackRing &&other) noexcept {
+  if (this == &other)
+    return *this;
+  this->release();
+  _device = std::exchange(other._device, nullptr);
+  m_slots = std::move(other.m_slots);
+  m_callback = std::move(other.m_callback);
+  m_planes = std::move(other.m_planes);
+  m_payloadSize = other.m_payloadSize;
+  m_policy = other.m_policy;
+  m_head = other.m_head;
+  m_pendingCount = std::exchange(other.m_pendingCount, 0u);
+  m_stats = other.m_stats;
+  return *this;
+}
+
+bool FrameReadbackRing::submitFrame(
+    CommandBuffer &cmdBuf, std::span<SDL_GPUTexture *const> textures) {
+  SDL_assert(textures.size() == m_planes.size());
+  if (std::ranges::find(textures, nullptr) != textures.end()) {
+    cmdBuf.submit();
+    m_stats.dropped++;
+    return false;
+  }
+
+  poll();
+  if (m_pendingCount == numSlots()) {
+    if (m_policy == ReadbackFullPolicy::DROP) {
+      cmdBuf.submit();
+      m_stats.dropped++;
+      return false;
+    }
+    m_stats.delayed++;
+    consumeOldest();
+  }
+
+  const Uint32 index = (m_head + m_pendingCount) % numSlots();
+  Slot &slot = m_slots[index];
+
+  SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(cmdBuf);
+  Uint32 offset = 0;
+  for (size_t i = 0; i < m_planes.size(); i++) {
+    const ReadbackPlane &plane = m_planes[i];
+    SDL_GPUTextureRegion source{
+        .texture = textures[i],
+        .layer = 0,
+        .w = plane.width,
+        .h = plane.height,
+        .d = 1,
+    };
+    SDL_GPUTextureTransferInfo destination{
+        .transfer_buffer = slot.buffer,
+        .offset = offset,
+    };
+    SDL_DownloadFromGPUTexture(copy_pass, &source, &destination);
+    offset += SDL_CalculateGPUTextureFormatSize(plane.format, plane.width,
+                                                plane.height, 1);
+  }
+  SDL_EndGPUCopyPass(copy_pass);
+
+  slot.fence = cmdBuf.submitAndAcquireFence();
+  if (!slot.fence) {
+    SDL_LogError(SDL_LOG_CATEGORY_GPU, "%s: failed to submit frame: %s",
+                 __FUNCTION__, SDL_GetError());
+    m_stats.dropped++;
+    return false;
+  }
+  m_pendingCount++;
+  m_stats.submitted++;
+  return true;
+}
+
+Uint32 FrameReadbackRing::poll() {
+  Uint32 count = 0;
+  while (m_pendingCount > 0 &&
+         SDL_QueryGPUFence(_device, m_slots[m_head].fence)) {
+    consumeOldest();
+    count++;
+  }
+  return count;
+}
+
+void FrameReadbackRing::flush() {
+  while (m_pendingCount > 0)
+    consumeOldest();
+}
+
+void FrameReadbackRing::consumeOldest() {
+  SDL_assert(m_pendingCount > 0);
+  Slot &slot = m_slots[m_head];
+  SDL_WaitForGPUFences(_device, true, &slot.fence, 1);
+  SDL_ReleaseGPUFence(_device, slot.fence);
+  slot.fence = nullptr;
+
+  auto *data = static_cast<const Uint8 *>(
+      SDL_MapGPUTransferBuffer(_device, slot.buffer, false));
+  if (data) {
+    if (m_callback)
+      m_callback(data, m_payloadSize);
+    SDL_UnmapGPUTransferBuffer(_device, slot.buffer);
+    m_stats.delivered++;
+  } else {
+    SDL_LogError(SDL_LOG_CATEGORY_GPU, "%s: failed to map buffer: %s",
+                 __FUNCTION__, SDL_GetError());
+    m_stats.dropped++;
+  }
+  m_head = (m_head + 1) % numSlots();
+  m_pendingCount--;
+}
+
+void FrameReadbackRing::release() noexcept {
+  if (!_device)
+    return;
+  for (Slot &slot : m_slots) {
+    if (slot.fence) {
+      SDL_WaitForGPUFences(_device, true, &slot.fence, 1);
+      SDL_ReleaseGPUFence(_device, slot.fence);
+    }
+    if (slot.buffer)
+      SDL_ReleaseGPUTransferBuffer(_device, slot.buffer);
+    slot = {};
+  }
+  m_slots.clear();
+  m_pendingCount = 0;
+  m_head = 0;
+  _device = nullptr;
+}
+
+} // namespace candlewick::media
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "../core/Core.h"
+#include "../core/Tags.h"
+#include <SDL3/SDL_gpu.h>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace candlewick {
+namespace media {
+
+  /// \brief Behaviour of FrameReadbackRing::submitFrame() when every slot of
+  /// the ring still holds a frame in flight.
+  enum class ReadbackFullPolicy {
+    /// Wait for the oldest download to complete. The frame is counted as
+    /// delayed.
+    WAIT,
+    /// Skip the readback of the new frame. The frame is counted as dropped.
+    DROP,
+  };
+
+  /// \brief Counters for FrameReadbackRing.
+  struct FrameReadbackStats {
+    /// Frames whose download was recorded and submitted.
+    Uint64 submitted = 0;
+    /// Frames handed over to the callback.
+    Uint64 delivered = 0;
+    /// Frames for which the CPU had to wait on a download fence.
+    Uint64 delayed = 0;
+    /// Frames which were not read back.
+    Uint64 dropped = 0;
+  };
+
+  /// \brief Texture region downloaded by a FrameReadbackRing. The planes of a
+  /// frame are stored back-to-back in the frame's payload.
+  struct ReadbackPlane {
+    Uint32 width;
+    Uint32 height;
+    SDL_GPUTextureFormat format;
+  };
+
+  /// \brief Pipelined GPU-to-CPU frame readback using a ring of reusable
+  /// download transfer buffers.
+  ///
+  /// The download of a frame is recorded at the end of that frame's command
+  /// buffer. Its result is handed to the callback once its fence is signaled,
+  /// and at the latest when its slot is needed again, \f$N\f$ frames later.
+  /// Hence, the CPU never waits on the fence of the frame it just submitted.
+  /// Frames are always delivered in submission order.
+  class FrameReadbackRing {
+  public:
+    /// Callback receiving the (tightly packed) pixel data of a frame. The
+    /// pointer is only valid for the duration of the call.
+    using FrameCallback =
+        std::function<void(const Uint8 *data, Uint32 payloadSize)>;
+
+    FrameReadbackRing(NoInitT) {}
+    /// \brief Constructor for frames made of a single texture.
+    FrameReadbackRing(const Device &device, Uint32 width, Uint32 height,
+                      SDL_GPUTextureFormat format, FrameCallback callback,
+                      Uint32 numSlots = 3,
+                      ReadbackFullPolicy policy = ReadbackFullPolicy::WAIT);
+    /// \brief Constructor for frames made of several textures (e.g. the
+    /// planes of a YUV image).
+    FrameReadbackRing(const Device &device,
+                      std::span<const ReadbackPlane> planes,
+                      FrameCallback callback, Uint32 numSlots = 3,
+                      ReadbackFullPolicy policy = ReadbackFullPolicy::WAIT);
+    FrameReadbackRing(const FrameReadbackRing &) = delete;
+    FrameReadbackRing &operator=(const FrameReadbackRing &) = delete;
+    FrameReadbackRing(FrameReadbackRing &&other) noexcept;
+    FrameReadbackRing &operator=(FrameReadbackRing &&other) noexcept;
+
+    bool initialized() const { return _device != nullptr; }
+
+    /// \brief Record the download of \p texture into \p cmdBuf, then submit
+    /// the command buffer.
+    ///
+    /// Completed frames are delivered to the callback first, without
+    /// blocking. The command buffer is always submitted.
+    /// \returns Whether the frame will be read back.
+    bool submitFrame(CommandBuffer &cmdBuf, SDL_GPUTexture *texture) {
+      return submitFrame(cmdBuf, std::span{&texture, 1});
+    }
+
+    /// \copybrief submitFrame()
+    /// \param textures One texture per plane, in the order of the planes
+    /// given to the constructor.
+    bool submitFrame(CommandBuffer &cmdBuf,
+                     std::span<SDL_GPUTexture *const> textures);
+
+    /// \brief Deliver all frames whose download has completed, without
+    /// blocking.
+    /// \returns The number of delivered frames.
+    Uint32 poll();
+
+    /// \brief Wait for all pending downloads and deliver them.
+    void flush();
+
+    const FrameReadbackStats &stats() const { return m_stats; }
+    Uint32 numSlots() const { return Uint32(m_slots.size()); }
+    Uint32 pendingFrames() const { return m_pendingCount; }
+    std::span<const ReadbackPlane> planes() const { return m_planes; }
+    Uint32 payloadSize() const { return m_payloadSize; }
+
+    /// \brief Release the transfer buffers. Pending frames are waited on but
+    /// not delivered: call flush() beforehand to keep them.
+    void release() noexcept;
+    ~FrameReadbackRing() noexcept { this->release(); }
+
+  private:
+    struct Slot {
+      SDL_GPUTransferBuffer *buffer = nullptr;
+      SDL_GPUFence *fence = nullptr;
+    };
+
+    /// Deliver the oldest pending frame, waiting on its fence.
+    void consumeOldest();
+
+    SDL_GPUDevice *_device = nullptr;
+    std::vector<Slot> m_slots;
+    FrameCallback m_callback;
+    std::vector<ReadbackPlane> m_planes;
+    Uint32 m_payloadSize = 0;
+    ReadbackFullPolicy m_policy = ReadbackFullPolicy::WAIT;
+    /// Index of the oldest frame in flight.
+    Uint32 m_head = 0;
+    Uint32 m_pendingCount = 0;
+    FrameReadbackStats m_stats;
+  };
+
+} // namespace media
+} // namespace candlewick
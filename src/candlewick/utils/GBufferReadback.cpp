@@ -0,0 +1,198 @@
+#include "GBufferReadback.h"
+#include "../core/Camera.h"
+#include "../core/CommandBuffer.h"
+#include "../core/Device.h"
+#include "../core/Shader.h"
+#include "../core/errors.h"
+
+#include <SDL3/SDL_assert.h>
+#include <format>
+#include <vector>
+
+namespace candlewick::media {
+
+struct alignas(16) linearize_depth_ubo_t {
+  float near_plane;
+  float far_plane;
+  Uint32 is_ortho;
+};
+
+std::vector<ReadbackPlane> readbackPlanes(const GBufferReadbackConfig &config) {
+  const Uint32 width = config.width;
+  const Uint32 height = config.height;
+  // planes are laid out in the order of the GBufferFrame fields
+  std::vector<ReadbackPlane> planes;
+  if (config.color_format != SDL_GPU_TEXTUREFORMAT_INVALID)
+    planes.push_back({width, height, config.color_format});
+  if (config.depth)
+    planes.push_back({width, height, SDL_GPU_TEXTUREFORMAT_R32_FLOAT});
+  if (config.normals)
+    planes.push_back({width, height, SDL_GPU_TEXTUREFORMAT_R16G16_FLOAT});
+  if (config.instance_ids)
+    planes.push_back({width, height, SDL_GPU_TEXTUREFORMAT_R32_UINT});
+  return planes;
+}
+
+GBufferReadback::GBufferReadback(const Device &device,
+                                 const GBufferReadbackConfig &config,
+                                 FrameCallback callback)
+    : _device(device), m_config(config), m_callback(std::move(callback)) {
+  const Uint32 width = config.width;
+  const Uint32 height = config.height;
+
+  const std::vector<ReadbackPlane> planes = readbackPlanes(config);
+  if (planes.empty())
+    throw std::invalid_argument("GBufferReadback: no buffer requested.");
+
+  if (config.depth) {
+    m_linearDepth = Texture{device,
+                            {
+                                .type = SDL_GPU_TEXTURETYPE_2D,
+                                .format = SDL_GPU_TEXTUREFORMAT_R32_FLOAT,
+                                .usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET,
+                                .width = width,
+                                .height = height,
+                                .layer_count_or_depth = 1,
+                                .num_levels = 1,
+                                .sample_count = SDL_GPU_SAMPLECOUNT_1,
+                                .props = 0,
+                            },
+                            "Linear depth"};
+
+    SDL_GPUSamplerCreateInfo sampler_desc{
+        .min_filter = SDL_GPU_FILTER_NEAREST,
+        .mag_filter = SDL_GPU_FILTER_NEAREST,
+        .mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST,
+        .address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+        .address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+        .address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+        .compare_op = SDL_GPU_COMPAREOP_NEVER,
+    };
+    m_depthSampler = SDL_CreateGPUSampler(device, &sampler_desc);
+
+    auto vertexShader = Shader::fromMetadata(device, "DrawQuad.vert");
+    auto fragmentShader = Shader::fromMetadata(device, "LinearizeDepth.frag");
+    SDL_GPUColorTargetDescription color_desc;
+    SDL_zero(color_desc);
+    color_desc.format = m_linearDepth.format();
+    SDL_GPUGraphicsPipelineCreateInfo pipeline_desc{
+        .vertex_shader = vertexShader,
+        .fragment_shader = fragmentShader,
+        .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+        .rasterizer_state{.fill_mode = SDL_GPU_FILLMODE_FILL,
+                          .cull_mode = SDL_GPU_CULLMODE_NONE},
+        .target_info{.color_target_descriptions = &color_desc,
+                     .num_color_targets = 1,
+                     .has_depth_stencil_target = false},
+    };
+    m_depthPipeline = SDL_CreateGPUGraphicsPipeline(device, &pipeline_desc);
+    if (!m_depthPipeline)
+      terminate_with_message(
+          std::format("Failed to create depth linearization pipeline: {:s}",
+                      SDL_GetError()));
+  }
+
+  m_ring = FrameReadbackRing{
+      device, planes, [this](const Uint8 *data, Uint32) { deliver(data); },
+      config.num_slots, config.policy};
+}
+
+void GBufferReadback::linearizeDepth(CommandBuffer &cmdBuf,
+                                     SDL_GPUTexture *depth,
+                                     const Camera &camera) {
+  const Mat4f &proj = camera.projection;
+  linearize_depth_ubo_t ubo;
+  if (projectionType(proj) == CameraProjection::ORTHOGRAPHIC) {
+    ubo = {orthoProjNear(proj), orthoProjFar(proj), 1u};
+  } else {
+    ubo = {perspectiveProjNear(proj), perspectiveProjFar(proj), 0u};
+  }
+
+  SDL_GPUColorTargetInfo color_info{
+      .texture = m_linearDepth,
+      .load_op = SDL_GPU_LOADOP_DONT_CARE,
+      .store_op = SDL_GPU_STOREOP_STORE,
+  };
+  SDL_GPURenderPass *render_pass =
+      SDL_BeginGPURenderPass(cmdBuf, &color_info, 1, nullptr);
+  SDL_BindGPUGraphicsPipeline(render_pass, m_depthPipeline);
+  const SDL_GPUTextureSamplerBinding binding{.texture = depth,
+                                             .sampler = m_depthSampler};
+  SDL_BindGPUFragmentSamplers(render_pass, 0, &binding, 1);
+  cmdBuf.pushFragmentUniform(0, &ubo, sizeof(ubo));
+  SDL_DrawGPUPrimitives(render_pass, 6, 1, 0, 0);
+  SDL_EndGPURenderPass(render_pass);
+}
+
+bool GBufferReadback::submitFrame(CommandBuffer &cmdBuf,
+                                  const GBufferTextures &textures,
+                                  const Camera &camera) {
+  SDL_GPUTexture *sources[4];
+  Uint32 count = 0;
+  if (m_config.color_format != SDL_GPU_TEXTUREFORMAT_INVALID)
+    sources[count++] = textures.color;
+  if (m_config.depth) {
+    // a null depth texture makes the ring drop the frame
+    SDL_GPUTexture *linear_depth = nullptr;
+    if (textures.depth) {
+      linearizeDepth(cmdBuf, textures.depth, camera);
+      linear_depth = m_linearDepth;
+    }
+    sources[count++] = linear_depth;
+  }
+  if (m_config.normals)
+    sources[count++] = textures.normal;
+  if (m_config.instance_ids)
+    sources[count++] = textures.instanceId;
+  return m_ring.submitFrame(cmdBuf, std::span{sources, count});
+}
+
+void GBufferReadback::deliver(const Uint8 *data) const {
+  if (!m_callback)
+    return;
+  const Uint32 width = m_config.width;
+  const Uint32 height = m_config.height;
+  const size_t num_pixels = size_t(width) * height;
+  GBufferFrame frame{
+      .width = width,
+      .height = height,
+      .color_format = m_config.color_format,
+  };
+  if (m_config.color_format != SDL_GPU_TEXTUREFORMAT_INVALID) {
+    const Uint32 size = SDL_CalculateGPUTextureFormatSize(
+        m_config.color_format, width, height, 1);
+    frame.color = {data, size};
+    data += size;
+  }
+  // the remaining planes have 4-byte texels, and all plane sizes are
+  // multiples of 4 bytes: the casts below are aligned.
+  if (m_config.depth) {
+    frame.linear_depth = {reinterpret_cast<const float *>(data), num_pixels};
+    data += num_pixels * sizeof(float);
+  }
+  if (m_config.normals) {
+    frame.normals = {reinterpret_cast<const Uint16 *>(data), 2 * num_pixels};
+    data += num_pixels * 2 * sizeof(Uint16);
+  }
+  if (m_config.instance_ids) {
+    frame.instance_ids = {reinterpret_cast<const Uint32 *>(data), num_pixels};
+  }
+  m_callback(frame);
+}
+
+void GBufferReadback::release() noexcept {
+  if (!_device)
+    return;
+  // pending frames are discarded, the callback may refer to destroyed state
+  m_ring.release();
+  m_linearDepth.destroy();
+  if (m_depthPipeline)
+    SDL_ReleaseGPUGraphicsPipeline(_device, m_depthPipeline);
+  if (m_depthSampler)
+    SDL_ReleaseGPUSampler(_device, m_depthSampler);
+  m_depthPipeline = nullptr;
+  m_depthSampler = nullptr;
+  _device = nullptr;
+}
+
+} // namespace candlewick::media
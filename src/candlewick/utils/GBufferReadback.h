@@ -0,0 +1,127 @@
+#pragma once
+
+#include "FrameReadback.h"
+#include "../core/Core.h"
+#include "../core/Texture.h"
+#include <SDL3/SDL_gpu.h>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace candlewick {
+namespace media {
+
+  /// \brief Textures making up a rendered frame, as passed to
+  /// GBufferReadback::submitFrame().
+  struct GBufferTextures {
+    /// Color target, e.g. the swapchain texture.
+    SDL_GPUTexture *color = nullptr;
+    /// Depth texture, which must have the `SDL_GPU_TEXTUREUSAGE_SAMPLER` usage
+    /// flag.
+    SDL_GPUTexture *depth = nullptr;
+    /// View-space normals, e.g. `multibody::RobotScene::GBuffer::normalMap`.
+    SDL_GPUTexture *normal = nullptr;
+    /// Segmentation IDs, e.g. `multibody::RobotScene::GBuffer::instanceIdMap`.
+    SDL_GPUTexture *instanceId = nullptr;
+  };
+
+  /// \brief Selection of the buffers read back by a GBufferReadback.
+  struct GBufferReadbackConfig {
+    Uint32 width;
+    Uint32 height;
+    /// Format of the color texture. Set to `SDL_GPU_TEXTUREFORMAT_INVALID` to
+    /// skip the color buffer.
+    SDL_GPUTextureFormat color_format = SDL_GPU_TEXTUREFORMAT_INVALID;
+    bool depth = true;
+    bool normals = false;
+    bool instance_ids = false;
+    Uint32 num_slots = 3;
+    ReadbackFullPolicy policy = ReadbackFullPolicy::WAIT;
+  };
+
+  /// \brief Planes of the frames downloaded by a GBufferReadback with
+  /// \p config, in the order of the GBufferFrame fields.
+  std::vector<ReadbackPlane>
+  readbackPlanes(const GBufferReadbackConfig &config);
+
+  /// \brief Buffers of a frame delivered by GBufferReadback. Buffers which
+  /// were not requested are empty.
+  ///
+  /// The spans point into the mapped transfer buffer of the frame, see
+  /// GBufferReadback::FrameCallback for their lifetime.
+  struct GBufferFrame {
+    Uint32 width;
+    Uint32 height;
+    SDL_GPUTextureFormat color_format;
+    /// Color pixels, in GBufferFrame::color_format.
+    std::span<const Uint8> color;
+    /// Linear view-space depth. Pixels not covered by geometry are at the far
+    /// plane.
+    std::span<const float> linear_depth;
+    /// View-space normals (xy components) as pairs of half floats.
+    std::span<const Uint16> normals;
+    /// Segmentation IDs, 0 for the background.
+    std::span<const Uint32> instance_ids;
+  };
+
+  /// \brief Batched readback of the color, depth, normal and instance ID
+  /// buffers of a frame.
+  ///
+  /// The depth buffer is first converted to linear view-space depth in an
+  /// `R32_FLOAT` texture. Then all the requested buffers are downloaded to the
+  /// same transfer buffer of a FrameReadbackRing, with a single fence for the
+  /// frame. The callback receives views of the mapped transfer buffer, so it
+  /// can write them to their final destination without intermediate copies.
+  class GBufferReadback {
+  public:
+    /// Callback receiving the buffers of a frame. It is called on the thread
+    /// calling submitFrame(), poll() or flush(), whichever finds the
+    /// download complete.
+    ///
+    /// The spans of the frame are only valid until the callback returns: the
+    /// transfer buffer is then unmapped, and reused by a later frame. Copy
+    /// the buffers to keep them, e.g. to hand them to another thread.
+    using FrameCallback = std::function<void(const GBufferFrame &frame)>;
+
+    GBufferReadback(NoInitT) {}
+    GBufferReadback(const Device &device, const GBufferReadbackConfig &config,
+                    FrameCallback callback);
+    GBufferReadback(const GBufferReadback &) = delete;
+    GBufferReadback &operator=(const GBufferReadback &) = delete;
+
+    bool initialized() const { return _device != nullptr; }
+    const GBufferReadbackConfig &config() const { return m_config; }
+
+    /// \brief Record the depth conversion and the download of the requested
+    /// buffers into \p cmdBuf, then submit the command buffer.
+    /// \param camera The camera the frame was rendered with, for the depth
+    /// linearization.
+    /// \returns Whether the frame will be read back.
+    bool submitFrame(CommandBuffer &cmdBuf, const GBufferTextures &textures,
+                     const Camera &camera);
+
+    /// \copydoc FrameReadbackRing::poll()
+    Uint32 poll() { return m_ring.poll(); }
+    /// \copydoc FrameReadbackRing::flush()
+    void flush() { m_ring.flush(); }
+    const FrameReadbackStats &stats() const { return m_ring.stats(); }
+
+    void release() noexcept;
+    ~GBufferReadback() noexcept { this->release(); }
+
+  private:
+    void linearizeDepth(CommandBuffer &cmdBuf, SDL_GPUTexture *depth,
+                        const Camera &camera);
+    void deliver(const Uint8 *data) const;
+
+    SDL_GPUDevice *_device = nullptr;
+    GBufferReadbackConfig m_config{};
+    FrameCallback m_callback;
+    Texture m_linearDepth{NoInit};
+    SDL_GPUGraphicsPipeline *m_depthPipeline = nullptr;
+    SDL_GPUSampler *m_depthSampler = nullptr;
+    FrameReadbackRing m_ring{NoInit};
+  };
+
+} // namespace media
+} // namespace candlewick
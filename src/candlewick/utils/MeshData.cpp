@@ -4,6 +4,7 @@
 #include "../core/CommandBuffer.h"
 
 #include <SDL3/SDL_log.h>
+#include <limits>
 
 namespace candlewick {
 
@@ -173,4 +174,25 @@ void uploadMeshToDevice(const Device &device, const Mesh &mesh,
   uploadMeshToDevice(device, mesh.view(0), meshData);
 }
 
+BoundingBox computeBoundingBox(std::span<const MeshData> meshDatas) {
+  Float3 lower = Float3::Constant(std::numeric_limits<float>::max());
+  Float3 upper = Float3::Constant(std::numeric_limits<float>::lowest());
+  for (const MeshData &data : meshDatas) {
+    auto posAttr = data.layout.getAttribute(VertexAttrib::Position);
+    if (!posAttr)
+      continue;
+    const Uint32 stride = data.vertexSize();
+    const char *base = data.vertexData().data() + posAttr->offset;
+    for (Uint32 i = 0; i < data.numVertices(); i++) {
+      Float3 pos;
+      SDL_memcpy(pos.data(), base + i * stride, sizeof(Float3));
+      lower = lower.cwiseMin(pos);
+      upper = upper.cwiseMax(pos);
+    }
+  }
+  if ((lower.array() > upper.array()).any())
+    return {Float3::Zero(), Float3::Zero()};
+  return {0.5f * (lower + upper), 0.5f * (upper - lower)};
+}
+
 } // namespace candlewick
@@ -3,6 +3,7 @@
 #include "Utils.h"
 #include "../core/MeshLayout.h"
 #include "../core/MaterialUniform.h"
+#include "../core/Culling.h"
 #include "../core/Tags.h"
 
 #include <span>
@@ -150,4 +151,9 @@ extractMaterials(std::span<const MeshData> meshDatas) {
   return out;
 }
 
+/// \brief Axis-aligned bounding box of the vertex positions of a batch of
+/// meshes, in their common local frame. Empty meshes yield a box of size zero
+/// at the origin.
+BoundingBox computeBoundingBox(std::span<const MeshData> meshDatas);
+
 } // namespace candlewick
@@ -1,27 +1,90 @@
 #include "PixelFormatConversion.h"
 
+#ifdef CANDLEWICK_WITH_SIMDE
+#define CANDLEWICK_PIXEL_KERNELS_NAMESPACE baseline
+#include "internal/PixelFormatKernelsImpl.h"
+#else
+#include "internal/PixelFormatKernels.h"
+#endif
+
+#include <SDL3/SDL_cpuinfo.h>
+
 namespace candlewick {
 
-void bgraToRgbaConvert_impl(const Uint32 *bgraPixels, Uint32 *rgbaPixels,
-                            Uint32 pixelCount) {
-  // define appropriate masks for BGRA format
-  Uint32 red_mask = 0x00FF0000;
-  Uint32 green_mask = 0x0000FF00;
-  Uint32 blue_mask = 0x000000FF;
-  Uint32 alpha_mask = 0xFF000000;
-
-  for (Uint32 i = 0; i < pixelCount; ++i) {
-    Uint32 pixel = bgraPixels[i];
-    rgbaPixels[i] = ((pixel & red_mask) >> 16) |  // Extract Red
-                    ((pixel & green_mask)) |      // Keep Green
-                    ((pixel & blue_mask) << 16) | // Extract Blue
-                    (pixel & alpha_mask);         // Keep Alpha
+#ifndef CANDLEWICK_WITH_SIMDE
+namespace detail::baseline {
+  static void rgbaToRgb(const Uint8 *src, Uint8 *dst, Uint32 pixelCount) {
+    scalar::dropAlpha(src, dst, pixelCount, {0, 1, 2});
   }
+
+  static void bgraToRgb(const Uint8 *src, Uint8 *dst, Uint32 pixelCount) {
+    scalar::dropAlpha(src, dst, pixelCount, {2, 1, 0});
+  }
+
+  const PixelKernels kernels{
+      .name = "scalar",
+      .bgraToRgba = scalar::bgraToRgba,
+      .rgbaToRgb = rgbaToRgb,
+      .bgraToRgb = bgraToRgb,
+      .floatToUnorm8 = scalar::floatToUnorm8,
+      .depthToUnorm16 = scalar::depthToUnorm16,
+      .swapRows = scalar::swapRows,
+  };
+} // namespace detail::baseline
+#endif
+
+static const detail::PixelKernels &selectPixelKernels() {
+#ifdef CANDLEWICK_PIXEL_KERNELS_AVX2
+  if (SDL_HasAVX2())
+    return detail::avx2::kernels;
+#endif
+  return detail::baseline::kernels;
+}
+
+static const detail::PixelKernels &pixelKernels() {
+  static const detail::PixelKernels &kernels = selectPixelKernels();
+  return kernels;
 }
 
 void bgraToRgbaConvert(const Uint32 *bgraPixels, Uint32 *rgbaPixels,
                        Uint32 pixelCount) {
-  bgraToRgbaConvert_impl(bgraPixels, rgbaPixels, pixelCount);
+  pixelKernels().bgraToRgba(bgraPixels, rgbaPixels, pixelCount);
+}
+
+void rgbaToRgbConvert(const Uint8 *rgbaPixels, Uint8 *rgbPixels,
+                      Uint32 pixelCount) {
+  pixelKernels().rgbaToRgb(rgbaPixels, rgbPixels, pixelCount);
 }
 
+void bgraToRgbConvert(const Uint8 *bgraPixels, Uint8 *rgbPixels,
+                      Uint32 pixelCount) {
+  pixelKernels().bgraToRgb(bgraPixels, rgbPixels, pixelCount);
+}
+
+void floatToUnorm8Convert(const float *values, Uint8 *out, Uint32 count) {
+  pixelKernels().floatToUnorm8(values, out, count);
+}
+
+void depthToUnorm16Convert(const float *depth, Uint16 *out, Uint32 count) {
+  pixelKernels().depthToUnorm16(depth, out, count);
+}
+
+void flipImageVertically(const void *src, void *dst, Uint32 rowBytes,
+                         Uint32 numRows) {
+  auto *out = static_cast<Uint8 *>(dst);
+  if (src == dst) {
+    for (Uint32 i = 0; i < numRows / 2; i++)
+      pixelKernels().swapRows(out + size_t(i) * rowBytes,
+                              out + size_t(numRows - 1 - i) * rowBytes,
+                              rowBytes);
+    return;
+  }
+  auto *in = static_cast<const Uint8 *>(src);
+  for (Uint32 i = 0; i < numRows; i++)
+    SDL_memcpy(out + size_t(i) * rowBytes,
+               in + size_t(numRows - 1 - i) * rowBytes, rowBytes);
+}
+
+const char *pixelConversionBackend() { return pixelKernels().name; }
+
 } // namespace candlewick
@@ -4,8 +4,44 @@
 
 namespace candlewick {
 
-/// \brief Convert from 8-bit BGRA to 8-bit RGBA.
+/// \name Pixel format conversion kernels
+/// These functions are vectorized (using SIMDe). The instruction set is
+/// selected at runtime, on first use, depending on the host CPU.
+/// Unless stated otherwise, the input and output buffers must not overlap.
+/// \{
+
+/// \brief Convert from 8-bit BGRA to 8-bit RGBA (or conversely, since this
+/// swaps the first and third channels). Can be performed in-place.
 void bgraToRgbaConvert(const Uint32 *bgraPixels, Uint32 *rgbaPixels,
                        Uint32 pixelCount);
 
+/// \brief Convert 8-bit RGBA to 8-bit RGB, dropping the alpha channel.
+void rgbaToRgbConvert(const Uint8 *rgbaPixels, Uint8 *rgbPixels,
+                      Uint32 pixelCount);
+
+/// \brief Convert 8-bit BGRA to 8-bit RGB, dropping the alpha channel.
+void bgraToRgbConvert(const Uint8 *bgraPixels, Uint8 *rgbPixels,
+                      Uint32 pixelCount);
+
+/// \brief Convert normalized floats (e.g. the channels of a float color
+/// texture) to 8-bit unsigned normalized values. Inputs are clamped to
+/// \f$[0,1]\f$, and NaNs are mapped to 0.
+void floatToUnorm8Convert(const float *values, Uint8 *out, Uint32 count);
+
+/// \brief Convert depth values in \f$[0,1]\f$ (e.g. from a `D32_FLOAT`
+/// texture) to 16-bit unsigned normalized values.
+void depthToUnorm16Convert(const float *depth, Uint16 *out, Uint32 count);
+
+/// \brief Flip an image vertically. If \p src and \p dst are equal, the image
+/// is flipped in-place.
+/// \param rowBytes Size of an image row, in bytes.
+void flipImageVertically(const void *src, void *dst, Uint32 rowBytes,
+                         Uint32 numRows);
+
+/// \brief Name of the instruction set used by the conversion kernels, or
+/// "scalar" if candlewick was built without SIMDe.
+const char *pixelConversionBackend();
+
+/// \}
+
 } // namespace candlewick
@@ -0,0 +1,4 @@
+// AVX2 variant of the pixel conversion kernels. This file is compiled with
+// AVX2 code generation enabled, and only called if the CPU supports it.
+#define CANDLEWICK_PIXEL_KERNELS_NAMESPACE avx2
+#include "internal/PixelFormatKernelsImpl.h"
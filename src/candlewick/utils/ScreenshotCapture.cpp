@@ -0,0 +1,331 @@
+#include "ScreenshotCapture.h"
+#include "PixelFormatConversion.h"
+#include "../core/CommandBuffer.h"
+#include "../core/Device.h"
+#include "../core/errors.h"
+#include "../third-party/stb_image_write.h"
+
+#include <SDL3/SDL_assert.h>
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <shared_mutex>
+#include <magic_enum/magic_enum.hpp>
+
+namespace candlewick::media {
+
+/// stb_image_write reads the PNG compression level from a global variable.
+/// Encoders using the same level share the lock; changing the level requires
+/// exclusive access.
+static std::shared_mutex g_pngLevelMutex;
+
+/// Range of the PNG compression levels. stb_image_write raises lower levels to
+/// the minimum; clamping them here also keeps equivalent levels from taking
+/// the exclusive lock.
+constexpr int PNG_MIN_LEVEL = 5;
+constexpr int PNG_MAX_LEVEL = 9;
+
+static void writePng(const std::string &filename, const Uint8 *pixels,
+                     Uint32 width, Uint32 height, Uint32 channels,
+                     int level) {
+  level = std::clamp(level, PNG_MIN_LEVEL, PNG_MAX_LEVEL);
+  std::shared_lock lock{g_pngLevelMutex};
+  while (stbi_write_png_compression_level != level) {
+    lock.unlock();
+    {
+      std::unique_lock exclusive{g_pngLevelMutex};
+      stbi_write_png_compression_level = level;
+    }
+    lock.lock();
+  }
+  if (!stbi_write_png(filename.c_str(), int(width), int(height),
+                      int(channels), pixels, 0))
+    throw std::runtime_error(
+        std::format("Failed to write PNG file {:s}", filename));
+}
+
+/// Header of a version 1.0 .npy file, padded to a multiple of 64 bytes.
+static std::string npyHeader(Uint32 width, Uint32 height, Uint32 channels) {
+  std::string dict = std::format(
+      "{{'descr': '|u1', 'fortran_order': False, 'shape': ({:d}, {:d}, {:d}), }}",
+      height, width, channels);
+  // magic (6) + version (2) + header length (2) + dict + newline
+  const size_t unpadded = 10 + dict.size() + 1;
+  dict.append((64 - unpadded % 64) % 64, ' ');
+  dict.push_back('\n');
+  const Uint16 len = Uint16(dict.size());
+
+  // magic string and version number (1.0)
+  std::string header{"\x93NUMPY\x01\x00", 8};
+  header.push_back(char(len & 0xFF));
+  header.push_back(char(len >> 8));
+  return header + dict;
+}
+
+void writeImageFile(const std::string &filename, const Uint8 *pixels,
+                    Uint32 width, Uint32 height, Uint32 channels,
+                    const ImageWriteOptions &options) {
+  if (channels != imageFileChannels(options.format))
+    throw std::invalid_argument(
+        std::format("{:d} channels given for a {:s} file.", channels,
+                    magic_enum::enum_name(options.format)));
+
+  if (options.format == ImageFileFormat::PNG) {
+    writePng(filename, pixels, width, height, channels,
+             options.pngCompressionLevel);
+    return;
+  }
+
+  std::string header;
+  switch (options.format) {
+  case ImageFileFormat::PPM:
+    header = std::format("P6\n{:d} {:d}\n255\n", width, height);
+    break;
+  case ImageFileFormat::PAM:
+    header = std::format("P7\nWIDTH {:d}\nHEIGHT {:d}\nDEPTH {:d}\nMAXVAL "
+                         "255\nTUPLTYPE RGB_ALPHA\nENDHDR\n",
+                         width, height, channels);
+    break;
+  case ImageFileFormat::NPY:
+    header = npyHeader(width, height, channels);
+    break;
+  case ImageFileFormat::PNG:
+    break;
+  }
+
+  std::ofstream file{filename, std::ios::binary};
+  file.write(header.data(), std::streamsize(header.size()));
+  file.write(reinterpret_cast<const char *>(pixels),
+             std::streamsize(size_t(width) * height * channels));
+  if (!file)
+    throw std::runtime_error(
+        std::format("Failed to write image file {:s}", filename));
+}
+
+/// Convert downloaded pixels to tightly packed 8-bit RGB(A).
+static void convertPixels(const Uint8 *src, SDL_GPUTextureFormat format,
+                          Uint8 *dst, Uint32 pixelCount, Uint32 channels) {
+  switch (format) {
+  case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM:
+    if (channels == 3)
+      bgraToRgbConvert(src, dst, pixelCount);
+    else
+      bgraToRgbaConvert(reinterpret_cast<const Uint32 *>(src),
+                        reinterpret_cast<Uint32 *>(dst), pixelCount);
+    break;
+  case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM:
+    if (channels == 3)
+      rgbaToRgbConvert(src, dst, pixelCount);
+    else
+      SDL_memcpy(dst, src, size_t(pixelCount) * 4);
+    break;
+  case SDL_GPU_TEXTUREFORMAT_R32G32B32A32_FLOAT: {
+    const auto *values = reinterpret_cast<const float *>(src);
+    if (channels == 3) {
+      std::vector<Uint8> rgba(size_t(pixelCount) * 4);
+      floatToUnorm8Convert(values, rgba.data(), pixelCount * 4);
+      rgbaToRgbConvert(rgba.data(), dst, pixelCount);
+    } else {
+      floatToUnorm8Convert(values, dst, pixelCount * 4);
+    }
+    break;
+  }
+  default:
+    SDL_assert(false);
+  }
+}
+
+struct ScreenshotCapture::Job {
+  TransferBuffer buffer;
+  SDL_GPUFence *fence;
+  SDL_GPUTextureFormat format;
+  Uint32 width;
+  Uint32 height;
+  std::string filename;
+  ImageWriteOptions options;
+  std::promise<void> promise;
+  const Uint8 *mapped = nullptr;
+  /// Set by the worker once it no longer reads the mapped buffer.
+  std::atomic<bool> readDone{false};
+};
+
+bool ScreenshotCapture::isFormatSupported(SDL_GPUTextureFormat format) {
+  switch (format) {
+  case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM:
+  case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM:
+  case SDL_GPU_TEXTUREFORMAT_R32G32B32A32_FLOAT:
+    return true;
+  default:
+    return false;
+  }
+}
+
+ScreenshotCapture::ScreenshotCapture(const Device &device, Uint32 numWorkers,
+                                     Uint32 maxInFlight)
+    : _device(device), m_maxInFlight(std::max(maxInFlight, 1u)),
+      m_workers(numWorkers) {}
+
+auto ScreenshotCapture::acquireBuffer(Uint32 size) -> TransferBuffer {
+  for (auto it = m_freeBuffers.begin(); it != m_freeBuffers.end(); ++it) {
+    if (it->size >= size) {
+      TransferBuffer buffer = *it;
+      m_freeBuffers.erase(it);
+      return buffer;
+    }
+  }
+  // no pooled buffer is large enough: drop one, to keep the pool bounded
+  if (!m_freeBuffers.empty()) {
+    SDL_ReleaseGPUTransferBuffer(_device, m_freeBuffers.back().handle);
+    m_freeBuffers.pop_back();
+  }
+  SDL_GPUTransferBufferCreateInfo info{
+      .usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD,
+      .size = size,
+      .props = 0,
+  };
+  SDL_GPUTransferBuffer *handle = SDL_CreateGPUTransferBuffer(_device, &info);
+  if (!handle)
+    throw RAIIException(SDL_GetError());
+  return {handle, size};
+}
+
+std::future<void> ScreenshotCapture::capture(
+    CommandBuffer &cmdBuf, SDL_GPUTexture *texture,
+    SDL_GPUTextureFormat format, Uint32 width, Uint32 height,
+    std::string filename, const ImageWriteOptions &options) {
+  if (!isFormatSupported(format))
+    throw std::invalid_argument(
+        std::format("Unsupported texture format {:s} for capture.",
+                    magic_enum::enum_name(format)));
+
+  poll();
+  if (m_jobs.size() >= m_maxInFlight) {
+    m_stalls++;
+    retireOldest();
+  }
+
+  auto job = std::make_shared<Job>();
+  job->buffer = acquireBuffer(
+      SDL_CalculateGPUTextureFormatSize(format, width, height, 1));
+  job->format = format;
+  job->width = width;
+  job->height = height;
+  job->filename = std::move(filename);
+  job->options = options;
+
+  SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(cmdBuf);
+  SDL_GPUTextureRegion source{
+      .texture = texture,
+      .layer = 0,
+      .w = width,
+      .h = height,
+      .d = 1,
+  };
+  SDL_GPUTextureTransferInfo destination{
+      .transfer_buffer = job->buffer.handle,
+      .offset = 0,
+  };
+  SDL_DownloadFromGPUTexture(copy_pass, &source, &destination);
+  SDL_EndGPUCopyPass(copy_pass);
+
+  job->fence = cmdBuf.submitAndAcquireFence();
+  if (!job->fence) {
+    m_freeBuffers.push_back(job->buffer);
+    throw RAIIException(SDL_GetError());
+  }
+  m_requested++;
+  std::future<void> future = job->promise.get_future();
+  m_jobs.push_back(std::move(job));
+  return future;
+}
+
+void ScreenshotCapture::dispatch(const std::shared_ptr<Job> &job) {
+  SDL_ReleaseGPUFence(_device, job->fence);
+  job->fence = nullptr;
+  job->mapped = static_cast<const Uint8 *>(
+      SDL_MapGPUTransferBuffer(_device, job->buffer.handle, false));
+  m_activeWrites++;
+
+  m_workers.push([this, job] {
+    try {
+      if (!job->mapped)
+        throw std::runtime_error("Failed to map transfer buffer.");
+      const Uint32 channels = imageFileChannels(job->options.format);
+      const Uint32 pixelCount = job->width * job->height;
+      std::vector<Uint8> pixels(size_t(pixelCount) * channels);
+      convertPixels(job->mapped, job->format, pixels.data(), pixelCount,
+                    channels);
+      job->readDone.store(true, std::memory_order_release);
+      job->readDone.notify_all();
+
+      writeImageFile(job->filename, pixels.data(), job->width, job->height,
+                     channels, job->options);
+      m_written++;
+      job->promise.set_value();
+    } catch (...) {
+      job->readDone.store(true, std::memory_order_release);
+      job->readDone.notify_all();
+      m_failed++;
+      job->promise.set_exception(std::current_exception());
+    }
+    m_activeWrites--;
+    m_activeWrites.notify_all();
+  });
+}
+
+void ScreenshotCapture::poll() {
+  for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+    const std::shared_ptr<Job> &job = *it;
+    if (job->fence && SDL_QueryGPUFence(_device, job->fence))
+      dispatch(job);
+    if (!job->fence && job->readDone.load(std::memory_order_acquire)) {
+      if (job->mapped)
+        SDL_UnmapGPUTransferBuffer(_device, job->buffer.handle);
+      m_freeBuffers.push_back(job->buffer);
+      it = m_jobs.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ScreenshotCapture::retireOldest() {
+  const std::shared_ptr<Job> &job = m_jobs.front();
+  if (job->fence) {
+    SDL_WaitForGPUFences(_device, true, &job->fence, 1);
+    dispatch(job);
+  }
+  job->readDone.wait(false, std::memory_order_acquire);
+  poll();
+}
+
+void ScreenshotCapture::waitAll() {
+  while (!m_jobs.empty())
+    retireOldest();
+  Uint32 active = m_activeWrites.load(std::memory_order_acquire);
+  while (active != 0) {
+    m_activeWrites.wait(active, std::memory_order_acquire);
+    active = m_activeWrites.load(std::memory_order_acquire);
+  }
+}
+
+auto ScreenshotCapture::stats() const -> Stats {
+  return {
+      .requested = m_requested.load(),
+      .written = m_written.load(),
+      .failed = m_failed.load(),
+      .stalls = m_stalls.load(),
+  };
+}
+
+void ScreenshotCapture::release() noexcept {
+  if (!_device)
+    return;
+  waitAll();
+  for (TransferBuffer &buffer : m_freeBuffers)
+    SDL_ReleaseGPUTransferBuffer(_device, buffer.handle);
+  m_freeBuffers.clear();
+  _device = nullptr;
+}
+
+} // namespace candlewick::media
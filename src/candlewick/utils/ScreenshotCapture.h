@@ -0,0 +1,135 @@
+#pragma once
+
+#include "../core/Core.h"
+#include "ThreadPool.h"
+#include <SDL3/SDL_gpu.h>
+
+#include <atomic>
+#include <future>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace candlewick {
+namespace media {
+
+  enum class ImageFileFormat {
+    /// PNG, compressed with stb_image_write. Slowest to write.
+    PNG,
+    /// Binary PPM (P6): uncompressed RGB, alpha is dropped.
+    PPM,
+    /// PAM (P7): uncompressed RGBA.
+    PAM,
+    /// NumPy array file, of shape (height, width, 4) and type uint8.
+    NPY,
+  };
+
+  struct ImageWriteOptions {
+    ImageFileFormat format = ImageFileFormat::PNG;
+    /// Compression level for PNG files, from 5 (fastest) to 9. Levels out of
+    /// this range are clamped: stb_image_write does not go below 5.
+    int pngCompressionLevel = 8;
+  };
+
+  /// \brief Number of channels written for the given file format.
+  constexpr Uint32 imageFileChannels(ImageFileFormat format) {
+    return format == ImageFileFormat::PPM ? 3u : 4u;
+  }
+
+  /// \brief Write 8-bit pixels to an image file, synchronously.
+  /// \param channels Must be imageFileChannels(options.format).
+  /// \throws std::runtime_error if the file cannot be written.
+  void writeImageFile(const std::string &filename, const Uint8 *pixels,
+                      Uint32 width, Uint32 height, Uint32 channels,
+                      const ImageWriteOptions &options);
+
+  /// \brief Asynchronous capture of textures to image files.
+  ///
+  /// capture() records the download of the texture at the end of a command
+  /// buffer, submits it, and returns immediately. Once the download has
+  /// completed (checked when calling capture() or poll()), the pixels are
+  /// converted and written by a pool of worker threads, straight from the
+  /// mapped transfer buffer. Transfer buffers are pooled and reused.
+  ///
+  /// All member functions must be called from the thread which owns the
+  /// device.
+  class ScreenshotCapture {
+  public:
+    struct Stats {
+      /// Captures requested.
+      Uint64 requested = 0;
+      /// Images successfully written.
+      Uint64 written = 0;
+      /// Captures which failed (e.g. I/O error).
+      Uint64 failed = 0;
+      /// Times capture() had to wait because too many captures were in
+      /// flight.
+      Uint64 stalls = 0;
+    };
+
+    /// \param numWorkers Number of threads for pixel conversion and encoding.
+    /// \param maxInFlight Maximum number of captures waiting on the GPU or on
+    /// a worker before capture() blocks. This bounds the number of transfer
+    /// buffers.
+    ScreenshotCapture(const Device &device, Uint32 numWorkers = 2,
+                      Uint32 maxInFlight = 4);
+    ScreenshotCapture(const ScreenshotCapture &) = delete;
+    ScreenshotCapture &operator=(const ScreenshotCapture &) = delete;
+
+    /// \brief Record the download of \p texture into \p cmdBuf, submit it,
+    /// and write the image asynchronously.
+    ///
+    /// Supported texture formats are `R8G8B8A8_UNORM`, `B8G8R8A8_UNORM` and
+    /// `R32G32B32A32_FLOAT`.
+    /// \returns A future which becomes ready once the file is written, and
+    /// holds the exception if writing failed.
+    std::future<void> capture(CommandBuffer &cmdBuf, SDL_GPUTexture *texture,
+                              SDL_GPUTextureFormat format, Uint32 width,
+                              Uint32 height, std::string filename,
+                              const ImageWriteOptions &options = {});
+
+    /// \brief Hand completed downloads over to the workers, and recycle the
+    /// transfer buffers they are done reading. Does not block.
+    void poll();
+
+    /// \brief Wait until every capture has been written.
+    void waitAll();
+
+    Uint32 inFlight() const { return Uint32(m_jobs.size()); }
+    Stats stats() const;
+
+    /// \brief Wait for all captures, then release the transfer buffers.
+    void release() noexcept;
+    ~ScreenshotCapture() noexcept { this->release(); }
+
+    static bool isFormatSupported(SDL_GPUTextureFormat format);
+
+  private:
+    struct Job;
+    struct TransferBuffer {
+      SDL_GPUTransferBuffer *handle;
+      Uint32 size;
+    };
+
+    TransferBuffer acquireBuffer(Uint32 size);
+    /// Map the job's buffer and hand it to the worker pool.
+    void dispatch(const std::shared_ptr<Job> &job);
+    /// Block until the oldest job's buffer can be recycled, then recycle it.
+    void retireOldest();
+
+    SDL_GPUDevice *_device;
+    Uint32 m_maxInFlight;
+    std::list<std::shared_ptr<Job>> m_jobs;
+    std::vector<TransferBuffer> m_freeBuffers;
+    std::atomic<Uint32> m_activeWrites{0};
+    std::atomic<Uint64> m_requested{0};
+    std::atomic<Uint64> m_written{0};
+    std::atomic<Uint64> m_failed{0};
+    std::atomic<Uint64> m_stalls{0};
+    // declared last, so that the workers are joined first on destruction
+    ThreadPool m_workers;
+  };
+
+} // namespace media
+} // namespace candlewick
@@ -0,0 +1,208 @@
+#include "SharedFrameSink.h"
+#include "GBufferReadback.h"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <sys/stat.h>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+namespace candlewick::media {
+
+static Uint64 alignUp(Uint64 value, Uint64 alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+static Uint64 monotonicTimeNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return Uint64(ts.tv_sec) * 1'000'000'000ull + Uint64(ts.tv_nsec);
+}
+
+/// Clear the magic number of the segment \p name, if there is one: its
+/// readers then know it is no longer written to.
+static void markStale(const std::string &name) {
+  const int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0)
+    return;
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      size_t(st.st_size) < sizeof(candlewick_shm_frames_header)) {
+    close(fd);
+    return;
+  }
+  void *mem = mmap(nullptr, sizeof(candlewick_shm_frames_header),
+                   PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED)
+    return;
+  auto *header = static_cast<candlewick_shm_frames_header *>(mem);
+  __atomic_store_n(&header->magic, 0u, __ATOMIC_RELEASE);
+  munmap(mem, sizeof(candlewick_shm_frames_header));
+}
+
+SharedFrameSink::SharedFrameSink(const std::string &name,
+                                 std::span<const ReadbackPlane> planes,
+                                 Uint32 numSlots)
+    : m_planes(planes.begin(), planes.end()), m_name(name) {
+  if (planes.empty() || planes.size() > CANDLEWICK_SHM_FRAMES_MAX_PLANES)
+    throw std::invalid_argument(
+        std::format("SharedFrameSink: frames must have 1 to {:d} planes.",
+                    CANDLEWICK_SHM_FRAMES_MAX_PLANES));
+  if (numSlots < 2)
+    throw std::invalid_argument("SharedFrameSink: at least 2 slots needed.");
+
+  candlewick_shm_frames_header header_desc{};
+  header_desc.num_planes = Uint32(planes.size());
+  header_desc.capacity = numSlots;
+  for (size_t i = 0; i < planes.size(); i++) {
+    const ReadbackPlane &plane = planes[i];
+    auto &desc = header_desc.planes[i];
+    desc.format = Uint32(plane.format);
+    desc.width = plane.width;
+    desc.height = plane.height;
+    desc.row_pitch =
+        SDL_CalculateGPUTextureFormatSize(plane.format, plane.width, 1, 1);
+    desc.offset = m_payloadSize;
+    desc.size = SDL_CalculateGPUTextureFormatSize(plane.format, plane.width,
+                                                  plane.height, 1);
+    // readback payloads are tightly packed: so are the planes of a slot
+    m_payloadSize += desc.size;
+  }
+  // page-aligned slots can be mapped or registered separately by consumers
+  header_desc.slot_stride =
+      alignUp(sizeof(candlewick_shm_frames_slot) + m_payloadSize, 4096);
+  m_size = sizeof(candlewick_shm_frames_header) +
+           size_t(numSlots) * header_desc.slot_stride;
+
+  // A segment left over by a previous run may still be mapped by readers:
+  // resizing it would fault them. Retire it, and create a new one.
+  markStale(name);
+  shm_unlink(name.c_str());
+  const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+    throw std::runtime_error(
+        std::format("Failed to create shared frames '{:s}': {:s}", name,
+                    strerror(errno)));
+  if (ftruncate(fd, off_t(m_size)) != 0) {
+    const int err = errno;
+    close(fd);
+    shm_unlink(name.c_str());
+    throw std::runtime_error(std::format(
+        "Failed to resize shared frames '{:s}': {:s}", name, strerror(err)));
+  }
+  void *mem = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) {
+    const int err = errno;
+    shm_unlink(name.c_str());
+    throw std::runtime_error(std::format(
+        "Failed to map shared frames '{:s}': {:s}", name, strerror(err)));
+  }
+
+  m_header = static_cast<candlewick_shm_frames_header *>(mem);
+  *m_header = header_desc;
+  m_header->version = CANDLEWICK_SHM_FRAMES_VERSION;
+  // readers check the magic number first
+  __atomic_store_n(&m_header->magic, CANDLEWICK_SHM_FRAMES_MAGIC,
+                   __ATOMIC_RELEASE);
+}
+
+SharedFrameSink::SharedFrameSink(SharedFrameSink &&other) noexcept
+    : m_header(std::exchange(other.m_header, nullptr)), m_size(other.m_size),
+      m_payloadSize(other.m_payloadSize), m_planes(std::move(other.m_planes)),
+      m_name(std::move(other.m_name)) {}
+
+SharedFrameSink &SharedFrameSink::operator=(SharedFrameSink &&other) noexcept {
+  if (this != &other) {
+    release();
+    m_header = std::exchange(other.m_header, nullptr);
+    m_size = other.m_size;
+    m_payloadSize = other.m_payloadSize;
+    m_planes = std::move(other.m_planes);
+    m_name = std::move(other.m_name);
+  }
+  return *this;
+}
+
+candlewick_shm_frames_slot *SharedFrameSink::beginWrite(Uint64 &index) {
+  index = __atomic_load_n(&m_header->write_count, __ATOMIC_RELAXED);
+  char *slots = reinterpret_cast<char *>(m_header + 1);
+  auto *slot = reinterpret_cast<candlewick_shm_frames_slot *>(
+      slots + (index % m_header->capacity) * m_header->slot_stride);
+  __atomic_store_n(&slot->sequence, 2 * index + 1, __ATOMIC_RELAXED);
+  // the odd sequence must be visible before the data changes
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  return slot;
+}
+
+void SharedFrameSink::endWrite(candlewick_shm_frames_slot *slot,
+                               Uint64 index) {
+  slot->timestamp_ns = monotonicTimeNs();
+  __atomic_store_n(&slot->sequence, 2 * index + 2, __ATOMIC_RELEASE);
+  __atomic_store_n(&m_header->write_count, index + 1, __ATOMIC_RELEASE);
+}
+
+void SharedFrameSink::writeFrame(const Uint8 *data, Uint64 payloadSize) {
+  if (payloadSize != m_payloadSize)
+    throw std::invalid_argument(
+        std::format("SharedFrameSink: frame of {:d} bytes, expected {:d}.",
+                    payloadSize, m_payloadSize));
+  Uint64 index;
+  candlewick_shm_frames_slot *slot = beginWrite(index);
+  std::memcpy(slot + 1, data, payloadSize);
+  endWrite(slot, index);
+}
+
+template <typename T> static std::span<const Uint8> asBytes(std::span<T> s) {
+  return {reinterpret_cast<const Uint8 *>(s.data()), s.size_bytes()};
+}
+
+void SharedFrameSink::writeFrame(const GBufferFrame &frame) {
+  // same order as the planes of readbackPlanes()
+  std::span<const Uint8> buffers[CANDLEWICK_SHM_FRAMES_MAX_PLANES];
+  Uint32 count = 0;
+  for (auto buffer : {frame.color, asBytes(frame.linear_depth),
+                      asBytes(frame.normals), asBytes(frame.instance_ids)}) {
+    if (buffer.empty())
+      continue;
+    if (count == m_header->num_planes ||
+        buffer.size() != m_header->planes[count].size)
+      throw std::invalid_argument(
+          "SharedFrameSink: frame buffers do not match the sink planes.");
+    buffers[count++] = buffer;
+  }
+  if (count != m_header->num_planes)
+    throw std::invalid_argument(
+        "SharedFrameSink: frame buffers do not match the sink planes.");
+
+  Uint64 index;
+  candlewick_shm_frames_slot *slot = beginWrite(index);
+  Uint8 *dst = reinterpret_cast<Uint8 *>(slot + 1);
+  for (Uint32 i = 0; i < count; i++)
+    std::memcpy(dst + m_header->planes[i].offset, buffers[i].data(),
+                buffers[i].size());
+  endWrite(slot, index);
+}
+
+void SharedFrameSink::release() noexcept {
+  if (!m_header)
+    return;
+  __atomic_store_n(&m_header->magic, 0u, __ATOMIC_RELEASE);
+  munmap(m_header, m_size);
+  shm_unlink(m_name.c_str());
+  m_header = nullptr;
+  m_size = 0;
+}
+
+FrameReadbackRing createSharedFrameReadbackRing(const Device &device,
+                                                SharedFrameSink &sink,
+                                                Uint32 numSlots,
+                                                ReadbackFullPolicy policy) {
+  return FrameReadbackRing{device, sink.planes(), sink.callback(), numSlots,
+                           policy};
+}
+
+} // namespace candlewick::media
@@ -0,0 +1,88 @@
+#pragma once
+
+#ifndef CANDLEWICK_WITH_SHARED_STATE
+#error "Including this file requires candlewick to be built on a POSIX system"
+#endif
+#include "FrameReadback.h"
+#include "shm_frames.h"
+#include <span>
+#include <string>
+#include <vector>
+
+namespace candlewick {
+namespace media {
+
+  struct GBufferFrame;
+
+  /// \brief Output of rendered frames to a shared-memory ring, which other
+  /// processes read without copies using the C API of shm_frames.h.
+  ///
+  /// The sink is fed from the readback callbacks, so a frame is written with
+  /// a single copy, from the mapped transfer buffer to the shared segment.
+  /// Writing never waits for readers: the oldest frames are overwritten, and
+  /// the per-slot sequence numbers let readers detect it.
+  ///
+  /// \sa createSharedFrameReadbackRing()
+  class SharedFrameSink {
+  public:
+    SharedFrameSink(NoInitT) {}
+    /// \brief Create (or replace) the shared memory object \p name, holding
+    /// \p numSlots frames made of \p planes. A segment left with the same
+    /// name is marked stale for its readers, and unlinked rather than
+    /// resized.
+    /// \throws std::runtime_error if the object cannot be created.
+    SharedFrameSink(const std::string &name,
+                    std::span<const ReadbackPlane> planes,
+                    Uint32 numSlots = 4);
+    SharedFrameSink(const SharedFrameSink &) = delete;
+    SharedFrameSink &operator=(const SharedFrameSink &) = delete;
+    SharedFrameSink(SharedFrameSink &&other) noexcept;
+    SharedFrameSink &operator=(SharedFrameSink &&other) noexcept;
+    ~SharedFrameSink() noexcept { release(); }
+
+    bool initialized() const { return m_header != nullptr; }
+    const std::string &name() const { return m_name; }
+    std::span<const ReadbackPlane> planes() const { return m_planes; }
+    /// \brief Size of a frame, all planes included.
+    Uint64 payloadSize() const { return m_payloadSize; }
+    Uint64 framesWritten() const { return m_header->write_count; }
+
+    /// \brief Write a frame, with its planes stored back-to-back in \p data
+    /// (as delivered by FrameReadbackRing).
+    void writeFrame(const Uint8 *data, Uint64 payloadSize);
+    /// \brief Write the buffers of a GBufferReadback frame. The sink must
+    /// have been created with the planes of the same GBufferReadbackConfig.
+    /// \sa readbackPlanes()
+    void writeFrame(const GBufferFrame &frame);
+
+    /// \brief Callback writing the frames of a FrameReadbackRing to this
+    /// sink, which must outlive the ring.
+    FrameReadbackRing::FrameCallback callback() {
+      return [this](const Uint8 *data, Uint32 size) { writeFrame(data, size); };
+    }
+
+    /// \brief Unmap the segment and remove its name. Readers which mapped it
+    /// keep their mapping, and see it stale.
+    void release() noexcept;
+
+  private:
+    candlewick_shm_frames_slot *beginWrite(Uint64 &index);
+    void endWrite(candlewick_shm_frames_slot *slot, Uint64 index);
+
+    candlewick_shm_frames_header *m_header = nullptr;
+    size_t m_size = 0;
+    Uint64 m_payloadSize = 0;
+    std::vector<ReadbackPlane> m_planes;
+    std::string m_name;
+  };
+
+  /// \brief Create a FrameReadbackRing which writes its frames to \p sink.
+  /// The texture sizes and formats are the planes of the sink.
+  FrameReadbackRing
+  createSharedFrameReadbackRing(const Device &device, SharedFrameSink &sink,
+                                Uint32 numSlots = 3,
+                                ReadbackFullPolicy policy =
+                                    ReadbackFullPolicy::WAIT);
+
+} // namespace media
+} // namespace candlewick
@@ -0,0 +1,157 @@
+#include "SharedMemoryState.h"
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <utility>
+
+namespace candlewick {
+
+SharedStateReader::SharedStateReader(const std::string &name) : m_name(name) {
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    throw std::runtime_error(std::format(
+        "Failed to open shared state '{:s}': {:s}", name, strerror(errno)));
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      size_t(st.st_size) < sizeof(candlewick_shm_state_header)) {
+    close(fd);
+    throw std::runtime_error(
+        std::format("Shared state '{:s}' is too small.", name));
+  }
+  void *mem = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED)
+    throw std::runtime_error(std::format(
+        "Failed to map shared state '{:s}': {:s}", name, strerror(errno)));
+  m_header = static_cast<candlewick_shm_state_header *>(mem);
+  m_size = size_t(st.st_size);
+
+  // the producer writes the magic number last
+  const Uint32 magic = __atomic_load_n(&m_header->magic, __ATOMIC_ACQUIRE);
+  const char *error = nullptr;
+  if (magic != CANDLEWICK_SHM_STATE_MAGIC)
+    error = "is not initialized";
+  else if (m_header->version != CANDLEWICK_SHM_STATE_VERSION)
+    error = "has an unsupported version";
+  else if (m_header->capacity < 2 ||
+           m_header->slot_stride !=
+               candlewick_shm_state_slot_stride(m_header->dim) ||
+           m_size < candlewick_shm_state_segment_size(m_header->dim,
+                                                      m_header->capacity))
+    error = "has an invalid layout";
+  if (error) {
+    release();
+    throw std::runtime_error(
+        std::format("Shared state '{:s}' {:s}.", name, error));
+  }
+  m_kind = SharedStateKind(m_header->kind);
+  m_dim = m_header->dim;
+  m_capacity = m_header->capacity;
+  m_slotStride = m_header->slot_stride;
+}
+
+SharedStateReader::SharedStateReader(SharedStateReader &&other) noexcept
+    : m_header(std::exchange(other.m_header, nullptr)), m_size(other.m_size),
+      m_name(std::move(other.m_name)), m_kind(other.m_kind),
+      m_dim(other.m_dim), m_capacity(other.m_capacity),
+      m_slotStride(other.m_slotStride), m_stale(other.m_stale),
+      m_readCount(other.m_readCount), m_stats(other.m_stats) {}
+
+SharedStateReader &
+SharedStateReader::operator=(SharedStateReader &&other) noexcept {
+  if (this != &other) {
+    release();
+    m_header = std::exchange(other.m_header, nullptr);
+    m_size = other.m_size;
+    m_name = std::move(other.m_name);
+    m_kind = other.m_kind;
+    m_dim = other.m_dim;
+    m_capacity = other.m_capacity;
+    m_slotStride = other.m_slotStride;
+    m_stale = other.m_stale;
+    m_readCount = other.m_readCount;
+    m_stats = other.m_stats;
+  }
+  return *this;
+}
+
+void SharedStateReader::checkDim(Uint32 nq, Uint32 ngeoms) const {
+  const Uint32 expected =
+      kind() == SharedStateKind::CONFIGURATION ? nq : 12 * ngeoms;
+  if (dim() != expected)
+    throw std::invalid_argument(
+        std::format("Shared state has samples of dimension {:d}, expected "
+                    "{:d}.",
+                    dim(), expected));
+}
+
+const candlewick_shm_state_slot *
+SharedStateReader::slotAt(Uint64 index) const {
+  const char *slots = reinterpret_cast<const char *>(m_header) +
+                      sizeof(candlewick_shm_state_header);
+  return reinterpret_cast<const candlewick_shm_state_slot *>(
+      slots + (index % m_capacity) * m_slotStride);
+}
+
+Uint64 SharedStateReader::publishedCount() const {
+  return __atomic_load_n(&m_header->write_count, __ATOMIC_ACQUIRE);
+}
+
+bool SharedStateReader::readLatest(std::span<double> data, double &timestamp) {
+  const Uint32 dim = m_dim;
+  if (data.size() < dim)
+    throw std::invalid_argument(
+        std::format("SharedStateReader: buffer of size {:d} is smaller than "
+                    "the sample dimension {:d}.",
+                    data.size(), dim));
+
+  while (true) {
+    if (m_stale)
+      return false;
+    const Uint64 count = publishedCount();
+    // the producer clears the magic number of a segment it replaces, and a
+    // count going back means the segment was reset in place by an older
+    // producer
+    if (__atomic_load_n(&m_header->magic, __ATOMIC_ACQUIRE) !=
+            CANDLEWICK_SHM_STATE_MAGIC ||
+        count < m_readCount) {
+      m_stale = true;
+      return false;
+    }
+    if (count == m_readCount)
+      return false;
+    const Uint64 index = count - 1;
+    const candlewick_shm_state_slot *slot = slotAt(index);
+
+    // sequence lock: the copy is valid if the sequence of the slot is the
+    // one of sample `index` before and after it
+    const Uint64 expected = 2 * index + 2;
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) == expected) {
+      const double t = slot->timestamp;
+      std::memcpy(data.data(), slot + 1, dim * sizeof(double));
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == expected) {
+        timestamp = t;
+        m_stats.skipped += index - m_readCount;
+        m_stats.read++;
+        m_readCount = count;
+        return true;
+      }
+    }
+    // the producer lapped the ring during the copy: read a newer sample
+    m_stats.retries++;
+  }
+}
+
+void SharedStateReader::release() noexcept {
+  if (m_header)
+    munmap(m_header, m_size);
+  m_header = nullptr;
+  m_size = 0;
+  m_stale = false;
+}
+
+} // namespace candlewick
@@ -0,0 +1,101 @@
+#pragma once
+
+#ifndef CANDLEWICK_WITH_SHARED_STATE
+#error "Including this file requires candlewick to be built on a POSIX system"
+#endif
+#include "../core/Tags.h"
+#include "shm_state.h"
+#include <SDL3/SDL_stdinc.h>
+#include <span>
+#include <string>
+
+namespace candlewick {
+
+/// \brief Kind of samples in a shared-memory state channel.
+enum class SharedStateKind : Uint32 {
+  /// Configuration vectors \f$q\f$.
+  CONFIGURATION = CANDLEWICK_SHM_STATE_CONFIGURATION,
+  /// Geometry placements, as row-major \f$3 \times 4\f$ matrices.
+  PLACEMENTS = CANDLEWICK_SHM_STATE_PLACEMENTS,
+};
+
+/// \brief Counters for SharedStateReader.
+struct SharedStateStats {
+  /// Samples copied out by readLatest().
+  Uint64 read = 0;
+  /// Samples published, but never read because a newer one was available.
+  Uint64 skipped = 0;
+  /// Copies which were overwritten by the producer and retried.
+  Uint64 retries = 0;
+};
+
+/// \brief Reader of a shared-memory state channel, written by another
+/// process with the C API of shm_state.h.
+///
+/// The channel is a ring of samples guarded by sequence locks: reading the
+/// newest sample takes one copy, without locks or system calls, and never
+/// blocks the producer.
+///
+/// The layout of the channel is read once, when opening it. If the producer
+/// re-creates the channel (e.g. after a restart), the mapped segment becomes
+/// stale: readLatest() stops returning samples, and the reader must be opened
+/// again.
+class SharedStateReader {
+public:
+  SharedStateReader(NoInitT) {}
+  /// \brief Open and map the shared memory object \p name.
+  /// \throws std::runtime_error if the object does not exist, or was not
+  /// initialized by a compatible producer.
+  explicit SharedStateReader(const std::string &name);
+  SharedStateReader(const SharedStateReader &) = delete;
+  SharedStateReader &operator=(const SharedStateReader &) = delete;
+  SharedStateReader(SharedStateReader &&other) noexcept;
+  SharedStateReader &operator=(SharedStateReader &&other) noexcept;
+  ~SharedStateReader() noexcept { release(); }
+
+  bool initialized() const { return m_header != nullptr; }
+  const std::string &name() const { return m_name; }
+  SharedStateKind kind() const { return m_kind; }
+  /// \brief Number of doubles per sample.
+  Uint32 dim() const { return m_dim; }
+  /// \brief Whether the producer re-created or closed the channel since it
+  /// was opened. Checked by readLatest().
+  bool stale() const { return m_stale; }
+  /// \brief Check that the samples are states of a robot with \p nq
+  /// configuration variables and \p ngeoms geometries, following kind().
+  /// \throws std::invalid_argument if dim() does not match.
+  void checkDim(Uint32 nq, Uint32 ngeoms) const;
+
+  /// \brief Copy the newest sample into \p data if it is newer than the last
+  /// one read.
+  /// \param data Buffer of at least dim() values.
+  /// \param timestamp Timestamp of the sample, set by the producer.
+  /// \returns Whether a new sample was read. Always false once the channel
+  /// is stale().
+  bool readLatest(std::span<double> data, double &timestamp);
+
+  /// \brief Number of samples published so far.
+  Uint64 publishedCount() const;
+
+  const SharedStateStats &stats() const { return m_stats; }
+
+  void release() noexcept;
+
+private:
+  const candlewick_shm_state_slot *slotAt(Uint64 index) const;
+
+  candlewick_shm_state_header *m_header = nullptr;
+  size_t m_size = 0;
+  std::string m_name;
+  // layout of the channel, read when opening it
+  SharedStateKind m_kind = SharedStateKind::CONFIGURATION;
+  Uint32 m_dim = 0;
+  Uint32 m_capacity = 0;
+  Uint32 m_slotStride = 0;
+  bool m_stale = false;
+  // number of published samples at the last successful read
+  Uint64 m_readCount = 0;
+  SharedStateStats m_stats;
+};
+
+} // namespace candlewick
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace candlewick {
+
+/// \brief Fixed-size pool of worker threads, consuming a FIFO queue of tasks.
+///
+/// The destructor runs the tasks which are still queued, then joins the
+/// threads.
+class ThreadPool {
+public:
+  explicit ThreadPool(Uint32 numThreads) {
+    for (Uint32 i = 0; i < std::max(numThreads, 1u); i++)
+      m_threads.emplace_back([this] { workerLoop(); });
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  Uint32 size() const { return Uint32(m_threads.size()); }
+
+  void push(std::function<void()> task) {
+    {
+      std::lock_guard lock{m_mutex};
+      m_tasks.push_back(std::move(task));
+    }
+    m_cond.notify_one();
+  }
+
+  ~ThreadPool() noexcept {
+    {
+      std::lock_guard lock{m_mutex};
+      m_stopping = true;
+    }
+    m_cond.notify_all();
+    for (auto &thread : m_threads)
+      thread.join();
+  }
+
+private:
+  void workerLoop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock lock{m_mutex};
+        m_cond.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+        if (m_tasks.empty())
+          return;
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::deque<std::function<void()>> m_tasks;
+  bool m_stopping = false;
+};
+
+} // namespace candlewick
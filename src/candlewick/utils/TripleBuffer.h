@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <SDL3/SDL_stdinc.h>
+
+namespace candlewick {
+
+/// \brief Lock-free triple buffer, passing the latest value from one producer
+/// thread to one consumer thread.
+///
+/// The producer fills writeBuffer() and calls publish(); the consumer calls
+/// consume() and reads readBuffer(). Neither side ever waits for the other:
+/// values published faster than they are consumed are overwritten, and the
+/// consumer always gets the most recent one. Buffers are reused, so values
+/// holding heap storage (e.g. vectors of a fixed size) do not allocate after
+/// the first round.
+template <typename T> class TripleBuffer {
+public:
+  TripleBuffer() = default;
+  /// \brief Initialize the three buffers with copies of \p value.
+  explicit TripleBuffer(const T &value) : m_buffers{value, value, value} {}
+
+  TripleBuffer(const TripleBuffer &) = delete;
+  TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+  /// \brief Buffer owned by the producer. Its contents are unspecified after
+  /// publish(): it holds an older value, which should be overwritten.
+  T &writeBuffer() noexcept { return m_buffers[m_back]; }
+
+  /// \brief Make the write buffer the latest value. Producer thread only.
+  void publish() noexcept {
+    const Uint8 prev =
+        m_middle.exchange(Uint8(m_back | DIRTY_BIT), std::memory_order_acq_rel);
+    m_back = prev & INDEX_MASK;
+  }
+
+  /// \brief Fetch the latest published value into readBuffer(), if a new one
+  /// was published since the last call. Consumer thread only.
+  /// \returns Whether readBuffer() changed.
+  bool consume() noexcept {
+    if (!(m_middle.load(std::memory_order_relaxed) & DIRTY_BIT))
+      return false;
+    const Uint8 prev = m_middle.exchange(m_front, std::memory_order_acq_rel);
+    m_front = prev & INDEX_MASK;
+    return true;
+  }
+
+  /// \brief Buffer owned by the consumer, holding the last consumed value.
+  const T &readBuffer() const noexcept { return m_buffers[m_front]; }
+
+private:
+  static constexpr Uint8 INDEX_MASK = 0x3;
+  static constexpr Uint8 DIRTY_BIT = 0x4;
+
+  std::array<T, 3> m_buffers;
+  // middle buffer index, and whether it holds an unconsumed value
+  std::atomic<Uint8> m_middle{1};
+  // keep the indices owned by each thread on separate cache lines
+  alignas(64) Uint8 m_back = 0;
+  alignas(64) Uint8 m_front = 2;
+};
+
+} // namespace candlewick
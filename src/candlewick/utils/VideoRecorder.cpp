@@ -2,20 +2,35 @@
 
 #include <SDL3/SDL_log.h>
 #include <SDL3/SDL_filesystem.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
 #include <format>
+#include <thread>
+#include <vector>
 
 extern "C" {
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
 #include <libswscale/swscale.h>
 }
 
 namespace candlewick::media {
 
+/// Frame buffer from the recorder's pool, holding a copy of incoming data.
+struct PooledFrame {
+  std::vector<Uint8> data;
+  AVPixelFormat format = AV_PIX_FMT_NONE;
+  Uint32 width = 0;
+  Uint32 height = 0;
+};
+
 struct VideoRecorderImpl {
   Uint32 m_width;  //< Width of incoming frames
   Uint32 m_height; //< Height of incoming frames
-  Uint32 m_frameCounter;
+  std::atomic<Uint32> m_frameCounter{0};
 
   AVFormatContext *formatContext = nullptr;
   const AVCodec *codec = nullptr;
@@ -25,32 +40,38 @@ struct VideoRecorderImpl {
   AVFrame *frame = nullptr;
   AVPacket *packet = nullptr;
 
+  std::vector<PooledFrame> m_pool;
+  /// Slots of m_pool handed over to the encoder thread.
+  FrameQueue m_queue;
+  std::atomic<bool> m_failed{false};
+  std::exception_ptr m_encoderError;
+  std::thread m_encoderThread;
+  bool m_closed = false;
+
   VideoRecorderImpl(Uint32 width, Uint32 height, const std::string &filename,
                     VideoRecorder::Settings settings);
   void writeFrame(const Uint8 *data, size_t payloadSize,
-                  AVPixelFormat avPixelFormat);
-  ~VideoRecorderImpl() noexcept;
+                  AVPixelFormat avPixelFormat, Uint32 width, Uint32 height);
+  void close();
+  ~VideoRecorderImpl() noexcept { this->close(); }
+
+private:
+  void rethrowEncoderError() const;
+  void encoderLoop();
+  void encodeFrame(const PooledFrame &source);
+  /// Copy an NV12 frame of the output size to the encoder's YUV420P frame.
+  void copyNv12Frame(const PooledFrame &source);
+  /// Send a frame to the encoder (or null to flush it), and write the
+  /// resulting packets.
+  void sendFrame(AVFrame *avFrame);
 };
 
-VideoRecorderImpl::~VideoRecorderImpl() noexcept {
-  av_write_trailer(formatContext);
-  if (codecContext)
-    avcodec_free_context(&codecContext);
-  if (formatContext->pb)
-    avio_closep(&formatContext->pb);
-
-  avformat_free_context(formatContext);
-
-  if (frame)
-    av_frame_free(&frame);
-  if (packet)
-    av_packet_free(&packet);
-}
-
 VideoRecorderImpl::VideoRecorderImpl(Uint32 width, Uint32 height,
                                      const std::string &filename,
                                      VideoRecorder::Settings settings)
-    : m_width(width), m_height(height) {
+    : m_width(width), m_height(height),
+      m_pool(std::max(settings.queue_capacity, 1u)),
+      m_queue(Uint32(m_pool.size()), settings.queue_policy) {
   avformat_network_init();
   codec = avcodec_find_encoder(AV_CODEC_ID_H264);
 
@@ -115,39 +136,114 @@ VideoRecorderImpl::VideoRecorderImpl(Uint32 width, Uint32 height,
     throw std::runtime_error(
         std::format("Failed to allocate frame: {:s}", errbuf));
   }
+
+  m_encoderThread = std::thread(&VideoRecorderImpl::encoderLoop, this);
 }
 
-void VideoRecorderImpl::writeFrame(const Uint8 *data, size_t payloadSize,
-                                   AVPixelFormat avPixelFormat) {
-  AVFrame *tmpFrame = av_frame_alloc();
-  tmpFrame->format = avPixelFormat;
-  tmpFrame->width = int(m_width);
-  tmpFrame->height = int(m_height);
+void VideoRecorderImpl::rethrowEncoderError() const {
+  if (m_failed.load(std::memory_order_acquire))
+    std::rethrow_exception(m_encoderError);
+}
 
-  int ret = av_frame_get_buffer(tmpFrame, 0);
-  char errbuf[AV_ERROR_MAX_STRING_SIZE]{0};
-  if (ret < 0) {
-    av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
-    throw std::runtime_error(
-        std::format("Failed to allocate frame: {:s}", errbuf));
+void VideoRecorderImpl::writeFrame(const Uint8 *data, size_t payloadSize,
+                                   AVPixelFormat avPixelFormat, Uint32 width,
+                                   Uint32 height) {
+  rethrowEncoderError();
+  const int expectedSize =
+      av_image_get_buffer_size(avPixelFormat, int(width), int(height), 1);
+  if (expectedSize < 0 || payloadSize < size_t(expectedSize))
+    throw std::runtime_error(std::format(
+        "Frame payload size ({:d}) too small for a {:d}x{:d} image.",
+        payloadSize, width, height));
+
+  std::optional<Uint32> index = m_queue.acquire();
+  if (!index) {
+    rethrowEncoderError();
+    return;
   }
+  PooledFrame &pooled = m_pool[*index];
+  // does not reallocate once the pool is warm
+  pooled.data.assign(data, data + expectedSize);
+  pooled.format = avPixelFormat;
+  pooled.width = width;
+  pooled.height = height;
+
+  m_queue.submit(*index);
+}
 
-  memcpy(tmpFrame->data[0], data, payloadSize);
-
-  swsContext =
-      sws_getContext(tmpFrame->width, tmpFrame->height, avPixelFormat,
-                     frame->width, frame->height, codecContext->pix_fmt,
-                     SWS_BILINEAR, nullptr, nullptr, nullptr);
+void VideoRecorderImpl::encoderLoop() {
+  try {
+    while (auto index = m_queue.popReady()) {
+      encodeFrame(m_pool[*index]);
+      m_queue.release(*index);
+    }
+    // flush the encoder
+    sendFrame(nullptr);
+  } catch (...) {
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+                 "Video encoder thread stopped after an error.");
+    m_encoderError = std::current_exception();
+    m_failed.store(true, std::memory_order_release);
+    m_queue.abort();
+  }
+}
 
-  frame->pts = m_frameCounter++;
+void VideoRecorderImpl::copyNv12Frame(const PooledFrame &source) {
+  const Uint32 w = source.width;
+  const Uint32 h = source.height;
+  const Uint8 *srcY = source.data.data();
+  const Uint8 *srcUV = srcY + size_t(w) * h;
+  for (Uint32 row = 0; row < h; row++)
+    std::memcpy(frame->data[0] + row * frame->linesize[0], srcY + row * w, w);
+  for (Uint32 row = 0; row < h / 2; row++) {
+    const Uint8 *uv = srcUV + row * w;
+    Uint8 *u = frame->data[1] + row * frame->linesize[1];
+    Uint8 *v = frame->data[2] + row * frame->linesize[2];
+    for (Uint32 i = 0; i < w / 2; i++) {
+      u[i] = uv[2 * i];
+      v[i] = uv[2 * i + 1];
+    }
+  }
+}
 
-  sws_scale(swsContext, tmpFrame->data, tmpFrame->linesize, 0, m_height,
-            frame->data, frame->linesize);
+void VideoRecorderImpl::encodeFrame(const PooledFrame &source) {
+  // the encoder may still hold a reference to the previous frame's buffers
+  int ret = av_frame_make_writable(frame);
+  if (ret < 0)
+    throw std::runtime_error("Failed to make frame writable.");
+
+  if (source.format == AV_PIX_FMT_NV12 &&
+      codecContext->pix_fmt == AV_PIX_FMT_YUV420P &&
+      int(source.width) == frame->width &&
+      int(source.height) == frame->height) {
+    copyNv12Frame(source);
+  } else {
+    Uint8 *srcData[4];
+    int srcLinesize[4];
+    av_image_fill_arrays(srcData, srcLinesize, source.data.data(),
+                         source.format, int(source.width),
+                         int(source.height), 1);
+
+    swsContext = sws_getCachedContext(
+        swsContext, int(source.width), int(source.height), source.format,
+        frame->width, frame->height, codecContext->pix_fmt, SWS_BILINEAR,
+        nullptr, nullptr, nullptr);
+    if (!swsContext)
+      throw std::runtime_error("Failed to create scaling context.");
+
+    sws_scale(swsContext, srcData, srcLinesize, 0, int(source.height),
+              frame->data, frame->linesize);
+  }
+  frame->pts = m_frameCounter.load(std::memory_order_relaxed);
+  sendFrame(frame);
+  m_frameCounter.fetch_add(1, std::memory_order_release);
+}
 
-  ret = avcodec_send_frame(codecContext, frame);
+void VideoRecorderImpl::sendFrame(AVFrame *avFrame) {
+  char errbuf[AV_ERROR_MAX_STRING_SIZE]{0};
+  int ret = avcodec_send_frame(codecContext, avFrame);
   if (ret < 0) {
-    av_frame_free(&tmpFrame);
-    sws_freeContext(swsContext);
+    av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
     throw std::runtime_error(std::format("Error sending frame {:s}", errbuf));
   }
 
@@ -157,8 +253,6 @@ void VideoRecorderImpl::writeFrame(const Uint8 *data, size_t payloadSize,
       break;
     }
     if (ret < 0) {
-      av_frame_free(&tmpFrame);
-      sws_freeContext(swsContext);
       throw std::runtime_error("Error receiving packet from encoder");
     }
 
@@ -168,9 +262,30 @@ void VideoRecorderImpl::writeFrame(const Uint8 *data, size_t payloadSize,
     av_interleaved_write_frame(formatContext, packet);
     av_packet_unref(packet);
   }
+}
+
+void VideoRecorderImpl::close() {
+  if (m_closed)
+    return;
+  m_closed = true;
+  m_queue.close();
+  if (m_encoderThread.joinable())
+    m_encoderThread.join();
+
+  av_write_trailer(formatContext);
+  if (codecContext)
+    avcodec_free_context(&codecContext);
+  if (formatContext->pb)
+    avio_closep(&formatContext->pb);
+
+  avformat_free_context(formatContext);
 
-  av_frame_free(&tmpFrame);
-  sws_freeContext(swsContext);
+  if (swsContext)
+    sws_freeContext(swsContext);
+  if (frame)
+    av_frame_free(&frame);
+  if (packet)
+    av_packet_free(&packet);
 }
 
 // WRAPPING CLASS
@@ -183,11 +298,33 @@ VideoRecorder::VideoRecorder(Uint32 width, Uint32 height,
     : impl_(std::make_unique<VideoRecorderImpl>(width, height, filename,
                                                 settings)) {}
 
-Uint32 VideoRecorder::frameCounter() const { return impl_->m_frameCounter; }
+Uint32 VideoRecorder::frameCounter() const {
+  return impl_->m_frameCounter.load(std::memory_order_acquire);
+}
+
+Uint32 VideoRecorder::droppedFrames() const {
+  return impl_->m_queue.dropped();
+}
+
+Uint32 VideoRecorder::queuedFrames() const {
+  return impl_->m_queue.queued();
+}
 
 void VideoRecorder::writeFrame(const Uint8 *data, size_t payloadSize,
                                AVPixelFormat avPixelFormat) {
-  impl_->writeFrame(data, payloadSize, avPixelFormat);
+  impl_->writeFrame(data, payloadSize, avPixelFormat, impl_->m_width,
+                    impl_->m_height);
+}
+
+void VideoRecorder::writeFrame(const Uint8 *data, size_t payloadSize,
+                               AVPixelFormat avPixelFormat, Uint32 width,
+                               Uint32 height) {
+  impl_->writeFrame(data, payloadSize, avPixelFormat, width, height);
+}
+
+void VideoRecorder::close() {
+  if (impl_)
+    impl_->close();
 }
 
 VideoRecorder::~VideoRecorder() = default;
@@ -7,6 +7,7 @@
 #include <string>
 #include <memory>
 #include "candlewick/core/Tags.h"
+#include "FrameQueue.h"
 
 extern "C" {
 #include <libavutil/pixfmt.h>
@@ -17,6 +18,10 @@ namespace media {
 
   struct VideoRecorderImpl;
 
+  /// \brief Video recorder, encoding H.264 video on a dedicated thread.
+  ///
+  /// Frames passed to writeFrame() are copied into a pool of frame buffers
+  /// and handed to the encoder thread through a FrameQueue.
   class VideoRecorder {
   private:
     std::unique_ptr<VideoRecorderImpl> impl_;
@@ -28,6 +33,9 @@ namespace media {
       long bit_rate = 2500000u;
       int outputWidth;
       int outputHeight;
+      /// Number of frames which can be queued for encoding.
+      Uint32 queue_capacity = 8u;
+      FrameQueuePolicy queue_policy = FrameQueuePolicy::BLOCK;
     };
 
     /// \brief Constructor which will not open the file or stream.
@@ -46,9 +54,30 @@ namespace media {
                             .outputHeight = int(height),
                         }) {}
 
+    /// \brief Number of frames encoded so far.
     Uint32 frameCounter() const;
+    /// \brief Number of frames discarded because the queue was full.
+    Uint32 droppedFrames() const;
+    /// \brief Number of frames waiting to be encoded.
+    Uint32 queuedFrames() const;
+
+    /// \brief Queue a frame for encoding. The data is copied, and can be
+    /// reused as soon as this function returns.
+    /// \throws std::runtime_error if encoding a previous frame failed.
     void writeFrame(const Uint8 *data, size_t payloadSize,
                     AVPixelFormat avPixelFormat);
+    /// \brief Queue a frame of size \p width x \p height, which can differ
+    /// from the recorder's input size (e.g. frames which were already
+    /// downscaled on the GPU).
+    ///
+    /// NV12 frames at the output size are copied to the encoder's frame
+    /// directly, bypassing libswscale.
+    /// \sa YuvConverter
+    void writeFrame(const Uint8 *data, size_t payloadSize,
+                    AVPixelFormat avPixelFormat, Uint32 width, Uint32 height);
+    /// \brief Finish encoding queued frames, flush the encoder and close the
+    /// file. Called by the destructor.
+    void close();
     ~VideoRecorder();
   };
 
@@ -4,6 +4,8 @@
 #include "../utils/PixelFormatConversion.h"
 
 #include <SDL3/SDL_assert.h>
+#include <format>
+#include <magic_enum/magic_enum.hpp>
 
 namespace candlewick::media {
 
@@ -75,11 +77,25 @@ void dumpTextureImgToFile(const Device &device, SDL_GPUTexture *texture,
     SDL_memcpy(rgba_pixels, raw_pixels, img_num_bytes);
   }
 
+  SDL_UnmapGPUTransferBuffer(device, download_transfer_buffer);
+  SDL_ReleaseGPUTransferBuffer(device, download_transfer_buffer);
+
   stbi_write_png(filename, int(width), int(height), 4, rgba_pixels, 0);
   std::free(rgba_pixels);
 }
 
 #ifdef CANDLEWICK_WITH_FFMPEG_SUPPORT
+static AVPixelFormat sdlToAvPixelFormat(SDL_GPUTextureFormat format) {
+  switch (format) {
+  case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM:
+    return AV_PIX_FMT_BGRA;
+  case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM:
+    return AV_PIX_FMT_RGBA;
+  default:
+    return AV_PIX_FMT_NONE;
+  }
+}
+
 void videoWriteTextureToFrame(const Device &device,
                               media::VideoRecorder &recorder,
                               SDL_GPUTexture *texture,
@@ -124,20 +140,60 @@ void videoWriteTextureToFrame(const Device &device,
   Uint8 *raw_data = reinterpret_cast<Uint8 *>(
       SDL_MapGPUTransferBuffer(device, download_transfer_buffer, false));
 
-  AVPixelFormat outputFormat;
-  switch (format) {
-  case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM: {
-    outputFormat = AV_PIX_FMT_BGRA;
-    break;
-  }
-  case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM: {
-    outputFormat = AV_PIX_FMT_RGBA;
-    break;
-  }
-  default:
-    return;
-  }
-  recorder.writeFrame(raw_data, payload_size, outputFormat);
+  AVPixelFormat outputFormat = sdlToAvPixelFormat(format);
+  if (outputFormat != AV_PIX_FMT_NONE)
+    recorder.writeFrame(raw_data, payload_size, outputFormat);
+
+  SDL_UnmapGPUTransferBuffer(device, download_transfer_buffer);
+  SDL_ReleaseGPUTransferBuffer(device, download_transfer_buffer);
+}
+
+FrameReadbackRing createVideoReadbackRing(const Device &device,
+                                          VideoRecorder &recorder,
+                                          SDL_GPUTextureFormat format,
+                                          Uint32 width, Uint32 height,
+                                          Uint32 numSlots,
+                                          ReadbackFullPolicy policy) {
+  SDL_assert(recorder.initialized());
+  const AVPixelFormat outputFormat = sdlToAvPixelFormat(format);
+  if (outputFormat == AV_PIX_FMT_NONE)
+    throw std::runtime_error(
+        std::format("Unsupported texture format {:s} for video recording",
+                    magic_enum::enum_name(format)));
+  return FrameReadbackRing{
+      device,
+      width,
+      height,
+      format,
+      [&recorder, outputFormat](const Uint8 *data, Uint32 payloadSize) {
+        recorder.writeFrame(data, payloadSize, outputFormat);
+      },
+      numSlots,
+      policy,
+  };
+}
+
+FrameReadbackRing createVideoReadbackRing(const Device &device,
+                                          VideoRecorder &recorder,
+                                          const YuvConverter &converter,
+                                          Uint32 numSlots,
+                                          ReadbackFullPolicy policy) {
+  SDL_assert(recorder.initialized());
+  const Uint32 width = converter.width();
+  const Uint32 height = converter.height();
+  const ReadbackPlane planes[] = {
+      {width, height, converter.yPlane.format()},
+      {width / 2, height / 2, converter.uvPlane.format()},
+  };
+  return FrameReadbackRing{
+      device,
+      planes,
+      [&recorder, width, height](const Uint8 *data, Uint32 payloadSize) {
+        recorder.writeFrame(data, payloadSize, AV_PIX_FMT_NV12, width, height);
+      },
+      numSlots,
+      policy,
+  };
 }
 #endif
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../core/Core.h"
+#include "FrameReadback.h"
+#include "YuvConversion.h"
 #ifdef CANDLEWICK_WITH_FFMPEG_SUPPORT
 #include "VideoRecorder.h"
 #endif
@@ -14,10 +16,32 @@ namespace media {
                             const Uint32 height, const char *filename);
 
 #ifdef CANDLEWICK_WITH_FFMPEG_SUPPORT
+  /// \brief Download a texture and write it to the video, synchronously.
+  /// \sa createVideoReadbackRing() for pipelined readback.
   void videoWriteTextureToFrame(const Device &device, VideoRecorder &recorder,
                                 SDL_GPUTexture *texture,
                                 SDL_GPUTextureFormat format, const Uint32 width,
                                 const Uint32 height);
+
+  /// \brief Create a FrameReadbackRing which writes its frames to \p recorder.
+  /// The recorder must outlive the ring.
+  FrameReadbackRing
+  createVideoReadbackRing(const Device &device, VideoRecorder &recorder,
+                          SDL_GPUTextureFormat format, Uint32 width,
+                          Uint32 height, Uint32 numSlots = 3,
+                          ReadbackFullPolicy policy = ReadbackFullPolicy::WAIT);
+
+  /// \brief Create a FrameReadbackRing which downloads the NV12 planes of
+  /// \p converter and writes them to \p recorder. This avoids both reading
+  /// back full RGBA frames and converting them on the CPU.
+  ///
+  /// Submit frames with `ring.submitFrame(cmdBuf, converter.planes())`, after
+  /// calling YuvConverter::convert(). The converter size should be the
+  /// recorder's output size.
+  FrameReadbackRing
+  createVideoReadbackRing(const Device &device, VideoRecorder &recorder,
+                          const YuvConverter &converter, Uint32 numSlots = 3,
+                          ReadbackFullPolicy policy = ReadbackFullPolicy::WAIT);
 #endif
 
 } // namespace media
@@ -0,0 +1,151 @@
+#include "YuvConversion.h"
+#include "../core/CommandBuffer.h"
+#include "../core/Device.h"
+#include "../core/Shader.h"
+#include "../core/errors.h"
+
+#include <format>
+#include <utility>
+
+namespace candlewick::media {
+
+static Texture createPlaneTexture(const Device &device,
+                                  SDL_GPUTextureFormat format, Uint32 width,
+                                  Uint32 height, const char *name) {
+  SDL_GPUTextureCreateInfo texture_desc{
+      .type = SDL_GPU_TEXTURETYPE_2D,
+      .format = format,
+      .usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET,
+      .width = width,
+      .height = height,
+      .layer_count_or_depth = 1,
+      .num_levels = 1,
+      .sample_count = SDL_GPU_SAMPLECOUNT_1,
+      .props = 0,
+  };
+  return Texture{device, texture_desc, name};
+}
+
+YuvConverter::YuvConverter(const Device &device, Uint32 outputWidth,
+                           Uint32 outputHeight)
+    : _device(device) {
+  if (outputWidth % 2 != 0 || outputHeight % 2 != 0)
+    throw std::invalid_argument(
+        std::format("YUV 4:2:0 output size must be even (got {:d}x{:d}).",
+                    outputWidth, outputHeight));
+
+  yPlane = createPlaneTexture(device, SDL_GPU_TEXTUREFORMAT_R8_UNORM,
+                              outputWidth, outputHeight, "YUV luma plane");
+  uvPlane = createPlaneTexture(device, SDL_GPU_TEXTUREFORMAT_R8G8_UNORM,
+                               outputWidth / 2, outputHeight / 2,
+                               "YUV chroma plane");
+
+  SDL_GPUSamplerCreateInfo sampler_desc{
+      .min_filter = SDL_GPU_FILTER_LINEAR,
+      .mag_filter = SDL_GPU_FILTER_LINEAR,
+      .mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST,
+      .address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+      .address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+      .address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+  };
+  sampler = SDL_CreateGPUSampler(device, &sampler_desc);
+
+  auto vertexShader = Shader::fromMetadata(device, "DrawQuad.vert");
+  auto createPipeline = [&](const char *fragment_shader_name,
+                            SDL_GPUTextureFormat format) {
+    auto fragmentShader = Shader::fromMetadata(device, fragment_shader_name);
+    SDL_GPUColorTargetDescription color_desc;
+    SDL_zero(color_desc);
+    color_desc.format = format;
+    SDL_GPUGraphicsPipelineCreateInfo pipeline_desc{
+        .vertex_shader = vertexShader,
+        .fragment_shader = fragmentShader,
+        .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+        .rasterizer_state{.fill_mode = SDL_GPU_FILLMODE_FILL,
+                          .cull_mode = SDL_GPU_CULLMODE_NONE},
+        .target_info{.color_target_descriptions = &color_desc,
+                     .num_color_targets = 1,
+                     .has_depth_stencil_target = false},
+    };
+    auto *pipeline = SDL_CreateGPUGraphicsPipeline(device, &pipeline_desc);
+    if (!pipeline)
+      terminate_with_message(
+          std::format("Failed to create YUV conversion pipeline: {:s}",
+                      SDL_GetError()));
+    return pipeline;
+  };
+  lumaPipeline = createPipeline("RgbToYuvLuma.frag", yPlane.format());
+  chromaPipeline = createPipeline("RgbToYuvChroma.frag", uvPlane.format());
+}
+
+YuvConverter::YuvConverter(const Device &device, Uint32 outputWidth,
+                           Uint32 outputHeight,
+                           SDL_GPUTextureFormat sourceFormat,
+                           Uint32 sourceWidth, Uint32 sourceHeight)
+    : YuvConverter(device, outputWidth, outputHeight) {
+  sourceCopy = Texture{device,
+                       SDL_GPUTextureCreateInfo{
+                           .type = SDL_GPU_TEXTURETYPE_2D,
+                           .format = sourceFormat,
+                           .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+                           .width = sourceWidth,
+                           .height = sourceHeight,
+                           .layer_count_or_depth = 1,
+                           .num_levels = 1,
+                           .sample_count = SDL_GPU_SAMPLECOUNT_1,
+                           .props = 0,
+                       },
+                       "YUV conversion source"};
+}
+
+void YuvConverter::convert(CommandBuffer &cmdBuf, SDL_GPUTexture *source) {
+  if (sourceCopy.hasValue()) {
+    const SDL_GPUTextureLocation src_location{.texture = source};
+    const SDL_GPUTextureLocation dst_location{.texture = sourceCopy};
+    SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(cmdBuf);
+    SDL_CopyGPUTextureToTexture(copy_pass, &src_location, &dst_location,
+                                sourceCopy.width(), sourceCopy.height(), 1,
+                                false);
+    SDL_EndGPUCopyPass(copy_pass);
+    source = sourceCopy;
+  }
+  const SDL_GPUTextureSamplerBinding binding{.texture = source,
+                                             .sampler = sampler};
+  const std::pair<SDL_GPUTexture *, SDL_GPUGraphicsPipeline *> passes[] = {
+      {yPlane, lumaPipeline},
+      {uvPlane, chromaPipeline},
+  };
+  for (auto [target, pipeline] : passes) {
+    SDL_GPUColorTargetInfo color_info{
+        .texture = target,
+        .load_op = SDL_GPU_LOADOP_DONT_CARE,
+        .store_op = SDL_GPU_STOREOP_STORE,
+    };
+    SDL_GPURenderPass *render_pass =
+        SDL_BeginGPURenderPass(cmdBuf, &color_info, 1, nullptr);
+    SDL_BindGPUGraphicsPipeline(render_pass, pipeline);
+    SDL_BindGPUFragmentSamplers(render_pass, 0, &binding, 1);
+    SDL_DrawGPUPrimitives(render_pass, 6, 1, 0, 0);
+    SDL_EndGPURenderPass(render_pass);
+  }
+}
+
+void YuvConverter::release() noexcept {
+  if (!_device)
+    return;
+  yPlane.destroy();
+  uvPlane.destroy();
+  sourceCopy.destroy();
+  if (lumaPipeline)
+    SDL_ReleaseGPUGraphicsPipeline(_device, lumaPipeline);
+  if (chromaPipeline)
+    SDL_ReleaseGPUGraphicsPipeline(_device, chromaPipeline);
+  if (sampler)
+    SDL_ReleaseGPUSampler(_device, sampler);
+  lumaPipeline = nullptr;
+  chromaPipeline = nullptr;
+  sampler = nullptr;
+  _device = nullptr;
+}
+
+} // namespace candlewick::media
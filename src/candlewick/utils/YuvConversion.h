@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../core/Core.h"
+#include "../core/Texture.h"
+#include <SDL3/SDL_gpu.h>
+#include <array>
+
+namespace candlewick {
+namespace media {
+
+  /// \brief GPU conversion of color textures to the NV12 (YUV 4:2:0) layout,
+  /// with BT.601 limited-range coefficients.
+  ///
+  /// The luma plane is written to an `R8_UNORM` texture at the output size,
+  /// and the interleaved chroma plane to an `R8G8_UNORM` texture at half the
+  /// output size. The source is resampled bilinearly, hence can have any size.
+  /// Reading back both planes takes 1.5 bytes per pixel, against 4 for RGBA.
+  ///
+  /// The integer coefficients and rounding are libswscale's: at 1:1 scale,
+  /// the output is the same as that of its RGBA -> YUV420P conversion.
+  struct YuvConverter {
+    Texture yPlane{NoInit};
+    Texture uvPlane{NoInit};
+    /// Sampleable copy of the source, when the source cannot be sampled.
+    Texture sourceCopy{NoInit};
+    SDL_GPUGraphicsPipeline *lumaPipeline = nullptr;
+    SDL_GPUGraphicsPipeline *chromaPipeline = nullptr;
+    SDL_GPUSampler *sampler = nullptr;
+
+    YuvConverter(NoInitT) {}
+    /// \param outputWidth Width of the luma plane, must be even.
+    /// \param outputHeight Height of the luma plane, must be even.
+    YuvConverter(const Device &device, Uint32 outputWidth,
+                 Uint32 outputHeight);
+    /// \brief Converter for sources which lack the
+    /// `SDL_GPU_TEXTUREUSAGE_SAMPLER` usage flag, such as swapchain textures.
+    /// These are first copied to #sourceCopy, which has the given format and
+    /// size.
+    YuvConverter(const Device &device, Uint32 outputWidth, Uint32 outputHeight,
+                 SDL_GPUTextureFormat sourceFormat, Uint32 sourceWidth,
+                 Uint32 sourceHeight);
+
+    bool initialized() const { return _device != nullptr; }
+    Uint32 width() const { return yPlane.width(); }
+    Uint32 height() const { return yPlane.height(); }
+    /// Size of an NV12 frame, in bytes.
+    Uint32 payloadSize() const { return width() * height() * 3 / 2; }
+    std::array<SDL_GPUTexture *, 2> planes() const { return {yPlane, uvPlane}; }
+
+    /// \brief Record the conversion of \p source, which must have a UNORM or
+    /// float color format. Unless the converter was created with a source
+    /// format, \p source must have the `SDL_GPU_TEXTUREUSAGE_SAMPLER` usage
+    /// flag.
+    void convert(CommandBuffer &cmdBuf, SDL_GPUTexture *source);
+
+    void release() noexcept;
+
+  private:
+    SDL_GPUDevice *_device = nullptr;
+  };
+
+} // namespace media
+} // namespace candlewick
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+#include <cmath>
+
+namespace candlewick::detail {
+
+/// \brief Table of pixel conversion kernels, compiled once per instruction
+/// set. \see PixelFormatConversion.h for the semantics of each kernel.
+struct PixelKernels {
+  const char *name;
+  void (*bgraToRgba)(const Uint32 *src, Uint32 *dst, Uint32 pixelCount);
+  void (*rgbaToRgb)(const Uint8 *src, Uint8 *dst, Uint32 pixelCount);
+  void (*bgraToRgb)(const Uint8 *src, Uint8 *dst, Uint32 pixelCount);
+  void (*floatToUnorm8)(const float *src, Uint8 *dst, Uint32 count);
+  void (*depthToUnorm16)(const float *src, Uint16 *dst, Uint32 count);
+  void (*swapRows)(Uint8 *a, Uint8 *b, Uint32 rowBytes);
+};
+
+/// \brief Plain loops, which also process the tails of the vectorized
+/// kernels. They are the baseline kernels when SIMDe is not available.
+namespace scalar {
+  inline void bgraToRgba(const Uint32 *src, Uint32 *dst, Uint32 pixelCount) {
+    for (Uint32 i = 0; i < pixelCount; i++) {
+      const Uint32 p = src[i];
+      dst[i] = ((p & 0x00FF0000) >> 16) | (p & 0x0000FF00) |
+               ((p & 0x000000FF) << 16) | (p & 0xFF000000);
+    }
+  }
+
+  /// Keep the bytes \p order of each 4-byte pixel.
+  inline void dropAlpha(const Uint8 *src, Uint8 *dst, Uint32 pixelCount,
+                        const int (&order)[3]) {
+    for (Uint32 i = 0; i < pixelCount; i++) {
+      dst[3 * i + 0] = src[4 * i + order[0]];
+      dst[3 * i + 1] = src[4 * i + order[1]];
+      dst[3 * i + 2] = src[4 * i + order[2]];
+    }
+  }
+
+  /// Clamp to [0, 1] (NaN maps to 0), scale, and round to nearest even, as
+  /// the vector conversion does.
+  inline Uint32 toUnorm(float x, float scale) {
+    const float v = x > 0.f ? (x < 1.f ? x : 1.f) : 0.f;
+    return Uint32(std::lrint(v * scale));
+  }
+
+  inline void floatToUnorm8(const float *src, Uint8 *dst, Uint32 count) {
+    for (Uint32 i = 0; i < count; i++)
+      dst[i] = Uint8(toUnorm(src[i], 255.f));
+  }
+
+  inline void depthToUnorm16(const float *src, Uint16 *dst, Uint32 count) {
+    for (Uint32 i = 0; i < count; i++)
+      dst[i] = Uint16(toUnorm(src[i], 65535.f));
+  }
+
+  inline void swapRows(Uint8 *a, Uint8 *b, Uint32 rowBytes) {
+    for (Uint32 i = 0; i < rowBytes; i++) {
+      Uint8 tmp = a[i];
+      a[i] = b[i];
+      b[i] = tmp;
+    }
+  }
+} // namespace scalar
+
+namespace baseline {
+  extern const PixelKernels kernels;
+}
+#ifdef CANDLEWICK_PIXEL_KERNELS_AVX2
+namespace avx2 {
+  extern const PixelKernels kernels;
+}
+#endif
+
+} // namespace candlewick::detail
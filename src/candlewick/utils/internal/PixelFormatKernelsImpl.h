@@ -0,0 +1,147 @@
+// Pixel conversion kernels, written with 256-bit SIMDe intrinsics.
+//
+// This file is included by one translation unit per instruction set, with
+// CANDLEWICK_PIXEL_KERNELS_NAMESPACE set to the name of the namespace to
+// define the kernels in. SIMDe maps the intrinsics to the best instructions
+// enabled for that translation unit (e.g. native AVX2 when compiled with
+// -mavx2, pairs of SSE or NEON instructions otherwise).
+#ifndef CANDLEWICK_PIXEL_KERNELS_NAMESPACE
+#error "CANDLEWICK_PIXEL_KERNELS_NAMESPACE must be defined."
+#endif
+
+#include "PixelFormatKernels.h"
+
+#include <simde/x86/avx2.h>
+
+namespace candlewick::detail {
+namespace CANDLEWICK_PIXEL_KERNELS_NAMESPACE {
+
+  static simde__m256i load256(const void *src) {
+    return simde_mm256_loadu_si256(static_cast<const simde__m256i *>(src));
+  }
+
+  static void store256(void *dst, simde__m256i value) {
+    simde_mm256_storeu_si256(static_cast<simde__m256i *>(dst), value);
+  }
+
+  /// Byte shuffle (within each 128-bit lane) swapping the R and B channels.
+  static simde__m256i swapRedBlueMask() {
+    return simde_mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13,
+                                 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11,
+                                 14, 13, 12, 15);
+  }
+
+  static void bgraToRgba(const Uint32 *src, Uint32 *dst, Uint32 pixelCount) {
+    const simde__m256i mask = swapRedBlueMask();
+    Uint32 i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+      store256(dst + i, simde_mm256_shuffle_epi8(load256(src + i), mask));
+    scalar::bgraToRgba(src + i, dst + i, pixelCount - i);
+  }
+
+  /// Drop every 4th byte of 8 pixels: each lane is compacted by a byte
+  /// shuffle, then the two lanes are joined with a cross-lane permutation.
+  /// The 24 valid bytes end up at the start of the register.
+  static void dropAlphaImpl(const Uint8 *src, Uint8 *dst, Uint32 pixelCount,
+                            simde__m256i shuffle, const int (&order)[3]) {
+    const simde__m256i compact = simde_mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+    Uint32 i = 0;
+    // the 32-byte store writes 8 bytes past the 24 output bytes: stop early
+    for (; i + 11 <= pixelCount; i += 8) {
+      simde__m256i px = load256(src + 4 * i);
+      px = simde_mm256_shuffle_epi8(px, shuffle);
+      px = simde_mm256_permutevar8x32_epi32(px, compact);
+      store256(dst + 3 * i, px);
+    }
+    scalar::dropAlpha(src + 4 * i, dst + 3 * i, pixelCount - i, order);
+  }
+
+  static void rgbaToRgb(const Uint8 *src, Uint8 *dst, Uint32 pixelCount) {
+    const simde__m256i shuffle = simde_mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, //
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    dropAlphaImpl(src, dst, pixelCount, shuffle, {0, 1, 2});
+  }
+
+  static void bgraToRgb(const Uint8 *src, Uint8 *dst, Uint32 pixelCount) {
+    const simde__m256i shuffle = simde_mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, //
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    dropAlphaImpl(src, dst, pixelCount, shuffle, {2, 1, 0});
+  }
+
+  static simde__m256i toUnorm(const float *src, simde__m256 scale) {
+    const simde__m256 zero = simde_mm256_setzero_ps();
+    const simde__m256 one = simde_mm256_set1_ps(1.f);
+    simde__m256 x = simde_mm256_loadu_ps(src);
+    // max(x, 0) returns 0 for NaN inputs
+    x = simde_mm256_min_ps(simde_mm256_max_ps(x, zero), one);
+    return simde_mm256_cvtps_epi32(simde_mm256_mul_ps(x, scale));
+  }
+
+  static void floatToUnorm8(const float *src, Uint8 *dst, Uint32 count) {
+    const simde__m256 scale = simde_mm256_set1_ps(255.f);
+    // undo the per-lane interleaving of the pack instructions
+    const simde__m256i order = simde_mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    Uint32 i = 0;
+    for (; i + 32 <= count; i += 32) {
+      simde__m256i a = toUnorm(src + i, scale);
+      simde__m256i b = toUnorm(src + i + 8, scale);
+      simde__m256i c = toUnorm(src + i + 16, scale);
+      simde__m256i d = toUnorm(src + i + 24, scale);
+      simde__m256i ab = simde_mm256_packus_epi32(a, b);
+      simde__m256i cd = simde_mm256_packus_epi32(c, d);
+      simde__m256i abcd = simde_mm256_packus_epi16(ab, cd);
+      abcd = simde_mm256_permutevar8x32_epi32(abcd, order);
+      store256(dst + i, abcd);
+    }
+    scalar::floatToUnorm8(src + i, dst + i, count - i);
+  }
+
+  static void depthToUnorm16(const float *src, Uint16 *dst, Uint32 count) {
+    const simde__m256 scale = simde_mm256_set1_ps(65535.f);
+    Uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+      simde__m256i a = toUnorm(src + i, scale);
+      simde__m256i b = toUnorm(src + i + 8, scale);
+      simde__m256i ab = simde_mm256_packus_epi32(a, b);
+      ab = simde_mm256_permute4x64_epi64(ab, SIMDE_MM_SHUFFLE(3, 1, 2, 0));
+      store256(dst + i, ab);
+    }
+    scalar::depthToUnorm16(src + i, dst + i, count - i);
+  }
+
+  static void swapRows(Uint8 *a, Uint8 *b, Uint32 rowBytes) {
+    Uint32 i = 0;
+    for (; i + 32 <= rowBytes; i += 32) {
+      simde__m256i va = load256(a + i);
+      simde__m256i vb = load256(b + i);
+      store256(a + i, vb);
+      store256(b + i, va);
+    }
+    scalar::swapRows(a + i, b + i, rowBytes - i);
+  }
+
+  extern const PixelKernels kernels;
+  const PixelKernels kernels{
+#if defined(SIMDE_X86_AVX2_NATIVE)
+      .name = "AVX2",
+#elif defined(SIMDE_X86_SSSE3_NATIVE)
+      .name = "SSSE3",
+#elif defined(SIMDE_X86_SSE2_NATIVE)
+      .name = "SSE2",
+#elif defined(SIMDE_ARM_NEON_A64V8_NATIVE) || defined(SIMDE_ARM_NEON_A32V7_NATIVE)
+      .name = "NEON",
+#else
+      .name = "portable",
+#endif
+      .bgraToRgba = bgraToRgba,
+      .rgbaToRgb = rgbaToRgb,
+      .bgraToRgb = bgraToRgb,
+      .floatToUnorm8 = floatToUnorm8,
+      .depthToUnorm16 = depthToUnorm16,
+      .swapRows = swapRows,
+  };
+
+} // namespace CANDLEWICK_PIXEL_KERNELS_NAMESPACE
+} // namespace candlewick::detail
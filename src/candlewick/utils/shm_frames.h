@@ -0,0 +1,220 @@
+/*
+ * Consumer side of the candlewick shared-memory frame output.
+ *
+ * This header is plain C (C99 or later, or C++), with no dependency on the
+ * rest of candlewick: a downstream process (e.g. a teleoperation UI or an
+ * inference node) includes it to access the frames written by
+ * candlewick::media::SharedFrameSink, without copies.
+ *
+ * The segment holds a header followed by a ring of slots. Each slot holds a
+ * frame, made of one or more planes (e.g. color, then linear depth) stored
+ * back-to-back, and a sequence number. Readers get pointers into the
+ * mapped segment; since the producer never waits for readers, a reader
+ * checks that the slot was not overwritten once it is done with the data.
+ *
+ * When the producer stops, or is restarted and creates a new segment under
+ * the same name, the previous segment is marked stale (its magic number is
+ * cleared): candlewick_shm_frames_acquire() then returns NULL, and
+ * candlewick_shm_frames_stale() tells the reader to open the name again.
+ *
+ * Usage:
+ *
+ *     candlewick_shm_frames_reader reader;
+ *     if (candlewick_shm_frames_open("/robot_frames", &reader) != 0)
+ *       return -1;
+ *     uint64_t frame;
+ *     const candlewick_shm_frames_slot *slot =
+ *         candlewick_shm_frames_acquire(&reader, &frame);
+ *     if (slot) {
+ *       const void *color = candlewick_shm_frames_plane(&reader, slot, 0);
+ *       // ... use color ...
+ *       if (!candlewick_shm_frames_valid(slot, frame))
+ *         ; // overwritten while in use: discard the results
+ *     }
+ *     candlewick_shm_frames_close(&reader);
+ *
+ * POSIX only. Atomics use the GCC/Clang __atomic builtins.
+ */
+#ifndef CANDLEWICK_SHM_FRAMES_H
+#define CANDLEWICK_SHM_FRAMES_H
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* "CWKF", written last by the producer once the header is initialized. */
+#define CANDLEWICK_SHM_FRAMES_MAGIC 0x464b5743u
+#define CANDLEWICK_SHM_FRAMES_VERSION 1u
+#define CANDLEWICK_SHM_FRAMES_MAX_PLANES 4
+
+typedef struct candlewick_shm_frames_plane_desc {
+  /* an SDL_GPUTextureFormat value (e.g. R8G8B8A8_UNORM, R32_FLOAT) */
+  uint32_t format;
+  uint32_t width;
+  uint32_t height;
+  /* bytes per row, rows are tightly packed */
+  uint32_t row_pitch;
+  /* offset of the plane from the start of the slot payload */
+  uint64_t offset;
+  uint64_t size;
+} candlewick_shm_frames_plane_desc;
+
+typedef struct candlewick_shm_frames_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t num_planes;
+  /* number of slots in the ring */
+  uint32_t capacity;
+  /* size of a slot in bytes, including its header; a multiple of 4096 */
+  uint64_t slot_stride;
+  /* number of written frames; frame i is in slot i % capacity */
+  uint64_t write_count;
+  candlewick_shm_frames_plane_desc planes[CANDLEWICK_SHM_FRAMES_MAX_PLANES];
+  uint8_t padding_[32];
+} candlewick_shm_frames_header;
+
+typedef struct candlewick_shm_frames_slot {
+  /* 2 * i + 1 while frame i is being written, 2 * i + 2 once written */
+  uint64_t sequence;
+  /* CLOCK_MONOTONIC time at which the frame was written, in nanoseconds */
+  uint64_t timestamp_ns;
+  uint8_t padding_[48];
+  /* followed by the planes */
+} candlewick_shm_frames_slot;
+
+typedef struct candlewick_shm_frames_reader {
+  const candlewick_shm_frames_header *header;
+  size_t size;
+  /* number of written frames at the last acquire */
+  uint64_t read_count;
+} candlewick_shm_frames_reader;
+
+static inline const candlewick_shm_frames_slot *
+candlewick_shm_frames_get_slot(const candlewick_shm_frames_header *header,
+                               uint64_t index) {
+  const char *slots = (const char *)header + sizeof(*header);
+  return (const candlewick_shm_frames_slot *)(slots +
+                                              (index % header->capacity) *
+                                                  header->slot_stride);
+}
+
+/*
+ * Map the shared memory object `name` (e.g. "/robot_frames") read-only.
+ * Returns 0 on success, -1 if it cannot be mapped or was not initialized by
+ * a compatible producer.
+ */
+static inline int candlewick_shm_frames_open(
+    const char *name, candlewick_shm_frames_reader *reader) {
+  const candlewick_shm_frames_header *header;
+  struct stat st;
+  void *mem;
+  int fd;
+
+  reader->header = NULL;
+  reader->size = 0;
+  reader->read_count = 0;
+  fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0)
+    return -1;
+  if (fstat(fd, &st) != 0 ||
+      (size_t)st.st_size < sizeof(candlewick_shm_frames_header)) {
+    close(fd);
+    return -1;
+  }
+  mem = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED)
+    return -1;
+
+  header = (const candlewick_shm_frames_header *)mem;
+  if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) !=
+          CANDLEWICK_SHM_FRAMES_MAGIC ||
+      header->version != CANDLEWICK_SHM_FRAMES_VERSION ||
+      header->capacity < 2 ||
+      (size_t)st.st_size <
+          sizeof(*header) + header->capacity * header->slot_stride) {
+    munmap(mem, (size_t)st.st_size);
+    return -1;
+  }
+  reader->header = header;
+  reader->size = (size_t)st.st_size;
+  return 0;
+}
+
+/*
+ * Whether the producer stopped writing to the mapped segment. Close the
+ * reader, and open the name again to follow a restarted producer.
+ */
+static inline int
+candlewick_shm_frames_stale(const candlewick_shm_frames_reader *reader) {
+  return __atomic_load_n(&reader->header->magic, __ATOMIC_ACQUIRE) !=
+         CANDLEWICK_SHM_FRAMES_MAGIC;
+}
+
+/*
+ * Get the newest frame, if it is newer than the last acquired one. Returns
+ * NULL otherwise, or if the segment is stale. On success, `*frame` receives the index of the frame, to
+ * pass to candlewick_shm_frames_valid().
+ */
+static inline const candlewick_shm_frames_slot *
+candlewick_shm_frames_acquire(candlewick_shm_frames_reader *reader,
+                              uint64_t *frame) {
+  const candlewick_shm_frames_header *header = reader->header;
+  const candlewick_shm_frames_slot *slot;
+  uint64_t count;
+
+  for (;;) {
+    if (candlewick_shm_frames_stale(reader))
+      return NULL;
+    count = __atomic_load_n(&header->write_count, __ATOMIC_ACQUIRE);
+    if (count == reader->read_count)
+      return NULL;
+    slot = candlewick_shm_frames_get_slot(header, count - 1);
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) == 2 * count) {
+      reader->read_count = count;
+      *frame = count - 1;
+      return slot;
+    }
+    /* the producer already moved on to this slot: try a newer frame */
+  }
+}
+
+/* Pointer to plane `plane` of a slot, in the mapped segment. */
+static inline const void *
+candlewick_shm_frames_plane(const candlewick_shm_frames_reader *reader,
+                            const candlewick_shm_frames_slot *slot,
+                            uint32_t plane) {
+  return (const char *)(slot + 1) + reader->header->planes[plane].offset;
+}
+
+/*
+ * Whether the data of frame `frame` in `slot` was not overwritten since it
+ * was acquired. Call after using the data.
+ */
+static inline int
+candlewick_shm_frames_valid(const candlewick_shm_frames_slot *slot,
+                            uint64_t frame) {
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == 2 * frame + 2;
+}
+
+static inline void
+candlewick_shm_frames_close(candlewick_shm_frames_reader *reader) {
+  if (reader->header)
+    munmap((void *)reader->header, reader->size);
+  reader->header = NULL;
+  reader->size = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CANDLEWICK_SHM_FRAMES_H */
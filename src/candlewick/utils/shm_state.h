@@ -0,0 +1,225 @@
+/*
+ * Producer side of the candlewick shared-memory state channel.
+ *
+ * This header is plain C (C99 or later, or C++), with no dependency on the
+ * rest of candlewick: an external process (e.g. a simulator) includes it to
+ * publish robot states, which candlewick::SharedStateReader reads without
+ * sockets, serialization or locks.
+ *
+ * The segment holds a header followed by a ring of slots. Each slot holds a
+ * timestamp and `dim` doubles, guarded by a sequence lock: the producer never
+ * waits, and readers retry in the (rare) case where the slot they read is
+ * overwritten during the copy.
+ *
+ * A segment is never resized or reused: creating a channel under a name that
+ * is taken marks the previous segment as stale (its magic number is cleared),
+ * unlinks it, and creates a new one. Readers still mapping the previous
+ * segment notice it, and open the name again.
+ *
+ * Samples are either configurations q (CANDLEWICK_SHM_STATE_CONFIGURATION,
+ * `dim = nq`), or geometry placements (CANDLEWICK_SHM_STATE_PLACEMENTS,
+ * `dim = 12 * ngeoms`): the 3x4 matrix [R | p] of each geometry, row-major.
+ *
+ * Usage:
+ *
+ *     candlewick_shm_state state;
+ *     if (candlewick_shm_state_create("/robot_state",
+ *                                     CANDLEWICK_SHM_STATE_CONFIGURATION, nq,
+ *                                     8, &state) != 0)
+ *       return -1;
+ *     for (;;)
+ *       candlewick_shm_state_publish(&state, t, q);
+ *     candlewick_shm_state_destroy(&state, 1);
+ *
+ * POSIX only. Atomics use the GCC/Clang __atomic builtins.
+ */
+#ifndef CANDLEWICK_SHM_STATE_H
+#define CANDLEWICK_SHM_STATE_H
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* "CWKS", written last by the producer once the header is initialized. */
+#define CANDLEWICK_SHM_STATE_MAGIC 0x534b5743u
+#define CANDLEWICK_SHM_STATE_VERSION 1u
+
+enum candlewick_shm_state_kind {
+  CANDLEWICK_SHM_STATE_CONFIGURATION = 0,
+  CANDLEWICK_SHM_STATE_PLACEMENTS = 1,
+};
+
+typedef struct candlewick_shm_state_header {
+  uint32_t magic;
+  uint32_t version;
+  /* a candlewick_shm_state_kind */
+  uint32_t kind;
+  /* number of doubles per sample */
+  uint32_t dim;
+  /* number of slots in the ring */
+  uint32_t capacity;
+  /* size of a slot in bytes, including its header */
+  uint32_t slot_stride;
+  /* number of published samples; sample i is in slot i % capacity */
+  uint64_t write_count;
+  uint8_t padding_[32];
+} candlewick_shm_state_header;
+
+typedef struct candlewick_shm_state_slot {
+  /* 2 * i + 1 while sample i is being written, 2 * i + 2 once written */
+  uint64_t sequence;
+  double timestamp;
+  /* followed by dim doubles */
+} candlewick_shm_state_slot;
+
+typedef struct candlewick_shm_state {
+  candlewick_shm_state_header *header;
+  size_t size;
+  char name[256];
+} candlewick_shm_state;
+
+static inline size_t candlewick_shm_state_slot_stride(uint32_t dim) {
+  const size_t size =
+      sizeof(candlewick_shm_state_slot) + (size_t)dim * sizeof(double);
+  /* one cache line at least, and slots do not share cache lines */
+  return (size + 63u) & ~(size_t)63u;
+}
+
+static inline size_t candlewick_shm_state_segment_size(uint32_t dim,
+                                                       uint32_t capacity) {
+  return sizeof(candlewick_shm_state_header) +
+         (size_t)capacity * candlewick_shm_state_slot_stride(dim);
+}
+
+static inline candlewick_shm_state_slot *
+candlewick_shm_state_get_slot(candlewick_shm_state_header *header,
+                              uint64_t index) {
+  char *slots = (char *)header + sizeof(candlewick_shm_state_header);
+  return (candlewick_shm_state_slot *)(slots + (index % header->capacity) *
+                                                   header->slot_stride);
+}
+
+/*
+ * Mark the segment of an existing channel `name` as stale, if there is one,
+ * so that its readers stop waiting for samples.
+ */
+static inline void candlewick_shm_state_mark_stale(const char *name) {
+  candlewick_shm_state_header *header;
+  struct stat st;
+  int fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0)
+    return;
+  /* e.g. left empty by a producer which crashed while creating it */
+  if (fstat(fd, &st) != 0 ||
+      (size_t)st.st_size < sizeof(candlewick_shm_state_header)) {
+    close(fd);
+    return;
+  }
+  header = (candlewick_shm_state_header *)mmap(
+      NULL, sizeof(candlewick_shm_state_header), PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd, 0);
+  close(fd);
+  if (header == MAP_FAILED)
+    return;
+  __atomic_store_n(&header->magic, 0u, __ATOMIC_RELEASE);
+  munmap(header, sizeof(candlewick_shm_state_header));
+}
+
+/*
+ * Create the shared memory object `name` (e.g. "/robot_state") and map it.
+ * A previous channel with the same name is marked stale and unlinked: its
+ * readers keep a valid mapping, and never see it resized. `capacity` should
+ * be at least 2. Returns 0 on success, -1 on failure (errno is set).
+ */
+static inline int candlewick_shm_state_create(const char *name, uint32_t kind,
+                                              uint32_t dim, uint32_t capacity,
+                                              candlewick_shm_state *state) {
+  const size_t size = candlewick_shm_state_segment_size(dim, capacity);
+  candlewick_shm_state_header *header;
+  void *mem;
+  int fd;
+
+  memset(state, 0, sizeof(*state));
+  if (capacity < 2 || strlen(name) >= sizeof(state->name))
+    return -1;
+  candlewick_shm_state_mark_stale(name);
+  shm_unlink(name);
+  fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+    return -1;
+  if (ftruncate(fd, (off_t)size) != 0) {
+    close(fd);
+    shm_unlink(name);
+    return -1;
+  }
+  mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) {
+    shm_unlink(name);
+    return -1;
+  }
+
+  /* ftruncate zero-filled the new segment */
+  header = (candlewick_shm_state_header *)mem;
+  header->version = CANDLEWICK_SHM_STATE_VERSION;
+  header->kind = kind;
+  header->dim = dim;
+  header->capacity = capacity;
+  header->slot_stride = (uint32_t)candlewick_shm_state_slot_stride(dim);
+  __atomic_store_n(&header->magic, CANDLEWICK_SHM_STATE_MAGIC,
+                   __ATOMIC_RELEASE);
+
+  state->header = header;
+  state->size = size;
+  strcpy(state->name, name);
+  return 0;
+}
+
+/* Publish a sample of `dim` doubles. Wait-free. */
+static inline void candlewick_shm_state_publish(candlewick_shm_state *state,
+                                                double timestamp,
+                                                const double *data) {
+  candlewick_shm_state_header *header = state->header;
+  const uint64_t index =
+      __atomic_load_n(&header->write_count, __ATOMIC_RELAXED);
+  candlewick_shm_state_slot *slot =
+      candlewick_shm_state_get_slot(header, index);
+
+  __atomic_store_n(&slot->sequence, 2 * index + 1, __ATOMIC_RELAXED);
+  /* the odd sequence must be visible before the data changes */
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  slot->timestamp = timestamp;
+  memcpy(slot + 1, data, header->dim * sizeof(double));
+  __atomic_store_n(&slot->sequence, 2 * index + 2, __ATOMIC_RELEASE);
+  __atomic_store_n(&header->write_count, index + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Unmap the segment, and remove its name if `unlink_name` is non-zero. The
+ * segment is then marked stale for its readers.
+ */
+static inline void candlewick_shm_state_destroy(candlewick_shm_state *state,
+                                                int unlink_name) {
+  if (state->header) {
+    if (unlink_name)
+      __atomic_store_n(&state->header->magic, 0u, __ATOMIC_RELEASE);
+    munmap(state->header, state->size);
+  }
+  if (unlink_name && state->name[0])
+    shm_unlink(state->name);
+  memset(state, 0, sizeof(*state));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CANDLEWICK_SHM_STATE_H */
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "candlewick/core/Device.h"
+#include "candlewick/core/Renderer.h"
+#include "candlewick/core/errors.h"
+
+#include <optional>
+
+namespace candlewick {
+
+/// \brief GPU device for the tests, or std::nullopt when none is available:
+/// the test should then be skipped.
+inline std::optional<Device> tryCreateDevice() {
+  try {
+    return std::optional<Device>{std::in_place,
+                                 auto_detect_shader_format_subset()};
+  } catch (const RAIIException &) {
+    return std::nullopt;
+  }
+}
+
+/// \brief Headless renderer for the tests, or std::nullopt when there is no
+/// GPU device: the test should then be skipped.
+///
+/// Headless rendering only needs a GPU device, which can be a software one
+/// (e.g. lavapipe with SDL_GPU_DRIVER=vulkan).
+inline std::optional<Renderer> tryCreateHeadlessRenderer(
+    Uint32 width, Uint32 height,
+    SDL_GPUTextureFormat depth_format = SDL_GPU_TEXTUREFORMAT_D16_UNORM) {
+  try {
+    return std::optional<Renderer>{
+        std::in_place, Device{auto_detect_shader_format_subset()},
+        OffscreenTargetInfo{width, height}, depth_format};
+  } catch (const RAIIException &) {
+    return std::nullopt;
+  }
+}
+
+} // namespace candlewick
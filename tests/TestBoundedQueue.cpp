@@ -0,0 +1,71 @@
+#include "candlewick/utils/BoundedQueue.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace candlewick;
+
+GTEST_TEST(TestBoundedQueue, push_pop) {
+  BoundedQueue<int> queue(4);
+  EXPECT_TRUE(queue.empty());
+  for (int i = 0; i < 4; i++)
+    EXPECT_TRUE(queue.tryPush(i));
+  EXPECT_FALSE(queue.tryPush(4));
+  EXPECT_EQ(queue.size(), 4);
+
+  for (int i = 0; i < 4; i++) {
+    auto value = queue.tryPop();
+    ASSERT_TRUE(value.has_value());
+    EXPECT_EQ(*value, i);
+  }
+  EXPECT_FALSE(queue.tryPop().has_value());
+  // wrap around
+  EXPECT_TRUE(queue.tryPush(5));
+  EXPECT_EQ(queue.tryPop(), 5);
+}
+
+GTEST_TEST(TestBoundedQueue, concurrent_consumers) {
+  constexpr int numItems = 100000;
+  constexpr int numConsumers = 3;
+  BoundedQueue<int> queue(16);
+  std::vector<std::vector<int>> received(numConsumers);
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < numConsumers; c++) {
+    consumers.emplace_back([&, c] {
+      while (true) {
+        // read before popping: once set, an empty queue stays empty
+        const bool finished = done.load();
+        if (auto value = queue.tryPop())
+          received[c].push_back(*value);
+        else if (finished)
+          break;
+        else
+          std::this_thread::yield();
+      }
+    });
+  }
+  for (int i = 0; i < numItems; i++) {
+    while (!queue.tryPush(i))
+      std::this_thread::yield();
+  }
+  done.store(true);
+  for (auto &t : consumers)
+    t.join();
+
+  // every item is received exactly once, and in order for each consumer
+  std::vector<int> count(numItems, 0);
+  for (const auto &items : received) {
+    for (size_t j = 0; j < items.size(); j++) {
+      count[items[j]]++;
+      if (j > 0) {
+        EXPECT_LT(items[j - 1], items[j]);
+      }
+    }
+  }
+  for (int i = 0; i < numItems; i++)
+    EXPECT_EQ(count[i], 1) << "item " << i;
+}
@@ -0,0 +1,121 @@
+#include "HeadlessRenderer.h"
+#include "candlewick/core/Components.h"
+#include "candlewick/core/Renderer.h"
+#include "candlewick/multibody/CollisionDebug.h"
+#include "candlewick/multibody/RobotScene.h"
+#include <gtest/gtest.h>
+
+#include <coal/shape/geometric_shapes.h>
+#include <entt/entity/registry.hpp>
+#include <pinocchio/algorithm/geometry.hpp>
+#include <pinocchio/multibody/geometry.hpp>
+
+#include <optional>
+
+using namespace candlewick;
+using namespace candlewick::multibody;
+
+// two overlapping boxes, and a sphere further away
+static pin::GeometryModel makeGeometryModel() {
+  pin::GeometryModel geom_model;
+  geom_model.addGeometryObject({"box0", 0ul, pin::SE3::Identity(),
+                                std::make_shared<coal::Box>(0.2, 0.2, 0.2)});
+  geom_model.addGeometryObject(
+      {"box1", 0ul, pin::SE3{Eigen::Matrix3d::Identity(), {0.15, 0., 0.}},
+       std::make_shared<coal::Box>(0.2, 0.2, 0.2)});
+  geom_model.addGeometryObject(
+      {"sphere", 0ul, pin::SE3{Eigen::Matrix3d::Identity(), {0., 0.25, 0.}},
+       std::make_shared<coal::Sphere>(0.1)});
+  geom_model.addAllCollisionPairs();
+  return geom_model;
+}
+
+static void computeResults(const pin::GeometryModel &geom_model,
+                           pin::GeometryData &geom_data) {
+  for (size_t i = 0; i < geom_model.ngeoms; i++)
+    geom_data.oMg[i] = geom_model.geometryObjects[i].placement;
+  pin::computeCollisions(geom_model, geom_data, false);
+  pin::computeDistances(geom_model, geom_data);
+}
+
+GTEST_TEST(TestCollisionOverlay, draw_results) {
+  const pin::GeometryModel geom_model = makeGeometryModel();
+  pin::GeometryData geom_data{geom_model};
+  computeResults(geom_model, geom_data);
+
+  // box0-box1 collide, box0-sphere are 0.05 apart, box1-sphere 0.058
+  DebugDrawList list;
+  CollisionDrawStyle style;
+  style.maxDistance = 0.055f;
+  EXPECT_EQ(drawCollisionResults(list, geom_model, geom_data, style), 1u);
+  const size_t num_contacts = geom_data.collisionResults[0].numContacts();
+  EXPECT_GT(num_contacts, 0u);
+  EXPECT_EQ(list.instances(DebugShape::POINT).size(), num_contacts + 2);
+  EXPECT_EQ(list.instances(DebugShape::ARROW).size(), num_contacts + 1);
+
+  // inactive pairs are skipped
+  list.clear();
+  geom_data.deactivateCollisionPair(0);
+  EXPECT_EQ(drawCollisionResults(list, geom_model, geom_data, style), 0u);
+  EXPECT_EQ(list.instances(DebugShape::POINT).size(), 2u);
+}
+
+GTEST_TEST(TestCollisionOverlay, robot_scene_collision_model) {
+  std::optional<Renderer> renderer = tryCreateHeadlessRenderer(64, 48);
+  if (!renderer)
+    GTEST_SKIP() << "No GPU device available: " << SDL_GetError();
+
+  const pin::GeometryModel visual_model = makeGeometryModel();
+  pin::GeometryData visual_data{visual_model};
+  // copies share their coal geometries, hence their meshes
+  const pin::GeometryModel coll_model = visual_model;
+  pin::GeometryData coll_data{coll_model};
+  computeResults(coll_model, coll_data);
+
+  entt::registry registry;
+  RobotScene scene{registry, *renderer, visual_model, visual_data, {}};
+  scene.setCollisionModel(coll_model, coll_data);
+  auto coll_view = registry.view<const PinCollisionGeomComponent>();
+  // loaded when first shown
+  EXPECT_EQ(coll_view.size(), 0u);
+  scene.showCollisionModel(true);
+  ASSERT_EQ(coll_view.size(), coll_model.ngeoms);
+
+  auto visual_view = registry.view<const PinGeomObjComponent>();
+  for (auto [coll_ent, coll_id] : coll_view.each()) {
+    for (auto [vis_ent, vis_id] : visual_view.each()) {
+      if (vis_id.geom_index != coll_id.geom_index)
+        continue;
+      EXPECT_EQ(registry.get<MeshMaterialComponent>(coll_ent).mesh,
+                registry.get<MeshMaterialComponent>(vis_ent).mesh);
+    }
+  }
+
+  const Float4 color{1.f, 0.f, 0.f, 0.5f};
+  EXPECT_EQ(scene.highlightCollisions(color), 1u);
+  for (auto [ent, geom_id] : coll_view.each()) {
+    const bool colliding = geom_id.geom_index != 2;
+    EXPECT_EQ(registry.all_of<HighlightComponent>(ent), colliding);
+  }
+  scene.clearCollisionHighlights();
+  EXPECT_TRUE(registry.view<HighlightComponent>().empty());
+
+  scene.showCollisionModel(false);
+  for (auto ent : coll_view)
+    EXPECT_TRUE(registry.all_of<Disable>(ent));
+  // hidden geometries are kept
+  scene.showCollisionModel(true);
+  EXPECT_EQ(coll_view.size(), coll_model.ngeoms);
+  for (auto ent : coll_view)
+    EXPECT_FALSE(registry.all_of<Disable>(ent));
+
+  // geometries disabled by the user stay disabled
+  const entt::entity user_disabled = *visual_view.begin();
+  registry.emplace<Disable>(user_disabled);
+  scene.showVisualModel(false);
+  scene.showVisualModel(true);
+  for (auto ent : visual_view)
+    EXPECT_EQ(registry.all_of<Disable>(ent), ent == user_disabled);
+
+  scene.release();
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include "candlewick/core/DebugDraw.h"
+#include "candlewick/core/debug/Contacts.h"
+#include <Eigen/Geometry>
+
+using namespace candlewick;
+
+static Float3 transformInstance(const DebugShapeInstance &inst,
+                                const Float3 &p) {
+  const Float4 ph = p.homogeneous();
+  return {inst.modelRows[0].dot(ph), inst.modelRows[1].dot(ph),
+          inst.modelRows[2].dot(ph)};
+}
+
+GTEST_TEST(TestDebugDraw, pack_color) {
+  EXPECT_EQ(packColorRgba8(Float4{1.f, 0.f, 0.f, 1.f}), 0xFF0000FFu);
+  EXPECT_EQ(packColorRgba8(Float4{0.f, 0.f, 1.f, 0.f}), 0x00FF0000u);
+  // out-of-range values are clamped
+  EXPECT_EQ(packColorRgba8(Float4{2.f, -1.f, 0.f, 1.f}), 0xFF0000FFu);
+}
+
+GTEST_TEST(TestDebugDraw, lines) {
+  DebugDrawList list;
+  const Float4 white = Float4::Ones();
+  list.line(Float3::Zero(), Float3::UnitX(), white);
+  const Float3 points[]{Float3::Zero(), Float3::UnitX(), Float3::UnitY()};
+  list.polyline(points, white);
+  EXPECT_EQ(list.lineVertices().size(), 6u);
+  list.polyline(points, white, true);
+  EXPECT_EQ(list.lineVertices().size(), 12u);
+  EXPECT_EQ(list.lineVertices().back().pos, GpuVec3{Float3::Zero()});
+  list.frame(Mat4f::Identity());
+  EXPECT_EQ(list.size(), 9u);
+
+  list.clear();
+  EXPECT_TRUE(list.empty());
+}
+
+GTEST_TEST(TestDebugDraw, shapes) {
+  DebugDrawList list;
+  const Float4 red{1.f, 0.f, 0.f, 1.f};
+  list.sphere(Float3{1.f, 2.f, 3.f}, 0.5f, red);
+  Mat4f pose = Mat4f::Identity();
+  pose.topRightCorner<3, 1>() = Float3{0.f, 0.f, 1.f};
+  list.box(pose, Float3{1.f, 2.f, 3.f}, red);
+  list.point(Float3::Zero(), 0.1f, red);
+  EXPECT_EQ(list.instances(DebugShape::SPHERE).size(), 1u);
+  EXPECT_EQ(list.instances(DebugShape::BOX).size(), 1u);
+  EXPECT_EQ(list.instances(DebugShape::POINT).size(), 1u);
+
+  const auto &sphere = list.instances(DebugShape::SPHERE)[0];
+  EXPECT_TRUE(transformInstance(sphere, Float3::UnitX())
+                  .isApprox(Float3{1.5f, 2.f, 3.f}));
+  const auto &box = list.instances(DebugShape::BOX)[0];
+  EXPECT_TRUE(
+      transformInstance(box, Float3::Ones()).isApprox(Float3{1.f, 2.f, 4.f}));
+}
+
+GTEST_TEST(TestDebugDraw, arrow) {
+  DebugDrawList list;
+  const Float3 from{1.f, 0.f, 0.f};
+  const Float3 to{1.f, 2.f, 0.f};
+  list.arrow(from, to, Float4::Ones());
+  // degenerate arrows are skipped
+  list.arrow(from, from, Float4::Ones());
+  ASSERT_EQ(list.instances(DebugShape::ARROW).size(), 1u);
+
+  // the unit arrow goes from the origin to +z
+  const auto &arrow = list.instances(DebugShape::ARROW)[0];
+  EXPECT_TRUE(transformInstance(arrow, Float3::Zero()).isApprox(from));
+  EXPECT_TRUE(transformInstance(arrow, Float3::UnitZ()).isApprox(to));
+  // the shaft has the requested radius, across the arrow
+  const Float3 shaft =
+      transformInstance(arrow, Float3::UnitX()) - from;
+  EXPECT_NEAR(shaft.norm(), 0.01f, 1e-6f);
+  EXPECT_NEAR(shaft.dot(to - from), 0.f, 1e-6f);
+}
+
+GTEST_TEST(TestDebugDraw, triad) {
+  Mat4f pose = Mat4f::Identity();
+  const Mat3f R =
+      Eigen::AngleAxisf{0.7f, Float3{1.f, 2.f, 3.f}.normalized()}.matrix();
+  const Float3 origin{1.f, -2.f, 0.5f};
+  pose.topLeftCorner<3, 3>() = R;
+  pose.topRightCorner<3, 1>() = origin;
+
+  const auto instances = makeTriadInstances(pose);
+  for (Eigen::Index j = 0; j < 3; j++) {
+    SCOPED_TRACE(j);
+    const auto &arrow = instances[size_t(j)];
+    // arrow j goes along axis j of the pose, with length 0.5
+    EXPECT_TRUE(transformInstance(arrow, Float3::Zero()).isApprox(origin));
+    EXPECT_TRUE(transformInstance(arrow, Float3::UnitZ())
+                    .isApprox(origin + 0.5f * R.col(j)));
+    const Float3 shaft = transformInstance(arrow, Float3::UnitX()) - origin;
+    EXPECT_NEAR(shaft.norm(), 0.01f, 1e-6f);
+    EXPECT_NEAR(shaft.dot(R.col(j)), 0.f, 1e-6f);
+    // red, green and blue
+    Float4 color = Float4::UnitW();
+    color[j] = 1.f;
+    EXPECT_EQ(Float4{arrow.color}, color);
+  }
+}
+
+GTEST_TEST(TestDebugDraw, contacts) {
+  const ContactRecord contacts[]{
+      {Float3::Zero(), Float3::UnitZ(), Float3{0.f, 0.f, 50.f}},
+      // no force: no arrow
+      {Float3::UnitX(), Float3::UnitZ(), Float3::Zero()},
+  };
+  ContactDrawStyle style;
+  DebugDrawList list;
+  drawContacts(list, contacts, style);
+  EXPECT_EQ(list.instances(DebugShape::SPHERE).size(), 2u);
+  EXPECT_EQ(list.instances(DebugShape::ARROW).size(), 1u);
+  EXPECT_EQ(list.lineVertices().size(), 4u);
+
+  // the sphere of the loaded contact is larger
+  const auto &spheres = list.instances(DebugShape::SPHERE);
+  EXPECT_GT(spheres[0].modelRows[0].x(), spheres[1].modelRows[0].x());
+  EXPECT_FLOAT_EQ(spheres[1].modelRows[0].x(), style.minPointRadius);
+
+  const auto &arrow = list.instances(DebugShape::ARROW)[0];
+  EXPECT_TRUE(transformInstance(arrow, Float3::UnitZ())
+                  .isApprox(Float3{0.f, 0.f, 50.f * style.forceScale}));
+
+  list.clear();
+  style.showNormals = false;
+  style.showPoints = false;
+  drawContacts(list, contacts, style);
+  EXPECT_EQ(list.size(), 1u);
+}
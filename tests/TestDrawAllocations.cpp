@@ -0,0 +1,92 @@
+#include "HeadlessRenderer.h"
+#include "candlewick/core/Camera.h"
+#include "candlewick/core/CommandBuffer.h"
+#include "candlewick/core/Renderer.h"
+#include "candlewick/multibody/RobotScene.h"
+#include <gtest/gtest.h>
+
+#include <SDL3/SDL_init.h>
+#include <coal/shape/geometric_shapes.h>
+#include <entt/entity/registry.hpp>
+#include <pinocchio/multibody/geometry.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <optional>
+
+using namespace candlewick;
+using namespace candlewick::multibody;
+
+// Count the allocations of this process, whatever the build type of
+// candlewick. Array and nothrow forms call these ones.
+static std::atomic<Uint64> g_allocations{0};
+
+void *operator new(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+constexpr Uint32 width = 64;
+constexpr Uint32 height = 48;
+
+GTEST_TEST(TestDrawAllocations, robot_scene_steady_state) {
+  std::optional<Renderer> renderer = tryCreateHeadlessRenderer(width, height);
+  if (!renderer)
+    GTEST_SKIP() << "No GPU device available: " << SDL_GetError();
+
+  pin::GeometryModel geom_model;
+  geom_model.addGeometryObject(
+      {"box", 0ul, pin::SE3::Identity(),
+       std::make_shared<coal::Box>(0.2, 0.3, 0.4)});
+  geom_model.addGeometryObject(
+      {"sphere", 0ul, pin::SE3{Eigen::Matrix3d::Identity(), {0.5, 0., 0.}},
+       std::make_shared<coal::Sphere>(0.1)});
+  geom_model.addGeometryObject(
+      {"capsule", 0ul, pin::SE3{Eigen::Matrix3d::Identity(), {0., 0.5, 0.}},
+       std::make_shared<coal::Capsule>(0.1, 0.3)});
+  pin::GeometryData geom_data{geom_model};
+  for (size_t i = 0; i < geom_model.ngeoms; i++)
+    geom_data.oMg[i] = geom_model.geometryObjects[i].placement;
+
+  const Camera camera{
+      .projection = perspectiveFromFov(Radf{0.8f}, float(width) / height,
+                                       0.01f, 10.f),
+      .view = Eigen::Isometry3f{lookAt({2., 1., 1.}, Float3::Zero())},
+  };
+
+  Uint64 frame_allocations = 0;
+  {
+    entt::registry registry;
+    RobotScene scene{registry, *renderer, geom_model, geom_data, {}};
+    scene.worldSpaceBounds = AABB{Eigen::Vector3d::Constant(-1.),
+                                  Eigen::Vector3d::Constant(1.)};
+    scene.updateTransforms();
+
+    // the first frames fill the per-frame storage, later ones reuse it
+    for (int frame = 0; frame < 4; frame++) {
+      CommandBuffer cmdBuf = renderer->acquireCommandBuffer();
+      ASSERT_TRUE(renderer->waitAndAcquireSwapchain(cmdBuf));
+      const Uint64 before = g_allocations.load(std::memory_order_relaxed);
+      scene.uploadTransforms(cmdBuf);
+      scene.collectOpaqueCastables();
+      renderShadowPassFromAABB(cmdBuf, scene.shadowPass, scene.directionalLight,
+                               scene.castables(), scene.transformBuffer(),
+                               scene.worldSpaceBounds);
+      scene.render(cmdBuf, camera);
+      frame_allocations =
+          g_allocations.load(std::memory_order_relaxed) - before;
+      cmdBuf.submit();
+    }
+    SDL_WaitForGPUIdle(renderer->device);
+    scene.release();
+  }
+
+  EXPECT_EQ(frame_allocations, 0u);
+  renderer->destroy();
+  SDL_Quit();
+}
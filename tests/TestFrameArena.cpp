@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include "candlewick/core/FrameArena.h"
+#include <cstdint>
+
+using namespace candlewick;
+
+static bool isAligned(const void *ptr, size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+GTEST_TEST(TestFrameArena, alignment) {
+  FrameArena arena{1024, 1};
+  arena.beginFrame();
+  void *a = arena.allocate(3, 1);
+  void *b = arena.allocate(16, 64);
+  void *c = arena.allocate(8, 8);
+  EXPECT_TRUE(isAligned(b, 64));
+  EXPECT_TRUE(isAligned(c, 8));
+  EXPECT_NE(a, b);
+  EXPECT_LT(static_cast<char *>(b), static_cast<char *>(c));
+  EXPECT_EQ(arena.stats().overflows, 0u);
+}
+
+GTEST_TEST(TestFrameArena, frames_in_flight) {
+  FrameArena arena{256, 2};
+  arena.beginFrame();
+  std::span<int> first = arena.allocateArray<int>(4);
+  for (int i = 0; i < 4; i++)
+    first[size_t(i)] = i;
+
+  // the data of the previous frame is still valid
+  arena.beginFrame();
+  std::span<int> second = arena.allocateArray<int>(4);
+  EXPECT_NE(first.data(), second.data());
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(first[size_t(i)], i);
+
+  // back to the first region, which was reset
+  arena.beginFrame();
+  EXPECT_EQ(arena.allocateArray<int>(4).data(), first.data());
+}
+
+GTEST_TEST(TestFrameArena, overflow_grows_region) {
+  FrameArena arena{64, 1};
+  arena.beginFrame();
+  std::span<double> big = arena.allocateArray<double>(100);
+  big[99] = 1.;
+  FrameArenaStats stats = arena.stats();
+  EXPECT_EQ(stats.overflows, 1u);
+  EXPECT_GE(stats.highWaterMark, 800u);
+
+  // the region was resized to the high-water mark
+  arena.beginFrame();
+  (void)arena.allocateArray<double>(100);
+  stats = arena.stats();
+  EXPECT_EQ(stats.overflows, 1u);
+  EXPECT_GE(stats.capacity, 800u);
+}
+
+GTEST_TEST(TestFrameArena, vector) {
+  FrameArena arena{4096, 2};
+  arena.beginFrame();
+  FrameVector<int> values{arena};
+  values.reserve(10);
+  for (int i = 0; i < 10; i++)
+    values.push_back(i);
+  EXPECT_EQ(values.size(), 10u);
+  EXPECT_EQ(values[9], 9);
+  EXPECT_GE(arena.stats().used, 10 * sizeof(int));
+
+  // move-assigning a fresh vector does not touch the arena
+  const size_t used = arena.stats().used;
+  values = FrameVector<int>{arena};
+  EXPECT_TRUE(values.empty());
+  EXPECT_EQ(arena.stats().used, used);
+}
@@ -0,0 +1,178 @@
+#include "candlewick/utils/FrameQueue.h"
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace candlewick;
+using media::FrameQueue;
+using media::FrameQueuePolicy;
+
+using namespace std::chrono_literals;
+
+/// Pool of frames, each holding the number of the frame last written to it.
+struct Producer {
+  FrameQueue &queue;
+  std::array<int, 8> pool{};
+  int next = 0;
+
+  /// Write the next frame. \returns false if it was dropped.
+  bool write() {
+    const int frame = next++;
+    std::optional<Uint32> index = queue.acquire();
+    if (!index)
+      return false;
+    pool[*index] = frame;
+    queue.submit(*index);
+    return true;
+  }
+
+  /// Number of the oldest queued frame, and its slot.
+  std::pair<int, Uint32> consume() {
+    std::optional<Uint32> index = queue.popReady();
+    EXPECT_TRUE(index.has_value());
+    return {pool[*index], *index};
+  }
+};
+
+GTEST_TEST(TestFrameQueue, fifo) {
+  FrameQueue queue{3, FrameQueuePolicy::BLOCK};
+  Producer producer{queue};
+  for (int i = 0; i < 3; i++)
+    ASSERT_TRUE(producer.write());
+  EXPECT_EQ(queue.queued(), 3u);
+  for (int i = 0; i < 3; i++) {
+    auto [frame, index] = producer.consume();
+    EXPECT_EQ(frame, i);
+    queue.release(index);
+  }
+  EXPECT_EQ(queue.queued(), 0u);
+  EXPECT_EQ(queue.dropped(), 0u);
+}
+
+// The consumer holds frame 0, frames 1 and 2 are queued: frame 3 is dropped.
+GTEST_TEST(TestFrameQueue, drop_newest) {
+  FrameQueue queue{3, FrameQueuePolicy::DROP_NEWEST};
+  Producer producer{queue};
+  for (int i = 0; i < 3; i++)
+    ASSERT_TRUE(producer.write());
+  auto [first, held] = producer.consume();
+  EXPECT_EQ(first, 0);
+
+  EXPECT_FALSE(producer.write());
+  EXPECT_EQ(queue.dropped(), 1u);
+  EXPECT_EQ(queue.queued(), 2u);
+
+  queue.release(held);
+  EXPECT_TRUE(producer.write());
+  EXPECT_EQ(producer.consume().first, 1);
+  EXPECT_EQ(producer.consume().first, 2);
+  EXPECT_EQ(producer.consume().first, 4);
+  EXPECT_EQ(queue.dropped(), 1u);
+}
+
+// The consumer holds frame 0, frames 1 and 2 are queued: frame 3 replaces
+// frame 1, and the held frame is untouched.
+GTEST_TEST(TestFrameQueue, drop_oldest) {
+  FrameQueue queue{3, FrameQueuePolicy::DROP_OLDEST};
+  Producer producer{queue};
+  for (int i = 0; i < 3; i++)
+    ASSERT_TRUE(producer.write());
+  auto [first, held] = producer.consume();
+  EXPECT_EQ(first, 0);
+
+  EXPECT_TRUE(producer.write());
+  EXPECT_EQ(queue.dropped(), 1u);
+  EXPECT_EQ(queue.queued(), 2u);
+  EXPECT_EQ(producer.pool[held], 0);
+
+  EXPECT_EQ(producer.consume().first, 2);
+  EXPECT_EQ(producer.consume().first, 3);
+  queue.release(held);
+}
+
+// With every frame held by the consumer, there is no queued frame to drop:
+// the producer waits.
+GTEST_TEST(TestFrameQueue, drop_oldest_all_held) {
+  FrameQueue queue{1, FrameQueuePolicy::DROP_OLDEST};
+  Producer producer{queue};
+  ASSERT_TRUE(producer.write());
+  const Uint32 held = producer.consume().second;
+
+  std::atomic<bool> written = false;
+  std::thread thread{[&] { written = producer.write(); }};
+  std::this_thread::sleep_for(50ms);
+  EXPECT_FALSE(written);
+  queue.release(held);
+  thread.join();
+  EXPECT_TRUE(written);
+  EXPECT_EQ(producer.consume().first, 1);
+  EXPECT_EQ(queue.dropped(), 0u);
+}
+
+// The producer waits until the consumer releases a frame, and nothing is
+// dropped.
+GTEST_TEST(TestFrameQueue, block) {
+  FrameQueue queue{2, FrameQueuePolicy::BLOCK};
+  Producer producer{queue};
+  for (int i = 0; i < 2; i++)
+    ASSERT_TRUE(producer.write());
+
+  std::atomic<bool> written = false;
+  std::thread thread{[&] { written = producer.write(); }};
+  std::this_thread::sleep_for(50ms);
+  EXPECT_FALSE(written);
+  EXPECT_EQ(queue.queued(), 2u);
+
+  auto [first, index] = producer.consume();
+  EXPECT_EQ(first, 0);
+  queue.release(index);
+  thread.join();
+  EXPECT_TRUE(written);
+  EXPECT_EQ(producer.consume().first, 1);
+  EXPECT_EQ(producer.consume().first, 2);
+  EXPECT_EQ(queue.dropped(), 0u);
+}
+
+// A producer blocked on a consumer which stopped gives up.
+GTEST_TEST(TestFrameQueue, abort_wakes_producer) {
+  FrameQueue queue{1, FrameQueuePolicy::BLOCK};
+  Producer producer{queue};
+  ASSERT_TRUE(producer.write());
+
+  std::atomic<bool> done = false;
+  std::optional<Uint32> index;
+  std::thread thread{[&] {
+    index = queue.acquire();
+    done = true;
+  }};
+  std::this_thread::sleep_for(50ms);
+  EXPECT_FALSE(done);
+  queue.abort();
+  thread.join();
+  EXPECT_FALSE(index.has_value());
+  EXPECT_EQ(queue.dropped(), 0u);
+}
+
+// The consumer drains the queued frames before stopping.
+GTEST_TEST(TestFrameQueue, close_drains) {
+  FrameQueue queue{4, FrameQueuePolicy::BLOCK};
+  Producer producer{queue};
+  for (int i = 0; i < 3; i++)
+    ASSERT_TRUE(producer.write());
+
+  std::vector<int> consumed;
+  std::thread consumer{[&] {
+    while (auto index = queue.popReady()) {
+      consumed.push_back(producer.pool[*index]);
+      queue.release(*index);
+    }
+  }};
+  queue.close();
+  consumer.join();
+  EXPECT_EQ(consumed, (std::vector<int>{0, 1, 2}));
+}
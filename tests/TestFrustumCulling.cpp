@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include "candlewick/core/Camera.h"
+#include "candlewick/core/Culling.h"
+
+using namespace candlewick;
+
+static Mat4f testViewProj() {
+  // camera at the origin, looking down -Z
+  return perspectiveFromFov(60.0_degf, 1.f, 0.1f, 10.f);
+}
+
+GTEST_TEST(TestFrustumCulling, BoxInFront) {
+  auto frustum = FrustumPlanes::fromViewProj(testViewProj());
+  BoundingBox box{{0.f, 0.f, -5.f}, Float3::Constant(0.5f)};
+  EXPECT_TRUE(frustum.intersects(box));
+}
+
+GTEST_TEST(TestFrustumCulling, BoxOutside) {
+  auto frustum = FrustumPlanes::fromViewProj(testViewProj());
+  // behind the camera
+  EXPECT_FALSE(frustum.intersects({{0.f, 0.f, 5.f}, Float3::Constant(0.5f)}));
+  // beyond the far plane
+  EXPECT_FALSE(
+      frustum.intersects({{0.f, 0.f, -20.f}, Float3::Constant(0.5f)}));
+  // off to the side
+  EXPECT_FALSE(
+      frustum.intersects({{10.f, 0.f, -2.f}, Float3::Constant(0.5f)}));
+}
+
+GTEST_TEST(TestFrustumCulling, BoxStraddlingPlane) {
+  auto frustum = FrustumPlanes::fromViewProj(testViewProj());
+  // center outside the left plane, but the box crosses it
+  BoundingBox box{{-4.f, 0.f, -5.f}, Float3::Constant(2.f)};
+  EXPECT_TRUE(frustum.intersects(box));
+}
+
+GTEST_TEST(TestFrustumCulling, TransformedBox) {
+  auto frustum = FrustumPlanes::fromViewProj(testViewProj());
+  BoundingBox local{Float3::Zero(), {2.f, 0.1f, 0.1f}};
+  Mat4f M = Mat4f::Identity();
+  M.topRightCorner<3, 1>() << 0.f, 0.f, 5.f;
+  EXPECT_FALSE(frustum.intersects(local.transformed(M)));
+
+  // rotate by 90 degrees about Y: the long axis now points towards the camera
+  M.topLeftCorner<3, 3>() << 0.f, 0.f, 1.f, //
+      0.f, 1.f, 0.f,                        //
+      -1.f, 0.f, 0.f;
+  M.topRightCorner<3, 1>() << 0.f, 0.f, 1.5f;
+  BoundingBox world = local.transformed(M);
+  EXPECT_TRUE(world.halfExtents.isApprox(Float3{0.1f, 0.1f, 2.f}));
+  EXPECT_TRUE(frustum.intersects(world));
+}
@@ -0,0 +1,63 @@
+#include "HeadlessRenderer.h"
+#include "candlewick/core/CommandBuffer.h"
+#include "candlewick/core/Renderer.h"
+#include "candlewick/utils/FrameReadback.h"
+#include <gtest/gtest.h>
+
+#include <SDL3/SDL_init.h>
+#include <optional>
+#include <vector>
+
+using namespace candlewick;
+
+constexpr Uint32 width = 32;
+constexpr Uint32 height = 24;
+
+GTEST_TEST(TestHeadlessRenderer, clear_and_readback) {
+  std::optional<Renderer> renderer = tryCreateHeadlessRenderer(width, height);
+  if (!renderer)
+    GTEST_SKIP() << "No GPU device available: " << SDL_GetError();
+
+  EXPECT_TRUE(renderer->headless());
+  EXPECT_EQ(renderer->size()[0], int(width));
+  EXPECT_EQ(renderer->size()[1], int(height));
+  EXPECT_EQ(renderer->getSwapchainTextureFormat(),
+            SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM);
+  EXPECT_EQ(renderer->depth_texture.width(), width);
+
+  std::vector<Uint8> pixels;
+  {
+    media::FrameReadbackRing readback{
+        renderer->device, width, height, renderer->getSwapchainTextureFormat(),
+        [&](const Uint8 *data, Uint32 size) {
+          pixels.assign(data, data + size);
+        },
+        1};
+
+    CommandBuffer cmdBuf = renderer->acquireCommandBuffer();
+    ASSERT_TRUE(renderer->waitAndAcquireSwapchain(cmdBuf));
+    ASSERT_EQ(renderer->swapchain,
+              static_cast<SDL_GPUTexture *>(renderer->offscreen_texture));
+
+    SDL_GPUColorTargetInfo color_target{
+        .texture = renderer->swapchain,
+        .clear_color = {1.f, 0.f, 1.f, 1.f},
+        .load_op = SDL_GPU_LOADOP_CLEAR,
+        .store_op = SDL_GPU_STOREOP_STORE,
+    };
+    SDL_GPURenderPass *render_pass =
+        SDL_BeginGPURenderPass(cmdBuf, &color_target, 1, nullptr);
+    SDL_EndGPURenderPass(render_pass);
+    readback.submitFrame(cmdBuf, renderer->swapchain);
+    readback.flush();
+  }
+
+  ASSERT_EQ(pixels.size(), 4u * width * height);
+  for (Uint32 i = 0; i < width * height; i++) {
+    EXPECT_EQ(pixels[4 * i + 0], 255);
+    EXPECT_EQ(pixels[4 * i + 1], 0);
+    EXPECT_EQ(pixels[4 * i + 2], 255);
+  }
+  renderer->destroy();
+  SDL_Quit();
+}
@@ -0,0 +1,220 @@
+#include "candlewick/utils/ScreenshotCapture.h"
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+
+using namespace candlewick;
+using media::ImageFileFormat;
+
+// odd width, so that rows are not aligned
+constexpr Uint32 width = 37;
+constexpr Uint32 height = 23;
+
+static std::vector<Uint8> randomImage(Uint32 channels) {
+  std::mt19937 rng{channels};
+  std::uniform_int_distribution<int> dist{0, 255};
+  std::vector<Uint8> pixels(width * height * channels);
+  for (auto &b : pixels)
+    b = Uint8(dist(rng));
+  return pixels;
+}
+
+static std::string tempFile(const char *extension) {
+  return (std::filesystem::temp_directory_path() /
+          std::format("candlewick_test_image_{:d}.{:s}", getpid(), extension))
+      .string();
+}
+
+static std::string readFile(const std::string &filename) {
+  std::ifstream file{filename, std::ios::binary};
+  return {std::istreambuf_iterator<char>{file}, {}};
+}
+
+/// Split an uncompressed file into its text header and \p size bytes of
+/// pixels.
+static std::pair<std::string, std::vector<Uint8>>
+splitHeader(const std::string &contents, size_t size) {
+  EXPECT_GE(contents.size(), size);
+  const size_t header_size = contents.size() - size;
+  return {contents.substr(0, header_size),
+          {contents.begin() + std::ptrdiff_t(header_size), contents.end()}};
+}
+
+static Uint32 readBigEndian(const std::string &s, size_t pos) {
+  return Uint32(Uint8(s[pos])) << 24 | Uint32(Uint8(s[pos + 1])) << 16 |
+         Uint32(Uint8(s[pos + 2])) << 8 | Uint32(Uint8(s[pos + 3]));
+}
+
+/// Minimal 8-bit PNG decoder, with zlib as the reference inflater.
+static std::vector<Uint8> decodePng(const std::string &png, Uint32 &w,
+                                    Uint32 &h, Uint32 &channels) {
+  if (png.compare(0, 8, "\x89PNG\r\n\x1a\n") != 0)
+    throw std::runtime_error("Not a PNG file.");
+  std::string idat;
+  for (size_t pos = 8; pos + 12 <= png.size();) {
+    const Uint32 length = readBigEndian(png, pos);
+    const std::string type = png.substr(pos + 4, 4);
+    const std::string data = png.substr(pos + 8, length);
+    const uLong crc = crc32(crc32(0, nullptr, 0),
+                            reinterpret_cast<const Bytef *>(&png[pos + 4]),
+                            uInt(4 + length));
+    if (crc != readBigEndian(png, pos + 8 + length))
+      throw std::runtime_error("Bad CRC for PNG chunk " + type);
+    if (type == "IHDR") {
+      w = readBigEndian(data, 0);
+      h = readBigEndian(data, 4);
+      if (data[8] != 8)
+        throw std::runtime_error("Expected 8-bit samples.");
+      channels = data[9] == 6 ? 4 : data[9] == 2 ? 3 : 0;
+    } else if (type == "IDAT") {
+      idat += data;
+    }
+    pos += 12 + length;
+  }
+
+  const size_t stride = size_t(w) * channels;
+  std::vector<Uint8> filtered((stride + 1) * h);
+  uLongf size = uLongf(filtered.size());
+  if (uncompress(filtered.data(), &size,
+                 reinterpret_cast<const Bytef *>(idat.data()),
+                 uLong(idat.size())) != Z_OK ||
+      size != filtered.size())
+    throw std::runtime_error("Failed to inflate PNG data.");
+
+  // undo the per-row filters
+  std::vector<Uint8> pixels(stride * h);
+  for (size_t y = 0; y < h; y++) {
+    const Uint8 filter = filtered[y * (stride + 1)];
+    const Uint8 *in = &filtered[y * (stride + 1) + 1];
+    Uint8 *out = &pixels[y * stride];
+    const Uint8 *prev = y > 0 ? out - stride : nullptr;
+    for (size_t x = 0; x < stride; x++) {
+      const int a = x >= channels ? out[x - channels] : 0;
+      const int b = prev ? prev[x] : 0;
+      const int c = prev && x >= channels ? prev[x - channels] : 0;
+      int pred = 0;
+      switch (filter) {
+      case 0:
+        break;
+      case 1:
+        pred = a;
+        break;
+      case 2:
+        pred = b;
+        break;
+      case 3:
+        pred = (a + b) / 2;
+        break;
+      case 4: {
+        const int p = a + b - c;
+        const int pa = std::abs(p - a), pb = std::abs(p - b),
+                  pc = std::abs(p - c);
+        pred = pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+        break;
+      }
+      default:
+        throw std::runtime_error("Unknown PNG filter.");
+      }
+      out[x] = Uint8(in[x] + pred);
+    }
+  }
+  return pixels;
+}
+
+GTEST_TEST(TestImageWriter, ppm) {
+  const std::string filename = tempFile("ppm");
+  const auto pixels = randomImage(3);
+  media::writeImageFile(filename, pixels.data(), width, height, 3,
+                        {.format = ImageFileFormat::PPM});
+  const auto [header, data] = splitHeader(readFile(filename), pixels.size());
+  EXPECT_EQ(header, std::format("P6\n{:d} {:d}\n255\n", width, height));
+  EXPECT_EQ(data, pixels);
+  std::filesystem::remove(filename);
+}
+
+GTEST_TEST(TestImageWriter, pam) {
+  const std::string filename = tempFile("pam");
+  const auto pixels = randomImage(4);
+  media::writeImageFile(filename, pixels.data(), width, height, 4,
+                        {.format = ImageFileFormat::PAM});
+  const auto [header, data] = splitHeader(readFile(filename), pixels.size());
+  EXPECT_TRUE(header.starts_with("P7\n"));
+  EXPECT_TRUE(header.ends_with("ENDHDR\n"));
+  EXPECT_NE(header.find(std::format("WIDTH {:d}\n", width)), header.npos);
+  EXPECT_NE(header.find(std::format("HEIGHT {:d}\n", height)), header.npos);
+  EXPECT_EQ(data, pixels);
+  std::filesystem::remove(filename);
+}
+
+GTEST_TEST(TestImageWriter, npy) {
+  const std::string filename = tempFile("npy");
+  const auto pixels = randomImage(4);
+  media::writeImageFile(filename, pixels.data(), width, height, 4,
+                        {.format = ImageFileFormat::NPY});
+  const auto [header, data] = splitHeader(readFile(filename), pixels.size());
+  EXPECT_TRUE(header.starts_with("\x93NUMPY\x01\x00"));
+  EXPECT_EQ(header.size() % 64, 0u);
+  EXPECT_NE(header.find(std::format("'shape': ({:d}, {:d}, 4)", height, width)),
+            header.npos);
+  EXPECT_EQ(data, pixels);
+  std::filesystem::remove(filename);
+}
+
+GTEST_TEST(TestImageWriter, png) {
+  const std::string filename = tempFile("png");
+  const auto pixels = randomImage(4);
+  for (int level : {5, 8, 9}) {
+    SCOPED_TRACE(std::format("level {:d}", level));
+    media::writeImageFile(filename, pixels.data(), width, height, 4,
+                          {.format = ImageFileFormat::PNG,
+                           .pngCompressionLevel = level});
+    Uint32 w = 0, h = 0, channels = 0;
+    const auto decoded = decodePng(readFile(filename), w, h, channels);
+    EXPECT_EQ(w, width);
+    EXPECT_EQ(h, height);
+    EXPECT_EQ(channels, 4u);
+    EXPECT_EQ(decoded, pixels);
+  }
+  std::filesystem::remove(filename);
+}
+
+// Levels out of range are clamped, and give the same file as the nearest
+// valid level. Random pixels compress the same at any level: use a pattern,
+// with some noise.
+GTEST_TEST(TestImageWriter, png_level_clamped) {
+  constexpr Uint32 size = 128;
+  std::mt19937 rng{0};
+  std::vector<Uint8> pixels(size * size * 4);
+  for (Uint32 i = 0; i < pixels.size(); i++) {
+    const Uint32 x = i / 4 % size, y = i / 4 / size;
+    pixels[i] = Uint8((x / 4 ^ y / 4) * (i % 4 + 1) + rng() % 8 / 6);
+  }
+  const std::string filename = tempFile("png");
+  auto write = [&](int level) {
+    media::writeImageFile(filename, pixels.data(), size, size, 4,
+                          {.pngCompressionLevel = level});
+    return readFile(filename);
+  };
+  ASSERT_NE(write(5), write(9));
+  EXPECT_EQ(write(0), write(5));
+  EXPECT_EQ(write(20), write(9));
+  std::filesystem::remove(filename);
+}
+
+GTEST_TEST(TestImageWriter, channel_mismatch) {
+  const auto pixels = randomImage(4);
+  EXPECT_THROW(media::writeImageFile(tempFile("ppm"), pixels.data(), width,
+                                     height, 4,
+                                     {.format = ImageFileFormat::PPM}),
+               std::invalid_argument);
+}
@@ -0,0 +1,112 @@
+#include "HeadlessRenderer.h"
+#include "candlewick/core/Camera.h"
+#include "candlewick/core/CommandBuffer.h"
+#include "candlewick/core/Renderer.h"
+#include "candlewick/multibody/Components.h"
+#include "candlewick/multibody/RobotScene.h"
+#include "candlewick/utils/GBufferReadback.h"
+#include <gtest/gtest.h>
+
+#include <SDL3/SDL_init.h>
+#include <coal/shape/geometric_shapes.h>
+#include <entt/entity/registry.hpp>
+#include <pinocchio/multibody/geometry.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+using namespace candlewick;
+using namespace candlewick::multibody;
+
+constexpr Uint32 width = 64;
+constexpr Uint32 height = 48;
+
+class TestInstanceIdReadback
+    : public ::testing::TestWithParam<RobotScene::InstanceIdSource> {};
+
+// A box in the middle of the image, and a sphere to its right.
+TEST_P(TestInstanceIdReadback, pick_entity) {
+  std::optional<Renderer> renderer = tryCreateHeadlessRenderer(width, height);
+  if (!renderer)
+    GTEST_SKIP() << "No GPU device available: " << SDL_GetError();
+
+  pin::GeometryModel geom_model;
+  geom_model.addGeometryObject({"box", 0ul, pin::SE3::Identity(),
+                                std::make_shared<coal::Box>(0.5, 0.5, 0.5)});
+  geom_model.addGeometryObject(
+      {"sphere", 0ul, pin::SE3{Eigen::Matrix3d::Identity(), {0.8, 0., 0.}},
+       std::make_shared<coal::Sphere>(0.2)});
+  pin::GeometryData geom_data{geom_model};
+  for (size_t i = 0; i < geom_model.ngeoms; i++)
+    geom_data.oMg[i] = geom_model.geometryObjects[i].placement;
+
+  const Camera camera{
+      .projection = perspectiveFromFov(Radf{0.8f}, float(width) / height,
+                                       0.01f, 10.f),
+      .view = Eigen::Isometry3f{
+          lookAt({0.f, 0.f, 3.f}, Float3::Zero(), Float3::UnitY())},
+  };
+
+  std::vector<Uint32> ids;
+  {
+    entt::registry registry;
+    RobotScene::Config config;
+    config.enable_instance_id_target = true;
+    config.instance_id_source = GetParam();
+    RobotScene scene{registry, *renderer, geom_model, geom_data, config};
+    scene.worldSpaceBounds = AABB{Eigen::Vector3d::Constant(-1.),
+                                  Eigen::Vector3d::Constant(1.)};
+    scene.updateTransforms();
+
+    media::GBufferReadback readback{
+        renderer->device,
+        {.width = width,
+         .height = height,
+         .depth = false,
+         .instance_ids = true,
+         .num_slots = 1},
+        [&](const media::GBufferFrame &frame) {
+          ids.assign(frame.instance_ids.begin(), frame.instance_ids.end());
+        }};
+
+    CommandBuffer cmdBuf = renderer->acquireCommandBuffer();
+    ASSERT_TRUE(renderer->waitAndAcquireSwapchain(cmdBuf));
+    scene.uploadTransforms(cmdBuf);
+    scene.collectOpaqueCastables();
+    renderShadowPassFromAABB(cmdBuf, scene.shadowPass, scene.directionalLight,
+                             scene.castables(), scene.transformBuffer(),
+                             scene.worldSpaceBounds);
+    scene.render(cmdBuf, camera);
+    ASSERT_TRUE(readback.submitFrame(
+        cmdBuf, {.instanceId = scene.gBuffer.instanceIdMap}, camera));
+    readback.flush();
+    ASSERT_EQ(ids.size(), width * height);
+
+    auto view = registry.view<const PinGeomObjComponent>();
+    entt::entity box = entt::null, sphere = entt::null;
+    for (auto [ent, geom_id] : view.each())
+      (geom_id.geom_index == 0 ? box : sphere) = ent;
+
+    const Uint32 center_id = ids[(height / 2) * width + width / 2];
+    EXPECT_EQ(center_id, scene.instanceIdForEntity(box));
+    EXPECT_EQ(scene.entityFromInstanceId(center_id), box);
+    const Uint32 sphere_id = scene.instanceIdForEntity(sphere);
+    EXPECT_GT(std::ranges::count(ids, sphere_id), 0);
+    EXPECT_EQ(scene.entityFromInstanceId(sphere_id), sphere);
+
+    const Uint32 corner_id = ids[0];
+    EXPECT_EQ(corner_id, RobotScene::INSTANCE_ID_BACKGROUND);
+    EXPECT_EQ(scene.entityFromInstanceId(corner_id), entt::entity{entt::null});
+
+    readback.release();
+    scene.release();
+  }
+  renderer->destroy();
+  SDL_Quit();
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Sources, TestInstanceIdReadback,
+    ::testing::Values(RobotScene::InstanceIdSource::ENTITY,
+                      RobotScene::InstanceIdSource::GEOM_INDEX));
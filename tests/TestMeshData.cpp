@@ -94,6 +94,26 @@ GTEST_TEST(TestErasedBlob, custom_vertex) {
   }
 }
 
+GTEST_TEST(TestMeshBounds, bounding_box) {
+  std::vector<DefaultVertex> vertexData{
+      {{-1.f, 0.f, 2.f}, Float3::Zero(), Float4::Zero()},
+      {{3.f, -2.f, 0.f}, Float3::Zero(), Float4::Zero()},
+  };
+  std::vector<DefaultVertex> otherData{
+      {{0.f, 4.f, 1.f}, Float3::Zero(), Float4::Zero()},
+  };
+  std::vector<MeshData> datas;
+  datas.emplace_back(SDL_GPU_PRIMITIVETYPE_TRIANGLELIST, vertexData);
+  datas.emplace_back(SDL_GPU_PRIMITIVETYPE_TRIANGLELIST, otherData);
+
+  BoundingBox box = computeBoundingBox(datas);
+  EXPECT_TRUE(box.center.isApprox(Float3{1.f, 1.f, 1.f}));
+  EXPECT_TRUE(box.halfExtents.isApprox(Float3{2.f, 3.f, 1.f}));
+
+  BoundingBox empty = computeBoundingBox({});
+  EXPECT_TRUE(empty.halfExtents.isZero());
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
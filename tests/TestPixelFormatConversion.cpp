@@ -0,0 +1,102 @@
+#include "candlewick/utils/PixelFormatConversion.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace candlewick;
+
+// odd sizes, to exercise the scalar tails of the vectorized loops
+constexpr Uint32 sizes[] = {0, 1, 7, 8, 31, 33, 1000, 4099};
+
+static std::vector<Uint8> randomBytes(size_t n) {
+  std::mt19937 rng{n};
+  std::uniform_int_distribution<int> dist{0, 255};
+  std::vector<Uint8> out(n);
+  for (auto &b : out)
+    b = Uint8(dist(rng));
+  return out;
+}
+
+static std::vector<float> randomFloats(size_t n) {
+  std::mt19937 rng{n};
+  // includes out-of-range values, which should be clamped
+  std::uniform_real_distribution<float> dist{-0.2f, 1.2f};
+  std::vector<float> out(n);
+  for (auto &x : out)
+    x = dist(rng);
+  if (n > 2) {
+    out[0] = std::numeric_limits<float>::quiet_NaN();
+    out[1] = 1.f;
+  }
+  return out;
+}
+
+GTEST_TEST(TestPixelFormatConversion, bgra_to_rgba) {
+  for (Uint32 n : sizes) {
+    auto bytes = randomBytes(4 * n);
+    std::vector<Uint32> src(n), dst(n);
+    std::memcpy(src.data(), bytes.data(), bytes.size());
+    bgraToRgbaConvert(src.data(), dst.data(), n);
+    for (Uint32 i = 0; i < n; i++) {
+      const Uint8 *in = reinterpret_cast<const Uint8 *>(&src[i]);
+      const Uint8 *out = reinterpret_cast<const Uint8 *>(&dst[i]);
+      EXPECT_EQ(out[0], in[2]);
+      EXPECT_EQ(out[1], in[1]);
+      EXPECT_EQ(out[2], in[0]);
+      EXPECT_EQ(out[3], in[3]);
+    }
+    // in-place round trip
+    bgraToRgbaConvert(dst.data(), dst.data(), n);
+    EXPECT_EQ(dst, src);
+  }
+}
+
+GTEST_TEST(TestPixelFormatConversion, drop_alpha) {
+  for (Uint32 n : sizes) {
+    auto src = randomBytes(4 * n);
+    std::vector<Uint8> rgb(3 * n), bgr(3 * n);
+    rgbaToRgbConvert(src.data(), rgb.data(), n);
+    bgraToRgbConvert(src.data(), bgr.data(), n);
+    for (Uint32 i = 0; i < n; i++) {
+      for (Uint32 c = 0; c < 3; c++) {
+        EXPECT_EQ(rgb[3 * i + c], src[4 * i + c]);
+        EXPECT_EQ(bgr[3 * i + c], src[4 * i + 2 - c]);
+      }
+    }
+  }
+}
+
+GTEST_TEST(TestPixelFormatConversion, float_to_unorm) {
+  for (Uint32 n : sizes) {
+    auto src = randomFloats(n);
+    std::vector<Uint8> out8(n);
+    std::vector<Uint16> out16(n);
+    floatToUnorm8Convert(src.data(), out8.data(), n);
+    depthToUnorm16Convert(src.data(), out16.data(), n);
+    for (Uint32 i = 0; i < n; i++) {
+      const float x = std::isnan(src[i]) ? 0.f : std::clamp(src[i], 0.f, 1.f);
+      EXPECT_EQ(out8[i], Uint8(std::lrint(x * 255.f))) << "x = " << src[i];
+      EXPECT_EQ(out16[i], Uint16(std::lrint(x * 65535.f))) << "x = " << src[i];
+    }
+  }
+}
+
+GTEST_TEST(TestPixelFormatConversion, flip_vertically) {
+  const Uint32 rowBytes = 4 * 37;
+  for (Uint32 rows : {1u, 2u, 5u, 16u}) {
+    auto src = randomBytes(rowBytes * rows);
+    std::vector<Uint8> flipped(src.size());
+    flipImageVertically(src.data(), flipped.data(), rowBytes, rows);
+    for (Uint32 r = 0; r < rows; r++)
+      EXPECT_EQ(0, std::memcmp(&flipped[r * rowBytes],
+                               &src[(rows - 1 - r) * rowBytes], rowBytes));
+    // flipping again, in-place, gives back the input
+    flipImageVertically(flipped.data(), flipped.data(), rowBytes, rows);
+    EXPECT_EQ(flipped, src);
+  }
+}
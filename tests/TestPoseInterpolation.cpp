@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "candlewick/core/PoseInterpolation.h"
+
+using namespace candlewick;
+
+static Eigen::Quaternionf rotZ(float angle) {
+  return Eigen::Quaternionf{Eigen::AngleAxisf{angle, Float3::UnitZ()}};
+}
+
+GTEST_TEST(TestPoseInterpolation, endpoints_and_midpoint) {
+  PoseArray a, b, out;
+  a.resize(2);
+  b.resize(2);
+  a.set(0, rotZ(0.f), {0.f, 0.f, 0.f});
+  b.set(0, rotZ(1.f), {2.f, 0.f, 4.f});
+  // identical poses
+  a.set(1, rotZ(0.3f), {1.f, 1.f, 1.f});
+  b.set(1, rotZ(0.3f), {1.f, 1.f, 1.f});
+
+  interpolatePoses(a, b, 0.f, out);
+  EXPECT_TRUE(out.rotations.isApprox(a.rotations, 1e-5f));
+  EXPECT_TRUE(out.translations.isApprox(a.translations));
+  interpolatePoses(a, b, 1.f, out);
+  EXPECT_TRUE(out.rotations.isApprox(b.rotations, 1e-5f));
+  EXPECT_TRUE(out.translations.isApprox(b.translations));
+
+  interpolatePoses(a, b, 0.5f, out);
+  EXPECT_TRUE(Eigen::Quaternionf{out.rotations.col(0)}.isApprox(rotZ(0.5f),
+                                                                 1e-5f));
+  EXPECT_TRUE(out.translations.col(0).isApprox(Float3{1.f, 0.f, 2.f}));
+  EXPECT_TRUE(Eigen::Quaternionf{out.rotations.col(1)}.isApprox(rotZ(0.3f),
+                                                                 1e-5f));
+  EXPECT_TRUE(out.translations.col(1).isApprox(Float3::Ones()));
+}
+
+GTEST_TEST(TestPoseInterpolation, constant_angular_velocity) {
+  PoseArray a, b, out;
+  a.resize(1);
+  b.resize(1);
+  a.set(0, rotZ(-1.2f), Float3::Zero());
+  b.set(0, rotZ(1.2f), Float3::Zero());
+  for (float alpha : {0.1f, 0.25f, 0.8f}) {
+    interpolatePoses(a, b, alpha, out);
+    const float expected = -1.2f + 2.4f * alpha;
+    EXPECT_TRUE(Eigen::Quaternionf{out.rotations.col(0)}.isApprox(
+        rotZ(expected), 1e-5f))
+        << "alpha = " << alpha;
+  }
+}
+
+GTEST_TEST(TestPoseInterpolation, shortest_arc) {
+  PoseArray a, b, out;
+  a.resize(1);
+  b.resize(1);
+  a.set(0, rotZ(0.2f), Float3::Zero());
+  // same rotation as rotZ(0.4), with opposite quaternion sign
+  Eigen::Quaternionf q = rotZ(0.4f);
+  q.coeffs() *= -1.f;
+  b.set(0, q, Float3::Zero());
+  interpolatePoses(a, b, 0.5f, out);
+  Eigen::Quaternionf result{out.rotations.col(0)};
+  EXPECT_NEAR(result.angularDistance(rotZ(0.3f)), 0.f, 1e-4f);
+  EXPECT_NEAR(result.norm(), 1.f, 1e-6f);
+  const Mat3f R = out.matrix(0).topLeftCorner<3, 3>();
+  EXPECT_TRUE(R.isApprox(rotZ(0.3f).toRotationMatrix(), 1e-5f));
+}
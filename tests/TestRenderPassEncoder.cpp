@@ -0,0 +1,121 @@
+#include "HeadlessRenderer.h"
+#include "candlewick/core/Camera.h"
+#include "candlewick/core/CommandBuffer.h"
+#include "candlewick/core/DebugDraw.h"
+#include "candlewick/core/DebugScene.h"
+#include "candlewick/core/RenderPassEncoder.h"
+#include "candlewick/core/Renderer.h"
+#include <gtest/gtest.h>
+
+#include <SDL3/SDL_init.h>
+#include <entt/entity/registry.hpp>
+#include <optional>
+
+using namespace candlewick;
+
+constexpr Uint32 width = 32;
+constexpr Uint32 height = 24;
+
+class TestRenderPassEncoder : public ::testing::Test {
+protected:
+  void SetUp() override {
+    renderer = tryCreateHeadlessRenderer(width, height);
+    if (!renderer)
+      GTEST_SKIP() << "No GPU device available: " << SDL_GetError();
+  }
+  void TearDown() override {
+    if (!renderer)
+      return;
+    renderer->destroy();
+    SDL_Quit();
+  }
+
+  std::optional<Renderer> renderer;
+  const Camera camera{
+      .projection = perspectiveFromFov(55.0_degf, float(width) / height, 0.01f,
+                                       10.f),
+      .view = Eigen::Isometry3f{lookAt({3.f, 0.f, 1.f}, Float3::Zero())},
+  };
+};
+
+// Uniform payloads identical to the last one pushed to a slot are skipped,
+// per slot and per stage. Payloads too large to be cached are always pushed.
+TEST_F(TestRenderPassEncoder, uniform_pushes) {
+  CommandBuffer cmdBuf = renderer->acquireCommandBuffer();
+  ASSERT_TRUE(renderer->waitAndAcquireSwapchain(cmdBuf));
+  SDL_GPUColorTargetInfo color_target{
+      .texture = renderer->swapchain,
+      .load_op = SDL_GPU_LOADOP_CLEAR,
+      .store_op = SDL_GPU_STOREOP_STORE,
+  };
+  {
+    RenderPassEncoder encoder{
+        cmdBuf, SDL_BeginGPURenderPass(cmdBuf, &color_target, 1, nullptr),
+        &renderer->passStats};
+    const Float4 a{1.f, 0.f, 0.f, 1.f}, b{0.f, 1.f, 0.f, 1.f};
+    encoder.pushVertexUniform(0, &a, sizeof(a));
+    encoder.pushVertexUniform(0, &a, sizeof(a)); // skipped
+    encoder.pushVertexUniform(1, &a, sizeof(a));
+    encoder.pushFragmentUniform(0, &a, sizeof(a));
+    encoder.pushVertexUniform(0, &b, sizeof(b));
+    encoder.pushVertexUniform(0, &b, sizeof(b)); // skipped
+
+    Uint8 large[RenderPassEncoder::kMaxCachedUniformSize + 16]{};
+    encoder.pushFragmentUniform(1, large, sizeof(large));
+    encoder.pushFragmentUniform(1, large, sizeof(large));
+
+    // counted in the renderer's stats once the pass ends
+    EXPECT_EQ(renderer->passStats.uniformPushes, 0u);
+  }
+  const RenderPassStats &stats = renderer->passStats;
+  EXPECT_EQ(stats.passes, 1u);
+  EXPECT_EQ(stats.uniformPushes, 6u);
+  EXPECT_EQ(stats.skippedUniformPushes, 2u);
+  EXPECT_EQ(stats.draws, 0u);
+  cmdBuf.submit();
+}
+
+// Spheres and boxes are drawn with the same pipeline and uniforms: binding
+// them again for the boxes is skipped. Passes accumulate over the frame, and
+// are reset by the next one.
+TEST_F(TestRenderPassEncoder, debug_scene_passes) {
+  entt::registry registry;
+  DebugScene scene{registry, *renderer};
+  scene.drawImmediate([](DebugDrawList &list) {
+    list.sphere(Float3::Zero(), 0.5f, Float4::Ones());
+    list.box(Mat4f::Identity(), Float3::Constant(0.2f), Float4::Ones());
+  });
+
+  CommandBuffer cmdBuf = renderer->acquireCommandBuffer();
+  ASSERT_TRUE(renderer->waitAndAcquireSwapchain(cmdBuf));
+  scene.render(cmdBuf, camera);
+  RenderPassStats stats = renderer->passStats;
+  EXPECT_EQ(stats.passes, 1u);
+  EXPECT_EQ(stats.pipelineBinds, 1u);
+  EXPECT_EQ(stats.skippedPipelineBinds, 1u);
+  EXPECT_EQ(stats.uniformPushes, 1u);
+  EXPECT_EQ(stats.skippedUniformPushes, 1u);
+  EXPECT_EQ(stats.draws, 2u);
+
+  // the pipeline is bound again in the second pass
+  scene.render(cmdBuf, camera);
+  stats = renderer->passStats;
+  EXPECT_EQ(stats.passes, 2u);
+  EXPECT_EQ(stats.pipelineBinds, 2u);
+  EXPECT_EQ(stats.draws, 4u);
+  cmdBuf.submit();
+
+  // an empty scene still has its pass, without any command
+  scene.clearImmediate();
+  cmdBuf = renderer->acquireCommandBuffer();
+  ASSERT_TRUE(renderer->waitAndAcquireSwapchain(cmdBuf));
+  EXPECT_EQ(renderer->passStats.passes, 0u);
+  scene.render(cmdBuf, camera);
+  stats = renderer->passStats;
+  EXPECT_EQ(stats.passes, 1u);
+  EXPECT_EQ(stats.commands(), 0u);
+  EXPECT_EQ(stats.skipped(), 0u);
+  cmdBuf.submit();
+
+  scene.release();
+}
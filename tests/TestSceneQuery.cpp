@@ -0,0 +1,282 @@
+#include <gtest/gtest.h>
+
+#include "candlewick/core/Bvh.h"
+#include "candlewick/core/Camera.h"
+#include "candlewick/core/Components.h"
+#include "candlewick/core/SceneQuery.h"
+#include "candlewick/primitives/Sphere.h"
+
+#include <entt/entity/registry.hpp>
+#include <Eigen/Geometry>
+#include <random>
+
+using namespace candlewick;
+
+static bool contains(const std::vector<entt::entity> &ents, entt::entity ent) {
+  return std::ranges::find(ents, ent) != ents.end();
+}
+
+static std::vector<Float3> randomTriangles(Uint32 count, std::mt19937 &rng) {
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  auto random_point = [&] { return Float3{dist(rng), dist(rng), dist(rng)}; };
+  std::vector<Float3> positions;
+  for (Uint32 i = 0; i < count; i++) {
+    const Float3 center = random_point();
+    for (int k = 0; k < 3; k++)
+      positions.push_back(center + 0.2f * random_point());
+  }
+  return positions;
+}
+
+/// Moller-Trumbore over all the triangles.
+static float bruteForceRaycast(std::span<const Float3> positions,
+                               const Ray &ray) {
+  float best = SceneQuery::kInfinity;
+  for (size_t i = 0; i < positions.size(); i += 3) {
+    const Float3 e1 = positions[i + 1] - positions[i];
+    const Float3 e2 = positions[i + 2] - positions[i];
+    const Float3 p = ray.direction.cross(e2);
+    const float det = e1.dot(p);
+    if (det == 0.f)
+      continue;
+    const Float3 s = ray.origin - positions[i];
+    const float u = s.dot(p) / det;
+    const Float3 q = s.cross(e1);
+    const float v = ray.direction.dot(q) / det;
+    const float t = e2.dot(q) / det;
+    if (u >= 0.f && v >= 0.f && u + v <= 1.f && t >= 0.f)
+      best = std::min(best, t);
+  }
+  return best;
+}
+
+GTEST_TEST(TestSceneQuery, triangle_bvh_raycast) {
+  std::mt19937 rng{42};
+  const auto positions = randomTriangles(500, rng);
+  TriangleBvh bvh{positions};
+  EXPECT_EQ(bvh.numTriangles(), 500u);
+
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  Uint32 hits = 0;
+  for (int i = 0; i < 200; i++) {
+    const Float3 target{dist(rng), dist(rng), dist(rng)};
+    const Float3 origin = 3.f * Float3{dist(rng), dist(rng), dist(rng)};
+    const Ray ray{origin, (target - origin).normalized()};
+    const float expected = bruteForceRaycast(positions, ray);
+    TriangleHit hit;
+    const bool found = bvh.raycast(ray, SceneQuery::kInfinity, hit);
+    ASSERT_EQ(found, expected < SceneQuery::kInfinity);
+    if (found) {
+      hits++;
+      EXPECT_NEAR(hit.distance, expected, 1e-4f);
+      EXPECT_NEAR(hit.normal.norm(), 1.f, 1e-5f);
+      EXPECT_LE(hit.normal.dot(ray.direction), 0.f);
+    }
+  }
+  EXPECT_GT(hits, 0u);
+}
+
+GTEST_TEST(TestSceneQuery, triangle_bvh_closest_point) {
+  std::mt19937 rng{7};
+  const auto positions = randomTriangles(300, rng);
+  TriangleBvh bvh{positions};
+
+  std::uniform_real_distribution<float> dist(-2.f, 2.f);
+  for (int i = 0; i < 100; i++) {
+    const Float3 p{dist(rng), dist(rng), dist(rng)};
+    float expected = SceneQuery::kInfinity;
+    for (size_t j = 0; j < positions.size(); j += 3) {
+      const Float3 q = closestPointOnTriangle(p, positions[j], positions[j + 1],
+                                              positions[j + 2]);
+      expected = std::min(expected, (q - p).squaredNorm());
+    }
+    float dist_sq = SceneQuery::kInfinity;
+    Float3 closest;
+    ASSERT_TRUE(bvh.closestPoint(p, dist_sq, closest));
+    EXPECT_NEAR(dist_sq, expected, 1e-5f);
+    EXPECT_NEAR((closest - p).squaredNorm(), dist_sq, 1e-5f);
+  }
+}
+
+GTEST_TEST(TestSceneQuery, mesh_data_bvh) {
+  MeshData sphere = loadUvSphereSolid(16, 32);
+  TriangleBvh bvh = buildTriangleBvh(std::span{&sphere, 1});
+  ASSERT_FALSE(bvh.empty());
+
+  TriangleHit hit;
+  const Ray ray{{0.1f, 0.13f, 5.f}, {0.f, 0.f, -1.f}};
+  ASSERT_TRUE(bvh.raycast(ray, 10.f, hit));
+  // the tessellation is inside the unit sphere
+  EXPECT_GE(hit.distance, 5.f - std::sqrt(1.f - 0.1f * 0.1f - 0.13f * 0.13f));
+  EXPECT_LT(hit.distance, 4.1f);
+  EXPECT_FALSE(bvh.raycast(ray, 3.f, hit));
+}
+
+namespace {
+class SceneQueryTest : public ::testing::Test {
+protected:
+  entt::registry reg;
+  std::shared_ptr<const TriangleBvh> sphere;
+  SceneQuery query;
+
+  void SetUp() override {
+    MeshData data = loadUvSphereSolid(16, 32);
+    sphere = std::make_shared<const TriangleBvh>(
+        buildTriangleBvh(std::span{&data, 1}));
+  }
+
+  entt::entity addObject(const Float3 &position, bool with_mesh) {
+    auto ent = reg.create();
+    Mat4f M = Mat4f::Identity();
+    M.topRightCorner<3, 1>() = position;
+    reg.emplace<TransformComponent>(ent, M);
+    reg.emplace<LocalBoundsComponent>(
+        ent, BoundingBox{Float3::Zero(), Float3::Ones()});
+    if (with_mesh)
+      reg.emplace<PickingMeshComponent>(ent, sphere);
+    return ent;
+  }
+
+  void move(entt::entity ent, const Float3 &position) {
+    reg.patch<TransformComponent>(ent, [&](TransformComponent &M) {
+      M.topRightCorner<3, 1>() = position;
+    });
+  }
+};
+} // namespace
+
+TEST_F(SceneQueryTest, raycast) {
+  std::vector<entt::entity> ents;
+  for (int i = 0; i < 20; i++)
+    ents.push_back(addObject({3.f * float(i), 0.f, 0.f}, i % 2 == 0));
+  query.update(reg);
+  EXPECT_EQ(query.size(), 20u);
+
+  // the mesh: through the sphere, not its box corner
+  auto hit = query.raycast({{6.1f, 0.13f, 5.f}, {0.f, 0.f, -1.f}});
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(hit->entity, ents[2]);
+  EXPECT_NEAR(hit->distance, 4.f, 0.05f);
+  EXPECT_GT(hit->normal.z(), 0.9f);
+  EXPECT_NEAR(hit->normal.norm(), 1.f, 1e-5f);
+  EXPECT_FALSE(query.raycast({{6.8f, 0.8f, 5.f}, {0.f, 0.f, -1.f}}));
+
+  // the box
+  hit = query.raycast({{3.5f, 0.5f, 5.f}, {0.f, 0.f, -1.f}});
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(hit->entity, ents[1]);
+  EXPECT_FLOAT_EQ(hit->distance, 4.f);
+  EXPECT_TRUE(hit->normal.isApprox(Float3::UnitZ()));
+  // starting on the planes of the box
+  hit = query.raycast({{2.f, 0.5f, 5.f}, {0.f, 0.f, -1.f}});
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(hit->entity, ents[1]);
+
+  // closest of several entities along the ray
+  hit = query.raycast({{100.f, 0.f, 0.f}, {-1.f, 0.f, 0.f}});
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(hit->entity, ents[19]);
+  EXPECT_FALSE(query.raycast({{100.f, 0.f, 0.f}, {-1.f, 0.f, 0.f}}, 10.f));
+}
+
+TEST_F(SceneQueryTest, refit_and_rebuild) {
+  std::vector<entt::entity> ents;
+  for (int i = 0; i < 20; i++)
+    ents.push_back(addObject({3.f * float(i), 0.f, 0.f}, true));
+  query.update(reg);
+  EXPECT_EQ(query.stats().rebuilds, 1u);
+
+  // nothing moved
+  query.update(reg);
+  EXPECT_EQ(query.stats().rebuilds, 1u);
+  EXPECT_EQ(query.stats().refits, 0u);
+  EXPECT_EQ(query.stats().movedEntities, 0u);
+
+  // small motion: refit
+  move(ents[5], {15.f, 0.f, 0.5f});
+  query.update(reg);
+  EXPECT_EQ(query.stats().rebuilds, 1u);
+  EXPECT_EQ(query.stats().refits, 1u);
+  EXPECT_EQ(query.stats().movedEntities, 1u);
+  auto hit = query.raycast({{15.1f, 0.13f, 5.f}, {0.f, 0.f, -1.f}});
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(hit->entity, ents[5]);
+  EXPECT_NEAR(hit->distance, 3.5f, 0.05f);
+
+  // far away: the refit tree degrades, and is rebuilt
+  move(ents[0], {0.f, 500.f, 0.f});
+  query.update(reg);
+  EXPECT_EQ(query.stats().rebuilds, 2u);
+  hit = query.raycast({{0.1f, 500.13f, 5.f}, {0.f, 0.f, -1.f}});
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(hit->entity, ents[0]);
+
+  // disabled entities are removed
+  reg.emplace<Disable>(ents[0]);
+  query.update(reg);
+  EXPECT_EQ(query.size(), 19u);
+  EXPECT_EQ(query.stats().rebuilds, 3u);
+  EXPECT_FALSE(query.raycast({{0.1f, 500.13f, 5.f}, {0.f, 0.f, -1.f}}));
+}
+
+TEST_F(SceneQueryTest, overlaps) {
+  std::vector<entt::entity> ents;
+  for (int i = 0; i < 10; i++)
+    ents.push_back(addObject({3.f * float(i) + 0.1f, 0.13f, -10.f}, true));
+  query.update(reg);
+
+  std::vector<entt::entity> found;
+  query.queryBox({{4.6f, 0.f, -10.f}, {0.7f, 0.5f, 0.5f}}, found);
+  ASSERT_EQ(found.size(), 2u);
+  EXPECT_TRUE(contains(found, ents[1]));
+  EXPECT_TRUE(contains(found, ents[2]));
+
+  // camera at the origin, looking down -Z
+  Camera camera;
+  camera.projection = perspectiveFromFov(60.0_degf, 1.f, 0.1f, 100.f);
+  camera.view.setIdentity();
+  found.clear();
+  query.queryFrustum(FrustumPlanes::fromViewProj(camera.viewProj()), found);
+  EXPECT_TRUE(contains(found, ents[0]));
+  EXPECT_TRUE(contains(found, ents[1]));
+  EXPECT_FALSE(contains(found, ents[9]));
+
+  // the right half of the image
+  std::vector<entt::entity> right;
+  query.queryFrustum(cameraRectFrustum(camera, {0.5f, -1.f}, {1.f, 1.f}),
+                     right);
+  EXPECT_FALSE(contains(right, ents[0]));
+  EXPECT_LT(right.size(), found.size());
+
+  // picking through the center of the image
+  const Ray ray = cameraRay(camera, Float2::Zero());
+  EXPECT_TRUE(ray.direction.isApprox(-Float3::UnitZ(), 1e-5f));
+  auto hit = query.raycast(ray);
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(hit->entity, ents[0]);
+}
+
+TEST_F(SceneQueryTest, nearest) {
+  std::vector<entt::entity> ents;
+  for (int i = 0; i < 10; i++)
+    ents.push_back(addObject({3.f * float(i), 0.f, 0.f}, i != 4));
+
+  // scaled sphere
+  reg.patch<TransformComponent>(ents[2], [](TransformComponent &M) {
+    M.topLeftCorner<3, 3>() *= 0.5f;
+  });
+  query.update(reg);
+
+  auto hit = query.nearest({6.f, 2.f, 0.f});
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(hit->entity, ents[2]);
+  EXPECT_NEAR(hit->distance, 1.5f, 0.02f);
+  EXPECT_FALSE(query.nearest({6.f, 2.f, 0.f}, 1.4f));
+
+  // box of the entity without a mesh
+  hit = query.nearest({12.f, 3.f, 0.f});
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(hit->entity, ents[4]);
+  EXPECT_FLOAT_EQ(hit->distance, 2.f);
+  EXPECT_TRUE(hit->point.isApprox(Float3{12.f, 1.f, 0.f}));
+}
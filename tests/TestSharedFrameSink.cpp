@@ -0,0 +1,204 @@
+#include "candlewick/utils/GBufferReadback.h"
+#include "candlewick/utils/SharedFrameSink.h"
+#include <gtest/gtest.h>
+
+#include <format>
+#include <sys/wait.h>
+#include <thread>
+#include <vector>
+
+using namespace candlewick;
+using media::ReadbackPlane;
+using media::SharedFrameSink;
+
+constexpr Uint32 width = 16;
+constexpr Uint32 height = 8;
+constexpr Uint32 numPixels = width * height;
+
+static std::string sinkName() {
+  return std::format("/candlewick_test_frames_{:d}", getpid());
+}
+
+static const ReadbackPlane colorAndDepth[] = {
+    {width, height, SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM},
+    {width, height, SDL_GPU_TEXTUREFORMAT_R32_FLOAT},
+};
+
+static std::vector<Uint8> makeFrame(Uint8 value) {
+  std::vector<Uint8> frame(numPixels * (4 + sizeof(float)), value);
+  return frame;
+}
+
+GTEST_TEST(TestSharedFrameSink, layout) {
+  SharedFrameSink sink{sinkName(), colorAndDepth, 3};
+  EXPECT_EQ(sink.payloadSize(), numPixels * 8u);
+
+  candlewick_shm_frames_reader reader;
+  ASSERT_EQ(candlewick_shm_frames_open(sinkName().c_str(), &reader), 0);
+  const candlewick_shm_frames_header *header = reader.header;
+  EXPECT_EQ(header->num_planes, 2u);
+  EXPECT_EQ(header->capacity, 3u);
+  EXPECT_EQ(header->slot_stride % 4096, 0u);
+  EXPECT_EQ(header->planes[0].format,
+            Uint32(SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM));
+  EXPECT_EQ(header->planes[0].row_pitch, 4 * width);
+  EXPECT_EQ(header->planes[1].offset, 4u * numPixels);
+  EXPECT_EQ(header->planes[1].size, 4u * numPixels);
+  candlewick_shm_frames_close(&reader);
+}
+
+GTEST_TEST(TestSharedFrameSink, acquire_and_overwrite) {
+  SharedFrameSink sink{sinkName(), colorAndDepth, 2};
+  candlewick_shm_frames_reader reader;
+  ASSERT_EQ(candlewick_shm_frames_open(sinkName().c_str(), &reader), 0);
+
+  Uint64 frame;
+  EXPECT_EQ(candlewick_shm_frames_acquire(&reader, &frame), nullptr);
+
+  auto data = makeFrame(7);
+  sink.writeFrame(data.data(), data.size());
+  const candlewick_shm_frames_slot *slot =
+      candlewick_shm_frames_acquire(&reader, &frame);
+  ASSERT_NE(slot, nullptr);
+  EXPECT_EQ(frame, 0u);
+  EXPECT_GT(slot->timestamp_ns, 0u);
+  auto *color =
+      static_cast<const Uint8 *>(candlewick_shm_frames_plane(&reader, slot, 0));
+  EXPECT_EQ(color[0], 7);
+  EXPECT_EQ(color[4 * numPixels - 1], 7);
+  EXPECT_TRUE(candlewick_shm_frames_valid(slot, frame));
+  // nothing new
+  EXPECT_EQ(candlewick_shm_frames_acquire(&reader, &frame), nullptr);
+
+  // wrap around the ring: the acquired frame is overwritten
+  for (Uint8 i = 0; i < 2; i++) {
+    data = makeFrame(i);
+    sink.writeFrame(data.data(), data.size());
+  }
+  EXPECT_FALSE(candlewick_shm_frames_valid(slot, 0));
+  slot = candlewick_shm_frames_acquire(&reader, &frame);
+  ASSERT_NE(slot, nullptr);
+  EXPECT_EQ(frame, 2u);
+  EXPECT_EQ(sink.framesWritten(), 3u);
+  candlewick_shm_frames_close(&reader);
+}
+
+// A new sink with the same name, e.g. after a restart, leaves the mapping of
+// existing readers intact and marks it stale.
+GTEST_TEST(TestSharedFrameSink, replaced_sink) {
+  SharedFrameSink sink{sinkName(), colorAndDepth, 2};
+  auto data = makeFrame(3);
+  sink.writeFrame(data.data(), data.size());
+  candlewick_shm_frames_reader reader;
+  ASSERT_EQ(candlewick_shm_frames_open(sinkName().c_str(), &reader), 0);
+  EXPECT_FALSE(candlewick_shm_frames_stale(&reader));
+
+  // larger frames: the old segment would have grown
+  const ReadbackPlane large[] = {
+      {4 * width, 4 * height, SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM}};
+  SharedFrameSink restarted{sinkName(), large, 2};
+  EXPECT_TRUE(candlewick_shm_frames_stale(&reader));
+  Uint64 frame;
+  EXPECT_EQ(candlewick_shm_frames_acquire(&reader, &frame), nullptr);
+  // the old mapping is still readable
+  const candlewick_shm_frames_slot *slot =
+      candlewick_shm_frames_get_slot(reader.header, 0);
+  EXPECT_EQ(static_cast<const Uint8 *>(
+                candlewick_shm_frames_plane(&reader, slot, 0))[0],
+            3);
+  candlewick_shm_frames_close(&reader);
+
+  ASSERT_EQ(candlewick_shm_frames_open(sinkName().c_str(), &reader), 0);
+  EXPECT_EQ(reader.header->planes[0].width, 4 * width);
+  candlewick_shm_frames_close(&reader);
+}
+
+GTEST_TEST(TestSharedFrameSink, gbuffer_frame) {
+  media::GBufferReadbackConfig config{
+      .width = width,
+      .height = height,
+      .color_format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+      .depth = true,
+  };
+  SharedFrameSink sink{sinkName(), media::readbackPlanes(config)};
+  std::vector<Uint8> color(4 * numPixels, 1);
+  std::vector<float> depth(numPixels, 2.5f);
+  sink.writeFrame(media::GBufferFrame{
+      .width = width,
+      .height = height,
+      .color_format = config.color_format,
+      .color = color,
+      .linear_depth = depth,
+  });
+
+  candlewick_shm_frames_reader reader;
+  ASSERT_EQ(candlewick_shm_frames_open(sinkName().c_str(), &reader), 0);
+  Uint64 frame;
+  const candlewick_shm_frames_slot *slot =
+      candlewick_shm_frames_acquire(&reader, &frame);
+  ASSERT_NE(slot, nullptr);
+  auto *depth_plane =
+      static_cast<const float *>(candlewick_shm_frames_plane(&reader, slot, 1));
+  EXPECT_EQ(depth_plane[0], 2.5f);
+  EXPECT_EQ(depth_plane[numPixels - 1], 2.5f);
+  candlewick_shm_frames_close(&reader);
+
+  // a missing buffer is an error
+  EXPECT_THROW(sink.writeFrame(media::GBufferFrame{
+                   .width = width,
+                   .height = height,
+                   .color_format = config.color_format,
+                   .color = color,
+               }),
+               std::invalid_argument);
+}
+
+/// Frames are consumed by another process, as downstream consumers would.
+GTEST_TEST(TestSharedFrameSink, reader_process) {
+  constexpr Uint32 numFrames = 200;
+  SharedFrameSink sink{sinkName(), colorAndDepth, 4};
+
+  const pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    // child: no gtest assertions, report through the exit code
+    candlewick_shm_frames_reader reader;
+    if (candlewick_shm_frames_open(sinkName().c_str(), &reader) != 0)
+      _exit(2);
+    Uint64 last = 0;
+    bool first = true;
+    while (first || last + 1 < numFrames) {
+      Uint64 frame;
+      const candlewick_shm_frames_slot *slot =
+          candlewick_shm_frames_acquire(&reader, &frame);
+      if (!slot) {
+        std::this_thread::yield();
+        continue;
+      }
+      if (!first && frame <= last)
+        _exit(3);
+      auto *data = static_cast<const Uint8 *>(
+          candlewick_shm_frames_plane(&reader, slot, 0));
+      bool consistent = true;
+      for (Uint32 i = 0; i < sizeof(float) * numPixels; i++)
+        consistent &= data[i] == Uint8(frame);
+      // an inconsistent frame must have been overwritten during the check
+      if (!consistent && candlewick_shm_frames_valid(slot, frame))
+        _exit(4);
+      first = false;
+      last = frame;
+    }
+    candlewick_shm_frames_close(&reader);
+    _exit(0);
+  }
+
+  for (Uint32 i = 0; i < numFrames; i++) {
+    auto data = makeFrame(Uint8(i));
+    sink.writeFrame(data.data(), data.size());
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+}
@@ -0,0 +1,194 @@
+#include "candlewick/utils/SharedMemoryState.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace candlewick;
+
+static std::string channelName() {
+  return std::format("/candlewick_test_state_{:d}", getpid());
+}
+
+/// Channel created by the test, playing the producer.
+struct ProducerChannel {
+  candlewick_shm_state state;
+  ProducerChannel(Uint32 kind, Uint32 dim, Uint32 capacity) {
+    if (candlewick_shm_state_create(channelName().c_str(), kind, dim, capacity,
+                                    &state) != 0)
+      throw std::runtime_error("Failed to create shared state channel.");
+  }
+  ~ProducerChannel() { candlewick_shm_state_destroy(&state, 1); }
+
+  /// Publish sample \p i: all its values, and its timestamp, are \p i.
+  void publish(Uint64 i) {
+    std::vector<double> data(state.header->dim, double(i));
+    candlewick_shm_state_publish(&state, double(i), data.data());
+  }
+};
+
+GTEST_TEST(TestSharedMemoryState, read_latest) {
+  ProducerChannel channel{CANDLEWICK_SHM_STATE_CONFIGURATION, 7, 4};
+  SharedStateReader reader{channelName()};
+  EXPECT_EQ(reader.kind(), SharedStateKind::CONFIGURATION);
+  EXPECT_EQ(reader.dim(), 7u);
+
+  std::vector<double> q(7);
+  double t;
+  EXPECT_FALSE(reader.readLatest(q, t));
+  for (Uint64 i = 0; i < 3; i++)
+    channel.publish(i);
+  ASSERT_TRUE(reader.readLatest(q, t));
+  EXPECT_EQ(t, 2.);
+  EXPECT_EQ(q, std::vector<double>(7, 2.));
+  EXPECT_FALSE(reader.readLatest(q, t));
+  EXPECT_EQ(reader.stats().read, 1u);
+  EXPECT_EQ(reader.stats().skipped, 2u);
+}
+
+GTEST_TEST(TestSharedMemoryState, dimension_mismatch) {
+  ProducerChannel channel{CANDLEWICK_SHM_STATE_PLACEMENTS, 24, 4};
+  SharedStateReader reader{channelName()};
+  // placements of 2 geometries, whatever the configuration size
+  EXPECT_NO_THROW(reader.checkDim(7, 2));
+  EXPECT_THROW(reader.checkDim(24, 3), std::invalid_argument);
+
+  channel.publish(0);
+  std::vector<double> too_small(23);
+  double t;
+  EXPECT_THROW(reader.readLatest(too_small, t), std::invalid_argument);
+}
+
+GTEST_TEST(TestSharedMemoryState, not_initialized) {
+  // created by a producer which did not write the header yet
+  const int fd = shm_open(channelName().c_str(), O_CREAT | O_RDWR, 0600);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(ftruncate(fd, 4096), 0);
+  close(fd);
+  EXPECT_THROW(SharedStateReader{channelName()}, std::runtime_error);
+  shm_unlink(channelName().c_str());
+  EXPECT_THROW(SharedStateReader{channelName()}, std::runtime_error);
+}
+
+// The producer restarts: it creates the channel again, with the same name.
+// The old reader is left with a stale segment, and must not read from it;
+// a new reader sees the new channel.
+GTEST_TEST(TestSharedMemoryState, producer_restart) {
+  ProducerChannel channel{CANDLEWICK_SHM_STATE_CONFIGURATION, 3, 4};
+  SharedStateReader reader{channelName()};
+  std::vector<double> q(3);
+  double t;
+  for (Uint64 i = 0; i < 3; i++)
+    channel.publish(i);
+  ASSERT_TRUE(reader.readLatest(q, t));
+  EXPECT_FALSE(reader.stale());
+
+  candlewick_shm_state restarted;
+  ASSERT_EQ(candlewick_shm_state_create(channelName().c_str(),
+                                        CANDLEWICK_SHM_STATE_CONFIGURATION, 3,
+                                        4, &restarted),
+            0);
+  candlewick_shm_state_publish(&restarted, 10., std::vector(3, 10.).data());
+  EXPECT_FALSE(reader.readLatest(q, t));
+  EXPECT_TRUE(reader.stale());
+  EXPECT_EQ(reader.stats().read, 1u);
+  EXPECT_EQ(reader.stats().skipped, 2u);
+
+  SharedStateReader reopened{reader.name()};
+  ASSERT_TRUE(reopened.readLatest(q, t));
+  EXPECT_EQ(t, 10.);
+  // the old segment is unmapped, but its name now belongs to the new one
+  candlewick_shm_state_destroy(&channel.state, 0);
+  channel.state = restarted;
+}
+
+// A write count going backwards means the ring was reset under the reader.
+GTEST_TEST(TestSharedMemoryState, write_count_reset) {
+  ProducerChannel channel{CANDLEWICK_SHM_STATE_CONFIGURATION, 3, 4};
+  SharedStateReader reader{channelName()};
+  std::vector<double> q(3);
+  double t;
+  for (Uint64 i = 0; i < 3; i++)
+    channel.publish(i);
+  ASSERT_TRUE(reader.readLatest(q, t));
+  __atomic_store_n(&channel.state.header->write_count, 1, __ATOMIC_RELEASE);
+  EXPECT_FALSE(reader.readLatest(q, t));
+  EXPECT_TRUE(reader.stale());
+  EXPECT_EQ(reader.stats().skipped, 2u);
+}
+
+// The producer laps the reader: while the reader copies the newest sample,
+// its slot is overwritten by a newer one. The reader must notice it, and
+// read again.
+GTEST_TEST(TestSharedMemoryState, lapped_reader_retries) {
+  ProducerChannel channel{CANDLEWICK_SHM_STATE_CONFIGURATION, 4, 2};
+  SharedStateReader reader{channelName()};
+  for (Uint64 i = 0; i < 5; i++)
+    channel.publish(i);
+
+  // Sample 5 goes to the slot of sample 3, the newest one the reader sees.
+  // Leave it half-written, as if the producer was preempted while the
+  // reader copies the slot, and the newest sample still at 4...
+  candlewick_shm_state_header *header = channel.state.header;
+  candlewick_shm_state_slot *slot = candlewick_shm_state_get_slot(header, 5);
+  __atomic_store_n(&header->write_count, 4, __ATOMIC_RELEASE);
+  __atomic_store_n(&slot->sequence, 2 * 5 + 1, __ATOMIC_RELEASE);
+  // ...then let the producer finish writing it.
+  std::thread producer{[&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::vector<double> data(4, 5.);
+    slot->timestamp = 5.;
+    std::memcpy(slot + 1, data.data(), sizeof(double) * data.size());
+    __atomic_store_n(&slot->sequence, 2 * 5 + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->write_count, 6, __ATOMIC_RELEASE);
+  }};
+
+  std::vector<double> q(4);
+  double t;
+  ASSERT_TRUE(reader.readLatest(q, t));
+  producer.join();
+  EXPECT_EQ(t, 5.);
+  EXPECT_EQ(q, std::vector<double>(4, 5.));
+  EXPECT_GE(reader.stats().retries, 1u);
+}
+
+// A producer publishing as fast as possible in a ring of 2 slots laps the
+// reader often. Every sample read must be whole: its values all equal its
+// timestamp, which increases.
+GTEST_TEST(TestSharedMemoryState, no_torn_reads) {
+  constexpr Uint32 dim = 4096;
+  constexpr Uint64 num_samples = 20'000;
+  ProducerChannel channel{CANDLEWICK_SHM_STATE_CONFIGURATION, dim, 2};
+  SharedStateReader reader{channelName()};
+
+  std::atomic<bool> done = false;
+  std::thread producer{[&] {
+    for (Uint64 i = 1; i <= num_samples; i++)
+      channel.publish(i);
+    done.store(true, std::memory_order_release);
+  }};
+
+  std::vector<double> q(dim);
+  double t, last_t = 0.;
+  Uint64 torn = 0;
+  while (last_t < double(num_samples)) {
+    if (!reader.readLatest(q, t)) {
+      if (done.load(std::memory_order_acquire) && last_t == 0.)
+        break;
+      continue;
+    }
+    EXPECT_GT(t, last_t);
+    last_t = t;
+    for (double x : q)
+      torn += x != t;
+  }
+  producer.join();
+  EXPECT_EQ(torn, 0u);
+  EXPECT_EQ(last_t, double(num_samples));
+  EXPECT_EQ(reader.stats().read + reader.stats().skipped, num_samples);
+}
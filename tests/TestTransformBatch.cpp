@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include "candlewick/core/TransformBatch.h"
+#include <Eigen/Geometry>
+
+using namespace candlewick;
+
+static std::vector<Uint32> toVector(std::span<const Uint32> s) {
+  return {s.begin(), s.end()};
+}
+
+GTEST_TEST(TestTransformBatch, conversion) {
+  TransformBatch batch;
+  batch.resize(2);
+  const Eigen::Matrix3d R =
+      Eigen::AngleAxisd{0.3, Eigen::Vector3d::UnitY()}.toRotationMatrix();
+  const Eigen::Vector3d p{1., -2., 3.};
+  batch.setPlacement(1, R, p);
+  batch.update();
+
+  Mat4f expected = Mat4f::Identity();
+  expected.topLeftCorner<3, 3>() = R.cast<float>();
+  expected.topRightCorner<3, 1>() = p.cast<float>();
+  EXPECT_TRUE(batch.matrix(1).isApprox(expected));
+  EXPECT_EQ(batch.matrix(1).row(3), Float4(0.f, 0.f, 0.f, 1.f).transpose());
+}
+
+GTEST_TEST(TestTransformBatch, change_tracking) {
+  TransformBatch batch;
+  batch.resize(4);
+  const Eigen::Matrix3d R = Eigen::Matrix3d::Identity();
+  // everything is new after a resize
+  EXPECT_EQ(batch.update().size(), 4u);
+  EXPECT_TRUE(batch.update().empty());
+
+  // same placement: no change
+  batch.setPlacement(0, R, Eigen::Vector3d::Zero());
+  EXPECT_TRUE(batch.update().empty());
+
+  batch.setPlacement(2, R, Eigen::Vector3d::UnitX());
+  // set twice, reported once
+  batch.setPlacement(3, R, Eigen::Vector3d::UnitY());
+  batch.setPlacement(3, R, Eigen::Vector3d::UnitZ());
+  EXPECT_EQ(toVector(batch.update()), (std::vector<Uint32>{2, 3}));
+  const Float3 p3 = batch.matrix(3).topRightCorner<3, 1>();
+  EXPECT_TRUE(p3.isApprox(Float3::UnitZ()));
+
+  batch.invalidate();
+  EXPECT_EQ(batch.update().size(), 4u);
+}
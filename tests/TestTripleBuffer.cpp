@@ -0,0 +1,61 @@
+#include "candlewick/utils/TripleBuffer.h"
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace candlewick;
+
+GTEST_TEST(TestTripleBuffer, latest_value) {
+  TripleBuffer<int> buffer{-1};
+  EXPECT_FALSE(buffer.consume());
+  EXPECT_EQ(buffer.readBuffer(), -1);
+
+  buffer.writeBuffer() = 1;
+  buffer.publish();
+  EXPECT_TRUE(buffer.consume());
+  EXPECT_EQ(buffer.readBuffer(), 1);
+  EXPECT_FALSE(buffer.consume());
+  EXPECT_EQ(buffer.readBuffer(), 1);
+
+  // values which are not consumed are overwritten
+  for (int i = 2; i < 6; i++) {
+    buffer.writeBuffer() = i;
+    buffer.publish();
+  }
+  EXPECT_TRUE(buffer.consume());
+  EXPECT_EQ(buffer.readBuffer(), 5);
+  EXPECT_FALSE(buffer.consume());
+}
+
+struct Payload {
+  Uint64 a;
+  Uint64 b;
+};
+
+GTEST_TEST(TestTripleBuffer, concurrent) {
+  constexpr Uint64 numValues = 200000;
+  TripleBuffer<Payload> buffer{Payload{0, 0}};
+
+  std::thread producer{[&] {
+    for (Uint64 i = 1; i <= numValues; i++) {
+      // non-atomic payload: a torn read would be detected
+      Payload &p = buffer.writeBuffer();
+      p.a = i;
+      p.b = ~i;
+      buffer.publish();
+    }
+  }};
+
+  Uint64 last = 0;
+  while (last < numValues) {
+    if (!buffer.consume())
+      continue;
+    const Payload &p = buffer.readBuffer();
+    ASSERT_EQ(p.b, ~p.a);
+    // values arrive in order, possibly skipping some
+    ASSERT_GT(p.a, last);
+    last = p.a;
+  }
+  producer.join();
+  EXPECT_EQ(last, numValues);
+}
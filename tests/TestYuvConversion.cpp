@@ -0,0 +1,159 @@
+#include "HeadlessRenderer.h"
+#include "candlewick/core/CommandBuffer.h"
+#include "candlewick/core/Device.h"
+#include "candlewick/core/Texture.h"
+#include "candlewick/utils/FrameReadback.h"
+#include "candlewick/utils/YuvConversion.h"
+#include <gtest/gtest.h>
+
+#include <SDL3/SDL_init.h>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <utility>
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+using namespace candlewick;
+
+constexpr Uint32 width = 64;
+constexpr Uint32 height = 48;
+
+/// Random RGBA image, constant over 2x2 blocks so that the chroma planes do
+/// not depend on the chroma siting convention.
+static std::vector<Uint8> makeTestImage() {
+  std::mt19937 rng{42};
+  std::uniform_int_distribution<int> dist{0, 255};
+  std::vector<Uint8> rgba(4 * width * height);
+  for (Uint32 by = 0; by < height; by += 2) {
+    for (Uint32 bx = 0; bx < width; bx += 2) {
+      const Uint8 color[4] = {Uint8(dist(rng)), Uint8(dist(rng)),
+                              Uint8(dist(rng)), 255};
+      for (Uint32 y = by; y < by + 2; y++)
+        for (Uint32 x = bx; x < bx + 2; x++)
+          std::memcpy(&rgba[4 * (y * width + x)], color, 4);
+    }
+  }
+  return rgba;
+}
+
+/// Reference conversion to YUV420P using libswscale.
+static std::vector<Uint8> swscaleReference(const std::vector<Uint8> &rgba) {
+  std::vector<Uint8> yuv(width * height * 3 / 2);
+  SwsContext *sws = sws_getContext(
+      width, height, AV_PIX_FMT_RGBA, width, height, AV_PIX_FMT_YUV420P,
+      SWS_POINT | SWS_ACCURATE_RND | SWS_BITEXACT, nullptr, nullptr, nullptr);
+  const Uint8 *src[1] = {rgba.data()};
+  const int srcStride[1] = {int(4 * width)};
+  Uint8 *dst[3] = {yuv.data(), yuv.data() + width * height,
+                   yuv.data() + width * height * 5 / 4};
+  const int dstStride[3] = {int(width), int(width / 2), int(width / 2)};
+  sws_scale(sws, src, srcStride, 0, height, dst, dstStride);
+  sws_freeContext(sws);
+  return yuv;
+}
+
+/// Upload \p rgba to a new texture with the given usage, and convert it to
+/// NV12 on the GPU.
+static std::vector<Uint8> gpuConversion(const Device &device,
+                                        const std::vector<Uint8> &rgba,
+                                        SDL_GPUTextureUsageFlags usage,
+                                        bool copy_source) {
+  Texture source{device,
+                 SDL_GPUTextureCreateInfo{
+                     .type = SDL_GPU_TEXTURETYPE_2D,
+                     .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+                     .usage = usage,
+                     .width = width,
+                     .height = height,
+                     .layer_count_or_depth = 1,
+                     .num_levels = 1,
+                     .sample_count = SDL_GPU_SAMPLECOUNT_1,
+                     .props = 0,
+                 },
+                 "Test image"};
+  SDL_GPUTransferBufferCreateInfo upload_info{
+      .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+      .size = Uint32(rgba.size()),
+      .props = 0,
+  };
+  SDL_GPUTransferBuffer *upload =
+      SDL_CreateGPUTransferBuffer(device, &upload_info);
+  void *mapped = SDL_MapGPUTransferBuffer(device, upload, false);
+  std::memcpy(mapped, rgba.data(), rgba.size());
+  SDL_UnmapGPUTransferBuffer(device, upload);
+
+  media::YuvConverter converter =
+      copy_source ? media::YuvConverter{device, width, height,
+                                        source.format(), width, height}
+                  : media::YuvConverter{device, width, height};
+  const media::ReadbackPlane planes[] = {
+      {width, height, converter.yPlane.format()},
+      {width / 2, height / 2, converter.uvPlane.format()},
+  };
+  std::vector<Uint8> nv12;
+  media::FrameReadbackRing ring{
+      device, planes,
+      [&](const Uint8 *data, Uint32 size) { nv12.assign(data, data + size); },
+      1};
+
+  CommandBuffer cmdBuf{device};
+  SDL_GPUCopyPass *copy_pass = SDL_BeginGPUCopyPass(cmdBuf);
+  SDL_GPUTextureTransferInfo src_info{.transfer_buffer = upload, .offset = 0};
+  SDL_GPUTextureRegion dst_region{
+      .texture = source, .w = width, .h = height, .d = 1};
+  SDL_UploadToGPUTexture(copy_pass, &src_info, &dst_region, false);
+  SDL_EndGPUCopyPass(copy_pass);
+  converter.convert(cmdBuf, source);
+  EXPECT_TRUE(ring.submitFrame(cmdBuf, converter.planes()));
+  ring.flush();
+  EXPECT_EQ(nv12.size(), converter.payloadSize());
+
+  ring.release();
+  converter.release();
+  SDL_ReleaseGPUTransferBuffer(device, upload);
+  source.destroy();
+  return nv12;
+}
+
+GTEST_TEST(TestYuvConversion, matches_swscale) {
+  if (!SDL_Init(SDL_INIT_VIDEO))
+    GTEST_SKIP() << "Could not initialize SDL video: " << SDL_GetError();
+  std::optional<Device> device = tryCreateDevice();
+  if (!device) {
+    SDL_Quit();
+    GTEST_SKIP() << "No GPU device available: " << SDL_GetError();
+  }
+
+  const std::vector<Uint8> rgba = makeTestImage();
+  const std::vector<Uint8> ref = swscaleReference(rgba);
+  const Uint8 *refU = ref.data() + width * height;
+  const Uint8 *refV = refU + width * height / 4;
+
+  // the second source cannot be sampled, like swapchain textures, and is
+  // copied by the converter
+  const std::pair<SDL_GPUTextureUsageFlags, bool> sources[] = {
+      {SDL_GPU_TEXTUREUSAGE_SAMPLER, false},
+      {SDL_GPU_TEXTUREUSAGE_COLOR_TARGET, true},
+  };
+  for (auto [usage, copy_source] : sources) {
+    SCOPED_TRACE(copy_source ? "copied source" : "sampled source");
+    const std::vector<Uint8> nv12 =
+        gpuConversion(*device, rgba, usage, copy_source);
+    ASSERT_EQ(nv12.size(), ref.size());
+
+    // the shaders use libswscale's integer arithmetic: bytes must match
+    for (Uint32 i = 0; i < width * height; i++)
+      EXPECT_EQ(nv12[i], ref[i]) << "luma " << i;
+    const Uint8 *uv = nv12.data() + width * height;
+    for (Uint32 i = 0; i < width * height / 4; i++) {
+      EXPECT_EQ(uv[2 * i], refU[i]) << "U " << i;
+      EXPECT_EQ(uv[2 * i + 1], refV[i]) << "V " << i;
+    }
+  }
+
+  device->destroy();
+  SDL_Quit();
+}